@@ -18,8 +18,13 @@ LOCAL_PATH := art
 
 TEST_COMMON_SRC_FILES := \
 	compiler/dex/arena_allocator_test.cc \
+	compiler/dex/mir_optimization_test.cc \
+	compiler/dex/quick/local_optimizations_test.cc \
+	compiler/dex/quick/mir_to_lir_test.cc \
+	compiler/driver/compilation_cache_test.cc \
 	compiler/driver/compiler_driver_test.cc \
 	compiler/elf_writer_test.cc \
+	compiler/gc_map_builder_test.cc \
 	compiler/image_test.cc \
 	compiler/jni/jni_compiler_test.cc \
 	compiler/leb128_encoder_test.cc \
@@ -39,6 +44,7 @@ TEST_COMMON_SRC_FILES := \
 	runtime/base/unix_file/random_access_file_utils_test.cc \
 	runtime/base/unix_file/string_file_test.cc \
 	runtime/class_linker_test.cc \
+	runtime/dex_cache_prefetcher_test.cc \
 	runtime/dex_file_test.cc \
 	runtime/dex_instruction_visitor_test.cc \
 	runtime/dex_method_iterator_test.cc \
@@ -55,12 +61,15 @@ TEST_COMMON_SRC_FILES := \
 	runtime/mem_map_test.cc \
 	runtime/mirror/dex_cache_test.cc \
 	runtime/mirror/object_test.cc \
+	runtime/profiler_test.cc \
 	runtime/reference_table_test.cc \
 	runtime/runtime_test.cc \
 	runtime/thread_pool_test.cc \
+	runtime/thread_test.cc \
 	runtime/utils_test.cc \
 	runtime/verifier/method_verifier_test.cc \
 	runtime/verifier/reg_type_test.cc \
+	runtime/verifier/verification_cache_test.cc \
 	runtime/zip_archive_test.cc
 
 ifeq ($(ART_SEA_IR_MODE),true)
@@ -14,7 +14,7 @@
  * limitations under the License.
  */
 
-#include "arena_allocator.h"
+#include "base/arena_allocator.h"
 #include "arena_bit_vector.h"
 #include "gtest/gtest.h"
 
@@ -30,4 +30,13 @@ TEST(ArenaAllocator, Test) {
   EXPECT_EQ(2U, bv.GetStorageSize());
 }
 
+TEST(ArenaAllocator, Alignment) {
+  ArenaPool pool;
+  ArenaAllocator arena(&pool);
+  for (size_t bytes = 1; bytes < 32; ++bytes) {
+    void* ptr = arena.Alloc(bytes, ArenaAllocator::kAllocMisc);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % ArenaAllocator::kAlignment);
+  }
+}
+
 }  // namespace art
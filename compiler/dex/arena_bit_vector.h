@@ -17,7 +17,7 @@
 #ifndef ART_COMPILER_DEX_ARENA_BIT_VECTOR_H_
 #define ART_COMPILER_DEX_ARENA_BIT_VECTOR_H_
 
-#include "arena_allocator.h"
+#include "base/arena_allocator.h"
 #include "base/bit_vector.h"
 #include "compiler_enums.h"
 
@@ -17,8 +17,8 @@
 #ifndef ART_COMPILER_DEX_BACKEND_H_
 #define ART_COMPILER_DEX_BACKEND_H_
 
+#include "base/arena_allocator.h"
 #include "compiled_method.h"
-#include "arena_allocator.h"
 
 namespace art {
 
@@ -22,6 +22,27 @@
 
 namespace art {
 
+/**
+ * @class MethodInlining
+ * @brief Inline the calls to trivial methods, before the other passes look at the code.
+ */
+class MethodInlining : public Pass {
+ public:
+  MethodInlining():Pass("MethodInlining", "1_post_inlining_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    return ((cUnit->disable_opt & (1 << kMethodInlining)) == 0) &&
+        (cUnit->compiler_driver->GetMethodInlinerMap() != nullptr);
+  }
+
+  bool WalkBasicBlocks(CompilationUnit *cUnit, BasicBlock *bb) const {
+    cUnit->mir_graph->InlineCalls(bb);
+    // No need of repeating, so just return false.
+    return false;
+  }
+};
+
 /**
  * @class CodeLayout
  * @brief Perform the code layout pass.
@@ -56,6 +77,42 @@ class SSATransformation : public Pass {
   void End(CompilationUnit *cUnit) const;
 };
 
+/**
+ * @class ScalarReplacement
+ * @brief Replace the objects that don't escape the method by their fields.
+ */
+class ScalarReplacement : public Pass {
+ public:
+  ScalarReplacement():Pass("ScalarReplacement", "3_post_scalar_replacement_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    return ((cUnit->disable_opt & (1 << kScalarReplacement)) == 0);
+  }
+
+  void Start(CompilationUnit *cUnit) const {
+    cUnit->mir_graph->DoScalarReplacement();
+  }
+};
+
+/**
+ * @class Vectorization
+ * @brief Replace the leading iterations of simple int array loops by packed operations.
+ */
+class Vectorization : public Pass {
+ public:
+  Vectorization():Pass("Vectorization", "3_post_vectorization_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    return ((cUnit->disable_opt & (1 << kVectorization)) == 0);
+  }
+
+  void Start(CompilationUnit *cUnit) const {
+    cUnit->mir_graph->DoVectorization();
+  }
+};
+
 /**
  * @class ConstantPropagation
  * @brief Perform a constant propagation pass.
@@ -128,6 +185,62 @@ class NullCheckEliminationAndTypeInference : public Pass {
   }
 };
 
+/**
+ * @class LoopInvariantCodeMotion
+ * @brief Move loop invariant computations and loads to the loop preheaders.
+ */
+class LoopInvariantCodeMotion : public Pass {
+ public:
+  LoopInvariantCodeMotion():Pass("LICM", "4_post_licm_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    // The null check state at the end of the preheader tells which loads can be hoisted.
+    return ((cUnit->disable_opt & (1 << kLoopInvariantCodeMotion)) == 0) &&
+        ((cUnit->disable_opt & (1 << kNullCheckElimination)) == 0);
+  }
+
+  void Start(CompilationUnit *cUnit) const {
+    cUnit->mir_graph->DoLoopInvariantCodeMotion();
+  }
+};
+
+/**
+ * @class GlobalValueNumbering
+ * @brief Remove the null and range checks already done by a dominating block.
+ */
+class GlobalValueNumbering : public Pass {
+ public:
+  GlobalValueNumbering():Pass("GVN", "4_post_gvn_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    return ((cUnit->disable_opt & (1 << kGlobalValueNumbering)) == 0);
+  }
+
+  void Start(CompilationUnit *cUnit) const {
+    cUnit->mir_graph->DoGlobalValueNumbering();
+  }
+};
+
+/**
+ * @class BoundsCheckElimination
+ * @brief Remove the range checks of array accesses indexed by loop induction variables.
+ */
+class BoundsCheckElimination : public Pass {
+ public:
+  BoundsCheckElimination():Pass("BCE", "4_post_bce_cfg") {
+  }
+
+  bool Gate(const CompilationUnit *cUnit) const {
+    return ((cUnit->disable_opt & (1 << kBoundsCheckElimination)) == 0);
+  }
+
+  void Start(CompilationUnit *cUnit) const {
+    cUnit->mir_graph->DoLoopBoundsCheckElimination();
+  }
+};
+
 /**
  * @class NullCheckEliminationAndTypeInference
  * @brief Null check elimination and type inference.
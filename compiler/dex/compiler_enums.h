@@ -128,6 +128,7 @@ enum ExtendedMIROpcode {
   kMirOpCheck,
   kMirOpCheckPart2,
   kMirOpSelect,
+  kMirOpPackedArrayLoop,
   kMirOpLast,
 };
 
@@ -144,6 +145,15 @@ enum MIROptimizationFlagPositons {
   kMIRMark,                           // Temporary node mark.
 };
 
+// Kept in the vB of a kMirOpPackedArrayLoop.
+enum PackedArrayLoopFlags {
+  kPackedLoopBoundIsArray = 1,        // The loop bound is the length of the array.
+  kPackedLoopReduction = 2,           // Elements are folded into a sum rather than stored.
+  kPackedLoopArray1 = 4,              // The first operand is an array rather than a value.
+  kPackedLoopArray2 = 8,              // The second operand is an array rather than a value.
+  kPackedLoopLiteral2 = 16,           // The second operand is the literal in vC.
+};
+
 // For successor_block_list.
 enum BlockListType {
   kNotUsed = 0,
@@ -404,6 +414,7 @@ enum OatBitMapKind {
   kBitMapNullCheck,
   kBitMapTmpBlockV,
   kBitMapPredecessors,
+  kBitMapLoopBlocks,
   kNumBitMapKinds
 };
 
@@ -85,6 +85,15 @@ static uint32_t kCompilerOptimizerDisableFlags = 0 |  // Disable specific optimi
   // (1 << kMatch) |
   // (1 << kPromoteCompilerTemps) |
   // (1 << kSuppressExceptionEdges) |
+  // (1 << kGlobalValueNumbering) |
+  // (1 << kLoopInvariantCodeMotion) |
+  // (1 << kBoundsCheckElimination) |
+  // (1 << kMethodInlining) |
+  // (1 << kTrackLiveTempsAcrossBlocks) |
+  // (1 << kGuardedDevirtualization) |
+  // (1 << kScalarReplacement) |
+  // (1 << kVectorization) |
+  // (1 << kListScheduling) |
   0;
 
 static uint32_t kCompilerDebugFlags = 0 |     // Enable debug/testing modes
@@ -212,10 +221,13 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
    */
 
   if (compiler_backend == kPortable) {
-    // Fused long branches not currently useful in bitcode.
+    // Fused long branches not currently useful in bitcode, and code motion and vectorization
+    // are left to LLVM.
     cu.disable_opt |=
         (1 << kBranchFusing) |
-        (1 << kSuppressExceptionEdges);
+        (1 << kSuppressExceptionEdges) |
+        (1 << kLoopInvariantCodeMotion) |
+        (1 << kVectorization);
   }
 
   if (cu.instruction_set == kMips) {
@@ -230,7 +242,16 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
         (1 << kSafeOptimizations) |
         (1 << kBBOpt) |
         (1 << kMatch) |
-        (1 << kPromoteCompilerTemps));
+        (1 << kPromoteCompilerTemps) |
+        (1 << kGlobalValueNumbering) |
+        (1 << kLoopInvariantCodeMotion) |
+        (1 << kVectorization) |
+        (1 << kListScheduling));
+  }
+
+  if (cu.instruction_set == kThumb2 && !cu.GetInstructionSetFeatures().HasNeon()) {
+    // The packed loops are expanded with NEON instructions.
+    cu.disable_opt |= (1 << kVectorization);
   }
 
   cu.StartTimingSplit("BuildMIRGraph");
@@ -247,7 +268,9 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
 
   cu.NewTimingSplit("MIROpt:CheckFilters");
 #if !defined(ART_USE_PORTABLE_COMPILER)
-  if (cu.mir_graph->SkipCompilation(Runtime::Current()->GetCompilerFilter())) {
+  // With a profile only hot methods get here, always compile them.
+  if (!compiler.HasHotMethods() &&
+      cu.mir_graph->SkipCompilation(Runtime::Current()->GetCompilerFilter())) {
     return NULL;
   }
 #endif
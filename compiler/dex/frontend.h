@@ -52,6 +52,15 @@ enum opt_control_vector {
   kPromoteCompilerTemps,
   kBranchFusing,
   kSuppressExceptionEdges,
+  kGlobalValueNumbering,
+  kLoopInvariantCodeMotion,
+  kBoundsCheckElimination,
+  kMethodInlining,
+  kTrackLiveTempsAcrossBlocks,
+  kGuardedDevirtualization,
+  kScalarReplacement,
+  kVectorization,
+  kListScheduling,
 };
 
 // Force code generation paths for testing.
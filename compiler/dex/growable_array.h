@@ -19,8 +19,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "base/arena_allocator.h"
 #include "compiler_enums.h"
-#include "arena_allocator.h"
 
 namespace art {
 
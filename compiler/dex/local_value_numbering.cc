@@ -28,8 +28,6 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::RETURN:
     case Instruction::RETURN_OBJECT:
     case Instruction::RETURN_WIDE:
-    case Instruction::MONITOR_ENTER:
-    case Instruction::MONITOR_EXIT:
     case Instruction::GOTO:
     case Instruction::GOTO_16:
     case Instruction::GOTO_32:
@@ -52,6 +50,16 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::IF_GEZ:
     case Instruction::IF_GTZ:
     case Instruction::IF_LEZ:
+    case kMirOpFusedCmplFloat:
+    case kMirOpFusedCmpgFloat:
+    case kMirOpFusedCmplDouble:
+    case kMirOpFusedCmpgDouble:
+    case kMirOpFusedCmpLong:
+      // Nothing defined - take no action.
+      break;
+
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
     case Instruction::INVOKE_STATIC_RANGE:
     case Instruction::INVOKE_STATIC:
     case Instruction::INVOKE_DIRECT:
@@ -62,12 +70,13 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::INVOKE_SUPER_RANGE:
     case Instruction::INVOKE_INTERFACE:
     case Instruction::INVOKE_INTERFACE_RANGE:
-    case kMirOpFusedCmplFloat:
-    case kMirOpFusedCmpgFloat:
-    case kMirOpFusedCmplDouble:
-    case kMirOpFusedCmpgDouble:
-    case kMirOpFusedCmpLong:
-      // Nothing defined - take no action.
+      // The callee, or another thread we synchronize with, may write any field or array element.
+      ClobberMemory();
+      break;
+
+    case kMirOpPackedArrayLoop:
+      // Stores array elements, the index and sum it leaves get values of their own on first use.
+      ClobberMemory();
       break;
 
     case Instruction::MOVE_EXCEPTION:
@@ -93,8 +102,8 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
 
     case kMirOpPhi:
       /*
-       * Because we'll only see phi nodes at the beginning of an extended basic block,
-       * we can ignore them.  Revisit if we shift to global value numbering.
+       * Phi nodes only start extended basic blocks, and blocks with several predecessors in global
+       * value numbering. Their result gets a value of its own on first use.
        */
       break;
 
@@ -33,7 +33,11 @@ typedef SafeMap<uint32_t, uint16_t> MemoryVersionMap;
 
 class LocalValueNumbering {
  public:
-  explicit LocalValueNumbering(CompilationUnit* cu) : cu_(cu) {}
+  // Value names and memory versions stay below this, clear of NO_VALUE and ARRAY_REF.
+  static constexpr size_t kMaxValueNames = 0xff00;
+
+  explicit LocalValueNumbering(CompilationUnit* cu)
+      : cu_(cu), memory_version_base_(0), last_memory_version_(0) {}
 
   static uint64_t BuildKey(uint16_t op, uint16_t operand1, uint16_t operand2, uint16_t modifier) {
     return (static_cast<uint64_t>(op) << 48 | static_cast<uint64_t>(operand1) << 32 |
@@ -64,7 +68,7 @@ class LocalValueNumbering {
     uint16_t res;
     MemoryVersionMap::iterator it = memory_version_map_.find(key);
     if (it == memory_version_map_.end()) {
-      res = 0;
+      res = memory_version_base_;
       memory_version_map_.Put(key, res);
     } else {
       res = it->second;
@@ -74,12 +78,19 @@ class LocalValueNumbering {
 
   void AdvanceMemoryVersion(uint16_t base, uint16_t field) {
     uint32_t key = (base << 16) | field;
-    MemoryVersionMap::iterator it = memory_version_map_.find(key);
-    if (it == memory_version_map_.end()) {
-      memory_version_map_.Put(key, 0);
-    } else {
-      it->second++;
-    }
+    memory_version_map_.Overwrite(key, ++last_memory_version_);
+  };
+
+  // Forget what is known about memory, for calls and for blocks entered from more than one place.
+  void ClobberMemory() {
+    memory_version_map_.clear();
+    memory_version_base_ = ++last_memory_version_;
+  };
+
+  // Whether value names or memory versions are about to run out, after which nothing more may be
+  // numbered.
+  bool IsFull() const {
+    return value_map_.size() >= kMaxValueNames || last_memory_version_ >= kMaxValueNames;
   };
 
   void SetOperandValue(uint16_t s_reg, uint16_t value) {
@@ -134,6 +145,9 @@ class LocalValueNumbering {
   SregValueMap sreg_wide_value_map_;
   ValueMap value_map_;
   MemoryVersionMap memory_version_map_;
+  // Version of memory locations not written since memory was last clobbered.
+  uint16_t memory_version_base_;
+  uint16_t last_memory_version_;
   std::set<uint16_t> null_checked_;
 };
 
@@ -833,6 +833,9 @@ const uint32_t MIRGraph::analysis_attributes_[kMirOpLast] = {
 
   // 113 MIR_SELECT
   AN_NONE,
+
+  // 114 MIR_PACKED_ARRAY_LOOP
+  AN_NONE,
 };
 
 struct MethodStats {
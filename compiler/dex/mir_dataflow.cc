@@ -840,6 +840,9 @@ const uint64_t MIRGraph::oat_data_flow_attributes_[kMirOpLast] = {
 
   // 113 MIR_SELECT
   DF_DA | DF_UB,
+
+  // 114 MIR_PACKED_ARRAY_LOOP
+  DF_DA | DF_UA | DF_CORE_A,
 };
 
 /* Return the base virtual register for a SSA name */
@@ -290,6 +290,17 @@ struct BasicBlock {
   GrowableArray<SuccessorBlockInfo*>* successor_blocks;
 };
 
+/*
+ * A natural loop: the blocks that reach a back edge to the header without going through it.
+ * Loops sharing a header are merged.
+ */
+struct NaturalLoop {
+  BasicBlock* header;
+  ArenaBitVector* blocks;                  // Includes the header.
+  GrowableArray<BasicBlockId>* back_edges;  // Blocks branching back to the header.
+  size_t num_blocks;
+};
+
 /*
  * The "blocks" field in "successor_block_list" points to an array of elements with the type
  * "SuccessorBlockInfo".  For catch blocks, key is type index for the exception.  For swtich
@@ -718,6 +729,56 @@ class MIRGraph {
    */
   void CombineBlocks(BasicBlock* bb);
 
+  /**
+   * @brief Find the natural loops of the method, inner loops first.
+   * @param loops the vector the loops are added to.
+   */
+  void FindNaturalLoops(std::vector<NaturalLoop>* loops);
+
+  /**
+   * @brief Get the block entering a loop, if there is exactly one and it only branches there.
+   * @param loop the considered NaturalLoop.
+   * @return the preheader or NULL.
+   */
+  BasicBlock* GetLoopPreheader(const NaturalLoop& loop);
+
+  /**
+   * @brief Number values along the dominator tree to remove the null and range checks that a
+   * dominating block already did.
+   */
+  void DoGlobalValueNumbering();
+
+  /**
+   * @brief Move the loop invariant computations and loads of each loop to its preheader.
+   */
+  void DoLoopInvariantCodeMotion();
+
+  /**
+   * @brief Remove the range checks of array accesses indexed by a loop's induction variable
+   * when the loop test keeps the index within the array.
+   */
+  void DoLoopBoundsCheckElimination();
+
+  /**
+   * @brief Replace the objects that never leave the method and whose constructor only copies
+   * its arguments into fields by the registers holding those arguments.
+   */
+  void DoScalarReplacement();
+
+  /**
+   * @brief Run the leading iterations of loops that combine int array elements four at a time,
+   * with a kMirOpPackedArrayLoop in the loop's preheader.
+   */
+  void DoVectorization();
+
+  /**
+   * @brief Replace the calls of a BasicBlock to getters, setters and other trivial methods
+   * that can't be overridden with the callee's code. Longer callees are not inlined: frames,
+   * mapping tables and GC maps describe a single dex method.
+   * @param bb the considered BasicBlock.
+   */
+  void InlineCalls(BasicBlock* bb);
+
   void ClearAllVisitedFlags();
   /*
    * IsDebugBuild sanity check: keep track of the Dex PCs for catch entries so that later on
@@ -780,6 +841,13 @@ class MIRGraph {
   void SetConstantWide(int ssa_reg, int64_t value);
   int GetSSAUseCount(int s_reg);
   bool BasicBlockOpt(BasicBlock* bb);
+  bool IsLoopInvariant(const NaturalLoop& loop, BasicBlock* preheader, MIR* mir,
+                       const ArenaBitVector* loop_defs, const int* vreg_def_counts,
+                       bool loop_writes_fields);
+  void HoistLoopInvariants(const NaturalLoop& loop);
+  void EliminateLoopRangeChecks(const NaturalLoop& loop, const std::vector<MIR*>& ssa_defs);
+  bool HoldsSRegBefore(BasicBlock* bb, MIR* mir, int s_reg);
+  void VectorizeLoop(const NaturalLoop& loop);
   bool BuildExtendedBBList(struct BasicBlock* bb);
   bool FillDefBlockMatrix(BasicBlock* bb);
   void InitializeDominationInfo(BasicBlock* bb);
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEX_MIR_GRAPH_TEST_H_
+#define ART_COMPILER_DEX_MIR_GRAPH_TEST_H_
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "UniquePtr.h"
+#include "common_test.h"
+#include "compiler_internals.h"
+#include "dataflow_iterator-inl.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/dex_cache-inl.h"
+#include "object_utils.h"
+#include "pass.h"
+#include "pass_driver.h"
+
+namespace art {
+
+/*
+ * Runs the Quick middle end on one method of a test dex file, pass by pass, so that tests can
+ * look at the MIR graph an optimization leaves behind.
+ */
+class MirGraphTest : public CommonTest {
+ protected:
+  class TestPassDriver : public PassDriver {
+   public:
+    explicit TestPassDriver(CompilationUnit* cu) : PassDriver(cu) {
+    }
+
+    void LaunchThrough(const char* last_pass) {
+      for (const Pass* pass : pass_list_) {
+        RunPass(cu_, pass);
+        if (strcmp(pass->GetName(), last_pass) == 0) {
+          return;
+        }
+      }
+      LOG(FATAL) << "No pass " << last_pass;
+    }
+  };
+
+  MirGraphTest() : class_loader_(NULL) {
+  }
+
+  virtual void SetUp() {
+    CommonTest::SetUp();
+    cu_.reset(new CompilationUnit(&compiler_driver_->GetArenaPool()));
+  }
+
+  virtual void TearDown() {
+    cu_.reset();
+    CommonTest::TearDown();
+  }
+
+  // Loads and verifies class_name from the test dex file dex_name. Verification records the
+  // facts about its methods that the compiler relies on. The types of the dex file are resolved
+  // first, as the driver does before it compiles.
+  mirror::Class* VerifyClass(const char* dex_name, const char* class_name)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (class_loader_ == NULL) {
+      class_loader_ = LoadDex(dex_name);
+    }
+    Thread* self = Thread::Current();
+    SirtRef<mirror::ClassLoader> loader(self,
+        down_cast<mirror::ClassLoader*>(self->DecodeJObject(class_loader_)));
+    std::string descriptor(DotToDescriptor(class_name));
+    SirtRef<mirror::Class> klass(self, class_linker_->FindClass(descriptor.c_str(), loader));
+    CHECK(klass.get() != NULL) << "Class not found " << class_name;
+    SirtRef<mirror::DexCache> dex_cache(self, klass->GetDexCache());
+    const DexFile& dex_file = *dex_cache->GetDexFile();
+    for (size_t type_idx = 0; type_idx < dex_file.NumTypeIds(); ++type_idx) {
+      if (class_linker_->ResolveType(dex_file, type_idx, dex_cache, loader) == NULL) {
+        self->ClearException();
+      }
+    }
+    class_linker_->VerifyClass(klass);
+    CHECK(klass->IsVerified()) << class_name;
+    return klass.get();
+  }
+
+  // Builds the MIR graph of a method of class_name from the test dex file dex_name. Optimizations
+  // may be turned off in cu_->disable_opt before running the passes.
+  void BuildMIRGraph(const char* dex_name, const char* class_name, const char* method_name,
+                     const char* signature) {
+    const DexFile* dex_file;
+    const DexFile::CodeItem* code_item;
+    uint32_t access_flags;
+    InvokeType invoke_type;
+    uint16_t class_def_idx;
+    uint32_t method_idx;
+    {
+      ScopedObjectAccess soa(Thread::Current());
+      mirror::Class* klass = VerifyClass(dex_name, class_name);
+      mirror::ArtMethod* method = klass->FindDirectMethod(method_name, signature);
+      if (method == NULL) {
+        method = klass->FindVirtualMethod(method_name, signature);
+      }
+      CHECK(method != NULL) << "Method not found " << class_name << "." << method_name
+                            << signature;
+      MethodHelper mh(method);
+      dex_file = &mh.GetDexFile();
+      code_item = mh.GetCodeItem();
+      access_flags = method->GetAccessFlags();
+      invoke_type = method->IsStatic() ? kStatic : (method->IsDirect() ? kDirect : kVirtual);
+      class_def_idx = klass->GetDexClassDefIndex();
+      method_idx = method->GetDexMethodIndex();
+    }
+    cu_->compiler_driver = compiler_driver_.get();
+    cu_->class_linker = class_linker_;
+    cu_->instruction_set = compiler_driver_->GetInstructionSet();
+    cu_->compiler_backend = kQuick;
+    cu_->num_dalvik_registers = code_item->registers_size_;
+    cu_->mir_graph.reset(new MIRGraph(cu_.get(), &cu_->arena));
+    cu_->mir_graph->InlineMethod(code_item, access_flags, invoke_type, class_def_idx, method_idx,
+                                 class_loader_, *dex_file);
+  }
+
+  // Runs the middle end passes in their usual order, up to and including last_pass.
+  void RunPassesThrough(const char* last_pass) {
+    TestPassDriver driver(cu_.get());
+    driver.LaunchThrough(last_pass);
+  }
+
+  // Runs all the middle end passes and converts the method to LIR, without assembling it.
+  Mir2Lir* GenerateLIR() {
+    PassDriver driver(cu_.get());
+    driver.Launch();
+    cu_->mir_graph->RemapRegLocations();
+    Mir2Lir* cg = NULL;
+    switch (cu_->instruction_set) {
+      case kThumb2:
+        cg = ArmCodeGenerator(cu_.get(), cu_->mir_graph.get(), &cu_->arena);
+        break;
+      case kMips:
+        cg = MipsCodeGenerator(cu_.get(), cu_->mir_graph.get(), &cu_->arena);
+        break;
+      case kX86:
+        cg = X86CodeGenerator(cu_.get(), cu_->mir_graph.get(), &cu_->arena);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected instruction set: " << cu_->instruction_set;
+    }
+    cu_->cg.reset(cg);
+    cg->CompilerInitializeRegAlloc();
+    cg->SimpleRegAlloc();
+    cg->MethodMIR2LIR();
+    return cg;
+  }
+
+  LIR* GetFirstLIR(Mir2Lir* cg) {
+    return cg->first_lir_insn_;
+  }
+
+  LIR* GetBlockLabel(Mir2Lir* cg, BasicBlock* bb) {
+    return &cg->block_label_list_[bb->id];
+  }
+
+  // The MIRs of the method with the given opcode, in code order.
+  std::vector<MIR*> FindMIRs(int opcode) {
+    std::vector<MIR*> mirs;
+    AllNodesIterator iter(cu_->mir_graph.get());
+    for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+      for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+        if (static_cast<int>(mir->dalvikInsn.opcode) == opcode) {
+          mirs.push_back(mir);
+        }
+      }
+    }
+    std::sort(mirs.begin(), mirs.end(), MIROffsetLess);
+    return mirs;
+  }
+
+  BasicBlock* GetBlockOf(MIR* target) {
+    AllNodesIterator iter(cu_->mir_graph.get());
+    for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+      for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+        if (mir == target) {
+          return bb;
+        }
+      }
+    }
+    return NULL;
+  }
+
+  UniquePtr<CompilationUnit> cu_;
+  jobject class_loader_;
+
+ private:
+  static bool MIROffsetLess(const MIR* lhs, const MIR* rhs) {
+    return lhs->offset < rhs->offset;
+  }
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DEX_MIR_GRAPH_TEST_H_
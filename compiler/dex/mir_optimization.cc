@@ -14,12 +14,19 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include "compiler_internals.h"
 #include "local_value_numbering.h"
 #include "dataflow_iterator-inl.h"
+#include "dex/quick/dex_file_method_inliner.h"
+#include "dex/quick/dex_file_to_method_inliner_map.h"
 
 namespace art {
 
+// Global value numbering is skipped for methods with more blocks than this.
+static const int kMaxBlocksForGlobalValueNumbering = 1000;
+
 static unsigned int Predecessors(BasicBlock* bb) {
   return bb->predecessors->Size();
 }
@@ -880,4 +887,1467 @@ void MIRGraph::BasicBlockOptimization() {
   }
 }
 
+void MIRGraph::DoGlobalValueNumbering() {
+  // The value maps grow with the number of instructions numbered along a dominator tree path.
+  if (GetNumBlocks() > kMaxBlocksForGlobalValueNumbering) {
+    return;
+  }
+  /*
+   * Walk the dominator tree, each block starting from the values its immediate dominator ended
+   * with. Memory is forgotten where another path joins in, registers need not be since a name
+   * available in the dominator has the same value in every block it dominates. Catch entries
+   * start from nothing.
+   */
+  std::vector<std::pair<BasicBlock*, LocalValueNumbering*> > work_stack;
+  work_stack.push_back(std::make_pair(GetEntryBlock(), new LocalValueNumbering(cu_)));
+  bool full = false;
+  while (!work_stack.empty()) {
+    BasicBlock* bb = work_stack.back().first;
+    UniquePtr<LocalValueNumbering> lvn(work_stack.back().second);
+    work_stack.pop_back();
+    if (full) {
+      continue;  // Just free the remaining states.
+    }
+    if (bb->catch_entry) {
+      // The handler is entered from the checks of the try block too, including the one that
+      // threw, so nothing the dominator checked holds here. Start afresh, as the null check
+      // elimination does.
+      lvn.reset(new LocalValueNumbering(cu_));
+    } else if (bb->predecessors->Size() != 1) {
+      lvn->ClobberMemory();
+    }
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      lvn->GetValueNumber(mir);
+      if (lvn->IsFull()) {
+        full = true;
+        break;
+      }
+    }
+    if (full) {
+      continue;
+    }
+    std::vector<BasicBlock*> dominated;
+    ArenaBitVector::Iterator iter(bb->i_dominated);
+    for (int32_t id = iter.Next(); id != -1; id = iter.Next()) {
+      dominated.push_back(GetBasicBlock(id));
+    }
+    for (size_t i = 0; i < dominated.size(); i++) {
+      // The last block takes over this block's state, the others get a copy.
+      LocalValueNumbering* state =
+          (i + 1 == dominated.size()) ? lvn.release() : new LocalValueNumbering(*lvn);
+      work_stack.push_back(std::make_pair(dominated[i], state));
+    }
+  }
+  if (full && cu_->verbose) {
+    LOG(INFO) << "Stopped global value numbering of "
+              << PrettyMethod(cu_->method_idx, *cu_->dex_file) << ", out of value names";
+  }
+}
+
+static bool NaturalLoopSizeLess(const NaturalLoop& lhs, const NaturalLoop& rhs) {
+  return lhs.num_blocks < rhs.num_blocks;
+}
+
+void MIRGraph::FindNaturalLoops(std::vector<NaturalLoop>* loops) {
+  size_t first_loop = loops->size();
+  SafeMap<BasicBlockId, size_t> loop_of_header;
+  std::vector<BasicBlockId> work_list;
+  PreOrderDfsIterator iter(this);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    if (bb->dominators == NULL) {
+      continue;
+    }
+    std::vector<BasicBlockId> successors;
+    if (bb->taken != NullBasicBlockId) {
+      successors.push_back(bb->taken);
+    }
+    if (bb->fall_through != NullBasicBlockId) {
+      successors.push_back(bb->fall_through);
+    }
+    if (bb->successor_block_list_type != kNotUsed) {
+      GrowableArray<SuccessorBlockInfo*>::Iterator succ_iter(bb->successor_blocks);
+      for (SuccessorBlockInfo* info = succ_iter.Next(); info != NULL; info = succ_iter.Next()) {
+        successors.push_back(info->block);
+      }
+    }
+    for (BasicBlockId header_id : successors) {
+      // A back edge goes to a block dominating its source.
+      if (!bb->dominators->IsBitSet(header_id)) {
+        continue;
+      }
+      SafeMap<BasicBlockId, size_t>::iterator it = loop_of_header.find(header_id);
+      if (it == loop_of_header.end()) {
+        NaturalLoop loop;
+        loop.header = GetBasicBlock(header_id);
+        loop.blocks = new (arena_) ArenaBitVector(arena_, GetNumBlocks(), false, kBitMapLoopBlocks);
+        loop.blocks->SetBit(header_id);
+        loop.back_edges = new (arena_) GrowableArray<BasicBlockId>(arena_, 2);
+        loop.num_blocks = 0;
+        loops->push_back(loop);
+        loop_of_header.Put(header_id, loops->size() - 1);
+        it = loop_of_header.find(header_id);
+      }
+      NaturalLoop* loop = &(*loops)[it->second];
+      loop->back_edges->Insert(bb->id);
+      // Everything reaching the back edge without going through the header is in the loop.
+      work_list.clear();
+      if (!loop->blocks->IsBitSet(bb->id)) {
+        loop->blocks->SetBit(bb->id);
+        work_list.push_back(bb->id);
+      }
+      while (!work_list.empty()) {
+        BasicBlock* block = GetBasicBlock(work_list.back());
+        work_list.pop_back();
+        GrowableArray<BasicBlockId>::Iterator pred_iter(block->predecessors);
+        for (BasicBlockId pred_id = pred_iter.Next(); pred_id != NullBasicBlockId;
+             pred_id = pred_iter.Next()) {
+          if (!loop->blocks->IsBitSet(pred_id)) {
+            loop->blocks->SetBit(pred_id);
+            work_list.push_back(pred_id);
+          }
+        }
+      }
+    }
+  }
+  for (size_t i = first_loop; i < loops->size(); i++) {
+    (*loops)[i].num_blocks = (*loops)[i].blocks->NumSetBits();
+  }
+  // A loop nested in another one has fewer blocks.
+  std::stable_sort(loops->begin() + first_loop, loops->end(), NaturalLoopSizeLess);
+}
+
+BasicBlock* MIRGraph::GetLoopPreheader(const NaturalLoop& loop) {
+  BasicBlock* preheader = NULL;
+  GrowableArray<BasicBlockId>::Iterator iter(loop.header->predecessors);
+  for (BasicBlockId pred_id = iter.Next(); pred_id != NullBasicBlockId; pred_id = iter.Next()) {
+    if (loop.blocks->IsBitSet(pred_id)) {
+      continue;
+    }
+    if (preheader != NULL) {
+      return NULL;
+    }
+    preheader = GetBasicBlock(pred_id);
+  }
+  // Code appended to the preheader must run exactly when the loop is entered.
+  if ((preheader == NULL) || (preheader->block_type != kDalvikByteCode) ||
+      (preheader->fall_through != loop.header->id) || (preheader->taken != NullBasicBlockId) ||
+      (preheader->successor_block_list_type != kNotUsed)) {
+    return NULL;
+  }
+  return preheader;
+}
+
+/*
+ * Whether a field get is done with a plain load: the field is resolved, not volatile and, for a
+ * static field, its class needs no initialization.
+ */
+static bool IsPlainFieldGet(CompilationUnit* cu, MIR* mir) {
+  if ((cu->enable_debug & (1 << kDebugSlowFieldPath)) != 0) {
+    return false;
+  }
+  uint32_t field_idx = mir->dalvikInsn.vC;
+  int field_offset;
+  bool is_volatile;
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::IGET:
+    case Instruction::IGET_WIDE:
+    case Instruction::IGET_OBJECT:
+    case Instruction::IGET_BOOLEAN:
+    case Instruction::IGET_BYTE:
+    case Instruction::IGET_CHAR:
+    case Instruction::IGET_SHORT:
+      return cu->compiler_driver->ComputeInstanceFieldInfo(
+          field_idx, cu->mir_graph->GetCurrentDexCompilationUnit(), false,
+          &field_offset, &is_volatile, false) && !is_volatile;
+    case Instruction::SGET:
+    case Instruction::SGET_WIDE:
+    case Instruction::SGET_OBJECT:
+    case Instruction::SGET_BOOLEAN:
+    case Instruction::SGET_BYTE:
+    case Instruction::SGET_CHAR:
+    case Instruction::SGET_SHORT: {
+      field_idx = mir->dalvikInsn.vB;
+      int storage_index;
+      bool is_referrers_class;
+      bool is_initialized;
+      return cu->compiler_driver->ComputeStaticFieldInfo(
+          field_idx, cu->mir_graph->GetCurrentDexCompilationUnit(), false,
+          &field_offset, &storage_index, &is_referrers_class, &is_volatile, &is_initialized,
+          false) && !is_volatile && (is_referrers_class || is_initialized);
+    }
+    default:
+      return false;
+  }
+}
+
+/*
+ * Whether a field loaded before mir may have another value after it, because mir writes memory,
+ * calls out or synchronizes.
+ */
+static bool MayChangeFields(CompilationUnit* cu, MIR* mir) {
+  Instruction::Code opcode = mir->dalvikInsn.opcode;
+  if (static_cast<int>(opcode) >= kMirOpFirst) {
+    return false;
+  }
+  switch (opcode) {
+    case Instruction::IGET:
+    case Instruction::IGET_WIDE:
+    case Instruction::IGET_OBJECT:
+    case Instruction::IGET_BOOLEAN:
+    case Instruction::IGET_BYTE:
+    case Instruction::IGET_CHAR:
+    case Instruction::IGET_SHORT:
+    case Instruction::SGET:
+    case Instruction::SGET_WIDE:
+    case Instruction::SGET_OBJECT:
+    case Instruction::SGET_BOOLEAN:
+    case Instruction::SGET_BYTE:
+    case Instruction::SGET_CHAR:
+    case Instruction::SGET_SHORT:
+      // A volatile load orders the loads after it, a slow path may run a class initializer.
+      return !IsPlainFieldGet(cu, mir);
+    case Instruction::IPUT:
+    case Instruction::IPUT_WIDE:
+    case Instruction::IPUT_OBJECT:
+    case Instruction::IPUT_BOOLEAN:
+    case Instruction::IPUT_BYTE:
+    case Instruction::IPUT_CHAR:
+    case Instruction::IPUT_SHORT:
+    case Instruction::SPUT:
+    case Instruction::SPUT_WIDE:
+    case Instruction::SPUT_OBJECT:
+    case Instruction::SPUT_BOOLEAN:
+    case Instruction::SPUT_BYTE:
+    case Instruction::SPUT_CHAR:
+    case Instruction::SPUT_SHORT:
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
+    case Instruction::NEW_INSTANCE:
+      return true;
+    default:
+      return (Instruction::FlagsOf(opcode) & Instruction::kInvoke) != 0;
+  }
+}
+
+/* Whether an instruction computes a non-reference value from its operands alone, never throwing. */
+static bool IsPureOperation(Instruction::Code opcode) {
+  switch (opcode) {
+    case Instruction::MOVE:
+    case Instruction::MOVE_FROM16:
+    case Instruction::MOVE_16:
+    case Instruction::MOVE_WIDE:
+    case Instruction::MOVE_WIDE_FROM16:
+    case Instruction::MOVE_WIDE_16:
+    case Instruction::CONST_4:
+    case Instruction::CONST_16:
+    case Instruction::CONST:
+    case Instruction::CONST_HIGH16:
+    case Instruction::CONST_WIDE_16:
+    case Instruction::CONST_WIDE_32:
+    case Instruction::CONST_WIDE:
+    case Instruction::CONST_WIDE_HIGH16:
+    case Instruction::CMPL_FLOAT:
+    case Instruction::CMPG_FLOAT:
+    case Instruction::CMPL_DOUBLE:
+    case Instruction::CMPG_DOUBLE:
+    case Instruction::CMP_LONG:
+    case Instruction::NEG_INT:
+    case Instruction::NOT_INT:
+    case Instruction::NEG_LONG:
+    case Instruction::NOT_LONG:
+    case Instruction::NEG_FLOAT:
+    case Instruction::NEG_DOUBLE:
+    case Instruction::INT_TO_LONG:
+    case Instruction::INT_TO_FLOAT:
+    case Instruction::INT_TO_DOUBLE:
+    case Instruction::LONG_TO_INT:
+    case Instruction::LONG_TO_FLOAT:
+    case Instruction::LONG_TO_DOUBLE:
+    case Instruction::FLOAT_TO_INT:
+    case Instruction::FLOAT_TO_LONG:
+    case Instruction::FLOAT_TO_DOUBLE:
+    case Instruction::DOUBLE_TO_INT:
+    case Instruction::DOUBLE_TO_LONG:
+    case Instruction::DOUBLE_TO_FLOAT:
+    case Instruction::INT_TO_BYTE:
+    case Instruction::INT_TO_CHAR:
+    case Instruction::INT_TO_SHORT:
+    case Instruction::ADD_INT:
+    case Instruction::SUB_INT:
+    case Instruction::MUL_INT:
+    case Instruction::AND_INT:
+    case Instruction::OR_INT:
+    case Instruction::XOR_INT:
+    case Instruction::SHL_INT:
+    case Instruction::SHR_INT:
+    case Instruction::USHR_INT:
+    case Instruction::ADD_LONG:
+    case Instruction::SUB_LONG:
+    case Instruction::MUL_LONG:
+    case Instruction::AND_LONG:
+    case Instruction::OR_LONG:
+    case Instruction::XOR_LONG:
+    case Instruction::SHL_LONG:
+    case Instruction::SHR_LONG:
+    case Instruction::USHR_LONG:
+    case Instruction::ADD_FLOAT:
+    case Instruction::SUB_FLOAT:
+    case Instruction::MUL_FLOAT:
+    case Instruction::DIV_FLOAT:
+    case Instruction::REM_FLOAT:
+    case Instruction::ADD_DOUBLE:
+    case Instruction::SUB_DOUBLE:
+    case Instruction::MUL_DOUBLE:
+    case Instruction::DIV_DOUBLE:
+    case Instruction::REM_DOUBLE:
+    case Instruction::ADD_INT_2ADDR:
+    case Instruction::SUB_INT_2ADDR:
+    case Instruction::MUL_INT_2ADDR:
+    case Instruction::AND_INT_2ADDR:
+    case Instruction::OR_INT_2ADDR:
+    case Instruction::XOR_INT_2ADDR:
+    case Instruction::SHL_INT_2ADDR:
+    case Instruction::SHR_INT_2ADDR:
+    case Instruction::USHR_INT_2ADDR:
+    case Instruction::ADD_LONG_2ADDR:
+    case Instruction::SUB_LONG_2ADDR:
+    case Instruction::MUL_LONG_2ADDR:
+    case Instruction::AND_LONG_2ADDR:
+    case Instruction::OR_LONG_2ADDR:
+    case Instruction::XOR_LONG_2ADDR:
+    case Instruction::SHL_LONG_2ADDR:
+    case Instruction::SHR_LONG_2ADDR:
+    case Instruction::USHR_LONG_2ADDR:
+    case Instruction::ADD_FLOAT_2ADDR:
+    case Instruction::SUB_FLOAT_2ADDR:
+    case Instruction::MUL_FLOAT_2ADDR:
+    case Instruction::DIV_FLOAT_2ADDR:
+    case Instruction::REM_FLOAT_2ADDR:
+    case Instruction::ADD_DOUBLE_2ADDR:
+    case Instruction::SUB_DOUBLE_2ADDR:
+    case Instruction::MUL_DOUBLE_2ADDR:
+    case Instruction::DIV_DOUBLE_2ADDR:
+    case Instruction::REM_DOUBLE_2ADDR:
+    case Instruction::ADD_INT_LIT16:
+    case Instruction::RSUB_INT:
+    case Instruction::MUL_INT_LIT16:
+    case Instruction::AND_INT_LIT16:
+    case Instruction::OR_INT_LIT16:
+    case Instruction::XOR_INT_LIT16:
+    case Instruction::ADD_INT_LIT8:
+    case Instruction::RSUB_INT_LIT8:
+    case Instruction::MUL_INT_LIT8:
+    case Instruction::AND_INT_LIT8:
+    case Instruction::OR_INT_LIT8:
+    case Instruction::XOR_INT_LIT8:
+    case Instruction::SHL_INT_LIT8:
+    case Instruction::SHR_INT_LIT8:
+    case Instruction::USHR_INT_LIT8:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Hoisted instructions keep their Dalvik registers, so an instruction may only be moved if its
+ * operands are defined outside the loop, its result registers are written nowhere else in the
+ * loop and aren't read by the loop before it. The result is never a reference, that way a
+ * safepoint between the preheader and the original position doesn't need it in its GC map.
+ */
+bool MIRGraph::IsLoopInvariant(const NaturalLoop& loop, BasicBlock* preheader, MIR* mir,
+                               const ArenaBitVector* loop_defs, const int* vreg_def_counts,
+                               bool loop_writes_fields) {
+  Instruction::Code opcode = mir->dalvikInsn.opcode;
+  if ((mir->ssa_rep == NULL) || (mir->ssa_rep->num_defs == 0) ||
+      (static_cast<int>(opcode) >= kMirOpFirst)) {
+    return false;
+  }
+  for (int i = 0; i < mir->ssa_rep->num_uses; i++) {
+    if (loop_defs->IsBitSet(mir->ssa_rep->uses[i])) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+    int v_reg = SRegToVReg(mir->ssa_rep->defs[i]);
+    if ((vreg_def_counts[v_reg] != 1) ||
+        loop.header->data_flow_info->live_in_v->IsBitSet(v_reg)) {
+      return false;
+    }
+  }
+  if (IsPureOperation(opcode)) {
+    return true;
+  }
+  bool base_non_null = false;
+  if ((cu_->disable_opt & (1 << kNullCheckElimination)) == 0) {
+    ArenaBitVector* null_check_v = preheader->data_flow_info->ending_null_check_v;
+    base_non_null = (mir->ssa_rep->num_uses != 0) && (null_check_v != NULL) &&
+        !null_check_v->IsBitSet(mir->ssa_rep->uses[0]);
+  }
+  switch (opcode) {
+    case Instruction::ARRAY_LENGTH:
+      return base_non_null;
+    case Instruction::IGET:
+    case Instruction::IGET_WIDE:
+    case Instruction::IGET_BOOLEAN:
+    case Instruction::IGET_BYTE:
+    case Instruction::IGET_CHAR:
+    case Instruction::IGET_SHORT:
+      return base_non_null && !loop_writes_fields && IsPlainFieldGet(cu_, mir);
+    case Instruction::SGET:
+    case Instruction::SGET_WIDE:
+    case Instruction::SGET_BOOLEAN:
+    case Instruction::SGET_BYTE:
+    case Instruction::SGET_CHAR:
+    case Instruction::SGET_SHORT:
+      return !loop_writes_fields && IsPlainFieldGet(cu_, mir);
+    default:
+      return false;
+  }
+}
+
+/* Whether code may be appended to bb, nothing may come between an invoke and its move-result. */
+static bool MayAppendMIR(BasicBlock* bb) {
+  MIR* last_mir = bb->last_mir_insn;
+  if (last_mir == NULL) {
+    return true;
+  }
+  Instruction::Code last_opcode = last_mir->dalvikInsn.opcode;
+  return (static_cast<int>(last_opcode) >= kMirOpFirst) ||
+      (((Instruction::FlagsOf(last_opcode) & Instruction::kInvoke) == 0) &&
+       (last_opcode != Instruction::FILLED_NEW_ARRAY) &&
+       (last_opcode != Instruction::FILLED_NEW_ARRAY_RANGE));
+}
+
+void MIRGraph::HoistLoopInvariants(const NaturalLoop& loop) {
+  BasicBlock* preheader = GetLoopPreheader(loop);
+  if ((preheader == NULL) || !MayAppendMIR(preheader)) {
+    return;
+  }
+  ArenaBitVector* loop_defs =
+      new (arena_) ArenaBitVector(arena_, GetNumSSARegs(), false, kBitMapTempSSARegisterV);
+  std::vector<int> vreg_def_counts(cu_->num_dalvik_registers, 0);
+  bool loop_writes_fields = false;
+  ArenaBitVector::Iterator iter(loop.blocks);
+  for (int32_t id = iter.Next(); id != -1; id = iter.Next()) {
+    BasicBlock* bb = GetBasicBlock(id);
+    // Registers live into a handler are not tracked by the header's live-ins.
+    if (bb->successor_block_list_type == kCatch) {
+      return;
+    }
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        loop_defs->SetBit(mir->ssa_rep->defs[i]);
+        vreg_def_counts[SRegToVReg(mir->ssa_rep->defs[i])]++;
+      }
+      loop_writes_fields |= MayChangeFields(cu_, mir);
+    }
+  }
+  // Visit the blocks in DFS order so that an instruction's loop invariant operands get hoisted
+  // before it.
+  for (size_t i = 0; i < dfs_order_->Size(); i++) {
+    BasicBlock* bb = GetBasicBlock(dfs_order_->Get(i));
+    if (!loop.blocks->IsBitSet(bb->id)) {
+      continue;
+    }
+    // Only code that runs on every iteration is hoisted, a loop may exit before reaching the rest.
+    bool on_every_iteration = true;
+    GrowableArray<BasicBlockId>::Iterator back_edge_iter(loop.back_edges);
+    for (BasicBlockId back_edge = back_edge_iter.Next(); back_edge != NullBasicBlockId;
+         back_edge = back_edge_iter.Next()) {
+      if (!GetBasicBlock(back_edge)->dominators->IsBitSet(bb->id)) {
+        on_every_iteration = false;
+        break;
+      }
+    }
+    if (!on_every_iteration) {
+      continue;
+    }
+    MIR* prev = NULL;
+    MIR* mir = bb->first_mir_insn;
+    while (mir != NULL) {
+      MIR* next = mir->next;
+      if (!IsLoopInvariant(loop, preheader, mir, loop_defs, &vreg_def_counts[0],
+                           loop_writes_fields)) {
+        prev = mir;
+        mir = next;
+        continue;
+      }
+      if (prev == NULL) {
+        bb->first_mir_insn = next;
+      } else {
+        prev->next = next;
+      }
+      if (bb->last_mir_insn == mir) {
+        bb->last_mir_insn = prev;
+      }
+      AppendMIR(preheader, mir);
+      // The operands are live at the preheader, so the base was checked there.
+      mir->optimization_flags |= MIR_IGNORE_NULL_CHECK;
+      for (int j = 0; j < mir->ssa_rep->num_defs; j++) {
+        loop_defs->ClearBit(mir->ssa_rep->defs[j]);
+      }
+      if (cu_->verbose) {
+        LOG(INFO) << "Hoisted " << Instruction::Name(mir->dalvikInsn.opcode) << " at 0x"
+                  << std::hex << mir->offset << " to block " << std::dec << preheader->id;
+      }
+      mir = next;
+    }
+  }
+}
+
+void MIRGraph::DoLoopInvariantCodeMotion() {
+  std::vector<NaturalLoop> loops;
+  FindNaturalLoops(&loops);
+  // Inner loops first, what they hoist may then leave an enclosing loop as well.
+  for (const NaturalLoop& loop : loops) {
+    HoistLoopInvariants(loop);
+  }
+}
+
+/* Whether mir computes base + step, for a constant step. */
+static bool IsInductionStep(MIRGraph* mir_graph, MIR* mir, int base, int step) {
+  if ((mir == NULL) || (mir->ssa_rep == NULL)) {
+    return false;
+  }
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::ADD_INT_LIT8:
+    case Instruction::ADD_INT_LIT16:
+      return (mir->ssa_rep->uses[0] == base) && (static_cast<int32_t>(mir->dalvikInsn.vC) == step);
+    case Instruction::ADD_INT:
+    case Instruction::ADD_INT_2ADDR: {
+      int other;
+      if (mir->ssa_rep->uses[0] == base) {
+        other = mir->ssa_rep->uses[1];
+      } else if (mir->ssa_rep->uses[1] == base) {
+        other = mir->ssa_rep->uses[0];
+      } else {
+        return false;
+      }
+      return mir_graph->IsConst(other) && (mir_graph->ConstantValue(other) == step);
+    }
+    default:
+      return false;
+  }
+}
+
+/* The array whose length is the SSA name length, or INVALID_SREG. */
+static int ArrayOfLength(const std::vector<MIR*>& ssa_defs, int length) {
+  MIR* def = ssa_defs[length];
+  if ((def == NULL) || (def->dalvikInsn.opcode != Instruction::ARRAY_LENGTH)) {
+    return INVALID_SREG;
+  }
+  return def->ssa_rep->uses[0];
+}
+
+/*
+ * Two loop shapes are recognized, the loop test being at the header and the index being a header
+ * phi:
+ *   - counting up from a non-negative constant by one while index < array.length,
+ *   - counting down from array.length - 1 by one while index >= 0.
+ * On the edge into the loop body the index is then within the array, every iteration having
+ * entered the body before stepping the index, so it can't overflow. The range checks of the
+ * accesses dominated by the body with that index and array are not needed.
+ */
+void MIRGraph::EliminateLoopRangeChecks(const NaturalLoop& loop,
+                                        const std::vector<MIR*>& ssa_defs) {
+  BasicBlock* header = loop.header;
+  MIR* branch = header->last_mir_insn;
+  if ((branch == NULL) || (branch->ssa_rep == NULL) ||
+      (header->taken == NullBasicBlockId) || (header->fall_through == NullBasicBlockId)) {
+    return;
+  }
+  bool taken_in_loop = loop.blocks->IsBitSet(header->taken);
+  if (taken_in_loop == loop.blocks->IsBitSet(header->fall_through)) {
+    return;
+  }
+  BasicBlock* body = GetBasicBlock(taken_in_loop ? header->taken : header->fall_through);
+  if ((body == header) || (body->predecessors->Size() != 1)) {
+    return;
+  }
+  // The condition holding on the edge into the body.
+  int index = INVALID_SREG;
+  int length = INVALID_SREG;
+  bool counts_up;
+  switch (branch->dalvikInsn.opcode) {
+    case Instruction::IF_LT:
+    case Instruction::IF_GE:
+      if (taken_in_loop != (branch->dalvikInsn.opcode == Instruction::IF_LT)) {
+        return;
+      }
+      index = branch->ssa_rep->uses[0];
+      length = branch->ssa_rep->uses[1];
+      counts_up = true;
+      break;
+    case Instruction::IF_GT:
+    case Instruction::IF_LE:
+      if (taken_in_loop != (branch->dalvikInsn.opcode == Instruction::IF_GT)) {
+        return;
+      }
+      index = branch->ssa_rep->uses[1];
+      length = branch->ssa_rep->uses[0];
+      counts_up = true;
+      break;
+    case Instruction::IF_GEZ:
+    case Instruction::IF_LTZ:
+      if (taken_in_loop != (branch->dalvikInsn.opcode == Instruction::IF_GEZ)) {
+        return;
+      }
+      index = branch->ssa_rep->uses[0];
+      counts_up = false;
+      break;
+    default:
+      return;
+  }
+  MIR* phi = NULL;
+  for (MIR* mir = header->first_mir_insn; mir != NULL; mir = mir->next) {
+    if ((static_cast<int>(mir->dalvikInsn.opcode) == kMirOpPhi) &&
+        (mir->ssa_rep->defs[0] == index)) {
+      phi = mir;
+      break;
+    }
+  }
+  if (phi == NULL) {
+    return;
+  }
+  int array = counts_up ? ArrayOfLength(ssa_defs, length) : INVALID_SREG;
+  if (counts_up && (array == INVALID_SREG)) {
+    return;
+  }
+  int step = counts_up ? 1 : -1;
+  BasicBlockId* incoming = phi->meta.phi_incoming;
+  for (int i = 0; i < phi->ssa_rep->num_uses; i++) {
+    int value = phi->ssa_rep->uses[i];
+    if (loop.blocks->IsBitSet(incoming[i])) {
+      if (!IsInductionStep(this, ssa_defs[value], index, step)) {
+        return;
+      }
+    } else if (counts_up) {
+      // A packed loop only advances the index it is given.
+      MIR* def = ssa_defs[value];
+      if ((def != NULL) &&
+          (static_cast<int>(def->dalvikInsn.opcode) == kMirOpPackedArrayLoop)) {
+        value = def->ssa_rep->uses[0];
+      }
+      if (!IsConst(value) || (ConstantValue(value) < 0)) {
+        return;
+      }
+    } else {
+      // The initial value is array.length - 1, with the same array on every entry.
+      MIR* def = ssa_defs[value];
+      if ((def == NULL) || (def->ssa_rep == NULL) || (def->ssa_rep->num_uses == 0)) {
+        return;
+      }
+      int entry_length = def->ssa_rep->uses[0];
+      int entry_array = ArrayOfLength(ssa_defs, entry_length);
+      if (!IsInductionStep(this, def, entry_length, -1) || (entry_array == INVALID_SREG) ||
+          ((array != INVALID_SREG) && (array != entry_array))) {
+        return;
+      }
+      array = entry_array;
+    }
+  }
+  if (array == INVALID_SREG) {
+    return;
+  }
+  PreOrderDfsIterator iter(this);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    if ((bb->dominators == NULL) || !bb->dominators->IsBitSet(body->id)) {
+      continue;
+    }
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      int array_idx;
+      switch (mir->dalvikInsn.opcode) {
+        case Instruction::AGET:
+        case Instruction::AGET_WIDE:
+        case Instruction::AGET_OBJECT:
+        case Instruction::AGET_BOOLEAN:
+        case Instruction::AGET_BYTE:
+        case Instruction::AGET_CHAR:
+        case Instruction::AGET_SHORT:
+          array_idx = 0;
+          break;
+        case Instruction::APUT:
+        case Instruction::APUT_OBJECT:
+        case Instruction::APUT_BOOLEAN:
+        case Instruction::APUT_BYTE:
+        case Instruction::APUT_CHAR:
+        case Instruction::APUT_SHORT:
+          array_idx = 1;
+          break;
+        case Instruction::APUT_WIDE:
+          array_idx = 2;
+          break;
+        default:
+          continue;
+      }
+      if ((mir->ssa_rep->uses[array_idx] == array) &&
+          (mir->ssa_rep->uses[array_idx + 1] == index)) {
+        if (cu_->verbose) {
+          LOG(INFO) << "Removing loop range check for 0x" << std::hex << mir->offset;
+        }
+        mir->optimization_flags |= MIR_IGNORE_RANGE_CHECK;
+      }
+    }
+  }
+}
+
+void MIRGraph::DoLoopBoundsCheckElimination() {
+  std::vector<NaturalLoop> loops;
+  FindNaturalLoops(&loops);
+  if (loops.empty()) {
+    return;
+  }
+  std::vector<MIR*> ssa_defs(GetNumSSARegs(), NULL);
+  PreOrderDfsIterator iter(this);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        ssa_defs[mir->ssa_rep->defs[i]] = mir;
+      }
+    }
+  }
+  for (const NaturalLoop& loop : loops) {
+    EliminateLoopRangeChecks(loop, ssa_defs);
+  }
+}
+
+/*
+ * The class of type_idx if its instances can be replaced by their fields: it is defined in
+ * dex_file, extends Object and has neither a static initializer nor a finalizer, so creating an
+ * instance has no side effect once the constructor is accounted for.
+ */
+static const DexFile::ClassDef* FindReplaceableClass(const DexFile& dex_file, uint16_t type_idx) {
+  const DexFile::ClassDef* class_def = dex_file.FindClassDef(type_idx);
+  if ((class_def == NULL) || (class_def->superclass_idx_ == DexFile::kDexNoIndex16) ||
+      (strcmp(dex_file.StringByTypeIdx(class_def->superclass_idx_), "Ljava/lang/Object;") != 0)) {
+    return NULL;
+  }
+  const byte* class_data = dex_file.GetClassData(*class_def);
+  if (class_data == NULL) {
+    return NULL;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  for (; it.HasNext(); it.Next()) {
+    const DexFile::MethodId& method_id = dex_file.GetMethodId(it.GetMemberIndex());
+    const char* name = dex_file.GetMethodName(method_id);
+    if ((strcmp(name, "<clinit>") == 0) ||
+        ((strcmp(name, "finalize") == 0) &&
+         (dex_file.GetMethodSignature(method_id).ToString() == "()V"))) {
+      return NULL;
+    }
+  }
+  return class_def;
+}
+
+/*
+ * Analyse the constructor method_idx of class_def, which must call Object.<init>() and then only
+ * copy its arguments into non-volatile instance fields declared by the class, each at most once.
+ * Each stored field is mapped to the put opcode and to the argument word it copies.
+ */
+static bool AnalyseFieldCopyingConstructor(
+    const DexFile& dex_file, const DexFile::ClassDef& class_def, uint32_t method_idx,
+    SafeMap<uint32_t, std::pair<Instruction::Code, uint32_t> >* stores) {
+  SafeMap<uint32_t, uint32_t> field_flags;
+  const DexFile::CodeItem* code_item = NULL;
+  for (ClassDataItemIterator it(dex_file, dex_file.GetClassData(class_def)); it.HasNext();
+       it.Next()) {
+    if (it.HasNextInstanceField()) {
+      field_flags.Put(it.GetMemberIndex(), it.GetMemberAccessFlags());
+    } else if (it.HasNextDirectMethod() && (it.GetMemberIndex() == method_idx) &&
+               ((it.GetMemberAccessFlags() & (kAccStatic | kAccConstructor)) == kAccConstructor)) {
+      code_item = it.GetMethodCodeItem();
+    }
+  }
+  if (code_item == NULL) {
+    return false;
+  }
+  const uint32_t this_reg = code_item->registers_size_ - code_item->ins_size_;
+  const Instruction* inst = Instruction::At(code_item->insns_);
+  if ((inst->Opcode() != Instruction::INVOKE_DIRECT) || (inst->VRegA_35c() != 1) ||
+      (inst->VRegC_35c() != this_reg)) {
+    return false;
+  }
+  const DexFile::MethodId& super_id = dex_file.GetMethodId(inst->VRegB_35c());
+  if ((strcmp(dex_file.GetMethodName(super_id), "<init>") != 0) ||
+      (strcmp(dex_file.StringByTypeIdx(super_id.class_idx_), "Ljava/lang/Object;") != 0)) {
+    return false;
+  }
+  uint32_t dex_pc = inst->SizeInCodeUnits();
+  for (; dex_pc < code_item->insns_size_in_code_units_; dex_pc += inst->SizeInCodeUnits()) {
+    inst = Instruction::At(code_item->insns_ + dex_pc);
+    Instruction::Code opcode = inst->Opcode();
+    if (opcode == Instruction::RETURN_VOID) {
+      return true;
+    }
+    if ((opcode < Instruction::IPUT) || (opcode > Instruction::IPUT_SHORT) ||
+        (opcode == Instruction::IPUT_WIDE)) {
+      return false;
+    }
+    uint32_t src_reg = inst->VRegA_22c();
+    uint32_t field_idx = inst->VRegC_22c();
+    // Storing the object into itself would make it reachable from the fields.
+    if ((inst->VRegB_22c() != this_reg) || (src_reg <= this_reg)) {
+      return false;
+    }
+    auto flags = field_flags.find(field_idx);
+    if ((flags == field_flags.end()) || ((flags->second & kAccVolatile) != 0) ||
+        (stores->find(field_idx) != stores->end())) {
+      return false;
+    }
+    stores->Put(field_idx, std::make_pair(opcode, src_reg - this_reg));
+  }
+  return false;
+}
+
+/*
+ * Whether the Dalvik register of s_reg still holds that value just before mir in bb, so that mir
+ * can read it from there.
+ */
+bool MIRGraph::HoldsSRegBefore(BasicBlock* bb, MIR* mir, int s_reg) {
+  int v_reg = SRegToVReg(s_reg);
+  int current = INVALID_SREG;
+  for (MIR* prev = bb->first_mir_insn; prev != mir; prev = prev->next) {
+    if (prev->ssa_rep == NULL) {
+      continue;
+    }
+    for (int i = 0; i < prev->ssa_rep->num_defs; i++) {
+      if (SRegToVReg(prev->ssa_rep->defs[i]) == v_reg) {
+        current = prev->ssa_rep->defs[i];
+      }
+    }
+  }
+  if (current != INVALID_SREG) {
+    return current == s_reg;
+  }
+  // Not redefined in the block, so the value must reach the end of every predecessor. The SSA
+  // names only account for every path into the block if the register was already live there.
+  if ((bb->data_flow_info == NULL) || !bb->data_flow_info->live_in_v->IsBitSet(v_reg) ||
+      (bb->predecessors->Size() == 0)) {
+    return false;
+  }
+  GrowableArray<BasicBlockId>::Iterator iter(bb->predecessors);
+  for (BasicBlock* pred = GetBasicBlock(iter.Next()); pred != NULL;
+       pred = GetBasicBlock(iter.Next())) {
+    if ((pred->data_flow_info == NULL) ||
+        (pred->data_flow_info->vreg_to_ssa_map[v_reg] != s_reg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+// An object created by the method, with the instructions using it.
+struct ReplacementCandidate {
+  MIR* new_instance;
+  MIR* constructor;
+  std::vector<std::pair<BasicBlock*, MIR*> > loads;
+  bool escapes;
+};
+
+}  // anonymous namespace
+
+void MIRGraph::DoScalarReplacement() {
+  // The Dalvik registers of a catch handler hold the values they had where the exception was
+  // thrown, not at the end of the throwing block.
+  if ((cu_->code_item->tries_size_ != 0) || SLOW_INVOKE_PATH || SLOW_FIELD_PATH) {
+    return;
+  }
+  SafeMap<int, ReplacementCandidate> candidates;
+  AllNodesIterator iter(this);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if ((mir->dalvikInsn.opcode == Instruction::NEW_INSTANCE) && (mir->ssa_rep != NULL)) {
+        ReplacementCandidate candidate = { mir, NULL, {}, false };
+        candidates.Put(mir->ssa_rep->defs[0], candidate);
+      }
+    }
+  }
+  if (candidates.empty()) {
+    return;
+  }
+
+  // An object escapes unless it is only constructed and read from. Anything else, including
+  // merging it with another value in a Phi, may let another reference to it exist.
+  iter.Reset();
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      Instruction::Code opcode = mir->dalvikInsn.opcode;
+      for (int i = 0; i < mir->ssa_rep->num_uses; i++) {
+        auto it = candidates.find(mir->ssa_rep->uses[i]);
+        if (it == candidates.end()) {
+          continue;
+        }
+        ReplacementCandidate* candidate = &it->second;
+        if ((i == 0) && (opcode == Instruction::INVOKE_DIRECT ||
+                         opcode == Instruction::INVOKE_DIRECT_RANGE) &&
+            (candidate->constructor == NULL)) {
+          candidate->constructor = mir;
+        } else if ((i == 0) && (mir->ssa_rep->num_uses == 1) &&
+                   (opcode >= Instruction::IGET) && (opcode <= Instruction::IGET_SHORT) &&
+                   (opcode != Instruction::IGET_WIDE)) {
+          candidate->loads.push_back(std::make_pair(bb, mir));
+        } else {
+          candidate->escapes = true;
+        }
+      }
+    }
+  }
+
+  const DexFile& dex_file = *cu_->dex_file;
+  for (auto& it : candidates) {
+    ReplacementCandidate* candidate = &it.second;
+    if (candidate->escapes || (candidate->constructor == NULL)) {
+      continue;
+    }
+    // The allocation may only be dropped if it can't throw and creating the class runs no code.
+    uint16_t type_idx = candidate->new_instance->dalvikInsn.vB;
+    if (!cu_->compiler_driver->CanAccessInstantiableTypeWithoutChecks(cu_->method_idx, dex_file,
+                                                                      type_idx)) {
+      continue;
+    }
+    const DexFile::ClassDef* class_def = FindReplaceableClass(dex_file, type_idx);
+    if (class_def == NULL) {
+      continue;
+    }
+    MIR* constructor = candidate->constructor;
+    InvokeType type = kDirect;
+    MethodReference target_method(cu_->dex_file, constructor->dalvikInsn.vB);
+    int vtable_idx;
+    uintptr_t direct_code;
+    uintptr_t direct_method;
+    if (!cu_->compiler_driver->ComputeInvokeInfo(GetCurrentDexCompilationUnit(),
+                                                 constructor->offset, false, true, &type,
+                                                 &target_method, &vtable_idx, &direct_code,
+                                                 &direct_method) ||
+        (type != kDirect) || (target_method.dex_file != cu_->dex_file) ||
+        (dex_file.GetMethodId(target_method.dex_method_index).class_idx_ != type_idx)) {
+      continue;
+    }
+    SafeMap<uint32_t, std::pair<Instruction::Code, uint32_t> > stores;
+    if (!AnalyseFieldCopyingConstructor(dex_file, *class_def, target_method.dex_method_index,
+                                        &stores)) {
+      continue;
+    }
+    // Each load must read a field of the class with the width it was stored with, from a
+    // register that still holds the constructor's argument.
+    bool replaceable = true;
+    for (const auto& load : candidate->loads) {
+      MIR* mir = load.second;
+      uint32_t field_idx = mir->dalvikInsn.vC;
+      if ((dex_file.GetFieldId(field_idx).class_idx_ != type_idx) ||
+          !IsPlainFieldGet(cu_, mir)) {
+        replaceable = false;
+        break;
+      }
+      auto store = stores.find(field_idx);
+      if (store == stores.end()) {
+        continue;
+      }
+      uint32_t arg = store->second.second;
+      if ((mir->dalvikInsn.opcode - Instruction::IGET !=
+           store->second.first - Instruction::IPUT) ||
+          (static_cast<int>(arg) >= constructor->ssa_rep->num_uses) ||
+          !HoldsSRegBefore(load.first, mir, constructor->ssa_rep->uses[arg])) {
+        replaceable = false;
+        break;
+      }
+    }
+    if (!replaceable) {
+      continue;
+    }
+
+    // Fields the constructor doesn't store keep their default value. The register of the object
+    // is cleared rather than left alone, the GC map still says it holds a reference.
+    for (const auto& load : candidate->loads) {
+      MIR* mir = load.second;
+      auto store = stores.find(mir->dalvikInsn.vC);
+      if (store == stores.end()) {
+        mir->dalvikInsn.opcode = Instruction::CONST;
+        mir->dalvikInsn.vB = 0;
+        mir->ssa_rep->num_uses = 0;
+      } else {
+        int s_reg = constructor->ssa_rep->uses[store->second.second];
+        mir->dalvikInsn.opcode = (mir->dalvikInsn.opcode == Instruction::IGET_OBJECT) ?
+            Instruction::MOVE_OBJECT : Instruction::MOVE;
+        mir->dalvikInsn.vB = SRegToVReg(s_reg);
+        mir->ssa_rep->uses[0] = s_reg;
+        mir->ssa_rep->fp_use[0] = false;
+      }
+      mir->dalvikInsn.vC = 0;
+    }
+    constructor->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+    constructor->ssa_rep->num_uses = 0;
+    MIR* new_instance = candidate->new_instance;
+    new_instance->dalvikInsn.opcode = Instruction::CONST;
+    new_instance->dalvikInsn.vB = 0;
+    if (cu_->verbose) {
+      LOG(INFO) << "Scalar replaced " << dex_file.StringByTypeIdx(type_idx) << " at 0x"
+                << std::hex << new_instance->offset << " in "
+                << PrettyMethod(cu_->method_idx, dex_file);
+    }
+  }
+}
+
+/* The operation of an int arithmetic instruction, or kOpInvalid, and whether it has a literal. */
+static OpKind PackedOpKind(Instruction::Code opcode, bool* literal) {
+  *literal = false;
+  switch (opcode) {
+    case Instruction::ADD_INT_LIT8:
+    case Instruction::ADD_INT_LIT16:
+      *literal = true;
+      // Intentional fallthrough.
+    case Instruction::ADD_INT:
+    case Instruction::ADD_INT_2ADDR:
+      return kOpAdd;
+    case Instruction::SUB_INT:
+    case Instruction::SUB_INT_2ADDR:
+      return kOpSub;
+    case Instruction::MUL_INT_LIT8:
+    case Instruction::MUL_INT_LIT16:
+      *literal = true;
+      // Intentional fallthrough.
+    case Instruction::MUL_INT:
+    case Instruction::MUL_INT_2ADDR:
+      return kOpMul;
+    case Instruction::AND_INT_LIT8:
+    case Instruction::AND_INT_LIT16:
+      *literal = true;
+      // Intentional fallthrough.
+    case Instruction::AND_INT:
+    case Instruction::AND_INT_2ADDR:
+      return kOpAnd;
+    case Instruction::OR_INT_LIT8:
+    case Instruction::OR_INT_LIT16:
+      *literal = true;
+      // Intentional fallthrough.
+    case Instruction::OR_INT:
+    case Instruction::OR_INT_2ADDR:
+      return kOpOr;
+    case Instruction::XOR_INT_LIT8:
+    case Instruction::XOR_INT_LIT16:
+      *literal = true;
+      // Intentional fallthrough.
+    case Instruction::XOR_INT:
+    case Instruction::XOR_INT_2ADDR:
+      return kOpXor;
+    default:
+      return kOpInvalid;
+  }
+}
+
+/* Whether the backend of instruction_set has a packed form of op. */
+static bool HasPackedOp(InstructionSet instruction_set, OpKind op) {
+  switch (op) {
+    case kOpMov:
+    case kOpAdd:
+    case kOpSub:
+    case kOpAnd:
+    case kOpOr:
+    case kOpXor:
+      return true;
+    case kOpMul:
+      // SSE2 has no 32-bit packed multiply.
+      return instruction_set == kThumb2;
+    default:
+      return false;
+  }
+}
+
+/* The values of a header phi on entry from the preheader and on the back edge from the body. */
+static bool GetPhiIncoming(MIR* phi, BasicBlock* preheader, BasicBlock* body, int* entry,
+                           int* next) {
+  *entry = INVALID_SREG;
+  *next = INVALID_SREG;
+  if (phi->ssa_rep->num_uses != 2) {
+    return false;
+  }
+  BasicBlockId* incoming = phi->meta.phi_incoming;
+  for (int i = 0; i < 2; i++) {
+    if (incoming[i] == preheader->id) {
+      *entry = phi->ssa_rep->uses[i];
+    } else if (incoming[i] == body->id) {
+      *next = phi->ssa_rep->uses[i];
+    }
+  }
+  return (*entry != INVALID_SREG) && (*next != INVALID_SREG);
+}
+
+/* The value the phi gets from the preheader becomes value. */
+static void SetPhiEntry(MIR* phi, BasicBlock* preheader, int value) {
+  for (int i = 0; i < phi->ssa_rep->num_uses; i++) {
+    if (phi->meta.phi_incoming[i] == preheader->id) {
+      phi->ssa_rep->uses[i] = value;
+    }
+  }
+}
+
+/*
+ * A loop is vectorized if its test is at the header and its body is a single block doing
+ *   a[i] = x op y;   or   s = s op2 (x op y);
+ * before stepping i by one, the loop running while i < bound. Each of x and y is b[i] for a loop
+ * invariant int array b, a loop invariant value or a literal, and "x op y" may also be just x.
+ * The kMirOpPackedArrayLoop appended to the preheader runs the leading iterations four elements
+ * at a time and passes the index and sum it stopped at to the loop, which does the rest. It
+ * stops before any element outside of an array, so the loop still throws the exceptions.
+ */
+void MIRGraph::VectorizeLoop(const NaturalLoop& loop) {
+  BasicBlock* header = loop.header;
+  MIR* branch = header->last_mir_insn;
+  if ((loop.num_blocks != 2) || (branch == NULL) || (branch->ssa_rep == NULL) ||
+      (header->taken == NullBasicBlockId) || (header->fall_through == NullBasicBlockId) ||
+      (header->successor_block_list_type != kNotUsed)) {
+    return;
+  }
+  bool taken_in_loop = loop.blocks->IsBitSet(header->taken);
+  if (taken_in_loop == loop.blocks->IsBitSet(header->fall_through)) {
+    return;
+  }
+  BasicBlock* body = GetBasicBlock(taken_in_loop ? header->taken : header->fall_through);
+  BasicBlockId body_exit = (body->taken != NullBasicBlockId) ? body->taken : body->fall_through;
+  if ((body == header) || (body->block_type != kDalvikByteCode) ||
+      (body->predecessors->Size() != 1) || (body->successor_block_list_type != kNotUsed) ||
+      (body_exit != header->id) ||
+      ((body->taken != NullBasicBlockId) && (body->fall_through != NullBasicBlockId))) {
+    return;
+  }
+  BasicBlock* preheader = GetLoopPreheader(loop);
+  if ((preheader == NULL) || !MayAppendMIR(preheader)) {
+    return;
+  }
+  // The condition holding on the edge into the body is index < bound.
+  int index;
+  int bound;
+  switch (branch->dalvikInsn.opcode) {
+    case Instruction::IF_LT:
+    case Instruction::IF_GE:
+      if (taken_in_loop != (branch->dalvikInsn.opcode == Instruction::IF_LT)) {
+        return;
+      }
+      index = branch->ssa_rep->uses[0];
+      bound = branch->ssa_rep->uses[1];
+      break;
+    case Instruction::IF_GT:
+    case Instruction::IF_LE:
+      if (taken_in_loop != (branch->dalvikInsn.opcode == Instruction::IF_GT)) {
+        return;
+      }
+      index = branch->ssa_rep->uses[1];
+      bound = branch->ssa_rep->uses[0];
+      break;
+    default:
+      return;
+  }
+
+  ArenaBitVector* loop_defs =
+      new (arena_) ArenaBitVector(arena_, GetNumSSARegs(), false, kBitMapTempSSARegisterV);
+  for (BasicBlock* bb : { header, body }) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        return;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        loop_defs->SetBit(mir->ssa_rep->defs[i]);
+      }
+    }
+  }
+  // The header only holds the phis of the index and of the sum, and the array length bounding
+  // the index.
+  MIR* index_phi = NULL;
+  MIR* sum_phi = NULL;
+  int bound_array = INVALID_SREG;
+  for (MIR* mir = header->first_mir_insn; mir != branch; mir = mir->next) {
+    if (static_cast<int>(mir->dalvikInsn.opcode) == kMirOpPhi) {
+      if (mir->ssa_rep->defs[0] == index) {
+        index_phi = mir;
+      } else if (sum_phi == NULL) {
+        sum_phi = mir;
+      } else {
+        return;
+      }
+    } else if ((mir->dalvikInsn.opcode == Instruction::ARRAY_LENGTH) &&
+               (mir->ssa_rep->defs[0] == bound) &&
+               !loop_defs->IsBitSet(mir->ssa_rep->uses[0])) {
+      bound_array = mir->ssa_rep->uses[0];
+    } else {
+      return;
+    }
+  }
+  int index_entry;
+  int index_next;
+  if ((index_phi == NULL) || !GetPhiIncoming(index_phi, preheader, body, &index_entry,
+                                             &index_next) ||
+      ((bound_array == INVALID_SREG) && loop_defs->IsBitSet(bound))) {
+    return;
+  }
+
+  // The body only holds the loads and the store at the index, the arithmetic, the step and the
+  // goto.
+  MIR* loads[2];
+  int num_loads = 0;
+  MIR* ops[2];
+  int num_ops = 0;
+  MIR* store = NULL;
+  bool stepped = false;
+  for (MIR* mir = body->first_mir_insn; mir != NULL; mir = mir->next) {
+    Instruction::Code opcode = mir->dalvikInsn.opcode;
+    bool literal;
+    if ((mir->ssa_rep->num_defs == 1) && (mir->ssa_rep->defs[0] == index_next)) {
+      if (((opcode != Instruction::ADD_INT_LIT8) && (opcode != Instruction::ADD_INT_LIT16)) ||
+          (mir->ssa_rep->uses[0] != index) || (static_cast<int32_t>(mir->dalvikInsn.vC) != 1)) {
+        return;
+      }
+      stepped = true;
+    } else if ((opcode == Instruction::GOTO) || (opcode == Instruction::GOTO_16) ||
+               (opcode == Instruction::GOTO_32)) {
+      continue;
+    } else if ((opcode == Instruction::AGET) && (mir->ssa_rep->uses[1] == index) &&
+               !loop_defs->IsBitSet(mir->ssa_rep->uses[0]) && (num_loads < 2)) {
+      loads[num_loads++] = mir;
+    } else if ((opcode == Instruction::APUT) && (mir->ssa_rep->uses[2] == index) &&
+               !loop_defs->IsBitSet(mir->ssa_rep->uses[1]) && (store == NULL)) {
+      store = mir;
+    } else if ((PackedOpKind(opcode, &literal) != kOpInvalid) && (num_ops < 2)) {
+      ops[num_ops++] = mir;
+    } else {
+      return;
+    }
+  }
+  if (!stepped || ((store == NULL) == (sum_phi == NULL))) {
+    return;
+  }
+
+  // The element computed by each iteration, and what is done with it.
+  InstructionSet instruction_set = cu_->instruction_set;
+  int value = INVALID_SREG;
+  int sum_entry = INVALID_SREG;
+  MIR* sum_op = NULL;
+  OpKind sum_kind = kOpInvalid;
+  if (store != NULL) {
+    value = store->ssa_rep->uses[0];
+  } else {
+    int sum_next;
+    if (!GetPhiIncoming(sum_phi, preheader, body, &sum_entry, &sum_next)) {
+      return;
+    }
+    int sum = sum_phi->ssa_rep->defs[0];
+    for (int i = 0; i < num_ops; i++) {
+      MIR* mir = ops[i];
+      bool literal;
+      OpKind kind = PackedOpKind(mir->dalvikInsn.opcode, &literal);
+      // The lanes are summed up in another order than the iterations.
+      if ((mir->ssa_rep->defs[0] != sum_next) || literal || (kind == kOpSub) ||
+          !HasPackedOp(instruction_set, kind)) {
+        continue;
+      }
+      if ((mir->ssa_rep->uses[0] == sum) != (mir->ssa_rep->uses[1] == sum)) {
+        sum_op = mir;
+        sum_kind = kind;
+        value = mir->ssa_rep->uses[(mir->ssa_rep->uses[0] == sum) ? 1 : 0];
+      }
+    }
+    if (sum_op == NULL) {
+      return;
+    }
+  }
+  MIR* element_op = NULL;
+  for (int i = 0; i < num_ops; i++) {
+    if ((ops[i] != sum_op) && (ops[i]->ssa_rep->defs[0] == value)) {
+      element_op = ops[i];
+    }
+  }
+  if (num_ops != ((sum_op != NULL) ? 1 : 0) + ((element_op != NULL) ? 1 : 0)) {
+    return;
+  }
+  OpKind kind = kOpMov;
+  bool literal = false;
+  int operands[2] = { value, INVALID_SREG };
+  if (element_op != NULL) {
+    kind = PackedOpKind(element_op->dalvikInsn.opcode, &literal);
+    operands[0] = element_op->ssa_rep->uses[0];
+    operands[1] = literal ? INVALID_SREG : element_op->ssa_rep->uses[1];
+  }
+  if (!HasPackedOp(instruction_set, kind)) {
+    return;
+  }
+  // Each operand is either loaded from an array or the same on every iteration.
+  MIR* operand_loads[2] = { NULL, NULL };
+  int num_used_loads = 0;
+  for (int i = 0; i < 2; i++) {
+    if (operands[i] == INVALID_SREG) {
+      continue;
+    }
+    for (int j = 0; j < num_loads; j++) {
+      if (loads[j]->ssa_rep->defs[0] == operands[i]) {
+        operand_loads[i] = loads[j];
+      }
+    }
+    if (operand_loads[i] != NULL) {
+      if ((i == 0) || (operand_loads[1] != operand_loads[0])) {
+        num_used_loads++;
+      }
+    } else if (loop_defs->IsBitSet(operands[i])) {
+      return;
+    }
+  }
+  if (num_used_loads != num_loads) {
+    return;
+  }
+  // The packed operation is done in place of its first operand, which must be loaded afresh on
+  // every iteration unless it is only stored.
+  if ((operand_loads[0] == NULL) && (operand_loads[1] != NULL) && (kind != kOpSub)) {
+    std::swap(operands[0], operands[1]);
+    std::swap(operand_loads[0], operand_loads[1]);
+  }
+  if ((operand_loads[0] == NULL) && ((kind != kOpMov) || (store == NULL))) {
+    return;
+  }
+
+  uint32_t flags = (store == NULL) ? kPackedLoopReduction : 0;
+  std::vector<int> uses;
+  uses.push_back(index_entry);
+  if (bound_array != INVALID_SREG) {
+    flags |= kPackedLoopBoundIsArray;
+    uses.push_back(bound_array);
+  } else {
+    uses.push_back(bound);
+  }
+  uses.push_back((store != NULL) ? store->ssa_rep->uses[1] : sum_entry);
+  if (operand_loads[0] != NULL) {
+    flags |= kPackedLoopArray1;
+    uses.push_back(operand_loads[0]->ssa_rep->uses[0]);
+  } else {
+    uses.push_back(operands[0]);
+  }
+  if (literal) {
+    flags |= kPackedLoopLiteral2;
+  } else if (operand_loads[1] != NULL) {
+    flags |= kPackedLoopArray2;
+    uses.push_back(operand_loads[1]->ssa_rep->uses[0]);
+  } else if (operands[1] != INVALID_SREG) {
+    uses.push_back(operands[1]);
+  }
+
+  MIR* packed = static_cast<MIR*>(arena_->Alloc(sizeof(MIR), ArenaAllocator::kAllocMIR));
+  packed->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpPackedArrayLoop);
+  packed->dalvikInsn.vA = SRegToVReg(index);
+  packed->dalvikInsn.vB = flags;
+  packed->dalvikInsn.vC = (element_op != NULL) ? element_op->dalvikInsn.vC : 0;
+  packed->dalvikInsn.arg[0] = kind;
+  packed->dalvikInsn.arg[1] = sum_kind;
+  packed->offset = header->start_offset;
+  packed->m_unit_index = branch->m_unit_index;
+  SSARepresentation* ssa_rep = static_cast<SSARepresentation*>(
+      arena_->Alloc(sizeof(SSARepresentation), ArenaAllocator::kAllocDFInfo));
+  ssa_rep->num_uses = uses.size();
+  ssa_rep->uses = static_cast<int*>(arena_->Alloc(sizeof(int) * uses.size(),
+                                                  ArenaAllocator::kAllocDFInfo));
+  ssa_rep->fp_use = static_cast<bool*>(arena_->Alloc(sizeof(bool) * uses.size(),
+                                                     ArenaAllocator::kAllocDFInfo));
+  std::copy(uses.begin(), uses.end(), ssa_rep->uses);
+  ssa_rep->num_defs = (sum_phi != NULL) ? 2 : 1;
+  ssa_rep->defs = static_cast<int*>(arena_->Alloc(sizeof(int) * ssa_rep->num_defs,
+                                                  ArenaAllocator::kAllocDFInfo));
+  ssa_rep->fp_def = static_cast<bool*>(arena_->Alloc(sizeof(bool) * ssa_rep->num_defs,
+                                                     ArenaAllocator::kAllocDFInfo));
+  packed->ssa_rep = ssa_rep;
+  // The loop picks up where the packed loop left off.
+  MIR* phis[2] = { index_phi, sum_phi };
+  for (int i = 0; i < ssa_rep->num_defs; i++) {
+    int v_reg = SRegToVReg(phis[i]->ssa_rep->defs[0]);
+    ssa_rep->defs[i] = AddNewSReg(v_reg);
+    SetPhiEntry(phis[i], preheader, ssa_rep->defs[i]);
+    preheader->data_flow_info->vreg_to_ssa_map[v_reg] = ssa_rep->defs[i];
+  }
+  AppendMIR(preheader, packed);
+  if (cu_->verbose) {
+    LOG(INFO) << "Vectorized loop at 0x" << std::hex << header->start_offset << " in "
+              << PrettyMethod(cu_->method_idx, *cu_->dex_file);
+  }
+}
+
+void MIRGraph::DoVectorization() {
+  std::vector<NaturalLoop> loops;
+  FindNaturalLoops(&loops);
+  for (const NaturalLoop& loop : loops) {
+    VectorizeLoop(loop);
+  }
+}
+
+static InvokeType GetInvokeType(Instruction::Code opcode) {
+  switch (opcode) {
+    case Instruction::INVOKE_STATIC:
+    case Instruction::INVOKE_STATIC_RANGE:
+      return kStatic;
+    case Instruction::INVOKE_DIRECT:
+    case Instruction::INVOKE_DIRECT_RANGE:
+      return kDirect;
+    case Instruction::INVOKE_SUPER:
+    case Instruction::INVOKE_SUPER_RANGE:
+      return kSuper;
+    case Instruction::INVOKE_INTERFACE:
+    case Instruction::INVOKE_INTERFACE_RANGE:
+      return kInterface;
+    default:
+      DCHECK(opcode == Instruction::INVOKE_VIRTUAL || opcode == Instruction::INVOKE_VIRTUAL_RANGE)
+          << Instruction::Name(opcode);
+      return kVirtual;
+  }
+}
+
+void MIRGraph::InlineCalls(BasicBlock* bb) {
+  if (bb->block_type != kDalvikByteCode) {
+    return;
+  }
+  DexFileMethodInliner* inliner =
+      cu_->compiler_driver->GetMethodInlinerMap()->GetMethodInliner(cu_->dex_file);
+  const DexFile::MethodId& caller_id = cu_->dex_file->GetMethodId(cu_->method_idx);
+  for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+    Instruction::Code opcode = mir->dalvikInsn.opcode;
+    if (IsPseudoMirOp(opcode) || ((Instruction::FlagsOf(opcode) & Instruction::kInvoke) == 0)) {
+      continue;
+    }
+    // In a try block the invoke is split into a check and a work half, both would need updating.
+    if (try_block_addr_->IsBitSet(mir->offset)) {
+      continue;
+    }
+    InvokeType type = GetInvokeType(opcode);
+    MethodReference target_method(cu_->dex_file, mir->dalvikInsn.vB);
+    int vtable_idx;
+    uintptr_t direct_code;
+    uintptr_t direct_method;
+    if (SLOW_INVOKE_PATH ||
+        !cu_->compiler_driver->ComputeInvokeInfo(GetCurrentDexCompilationUnit(), mir->offset,
+                                                 false, true, &type, &target_method, &vtable_idx,
+                                                 &direct_code, &direct_method)) {
+      continue;
+    }
+    // Only calls that can't dispatch elsewhere, to methods analysed along with this dex file.
+    if (((type != kStatic) && (type != kDirect)) || (target_method.dex_file != cu_->dex_file)) {
+      continue;
+    }
+    // Calling a static method may initialize its class, which the referrer's class already is.
+    if ((type == kStatic) &&
+        (cu_->dex_file->GetMethodId(target_method.dex_method_index).class_idx_ !=
+         caller_id.class_idx_)) {
+      continue;
+    }
+    inliner->GenInline(cu_, mir, target_method.dex_method_index);
+  }
+}
+
 }  // namespace art
@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "mir_graph_test.h"
+
+namespace art {
+
+class MirOptimizationTest : public MirGraphTest {
+ protected:
+  // Whether the two loads of inner.value in a RedundantLoads method have their null checks done.
+  void CheckInnerValueLoads(const char* method_name, const char* signature,
+                            bool second_checked) {
+    BuildMIRGraph("RedundantLoads", "RedundantLoads", method_name, signature);
+    RunPassesThrough("GVN");
+    std::vector<MIR*> loads(FindMIRs(Instruction::IGET));
+    ASSERT_EQ(2U, loads.size());
+    EXPECT_EQ(0, loads[0]->optimization_flags & MIR_IGNORE_NULL_CHECK);
+    EXPECT_EQ(second_checked, (loads[1]->optimization_flags & MIR_IGNORE_NULL_CHECK) == 0);
+  }
+
+  // Whether the load of x in a RedundantLoads method ends up in the preheader of its loop.
+  void CheckLoopLoad(const char* method_name, bool hoisted) {
+    BuildMIRGraph("RedundantLoads", "RedundantLoads", method_name, "(I)I");
+    RunPassesThrough("LICM");
+    std::vector<MIR*> loads(FindMIRs(Instruction::IGET));
+    ASSERT_EQ(1U, loads.size());
+    std::vector<NaturalLoop> loops;
+    cu_->mir_graph->FindNaturalLoops(&loops);
+    ASSERT_EQ(1U, loops.size());
+    BasicBlock* preheader = cu_->mir_graph->GetLoopPreheader(loops[0]);
+    ASSERT_TRUE(preheader != NULL);
+    BasicBlock* bb = GetBlockOf(loads[0]);
+    ASSERT_TRUE(bb != NULL);
+    EXPECT_EQ(hoisted, bb == preheader);
+    EXPECT_EQ(!hoisted, loops[0].blocks->IsBitSet(bb->id));
+  }
+
+  // Whether the array load in the loop of a RangeChecks method keeps its range check.
+  void CheckLoopRangeCheck(const char* method_name, const char* signature, bool checked) {
+    BuildMIRGraph("RangeChecks", "RangeChecks", method_name, signature);
+    RunPassesThrough("BCE");
+    std::vector<MIR*> loads(FindMIRs(Instruction::AGET));
+    ASSERT_EQ(1U, loads.size());
+    EXPECT_EQ(checked, (loads[0]->optimization_flags & MIR_IGNORE_RANGE_CHECK) == 0);
+  }
+
+  // Runs the inlining pass on a method of the Inlining class.
+  void InlineCallsOf(const char* method_name, const char* signature) {
+    BuildMIRGraph("Inlining", "Inlining", method_name, signature);
+    RunPassesThrough("MethodInlining");
+  }
+
+  // The Dalvik register holding the method's first argument, or its receiver.
+  uint32_t FirstInRegister() {
+    return cu_->code_item->registers_size_ - cu_->code_item->ins_size_;
+  }
+
+  // Whether the object created by a ScalarReplacement method is still allocated and constructed.
+  void CheckAllocation(const char* method_name, const char* signature, bool allocated) {
+    BuildMIRGraph("ScalarReplacement", "ScalarReplacement", method_name, signature);
+    RunPassesThrough("ScalarReplacement");
+    EXPECT_EQ(allocated ? 1U : 0U, FindMIRs(Instruction::NEW_INSTANCE).size());
+    EXPECT_EQ(allocated ? 1U : 0U, FindMIRs(Instruction::INVOKE_DIRECT).size());
+  }
+
+  // The packed loop given to the loop of a Vectorization method, or NULL.
+  MIR* FindPackedLoop(const char* method_name, const char* signature) {
+    BuildMIRGraph("Vectorization", "Vectorization", method_name, signature);
+    RunPassesThrough("Vectorization");
+    std::vector<MIR*> packed_loops(FindMIRs(kMirOpPackedArrayLoop));
+    EXPECT_GE(1U, packed_loops.size());
+    return packed_loops.empty() ? NULL : packed_loops[0];
+  }
+};
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingRedundantLoad) {
+  TEST_DISABLED_FOR_PORTABLE();
+  // The dominated block loads the object already null checked.
+  CheckInnerValueLoads("loadInDominatedBlock", "(Z)I", false);
+}
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kGlobalValueNumbering);
+  CheckInnerValueLoads("loadInDominatedBlock", "(Z)I", true);
+}
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingLoadAfterStore) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckInnerValueLoads("loadAfterStore", "(ZLRedundantLoads$Inner;)I", true);
+}
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingLoadAfterCall) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckInnerValueLoads("loadAfterCall", "(Z)I", true);
+}
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingNullCheckInHandler) {
+  TEST_DISABLED_FOR_PORTABLE();
+  // The handler is entered from the null check of the first load.
+  CheckInnerValueLoads("loadInHandler", "(LRedundantLoads$Inner;)I", true);
+}
+
+TEST_F(MirOptimizationTest, GlobalValueNumberingRangeCheckInHandler) {
+  TEST_DISABLED_FOR_PORTABLE();
+  BuildMIRGraph("RedundantLoads", "RedundantLoads", "loadElementInHandler", "([II)I");
+  RunPassesThrough("GVN");
+  std::vector<MIR*> loads(FindMIRs(Instruction::AGET));
+  ASSERT_EQ(2U, loads.size());
+  // The handler is entered from the range check of the first load.
+  EXPECT_EQ(0, loads[1]->optimization_flags & MIR_IGNORE_RANGE_CHECK);
+  EXPECT_EQ(0, loads[1]->optimization_flags & MIR_IGNORE_NULL_CHECK);
+}
+
+TEST_F(MirOptimizationTest, LoopInvariantLoad) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopLoad("invariantLoad", true);
+}
+
+TEST_F(MirOptimizationTest, LoopInvariantLoadDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kLoopInvariantCodeMotion);
+  CheckLoopLoad("invariantLoad", false);
+}
+
+TEST_F(MirOptimizationTest, LoopLoadWithStore) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopLoad("loadInLoopWithStore", false);
+}
+
+TEST_F(MirOptimizationTest, LoopLoadWithCall) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopLoad("loadInLoopWithCall", false);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckCountingUp) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopRangeCheck("countUp", "([I)I", false);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckCountingDown) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopRangeCheck("countDown", "([I)I", false);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckEliminationDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kBoundsCheckElimination);
+  CheckLoopRangeCheck("countUp", "([I)I", true);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckBoundedByArgument) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopRangeCheck("boundedByArgument", "([II)I", true);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckCountingUpByTwo) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopRangeCheck("countUpByTwo", "([I)I", true);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckBoundedByOtherArray) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckLoopRangeCheck("boundedByOtherArray", "([I[I)I", true);
+}
+
+TEST_F(MirOptimizationTest, RangeCheckAfterPackedLoop) {
+  TEST_DISABLED_FOR_PORTABLE();
+  // The loop counts up from the index the packed loop stopped at, which starts at 0 too.
+  CheckLoopRangeCheck("countUp", "([I)I", false);
+  EXPECT_EQ(1U, FindMIRs(kMirOpPackedArrayLoop).size());
+}
+
+TEST_F(MirOptimizationTest, RangeCheckAfterPackedLoopElementwise) {
+  TEST_DISABLED_FOR_PORTABLE();
+  BuildMIRGraph("Vectorization", "Vectorization", "add", "([I[I[I)V");
+  RunPassesThrough("BCE");
+  ASSERT_EQ(1U, FindMIRs(kMirOpPackedArrayLoop).size());
+  // The loop bound is the length of the array stored to, the loads keep their checks.
+  std::vector<MIR*> stores(FindMIRs(Instruction::APUT));
+  ASSERT_EQ(1U, stores.size());
+  EXPECT_NE(0, stores[0]->optimization_flags & MIR_IGNORE_RANGE_CHECK);
+  std::vector<MIR*> loads(FindMIRs(Instruction::AGET));
+  ASSERT_EQ(2U, loads.size());
+  EXPECT_EQ(0, loads[0]->optimization_flags & MIR_IGNORE_RANGE_CHECK);
+  EXPECT_EQ(0, loads[1]->optimization_flags & MIR_IGNORE_RANGE_CHECK);
+}
+
+TEST_F(MirOptimizationTest, InlineEmptyMethod) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callEmpty", "()V");
+  EXPECT_TRUE(FindMIRs(Instruction::INVOKE_STATIC).empty());
+  EXPECT_FALSE(FindMIRs(kMirOpNop).empty());
+}
+
+TEST_F(MirOptimizationTest, InlineReturnArg) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callReturnArg", "(I)I");
+  EXPECT_TRUE(FindMIRs(Instruction::INVOKE_STATIC).empty());
+  EXPECT_TRUE(FindMIRs(Instruction::MOVE_RESULT).empty());
+  std::vector<MIR*> moves(FindMIRs(Instruction::MOVE));
+  ASSERT_EQ(1U, moves.size());
+  EXPECT_EQ(FirstInRegister(), moves[0]->dalvikInsn.vB);
+}
+
+TEST_F(MirOptimizationTest, InlineConstant) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callConstant", "()I");
+  EXPECT_TRUE(FindMIRs(Instruction::INVOKE_STATIC).empty());
+  std::vector<MIR*> consts(FindMIRs(Instruction::CONST));
+  ASSERT_EQ(1U, consts.size());
+  EXPECT_EQ(42U, consts[0]->dalvikInsn.vB);
+}
+
+TEST_F(MirOptimizationTest, InlineGetter) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callGetter", "()I");
+  EXPECT_TRUE(FindMIRs(Instruction::INVOKE_DIRECT).empty());
+  std::vector<MIR*> loads(FindMIRs(Instruction::IGET));
+  ASSERT_EQ(1U, loads.size());
+  EXPECT_EQ(FirstInRegister(), loads[0]->dalvikInsn.vB);
+}
+
+TEST_F(MirOptimizationTest, InlineSetter) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callSetter", "(I)V");
+  EXPECT_TRUE(FindMIRs(Instruction::INVOKE_DIRECT).empty());
+  std::vector<MIR*> stores(FindMIRs(Instruction::IPUT));
+  ASSERT_EQ(1U, stores.size());
+  EXPECT_EQ(FirstInRegister() + 1, stores[0]->dalvikInsn.vA);
+  EXPECT_EQ(FirstInRegister(), stores[0]->dalvikInsn.vB);
+}
+
+TEST_F(MirOptimizationTest, InlineDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kMethodInlining);
+  InlineCallsOf("callConstant", "()I");
+  EXPECT_EQ(1U, FindMIRs(Instruction::INVOKE_STATIC).size());
+}
+
+TEST_F(MirOptimizationTest, InlineRejectsEmptyInstanceMethod) {
+  TEST_DISABLED_FOR_PORTABLE();
+  // Nothing would null check the receiver.
+  InlineCallsOf("callEmptyInstance", "()V");
+  EXPECT_EQ(1U, FindMIRs(Instruction::INVOKE_DIRECT).size());
+}
+
+TEST_F(MirOptimizationTest, InlineRejectsGetterOfArgument) {
+  TEST_DISABLED_FOR_PORTABLE();
+  // The getter doesn't dereference its receiver.
+  InlineCallsOf("callGetterOfArgument", "(LInlining;)I");
+  EXPECT_EQ(1U, FindMIRs(Instruction::INVOKE_DIRECT).size());
+  EXPECT_TRUE(FindMIRs(Instruction::IGET).empty());
+}
+
+TEST_F(MirOptimizationTest, InlineRejectsStaticMethodOfOtherClass) {
+  TEST_DISABLED_FOR_PORTABLE();
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    VerifyClass("Inlining", "InliningOther");
+  }
+  // The call may initialize the other class.
+  InlineCallsOf("callConstantOfOtherClass", "()I");
+  EXPECT_EQ(1U, FindMIRs(Instruction::INVOKE_STATIC).size());
+}
+
+TEST_F(MirOptimizationTest, InlineRejectsCallInTryBlock) {
+  TEST_DISABLED_FOR_PORTABLE();
+  InlineCallsOf("callGetterInTry", "()I");
+  EXPECT_EQ(1U, FindMIRs(Instruction::INVOKE_DIRECT).size());
+  EXPECT_TRUE(FindMIRs(Instruction::IGET).empty());
+}
+
+TEST_F(MirOptimizationTest, ScalarReplacementNonEscaping) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckAllocation("nonEscaping", "(II)I", false);
+  // The loads read the constructor's arguments instead.
+  EXPECT_TRUE(FindMIRs(Instruction::IGET).empty());
+  std::vector<MIR*> moves(FindMIRs(Instruction::MOVE));
+  ASSERT_EQ(2U, moves.size());
+  EXPECT_EQ(FirstInRegister(), moves[0]->dalvikInsn.vB);
+  EXPECT_EQ(FirstInRegister() + 1, moves[1]->dalvikInsn.vB);
+}
+
+TEST_F(MirOptimizationTest, ScalarReplacementDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kScalarReplacement);
+  CheckAllocation("nonEscaping", "(II)I", true);
+}
+
+TEST_F(MirOptimizationTest, ScalarReplacementEscaping) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckAllocation("escaping", "(II)I", true);
+}
+
+TEST_F(MirOptimizationTest, ScalarReplacementNotCopyingConstructor) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckAllocation("notCopyingConstructor", "(I)I", true);
+}
+
+TEST_F(MirOptimizationTest, ScalarReplacementWrittenAfterConstruction) {
+  TEST_DISABLED_FOR_PORTABLE();
+  CheckAllocation("writtenAfterConstruction", "(II)I", true);
+}
+
+TEST_F(MirOptimizationTest, VectorizationElementwise) {
+  TEST_DISABLED_FOR_PORTABLE();
+  MIR* packed_loop = FindPackedLoop("add", "([I[I[I)V");
+  ASSERT_TRUE(packed_loop != NULL);
+  EXPECT_EQ(static_cast<uint32_t>(kPackedLoopBoundIsArray | kPackedLoopArray1 | kPackedLoopArray2),
+            packed_loop->dalvikInsn.vB);
+  EXPECT_EQ(kOpAdd, static_cast<OpKind>(packed_loop->dalvikInsn.arg[0]));
+  // The loop goes on from the index the packed loop stopped at.
+  ASSERT_EQ(1, packed_loop->ssa_rep->num_defs);
+  std::vector<NaturalLoop> loops;
+  cu_->mir_graph->FindNaturalLoops(&loops);
+  ASSERT_EQ(1U, loops.size());
+  EXPECT_EQ(cu_->mir_graph->GetLoopPreheader(loops[0]), GetBlockOf(packed_loop));
+}
+
+TEST_F(MirOptimizationTest, VectorizationReduction) {
+  TEST_DISABLED_FOR_PORTABLE();
+  MIR* packed_loop = FindPackedLoop("sum", "([I)I");
+  ASSERT_TRUE(packed_loop != NULL);
+  EXPECT_EQ(static_cast<uint32_t>(kPackedLoopReduction | kPackedLoopBoundIsArray |
+                                  kPackedLoopArray1),
+            packed_loop->dalvikInsn.vB);
+  EXPECT_EQ(kOpMov, static_cast<OpKind>(packed_loop->dalvikInsn.arg[0]));
+  EXPECT_EQ(kOpAdd, static_cast<OpKind>(packed_loop->dalvikInsn.arg[1]));
+  EXPECT_EQ(2, packed_loop->ssa_rep->num_defs);
+}
+
+TEST_F(MirOptimizationTest, VectorizationDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kVectorization);
+  EXPECT_TRUE(FindPackedLoop("add", "([I[I[I)V") == NULL);
+}
+
+TEST_F(MirOptimizationTest, VectorizationRejectsStrideOfTwo) {
+  TEST_DISABLED_FOR_PORTABLE();
+  EXPECT_TRUE(FindPackedLoop("addByTwo", "([I[I[I)V") == NULL);
+}
+
+TEST_F(MirOptimizationTest, VectorizationRejectsLoadOfPreviousStore) {
+  TEST_DISABLED_FOR_PORTABLE();
+  EXPECT_TRUE(FindPackedLoop("addToPrevious", "([I)V") == NULL);
+}
+
+TEST_F(MirOptimizationTest, VectorizationRejectsCharArrays) {
+  TEST_DISABLED_FOR_PORTABLE();
+  EXPECT_TRUE(FindPackedLoop("addChars", "([C[C[C)V") == NULL);
+}
+
+TEST_F(MirOptimizationTest, VectorizationRejectsLongArrays) {
+  TEST_DISABLED_FOR_PORTABLE();
+  EXPECT_TRUE(FindPackedLoop("addLongs", "([J[J[J)V") == NULL);
+}
+
+}  // namespace art
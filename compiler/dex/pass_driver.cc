@@ -85,13 +85,19 @@ void PassDriver::CreatePasses() {
    *   - This is not yet an issue: no current pass would require it.
    */
   static const Pass* passes[] = {
+      GetPassInstance<MethodInlining>(),
       GetPassInstance<CodeLayout>(),
       GetPassInstance<SSATransformation>(),
+      GetPassInstance<ScalarReplacement>(),
+      GetPassInstance<Vectorization>(),
       GetPassInstance<ConstantPropagation>(),
       GetPassInstance<InitRegLocations>(),
       GetPassInstance<MethodUseCount>(),
       GetPassInstance<NullCheckEliminationAndTypeInferenceInit>(),
       GetPassInstance<NullCheckEliminationAndTypeInference>(),
+      GetPassInstance<LoopInvariantCodeMotion>(),
+      GetPassInstance<GlobalValueNumbering>(),
+      GetPassInstance<BoundsCheckElimination>(),
       GetPassInstance<BBCombine>(),
       GetPassInstance<BBOptimizations>(),
   };
@@ -460,6 +460,17 @@ enum ArmOpcode {
   kThumb2LdrdPcRel8,  // ldrd rt, rt2, pc +-/1024.
   kThumb2LdrdI8,     // ldrd rt, rt2, [rn +-/1024].
   kThumb2StrdI8,     // strd rt, rt2, [rn +-/1024].
+  kThumb2ClzRR,      // clz [111110101011] rm[19..16] [1111] rd[11..8] 1000 rm[3..0]
+  kThumb2RbitRR,     // rbit [111110101001] rm[19..16] [1111] rd[11..8] 1010 rm[3..0]
+  kThumb2VaddQ,      // vadd.i32 [111011110D10] vn[19..16] vd[15..12] [1000] N1M0 vm[3..0].
+  kThumb2VsubQ,      // vsub.i32 [111111110D10] vn[19..16] vd[15..12] [1000] N1M0 vm[3..0].
+  kThumb2VmulQ,      // vmul.i32 [111011110D10] vn[19..16] vd[15..12] [1001] N1M1 vm[3..0].
+  kThumb2VandQ,      // vand [111011110D00] vn[19..16] vd[15..12] [0001] N1M1 vm[3..0].
+  kThumb2VorrQ,      // vorr [111011110D10] vn[19..16] vd[15..12] [0001] N1M1 vm[3..0].
+  kThumb2VeorQ,      // veor [111111110D00] vn[19..16] vd[15..12] [0001] N1M1 vm[3..0].
+  kThumb2VdupQ,      // vdup.32 [111011101010] vd[19..16] rt[15..12] [1011] D001 [0000].
+  kThumb2Vld1Q,      // vld1.32 [111110010D10] rn[19..16] vd[15..12] [101010001111].
+  kThumb2Vst1Q,      // vst1.32 [111110010D00] rn[19..16] vd[15..12] [101010001111].
   kArmLast,
 };
 
@@ -1039,6 +1039,52 @@ const ArmEncodingMap ArmMir2Lir::EncodingMap[kArmLast] = {
                  kFmtBitBlt, 7, 0,
                  IS_QUAD_OP | REG_USE0 | REG_USE1 | REG_USE2 | IS_STORE,
                  "strd", "!0C, !1C, [!2C, #!3E]", 4, kFixupNone),
+    ENCODING_MAP(kThumb2ClzRR, 0xfab0f080,
+                 kFmtBitBlt, 11, 8, kFmtBitBlt, 19, 16, kFmtBitBlt, 3, 0,
+                 kFmtUnused, -1, -1,
+                 IS_TERTIARY_OP | REG_DEF0_USE12,  // Binary, but rm is stored twice.
+                 "clz", "!0C, !1C", 4, kFixupNone),
+    ENCODING_MAP(kThumb2RbitRR, 0xfa90f0a0,
+                 kFmtBitBlt, 11, 8, kFmtBitBlt, 19, 16, kFmtBitBlt, 3, 0,
+                 kFmtUnused, -1, -1,
+                 IS_TERTIARY_OP | REG_DEF0_USE12,  // Binary, but rm is stored twice.
+                 "rbit", "!0C, !1C", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VaddQ, 0xef200840,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "vadd.i32", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VsubQ, 0xff200840,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "vsub.i32", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VmulQ, 0xef200950,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "vmul.i32", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VandQ, 0xef000150,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "vand", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VorrQ, 0xef200150,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "vorr", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VeorQ, 0xff000150,
+                 kFmtDfp, 22, 12, kFmtDfp, 7, 16, kFmtDfp, 5, 0,
+                 kFmtUnused, -1, -1, IS_TERTIARY_OP | REG_DEF0_USE12,
+                 "veor", "!0q, !1q, !2q", 4, kFixupNone),
+    ENCODING_MAP(kThumb2VdupQ, 0xeea00b10,
+                 kFmtDfp, 7, 16, kFmtBitBlt, 15, 12, kFmtUnused, -1, -1,
+                 kFmtUnused, -1, -1, IS_BINARY_OP | REG_DEF0_USE1,
+                 "vdup.32", "!0q, !1C", 4, kFixupNone),
+    ENCODING_MAP(kThumb2Vld1Q, 0xf9200a8f,
+                 kFmtDfp, 22, 12, kFmtBitBlt, 19, 16, kFmtUnused, -1, -1,
+                 kFmtUnused, -1, -1, IS_BINARY_OP | REG_DEF0_USE1 | IS_LOAD,
+                 "vld1.32", "{!0q}, [!1C]", 4, kFixupNone),
+    ENCODING_MAP(kThumb2Vst1Q, 0xf9000a8f,
+                 kFmtDfp, 22, 12, kFmtBitBlt, 19, 16, kFmtUnused, -1, -1,
+                 kFmtUnused, -1, -1, IS_BINARY_OP | REG_USE01 | IS_STORE,
+                 "vst1.32", "{!0q}, [!1C]", 4, kFixupNone),
 };
 
 // new_lir replaces orig_lir in the pcrel_fixup list.
@@ -509,6 +509,75 @@ bool ArmMir2Lir::GenInlinedMinMaxInt(CallInfo* info, bool is_min) {
   return true;
 }
 
+bool ArmMir2Lir::GenInlinedMinMaxLong(CallInfo* info, bool is_min) {
+  DCHECK_EQ(cu_->instruction_set, kThumb2);
+  RegLocation rl_src1 = info->args[0];
+  RegLocation rl_src2 = info->args[2];
+  rl_src1 = LoadValueWide(rl_src1, kCoreReg);
+  rl_src2 = LoadValueWide(rl_src2, kCoreReg);
+  RegLocation rl_dest = InlineTargetWide(info);
+  RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+  // Only the flags of src1 - src2 are needed, their signed comparison orders the values.
+  int t_reg = AllocTemp();
+  OpRegRegReg(kOpSub, t_reg, rl_src1.low_reg, rl_src2.low_reg);
+  OpRegRegReg(kOpSbc, t_reg, rl_src1.high_reg, rl_src2.high_reg);
+  FreeTemp(t_reg);
+  OpIT((is_min) ? kCondLt : kCondGe, "TEE");
+  OpRegReg(kOpMov, rl_result.low_reg, rl_src1.low_reg);
+  OpRegReg(kOpMov, rl_result.high_reg, rl_src1.high_reg);
+  OpRegReg(kOpMov, rl_result.low_reg, rl_src2.low_reg);
+  OpRegReg(kOpMov, rl_result.high_reg, rl_src2.high_reg);
+  GenBarrier();
+  StoreValueWide(rl_dest, rl_result);
+  return true;
+}
+
+bool ArmMir2Lir::GenInlinedNumberOfZeros(CallInfo* info, OpSize size, bool is_trailing) {
+  DCHECK_EQ(cu_->instruction_set, kThumb2);
+  RegLocation rl_dest = InlineTarget(info);
+  if (size == kWord) {
+    RegLocation rl_src = LoadValue(info->args[0], kCoreReg);
+    RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+    if (is_trailing) {
+      // The trailing zeros are the leading zeros of the reversed bits.
+      NewLIR3(kThumb2RbitRR, rl_result.low_reg, rl_src.low_reg, rl_src.low_reg);
+      NewLIR3(kThumb2ClzRR, rl_result.low_reg, rl_result.low_reg, rl_result.low_reg);
+    } else {
+      NewLIR3(kThumb2ClzRR, rl_result.low_reg, rl_src.low_reg, rl_src.low_reg);
+    }
+    StoreValue(rl_dest, rl_result);
+    return true;
+  }
+  DCHECK_EQ(size, kLong);
+  RegLocation rl_src = LoadValueWide(info->args[0], kCoreReg);
+  RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+  // Count in the word the scan starts from. If that word is all zeros, the count is 32 plus
+  // the count of the other word.
+  int first_reg = is_trailing ? rl_src.low_reg : rl_src.high_reg;
+  int second_reg = is_trailing ? rl_src.high_reg : rl_src.low_reg;
+  // The result may share a register with the source, count in temps.
+  int r_count = AllocTemp();
+  int t_reg = AllocTemp();
+  if (is_trailing) {
+    NewLIR3(kThumb2RbitRR, r_count, first_reg, first_reg);
+    NewLIR3(kThumb2ClzRR, r_count, r_count, r_count);
+    NewLIR3(kThumb2RbitRR, t_reg, second_reg, second_reg);
+    NewLIR3(kThumb2ClzRR, t_reg, t_reg, t_reg);
+  } else {
+    NewLIR3(kThumb2ClzRR, r_count, first_reg, first_reg);
+    NewLIR3(kThumb2ClzRR, t_reg, second_reg, second_reg);
+  }
+  OpRegImm(kOpCmp, first_reg, 0);
+  OpIT(kCondEq, "");
+  OpRegRegImm(kOpAdd, r_count, t_reg, 32);
+  GenBarrier();
+  OpRegCopy(rl_result.low_reg, r_count);
+  FreeTemp(r_count);
+  FreeTemp(t_reg);
+  StoreValue(rl_dest, rl_result);
+  return true;
+}
+
 bool ArmMir2Lir::GenInlinedPeek(CallInfo* info, OpSize size) {
   RegLocation rl_src_address = info->args[0];  // long address
   rl_src_address.wide = 0;  // ignore high half in info->args[1]
@@ -36,6 +36,14 @@ static int core_temps[] = {r0, r1, r2, r3, r12};
 static int fp_temps[] = {fr0, fr1, fr2, fr3, fr4, fr5, fr6, fr7,
                         fr8, fr9, fr10, fr11, fr12, fr13, fr14, fr15};
 
+/*
+ * Pipelines of the Cortex-A9 and of the Cortex-A15. The cores with the integer divide
+ * instructions (Cortex-A15, Cortex-A7, Krait) are scheduled for the latter.
+ */
+//                                            issue alu load mul div fp fp_div vector
+static const SchedulingModel kCortexA9Model  = { 2,   1,  3,   3,  20, 4,  15,    3 };
+static const SchedulingModel kCortexA15Model = { 3,   1,  4,   4,  12, 4,  18,    3 };
+
 RegLocation ArmMir2Lir::LocCReturn() {
   RegLocation res = ARM_LOC_C_RETURN;
   return res;
@@ -200,6 +208,42 @@ void ArmMir2Lir::SetupTargetResourceMasks(LIR* lir, uint64_t flags) {
       lir->u.m.def_mask |= ENCODE_ARM_REG_LR;
     }
   }
+
+  switch (opcode) {
+    // Quad registers are named by the double overlapping their low half, add the high half.
+    case kThumb2VaddQ:
+    case kThumb2VsubQ:
+    case kThumb2VmulQ:
+    case kThumb2VandQ:
+    case kThumb2VorrQ:
+    case kThumb2VeorQ:
+    case kThumb2VdupQ:
+    case kThumb2Vld1Q:
+    case kThumb2Vst1Q:
+      if (flags & REG_DEF0) {
+        SetupRegMask(&lir->u.m.def_mask, lir->operands[0] + 2);
+      }
+      if (flags & REG_USE0) {
+        SetupRegMask(&lir->u.m.use_mask, lir->operands[0] + 2);
+      }
+      if ((flags & REG_USE1) && ARM_FPREG(lir->operands[1])) {
+        SetupRegMask(&lir->u.m.use_mask, lir->operands[1] + 2);
+      }
+      if (flags & REG_USE2) {
+        SetupRegMask(&lir->u.m.use_mask, lir->operands[2] + 2);
+      }
+      break;
+    // The flags of a vcmp only reach the condition codes through the following fmstat.
+    case kThumb2Vcmps:
+    case kThumb2Vcmpd:
+      lir->u.m.def_mask |= ENCODE_FP_STATUS;
+      break;
+    case kThumb2Fmstat:
+      lir->u.m.use_mask |= ENCODE_FP_STATUS;
+      break;
+    default:
+      break;
+  }
 }
 
 ArmConditionCode ArmMir2Lir::ArmConditionEncoding(ConditionCode ccode) {
@@ -387,6 +431,9 @@ std::string ArmMir2Lir::BuildInsnString(const char* fmt, LIR* lir, unsigned char
            case 'S':
              snprintf(tbuf, arraysize(tbuf), "d%d", (operand & ARM_FP_REG_MASK) >> 1);
              break;
+           case 'q':
+             snprintf(tbuf, arraysize(tbuf), "q%d", (operand & ARM_FP_REG_MASK) >> 2);
+             break;
            case 'h':
              snprintf(tbuf, arraysize(tbuf), "%04x", operand);
              break;
@@ -500,6 +547,53 @@ bool ArmMir2Lir::IsUnconditionalBranch(LIR* lir) {
   return ((lir->opcode == kThumbBUncond) || (lir->opcode == kThumb2BUncond));
 }
 
+const SchedulingModel& ArmMir2Lir::GetSchedulingModel() {
+  return cu_->GetInstructionSetFeatures().HasDivideInstruction() ? kCortexA15Model :
+      kCortexA9Model;
+}
+
+int ArmMir2Lir::GetInstructionLatency(LIR* lir) {
+  const SchedulingModel& model = GetSchedulingModel();
+  switch (lir->opcode) {
+    case kThumbMul:
+    case kThumb2MulRRR:
+    case kThumb2Mla:
+    case kThumb2Umull:
+    case kThumb2Smull:
+      return model.mul_latency;
+    case kThumb2SdivRRR:
+    case kThumb2UdivRRR:
+      return model.div_latency;
+    case kThumb2Vdivs:
+    case kThumb2Vdivd:
+    case kThumb2Vsqrts:
+    case kThumb2Vsqrtd:
+      return model.fp_div_latency;
+    case kThumb2VaddQ:
+    case kThumb2VsubQ:
+    case kThumb2VmulQ:
+    case kThumb2VandQ:
+    case kThumb2VorrQ:
+    case kThumb2VeorQ:
+    case kThumb2VdupQ:
+      return model.vector_latency;
+    case kThumb2Fmrs:
+    case kThumb2Fmrrd:
+      // Results coming back from the VFP pipeline.
+      return model.fp_latency;
+    default:
+      break;
+  }
+  uint64_t flags = GetTargetInstFlags(lir->opcode);
+  if (flags & IS_LOAD) {
+    return model.load_latency;
+  }
+  if ((flags & REG_DEF0) && ARM_FPREG(lir->operands[0])) {
+    return model.fp_latency;
+  }
+  return model.alu_latency;
+}
+
 ArmMir2Lir::ArmMir2Lir(CompilationUnit* cu, MIRGraph* mir_graph, ArenaAllocator* arena)
     : Mir2Lir(cu, mir_graph, arena) {
   // Sanity check - make sure encoding map lines up.
@@ -543,6 +637,38 @@ int ArmMir2Lir::AllocTypedTemp(bool fp_hint, int reg_class) {
   return AllocTemp();
 }
 
+/*
+ * Alloc a quad register, named by the double overlapping its low half. The four singles it
+ * overlaps must be free temps.
+ */
+int ArmMir2Lir::AllocPackedTemp() {
+  RegisterInfo* p = reg_pool_->FPRegs;
+  int num_regs = reg_pool_->num_fp_regs;
+  for (int next = 0; next + 3 < num_regs; next += 4) {
+    bool free = true;
+    for (int i = next; i < next + 4; i++) {
+      free = free && p[i].is_temp && !p[i].in_use;
+    }
+    if (free) {
+      DCHECK_EQ((p[next].reg & 0x3), 0);
+      for (int i = next; i < next + 4; i++) {
+        Clobber(p[i].reg);
+        p[i].in_use = true;
+      }
+      return S2d(p[next].reg, p[next + 1].reg);
+    }
+  }
+  LOG(FATAL) << "No free quad register";
+  return -1;
+}
+
+void ArmMir2Lir::FreePackedTemp(int v_reg) {
+  int low_reg = v_reg & ~ARM_FP_DOUBLE;
+  for (int i = 0; i < 4; i++) {
+    FreeTemp(low_reg + i);
+  }
+}
+
 void ArmMir2Lir::CompilerInitializeRegAlloc() {
   int num_regs = sizeof(core_regs)/sizeof(*core_regs);
   int num_reserved = sizeof(ReservedRegs)/sizeof(*ReservedRegs);
@@ -1092,4 +1092,61 @@ LIR* ArmMir2Lir::LoadBaseIndexedDisp(int rBase, int r_index, int scale,
   return NULL;
 }
 
+// vld1 and vst1 have no offset, the address is formed in r_base.
+void ArmMir2Lir::OpPackedLoad(int v_dest, int r_base, int r_index, int offset) {
+  OpRegRegRegShift(kOpAdd, r_base, r_base, r_index, EncodeShift(kArmLsl, 2));
+  OpRegImm(kOpAdd, r_base, offset);
+  NewLIR2(kThumb2Vld1Q, v_dest, r_base);
+}
+
+void ArmMir2Lir::OpPackedStore(int r_base, int r_index, int offset, int v_src) {
+  OpRegRegRegShift(kOpAdd, r_base, r_base, r_index, EncodeShift(kArmLsl, 2));
+  OpRegImm(kOpAdd, r_base, offset);
+  NewLIR2(kThumb2Vst1Q, v_src, r_base);
+}
+
+void ArmMir2Lir::OpPackedBroadcast(int v_dest, int r_src) {
+  NewLIR2(kThumb2VdupQ, v_dest, r_src);
+}
+
+void ArmMir2Lir::OpPackedRegReg(OpKind op, int v_dest_src1, int v_src2) {
+  ArmOpcode opcode = kThumbBkpt;
+  switch (op) {
+    case kOpAdd:
+      opcode = kThumb2VaddQ;
+      break;
+    case kOpSub:
+      opcode = kThumb2VsubQ;
+      break;
+    case kOpMul:
+      opcode = kThumb2VmulQ;
+      break;
+    case kOpAnd:
+      opcode = kThumb2VandQ;
+      break;
+    case kOpOr:
+      opcode = kThumb2VorrQ;
+      break;
+    case kOpXor:
+      opcode = kThumb2VeorQ;
+      break;
+    default:
+      LOG(FATAL) << "Bad packed opcode: " << op;
+  }
+  NewLIR3(opcode, v_dest_src1, v_dest_src1, v_src2);
+}
+
+void ArmMir2Lir::OpPackedReduce(OpKind op, int r_dest_src1, int v_src) {
+  int r_low = AllocTemp();
+  int r_high = AllocTemp();
+  // The quad is the doubles v_src and v_src + 2.
+  for (int half = 0; half < 2; half++) {
+    NewLIR3(kThumb2Fmrrd, r_low, r_high, v_src + 2 * half);
+    OpRegReg(op, r_dest_src1, r_low);
+    OpRegReg(op, r_dest_src1, r_high);
+  }
+  FreeTemp(r_low);
+  FreeTemp(r_high);
+}
+
 }  // namespace art
@@ -21,7 +21,10 @@
 #include "locks.h"
 #include "thread.h"
 #include "thread-inl.h"
+#include "dex/compiler_ir.h"
+#include "dex/frontend.h"
 #include "dex/mir_graph.h"
+#include "driver/compiler_driver.h"
 #include "dex_instruction.h"
 #include "dex_instruction-inl.h"
 
@@ -52,6 +55,11 @@ const char* const DexFileMethodInliner::kClassCacheNames[] = {
     "Ljava/lang/Thread;",      // kClassCacheJavaLangThread
     "Llibcore/io/Memory;",     // kClassCacheLibcoreIoMemory
     "Lsun/misc/Unsafe;",       // kClassCacheSunMiscUnsafe
+    "Ljava/lang/System;",      // kClassCacheJavaLangSystem
+    "Ljava/util/Arrays;",      // kClassCacheJavaUtilArrays
+    "[B",                      // kClassCacheByteArray
+    "[C",                      // kClassCacheCharArray
+    "[I",                      // kClassCacheIntArray
 };
 
 const char* const DexFileMethodInliner::kNameCacheNames[] = {
@@ -96,6 +104,12 @@ const char* const DexFileMethodInliner::kNameCacheNames[] = {
     "putObject",             // kNameCachePutObject
     "putObjectVolatile",     // kNameCachePutObjectVolatile
     "putOrderedObject",      // kNameCachePutOrderedObject
+    "bitCount",              // kNameCacheBitCount
+    "numberOfLeadingZeros",  // kNameCacheNumberOfLeadingZeros
+    "numberOfTrailingZeros",  // kNameCacheNumberOfTrailingZeros
+    "equals",                // kNameCacheEquals
+    "arraycopy",             // kNameCacheArrayCopy
+    "fill",                  // kNameCacheFill
 };
 
 const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
@@ -163,6 +177,19 @@ const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
     // kProtoCacheObjectJObject_V
     { kClassCacheVoid, 3, { kClassCacheJavaLangObject, kClassCacheLong,
         kClassCacheJavaLangObject } },
+    // kProtoCacheJJ_J
+    { kClassCacheLong, 2, { kClassCacheLong, kClassCacheLong } },
+    // kProtoCacheObject_Z
+    { kClassCacheBoolean, 1, { kClassCacheJavaLangObject } },
+    // kProtoCacheObjectIObjectII_V
+    { kClassCacheVoid, 5, { kClassCacheJavaLangObject, kClassCacheInt, kClassCacheJavaLangObject,
+        kClassCacheInt, kClassCacheInt } },
+    // kProtoCacheByteArrayB_V
+    { kClassCacheVoid, 2, { kClassCacheByteArray, kClassCacheByte } },
+    // kProtoCacheCharArrayC_V
+    { kClassCacheVoid, 2, { kClassCacheCharArray, kClassCacheChar } },
+    // kProtoCacheIntArrayI_V
+    { kClassCacheVoid, 2, { kClassCacheIntArray, kClassCacheInt } },
 };
 
 const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods[] = {
@@ -178,6 +205,14 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
     INTRINSIC(JavaLangLong, ReverseBytes, J_J, kIntrinsicReverseBytes, kLong),
     INTRINSIC(JavaLangShort, ReverseBytes, S_S, kIntrinsicReverseBytes, kSignedHalf),
 
+    INTRINSIC(JavaLangInteger, BitCount, I_I, kIntrinsicBitCount, kWord),
+    INTRINSIC(JavaLangLong, BitCount, J_I, kIntrinsicBitCount, kLong),
+    INTRINSIC(JavaLangInteger, NumberOfLeadingZeros, I_I, kIntrinsicNumberOfLeadingZeros, kWord),
+    INTRINSIC(JavaLangLong, NumberOfLeadingZeros, J_I, kIntrinsicNumberOfLeadingZeros, kLong),
+    INTRINSIC(JavaLangInteger, NumberOfTrailingZeros, I_I, kIntrinsicNumberOfTrailingZeros,
+              kWord),
+    INTRINSIC(JavaLangLong, NumberOfTrailingZeros, J_I, kIntrinsicNumberOfTrailingZeros, kLong),
+
     INTRINSIC(JavaLangMath,       Abs, I_I, kIntrinsicAbsInt, 0),
     INTRINSIC(JavaLangStrictMath, Abs, I_I, kIntrinsicAbsInt, 0),
     INTRINSIC(JavaLangMath,       Abs, J_J, kIntrinsicAbsLong, 0),
@@ -186,11 +221,16 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
     INTRINSIC(JavaLangStrictMath, Min, II_I, kIntrinsicMinMaxInt, kIntrinsicFlagMin),
     INTRINSIC(JavaLangMath,       Max, II_I, kIntrinsicMinMaxInt, kIntrinsicFlagMax),
     INTRINSIC(JavaLangStrictMath, Max, II_I, kIntrinsicMinMaxInt, kIntrinsicFlagMax),
+    INTRINSIC(JavaLangMath,       Min, JJ_J, kIntrinsicMinMaxLong, kIntrinsicFlagMin),
+    INTRINSIC(JavaLangStrictMath, Min, JJ_J, kIntrinsicMinMaxLong, kIntrinsicFlagMin),
+    INTRINSIC(JavaLangMath,       Max, JJ_J, kIntrinsicMinMaxLong, kIntrinsicFlagMax),
+    INTRINSIC(JavaLangStrictMath, Max, JJ_J, kIntrinsicMinMaxLong, kIntrinsicFlagMax),
     INTRINSIC(JavaLangMath,       Sqrt, D_D, kIntrinsicSqrt, 0),
     INTRINSIC(JavaLangStrictMath, Sqrt, D_D, kIntrinsicSqrt, 0),
 
     INTRINSIC(JavaLangString, CharAt, I_C, kIntrinsicCharAt, 0),
     INTRINSIC(JavaLangString, CompareTo, String_I, kIntrinsicCompareTo, 0),
+    INTRINSIC(JavaLangString, Equals, Object_Z, kIntrinsicStringEquals, 0),
     INTRINSIC(JavaLangString, IsEmpty, _Z, kIntrinsicIsEmptyOrLength, kIntrinsicFlagIsEmpty),
     INTRINSIC(JavaLangString, IndexOf, II_I, kIntrinsicIndexOf, kIntrinsicFlagNone),
     INTRINSIC(JavaLangString, IndexOf, I_I, kIntrinsicIndexOf, kIntrinsicFlagBase0),
@@ -198,6 +238,11 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
 
     INTRINSIC(JavaLangThread, CurrentThread, _Thread, kIntrinsicCurrentThread, 0),
 
+    INTRINSIC(JavaLangSystem, ArrayCopy, ObjectIObjectII_V, kIntrinsicSystemArrayCopy, 0),
+    INTRINSIC(JavaUtilArrays, Fill, ByteArrayB_V, kIntrinsicArrayFill, kUnsignedByte),
+    INTRINSIC(JavaUtilArrays, Fill, CharArrayC_V, kIntrinsicArrayFill, kUnsignedHalf),
+    INTRINSIC(JavaUtilArrays, Fill, IntArrayI_V, kIntrinsicArrayFill, kWord),
+
     INTRINSIC(LibcoreIoMemory, PeekByte, J_B, kIntrinsicPeek, kSignedByte),
     INTRINSIC(LibcoreIoMemory, PeekIntNative, J_I, kIntrinsicPeek, kWord),
     INTRINSIC(LibcoreIoMemory, PeekLongNative, J_J, kIntrinsicPeek, kLong),
@@ -330,18 +375,32 @@ bool DexFileMethodInliner::GenIntrinsic(Mir2Lir* backend, CallInfo* info) {
       return backend->GenInlinedAbsLong(info);
     case kIntrinsicMinMaxInt:
       return backend->GenInlinedMinMaxInt(info, intrinsic.data & kIntrinsicFlagMin);
+    case kIntrinsicMinMaxLong:
+      return backend->GenInlinedMinMaxLong(info, intrinsic.data & kIntrinsicFlagMin);
+    case kIntrinsicBitCount:
+      return backend->GenInlinedBitCount(info, static_cast<OpSize>(intrinsic.data));
+    case kIntrinsicNumberOfLeadingZeros:
+      return backend->GenInlinedNumberOfZeros(info, static_cast<OpSize>(intrinsic.data), false);
+    case kIntrinsicNumberOfTrailingZeros:
+      return backend->GenInlinedNumberOfZeros(info, static_cast<OpSize>(intrinsic.data), true);
     case kIntrinsicSqrt:
       return backend->GenInlinedSqrt(info);
     case kIntrinsicCharAt:
       return backend->GenInlinedCharAt(info);
     case kIntrinsicCompareTo:
       return backend->GenInlinedStringCompareTo(info);
+    case kIntrinsicStringEquals:
+      return backend->GenInlinedStringEquals(info);
     case kIntrinsicIsEmptyOrLength:
       return backend->GenInlinedStringIsEmptyOrLength(info, intrinsic.data & kIntrinsicFlagIsEmpty);
     case kIntrinsicIndexOf:
       return backend->GenInlinedIndexOf(info, intrinsic.data & kIntrinsicFlagBase0);
     case kIntrinsicCurrentThread:
       return backend->GenInlinedCurrentThread(info);
+    case kIntrinsicSystemArrayCopy:
+      return backend->GenInlinedSystemArrayCopy(info);
+    case kIntrinsicArrayFill:
+      return backend->GenInlinedArrayFill(info, static_cast<OpSize>(intrinsic.data));
     case kIntrinsicPeek:
       return backend->GenInlinedPeek(info, static_cast<OpSize>(intrinsic.data));
     case kIntrinsicPoke:
@@ -384,6 +443,131 @@ bool DexFileMethodInliner::GenSpecial(Mir2Lir* backend, uint32_t method_idx) {
   return true;
 }
 
+/* The register holding argument word arg of an invoke. */
+static uint32_t GetInvokeArgReg(MIR* invoke, uint32_t arg) {
+  switch (invoke->dalvikInsn.opcode) {
+    case Instruction::INVOKE_STATIC_RANGE:
+    case Instruction::INVOKE_DIRECT_RANGE:
+    case Instruction::INVOKE_VIRTUAL_RANGE:
+    case Instruction::INVOKE_SUPER_RANGE:
+    case Instruction::INVOKE_INTERFACE_RANGE:
+      return invoke->dalvikInsn.vC + arg;
+    default:
+      return invoke->dalvikInsn.arg[arg];
+  }
+}
+
+static Instruction::Code GetIGetIPutOpcode(const InlineIGetIPutData& data, bool is_put) {
+  switch (data.d.op_size) {
+    case kLong:
+      return is_put ? Instruction::IPUT_WIDE : Instruction::IGET_WIDE;
+    case kSignedByte:
+      return is_put ? Instruction::IPUT_BYTE : Instruction::IGET_BYTE;
+    case kUnsignedHalf:
+      return is_put ? Instruction::IPUT_CHAR : Instruction::IGET_CHAR;
+    case kSignedHalf:
+      return is_put ? Instruction::IPUT_SHORT : Instruction::IGET_SHORT;
+    default:
+      DCHECK_EQ(data.d.op_size, static_cast<uint32_t>(kWord));
+      if (data.d.is_object) {
+        return is_put ? Instruction::IPUT_OBJECT : Instruction::IGET_OBJECT;
+      }
+      return is_put ? Instruction::IPUT : Instruction::IGET;
+  }
+}
+
+bool DexFileMethodInliner::GenInline(CompilationUnit* cu, MIR* invoke, uint32_t method_idx) {
+  InlineMethod special;
+  {
+    ReaderMutexLock mu(Thread::Current(), lock_);
+    auto it = inline_methods_.find(method_idx);
+    if (it == inline_methods_.end() || (it->second.flags & kInlineSpecial) == 0) {
+      return false;
+    }
+    special = it->second;
+  }
+  Instruction::Code invoke_opcode = invoke->dalvikInsn.opcode;
+  bool is_static = (invoke_opcode == Instruction::INVOKE_STATIC) ||
+      (invoke_opcode == Instruction::INVOKE_STATIC_RANGE);
+  MIR* move_result = invoke->next;
+  if ((move_result != NULL) &&
+      (move_result->dalvikInsn.opcode != Instruction::MOVE_RESULT) &&
+      (move_result->dalvikInsn.opcode != Instruction::MOVE_RESULT_WIDE) &&
+      (move_result->dalvikInsn.opcode != Instruction::MOVE_RESULT_OBJECT)) {
+    move_result = NULL;
+  }
+  DecodedInstruction insn = invoke->dalvikInsn;
+  switch (special.opcode) {
+    case kInlineOpNop:
+    case kInlineOpReturnArg:
+    case kInlineOpConst:
+      // Nothing would null check the receiver.
+      if (!is_static) {
+        return false;
+      }
+      if (move_result == NULL) {
+        insn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+      } else if (special.opcode == kInlineOpConst) {
+        insn.opcode = Instruction::CONST;
+        insn.vA = move_result->dalvikInsn.vA;
+        insn.vB = special.data;
+      } else {
+        DCHECK_EQ(special.opcode, kInlineOpReturnArg);
+        InlineReturnArgData data;
+        data.data = special.data;
+        switch (move_result->dalvikInsn.opcode) {
+          case Instruction::MOVE_RESULT_WIDE:
+            insn.opcode = Instruction::MOVE_WIDE;
+            break;
+          case Instruction::MOVE_RESULT_OBJECT:
+            insn.opcode = Instruction::MOVE_OBJECT;
+            break;
+          default:
+            insn.opcode = Instruction::MOVE;
+            break;
+        }
+        insn.vA = move_result->dalvikInsn.vA;
+        insn.vB = GetInvokeArgReg(invoke, data.d.arg);
+      }
+      break;
+    case kInlineOpIGet:
+    case kInlineOpIPut: {
+      bool is_put = (special.opcode == kInlineOpIPut);
+      InlineIGetIPutData data;
+      data.data = special.data;
+      // An instance method must dereference its receiver, for the same NullPointerException.
+      if ((!is_static && data.d.object_arg != 0) || (!is_put && move_result == NULL)) {
+        return false;
+      }
+      // The caller accesses the field itself, so it needs access to it.
+      int field_offset;
+      bool is_volatile;
+      if (((cu->enable_debug & (1 << kDebugSlowFieldPath)) != 0) ||
+          !cu->compiler_driver->ComputeInstanceFieldInfo(
+              data.d.field, cu->mir_graph->GetCurrentDexCompilationUnit(), is_put,
+              &field_offset, &is_volatile, false)) {
+        return false;
+      }
+      insn.opcode = GetIGetIPutOpcode(data, is_put);
+      insn.vA = is_put ? GetInvokeArgReg(invoke, data.d.src_arg) : move_result->dalvikInsn.vA;
+      insn.vB = GetInvokeArgReg(invoke, data.d.object_arg);
+      insn.vC = data.d.field;
+      break;
+    }
+    default:
+      return false;
+  }
+  if (cu->verbose) {
+    LOG(INFO) << "Inlined " << PrettyMethod(method_idx, *dex_file_) << " at 0x" << std::hex
+              << invoke->offset;
+  }
+  invoke->dalvikInsn = insn;
+  if (move_result != NULL) {
+    move_result->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+  }
+  return true;
+}
+
 uint32_t DexFileMethodInliner::FindClassIndex(const DexFile* dex_file, IndexCache* cache,
                                               ClassCacheIndex index) {
   uint32_t* class_index = &cache->class_indexes[index];
@@ -29,6 +29,8 @@ namespace art {
 
 class CallInfo;
 class Mir2Lir;
+struct CompilationUnit;
+struct MIR;
 
 enum InlineMethodOpcode : uint16_t {
   kIntrinsicDoubleCvt,
@@ -37,12 +39,19 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicAbsInt,
   kIntrinsicAbsLong,
   kIntrinsicMinMaxInt,
+  kIntrinsicMinMaxLong,
+  kIntrinsicBitCount,
+  kIntrinsicNumberOfLeadingZeros,
+  kIntrinsicNumberOfTrailingZeros,
   kIntrinsicSqrt,
   kIntrinsicCharAt,
   kIntrinsicCompareTo,
+  kIntrinsicStringEquals,
   kIntrinsicIsEmptyOrLength,
   kIntrinsicIndexOf,
   kIntrinsicCurrentThread,
+  kIntrinsicSystemArrayCopy,
+  kIntrinsicArrayFill,
   kIntrinsicPeek,
   kIntrinsicPoke,
   kIntrinsicCas,
@@ -72,7 +81,7 @@ struct InlineMethod {
 enum IntrinsicFlags {
   kIntrinsicFlagNone = 0,
 
-  // kIntrinsicMinMaxInt
+  // kIntrinsicMinMaxInt, kIntrinsicMinMaxLong
   kIntrinsicFlagMax = kIntrinsicFlagNone,
   kIntrinsicFlagMin = 1,
 
@@ -167,6 +176,16 @@ class DexFileMethodInliner {
      */
     bool GenSpecial(Mir2Lir* backend, uint32_t method_idx);
 
+    /**
+     * Replace an invoke of a special function, and its move-result, with what the function does.
+     *
+     * @param cu the compilation unit of the caller.
+     * @param invoke the invoke, not yet converted to SSA form.
+     * @param method_idx the index of the invoked method, in the caller's DexFile.
+     * @return true if the invoke was replaced.
+     */
+    bool GenInline(CompilationUnit* cu, MIR* invoke, uint32_t method_idx) LOCKS_EXCLUDED(lock_);
+
   private:
     /**
      * To avoid multiple lookups of a class by its descriptor, we cache its
@@ -196,6 +215,11 @@ class DexFileMethodInliner {
       kClassCacheJavaLangThread,
       kClassCacheLibcoreIoMemory,
       kClassCacheSunMiscUnsafe,
+      kClassCacheJavaLangSystem,
+      kClassCacheJavaUtilArrays,
+      kClassCacheByteArray,
+      kClassCacheCharArray,
+      kClassCacheIntArray,
       kClassCacheLast
     };
 
@@ -247,6 +271,12 @@ class DexFileMethodInliner {
       kNameCachePutObject,
       kNameCachePutObjectVolatile,
       kNameCachePutOrderedObject,
+      kNameCacheBitCount,
+      kNameCacheNumberOfLeadingZeros,
+      kNameCacheNumberOfTrailingZeros,
+      kNameCacheEquals,
+      kNameCacheArrayCopy,
+      kNameCacheFill,
       kNameCacheLast
     };
 
@@ -287,6 +317,12 @@ class DexFileMethodInliner {
       kProtoCacheObjectJJ_V,
       kProtoCacheObjectJ_Object,
       kProtoCacheObjectJObject_V,
+      kProtoCacheJJ_J,
+      kProtoCacheObject_Z,
+      kProtoCacheObjectIObjectII_V,
+      kProtoCacheByteArrayB_V,
+      kProtoCacheCharArrayC_V,
+      kProtoCacheIntArrayI_V,
       kProtoCacheLast
     };
 
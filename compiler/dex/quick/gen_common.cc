@@ -1886,6 +1886,139 @@ void Mir2Lir::GenSuspendTestAndBranch(int opt_flags, LIR* target) {
   suspend_launchpads_.Insert(launch_pad);
 }
 
+/*
+ * Run the leading iterations of a vectorized loop four elements at a time. The packed loop is
+ * skipped altogether for a negative start or a null array, and stops before the index gets to
+ * the bound or to the length of an array, leaving the rest to the scalar loop. It has no suspend
+ * check, it is bounded by the array lengths.
+ */
+void Mir2Lir::GenPackedArrayLoop(MIR* mir) {
+  uint32_t flags = mir->dalvikInsn.vB;
+  OpKind op = static_cast<OpKind>(mir->dalvikInsn.arg[0]);
+  OpKind sum_op = static_cast<OpKind>(mir->dalvikInsn.arg[1]);
+  bool is_sum = (flags & kPackedLoopReduction) != 0;
+  RegLocation rl_start = mir_graph_->GetSrc(mir, 0);
+  RegLocation rl_bound = mir_graph_->GetSrc(mir, 1);
+  RegLocation rl_dest = mir_graph_->GetSrc(mir, 2);
+  RegLocation rl_src1 = mir_graph_->GetSrc(mir, 3);
+  RegLocation rl_src2 = (mir->ssa_rep->num_uses > 4) ? mir_graph_->GetSrc(mir, 4) : rl_src1;
+  int len_offset = mirror::Array::LengthOffset().Int32Value();
+  int data_offset = mirror::Array::DataOffset(sizeof(int32_t)).Int32Value();
+  LIR* skips[6];
+  int num_skips = 0;
+
+  // No Dalvik register is kept in a temp, the arrays are reloaded on every iteration. Three core
+  // temps are used at most, which leaves one of the four x86 temps free.
+  FlushAllRegs();
+  int r_index = AllocTemp();
+  int r_limit = AllocTemp();
+  int r_tmp = AllocTemp();
+  int v_sum = INVALID_REG;
+  LoadValueDirect(rl_start, r_index);
+  if (is_sum) {
+    // The lanes start out with the identity of the operation, so that the skipped loop reduces
+    // to the entry value of the sum.
+    v_sum = AllocPackedTemp();
+    LoadConstant(r_tmp, (sum_op == kOpMul) ? 1 : ((sum_op == kOpAnd) ? -1 : 0));
+    OpPackedBroadcast(v_sum, r_tmp);
+  }
+  skips[num_skips++] = OpCmpImmBranch(kCondLt, r_index, 0, NULL);
+  if ((flags & kPackedLoopBoundIsArray) != 0) {
+    LoadValueDirect(rl_bound, r_tmp);
+    skips[num_skips++] = OpCmpImmBranch(kCondEq, r_tmp, 0, NULL);
+    LoadWordDisp(r_tmp, len_offset, r_limit);
+  } else {
+    LoadValueDirect(rl_bound, r_limit);
+  }
+  RegLocation arrays[3];
+  int num_arrays = 0;
+  if (!is_sum) {
+    arrays[num_arrays++] = rl_dest;
+  }
+  if ((flags & kPackedLoopArray1) != 0) {
+    arrays[num_arrays++] = rl_src1;
+  }
+  if ((flags & kPackedLoopArray2) != 0) {
+    arrays[num_arrays++] = rl_src2;
+  }
+  for (int i = 0; i < num_arrays; i++) {
+    LoadValueDirect(arrays[i], r_tmp);
+    skips[num_skips++] = OpCmpImmBranch(kCondEq, r_tmp, 0, NULL);
+    LoadWordDisp(r_tmp, len_offset, r_tmp);
+    LIR* long_enough = OpCmpBranch(kCondGe, r_tmp, r_limit, NULL);
+    OpRegCopy(r_limit, r_tmp);
+    long_enough->target = NewLIR0(kPseudoTargetLabel);
+  }
+  skips[num_skips++] = OpCmpBranch(kCondLe, r_limit, r_index, NULL);
+  // Four more elements are processed while index < limit - 3, with limit now positive.
+  OpRegImm(kOpSub, r_limit, 3);
+
+  int v_src1 = AllocPackedTemp();
+  int v_src2 = INVALID_REG;
+  if ((flags & kPackedLoopArray1) == 0) {
+    LoadValueDirect(rl_src1, r_tmp);
+    OpPackedBroadcast(v_src1, r_tmp);
+  }
+  if (op != kOpMov) {
+    v_src2 = AllocPackedTemp();
+    if ((flags & kPackedLoopLiteral2) != 0) {
+      LoadConstant(r_tmp, static_cast<int32_t>(mir->dalvikInsn.vC));
+      OpPackedBroadcast(v_src2, r_tmp);
+    } else if ((flags & kPackedLoopArray2) == 0) {
+      LoadValueDirect(rl_src2, r_tmp);
+      OpPackedBroadcast(v_src2, r_tmp);
+    }
+  }
+
+  LIR* loop_top = NewLIR0(kPseudoTargetLabel);
+  LIR* loop_exit = OpCmpBranch(kCondGe, r_index, r_limit, NULL);
+  if ((flags & kPackedLoopArray1) != 0) {
+    LoadValueDirect(rl_src1, r_tmp);
+    OpPackedLoad(v_src1, r_tmp, r_index, data_offset);
+  }
+  if ((flags & kPackedLoopArray2) != 0) {
+    LoadValueDirect(rl_src2, r_tmp);
+    OpPackedLoad(v_src2, r_tmp, r_index, data_offset);
+  }
+  if (op != kOpMov) {
+    OpPackedRegReg(op, v_src1, v_src2);
+  }
+  if (is_sum) {
+    OpPackedRegReg(sum_op, v_sum, v_src1);
+  } else {
+    LoadValueDirect(rl_dest, r_tmp);
+    OpPackedStore(r_tmp, r_index, data_offset, v_src1);
+  }
+  OpRegImm(kOpAdd, r_index, 4);
+  OpUnconditionalBranch(loop_top);
+  LIR* done = NewLIR0(kPseudoTargetLabel);
+  loop_exit->target = done;
+  for (int i = 0; i < num_skips; i++) {
+    skips[i]->target = done;
+  }
+  FreeTemp(r_limit);
+  FreePackedTemp(v_src1);
+  if (v_src2 != INVALID_REG) {
+    FreePackedTemp(v_src2);
+  }
+
+  RegLocation rl_index = mir_graph_->GetDest(mir);
+  RegLocation rl_result = EvalLoc(rl_index, kCoreReg, true);
+  OpRegCopy(rl_result.low_reg, r_index);
+  StoreValue(rl_index, rl_result);
+  FreeTemp(r_index);
+  if (is_sum) {
+    LoadValueDirect(rl_dest, r_tmp);
+    OpPackedReduce(sum_op, r_tmp, v_sum);
+    FreePackedTemp(v_sum);
+    RegLocation rl_sum = mir_graph_->reg_location_[mir->ssa_rep->defs[1]];
+    rl_result = EvalLoc(rl_sum, kCoreReg, true);
+    OpRegCopy(rl_result.low_reg, r_tmp);
+    StoreValue(rl_sum, rl_result);
+  }
+  FreeTemp(r_tmp);
+}
+
 /* Call out to helper assembly routine that will null check obj and then lock it. */
 void Mir2Lir::GenMonitorEnter(int opt_flags, RegLocation rl_src) {
   FlushAllRegs();
@@ -22,6 +22,7 @@
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "invoke_type.h"
 #include "mirror/array.h"
+#include "mirror/class.h"
 #include "mirror/string.h"
 #include "mir_to_lir-inl.h"
 #include "x86/codegen_x86.h"
@@ -572,6 +573,43 @@ static int NextInterfaceCallInsn(CompilationUnit* cu, CallInfo* info, int state,
   return state + 1;
 }
 
+/*
+ * Interface call that checks for the single implementation found by class
+ * hierarchy analysis (see GenSingleImplementationCall).  Loads "this" into
+ * kArg1, this->klass_ into kInvokeTgt and the caller's resolved types into
+ * kArg0.  Not used on x86, where kInvokeTgt and kArg0 are the same register.
+ */
+static int NextSingleImplementationCallInsn(CompilationUnit* cu, CallInfo* info, int state,
+                                            const MethodReference& target_method,
+                                            uint32_t unused, uintptr_t unused2,
+                                            uintptr_t unused3, InvokeType unused4) {
+  Mir2Lir* cg = static_cast<Mir2Lir*>(cu->cg.get());
+  switch (state) {
+    case 0: {  // Get "this" [set kArg1]
+      RegLocation  rl_arg = info->args[0];
+      cg->LoadValueDirectFixed(rl_arg, cg->TargetReg(kArg1));
+      break;
+    }
+    case 1:  // Is "this" null? [use kArg1]
+      cg->GenNullCheck(info->args[0].s_reg_low, cg->TargetReg(kArg1), info->opt_flags);
+      // Get this->klass_ [use kArg1, set kInvokeTgt]
+      cg->LoadWordDisp(cg->TargetReg(kArg1), mirror::Object::ClassOffset().Int32Value(),
+                       cg->TargetReg(kInvokeTgt));
+      break;
+    case 2:  // Get the current Method* [set kArg0]
+      cg->LoadCurrMethodDirect(cg->TargetReg(kArg0));
+      break;
+    case 3:  // Get method->dex_cache_resolved_types_ [use kArg0, set kArg0]
+      cg->LoadWordDisp(cg->TargetReg(kArg0),
+                       mirror::ArtMethod::DexCacheResolvedTypesOffset().Int32Value(),
+                       cg->TargetReg(kArg0));
+      break;
+    default:
+      return -1;
+  }
+  return state + 1;
+}
+
 static int NextInvokeInsnSP(CompilationUnit* cu, CallInfo* info, ThreadOffset trampoline,
                             int state, const MethodReference& target_method,
                             uint32_t method_idx) {
@@ -1076,6 +1114,58 @@ bool Mir2Lir::GenInlinedAbsLong(CallInfo* info) {
   }
 }
 
+/*
+ * Count the bits set in r_src into r_dest, in parallel within the word. r_dest may be r_src, as
+ * r_src is only read before r_dest is first written. Clobbers r_tmp.
+ */
+void Mir2Lir::GenBitCount(int r_dest, int r_src, int r_tmp) {
+  DCHECK_NE(r_tmp, r_src);
+  DCHECK_NE(r_tmp, r_dest);
+  OpRegRegImm(kOpLsr, r_tmp, r_src, 1);
+  OpRegImm(kOpAnd, r_tmp, 0x55555555);
+  OpRegRegReg(kOpSub, r_dest, r_src, r_tmp);
+  OpRegRegImm(kOpLsr, r_tmp, r_dest, 2);
+  OpRegImm(kOpAnd, r_tmp, 0x33333333);
+  OpRegImm(kOpAnd, r_dest, 0x33333333);
+  OpRegReg(kOpAdd, r_dest, r_tmp);
+  OpRegRegImm(kOpLsr, r_tmp, r_dest, 4);
+  OpRegReg(kOpAdd, r_dest, r_tmp);
+  OpRegImm(kOpAnd, r_dest, 0x0f0f0f0f);
+  OpRegRegImm(kOpLsr, r_tmp, r_dest, 8);
+  OpRegReg(kOpAdd, r_dest, r_tmp);
+  OpRegRegImm(kOpLsr, r_tmp, r_dest, 16);
+  OpRegReg(kOpAdd, r_dest, r_tmp);
+  OpRegImm(kOpAnd, r_dest, 0x3f);
+}
+
+bool Mir2Lir::GenInlinedBitCount(CallInfo* info, OpSize size) {
+  if (cu_->instruction_set == kMips) {
+    // TODO - add Mips implementation
+    return false;
+  }
+  RegLocation rl_dest = InlineTarget(info);
+  if (size == kLong) {
+    RegLocation rl_src = LoadValueWide(info->args[0], kCoreReg);
+    int r_tmp = AllocTemp();
+    int r_high_count = AllocTemp();
+    GenBitCount(r_high_count, rl_src.high_reg, r_tmp);
+    // Done with the high word, x86 needs the register for the result.
+    FreeTemp(rl_src.high_reg);
+    RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+    GenBitCount(rl_result.low_reg, rl_src.low_reg, r_tmp);
+    OpRegReg(kOpAdd, rl_result.low_reg, r_high_count);
+    StoreValue(rl_dest, rl_result);
+  } else {
+    DCHECK_EQ(size, kWord);
+    RegLocation rl_src = LoadValue(info->args[0], kCoreReg);
+    int r_tmp = AllocTemp();
+    RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+    GenBitCount(rl_result.low_reg, rl_src.low_reg, r_tmp);
+    StoreValue(rl_dest, rl_result);
+  }
+  return true;
+}
+
 bool Mir2Lir::GenInlinedFloatCvt(CallInfo* info) {
   if (cu_->instruction_set == kMips) {
     // TODO - add Mips implementation
@@ -1181,6 +1271,92 @@ bool Mir2Lir::GenInlinedStringCompareTo(CallInfo* info) {
   return true;
 }
 
+/*
+ * Fast String.equals(Ljava/lang/Object;)Z. The identical, null and non-String cases and
+ * strings of different lengths are answered without looking at the characters, which are
+ * otherwise compared one at a time.
+ */
+bool Mir2Lir::GenInlinedStringEquals(CallInfo* info) {
+  if (cu_->instruction_set != kThumb2) {
+    // TODO - x86 runs out of temps, add Mips implementation
+    return false;
+  }
+  int value_offset = mirror::String::ValueOffset().Int32Value();
+  int count_offset = mirror::String::CountOffset().Int32Value();
+  int offset_offset = mirror::String::OffsetOffset().Int32Value();
+  int data_offset = mirror::Array::DataOffset(sizeof(uint16_t)).Int32Value();
+  int class_offset = mirror::Object::ClassOffset().Int32Value();
+
+  // Temps allocated after the first branch must not need flushing on one path only.
+  FlushAllRegs();
+  RegLocation rl_this = LoadValue(info->args[0], kCoreReg);
+  RegLocation rl_cmp = LoadValue(info->args[1], kCoreReg);
+  GenNullCheck(rl_this.s_reg_low, rl_this.low_reg, info->opt_flags);
+  // Holds the number of characters left to compare, then the result.
+  int reg_count = AllocTemp();
+  int reg_tmp = AllocTemp();
+  LIR* same_object = OpCmpBranch(kCondEq, rl_this.low_reg, rl_cmp.low_reg, NULL);
+  LIR* null_cmp = OpCmpImmBranch(kCondEq, rl_cmp.low_reg, 0, NULL);
+  // String is final, any other class means cmp isn't a String.
+  LoadWordDisp(rl_this.low_reg, class_offset, reg_count);
+  LoadWordDisp(rl_cmp.low_reg, class_offset, reg_tmp);
+  LIR* other_class = OpCmpBranch(kCondNe, reg_count, reg_tmp, NULL);
+  LoadWordDisp(rl_this.low_reg, count_offset, reg_count);
+  LoadWordDisp(rl_cmp.low_reg, count_offset, reg_tmp);
+  LIR* other_length = OpCmpBranch(kCondNe, reg_count, reg_tmp, NULL);
+
+  // Point at the first character of each string, freeing the strings as soon as possible.
+  int reg_this_ptr = AllocTemp();
+  LoadWordDisp(rl_this.low_reg, value_offset, reg_this_ptr);
+  LoadWordDisp(rl_this.low_reg, offset_offset, reg_tmp);
+  FreeTemp(rl_this.low_reg);
+  OpRegImm(kOpLsl, reg_tmp, 1);
+  OpRegReg(kOpAdd, reg_this_ptr, reg_tmp);
+  int reg_cmp_ptr = AllocTemp();
+  LoadWordDisp(rl_cmp.low_reg, value_offset, reg_cmp_ptr);
+  LoadWordDisp(rl_cmp.low_reg, offset_offset, reg_tmp);
+  FreeTemp(rl_cmp.low_reg);
+  OpRegImm(kOpLsl, reg_tmp, 1);
+  OpRegReg(kOpAdd, reg_cmp_ptr, reg_tmp);
+
+  int reg_char = AllocTemp();
+  LIR* loop = NewLIR0(kPseudoTargetLabel);
+  LIR* all_equal = OpCmpImmBranch(kCondEq, reg_count, 0, NULL);
+  LoadBaseDisp(reg_this_ptr, data_offset, reg_tmp, kUnsignedHalf, INVALID_SREG);
+  LoadBaseDisp(reg_cmp_ptr, data_offset, reg_char, kUnsignedHalf, INVALID_SREG);
+  LIR* other_char = OpCmpBranch(kCondNe, reg_tmp, reg_char, NULL);
+  OpRegImm(kOpAdd, reg_this_ptr, sizeof(uint16_t));
+  OpRegImm(kOpAdd, reg_cmp_ptr, sizeof(uint16_t));
+  OpRegImm(kOpSub, reg_count, 1);
+  OpUnconditionalBranch(loop);
+  FreeTemp(reg_this_ptr);
+  FreeTemp(reg_cmp_ptr);
+  FreeTemp(reg_char);
+  FreeTemp(reg_tmp);
+
+  LIR* not_equal = NewLIR0(kPseudoTargetLabel);
+  null_cmp->target = not_equal;
+  other_class->target = not_equal;
+  other_length->target = not_equal;
+  other_char->target = not_equal;
+  LoadConstant(reg_count, 0);
+  LIR* done = OpUnconditionalBranch(NULL);
+  LIR* equal = NewLIR0(kPseudoTargetLabel);
+  same_object->target = equal;
+  all_equal->target = equal;
+  LoadConstant(reg_count, 1);
+  done->target = NewLIR0(kPseudoTargetLabel);
+
+  // Record that we've already null checked
+  info->opt_flags |= MIR_IGNORE_NULL_CHECK;
+  RegLocation rl_dest = InlineTarget(info);
+  RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
+  OpRegCopy(rl_result.low_reg, reg_count);
+  FreeTemp(reg_count);
+  StoreValue(rl_dest, rl_result);
+  return true;
+}
+
 bool Mir2Lir::GenInlinedCurrentThread(CallInfo* info) {
   RegLocation rl_dest = InlineTarget(info);
   RegLocation rl_result = EvalLoc(rl_dest, kCoreReg, true);
@@ -1195,6 +1371,124 @@ bool Mir2Lir::GenInlinedCurrentThread(CallInfo* info) {
   return true;
 }
 
+/*
+ * Fast System.arraycopy(Ljava/lang/Object;ILjava/lang/Object;II)V for the short char array
+ * copies of StringBuilder and friends. Null, identical or other arrays, anything out of bounds
+ * and copies long enough for the library's memmove to be faster are left to the library, which
+ * copies them or throws.
+ */
+bool Mir2Lir::GenInlinedSystemArrayCopy(CallInfo* info) {
+  if (cu_->instruction_set != kThumb2) {
+    // TODO - x86 runs out of temps, add Mips implementation
+    return false;
+  }
+  int class_offset = mirror::Object::ClassOffset().Int32Value();
+  int component_offset = mirror::Class::ComponentTypeOffset().Int32Value();
+  int primitive_offset = mirror::Class::PrimitiveTypeOffset().Int32Value();
+  int len_offset = mirror::Array::LengthOffset().Int32Value();
+  int data_offset = mirror::Array::DataOffset(sizeof(uint16_t)).Int32Value();
+  // The loop below copies a char per iteration.
+  const int kMaxInlinedCopyLength = 32;
+
+  // The launch pad reloads the arguments from their Dalvik registers. The arguments are loaded
+  // into temps of our own as they are needed, there aren't enough temps to hold all five.
+  FlushAllRegs();
+  int reg_src = AllocTemp();
+  int reg_dst = AllocTemp();
+  int reg_tmp = AllocTemp();
+  int reg_count = AllocTemp();
+  LIR* launch_pad = RawLIR(0, kPseudoIntrinsicRetry, WrapPointer(info));
+  intrinsic_launchpads_.Insert(launch_pad);
+  // The launch pad calls the library instead of expanding this again.
+  info->opt_flags |= MIR_INLINED;
+  LoadValueDirect(info->args[0], reg_src);
+  LoadValueDirect(info->args[2], reg_dst);
+  OpCmpImmBranch(kCondEq, reg_src, 0, launch_pad);
+  OpCmpImmBranch(kCondEq, reg_dst, 0, launch_pad);
+  // A forward copy within one array could overwrite characters before reading them.
+  OpCmpBranch(kCondEq, reg_src, reg_dst, launch_pad);
+  // Both must be char[]; a class without a component type isn't an array.
+  LoadWordDisp(reg_src, class_offset, reg_tmp);
+  LoadWordDisp(reg_dst, class_offset, reg_count);
+  OpCmpBranch(kCondNe, reg_tmp, reg_count, launch_pad);
+  LoadWordDisp(reg_tmp, component_offset, reg_tmp);
+  OpCmpImmBranch(kCondEq, reg_tmp, 0, launch_pad);
+  LoadWordDisp(reg_tmp, primitive_offset, reg_tmp);
+  OpCmpImmBranch(kCondNe, reg_tmp, Primitive::kPrimChar, launch_pad);
+
+  // Check 0 <= pos && pos <= array.length - count for each array, then point at array[pos].
+  LoadValueDirect(info->args[4], reg_count);
+  OpCmpImmBranch(kCondLt, reg_count, 0, launch_pad);
+  OpCmpImmBranch(kCondGt, reg_count, kMaxInlinedCopyLength, launch_pad);
+  int reg_limit = AllocTemp();
+  LoadValueDirect(info->args[1], reg_tmp);
+  OpCmpImmBranch(kCondLt, reg_tmp, 0, launch_pad);
+  LoadWordDisp(reg_src, len_offset, reg_limit);
+  OpRegReg(kOpSub, reg_limit, reg_count);
+  OpCmpBranch(kCondLt, reg_limit, reg_tmp, launch_pad);
+  OpRegImm(kOpLsl, reg_tmp, 1);
+  OpRegReg(kOpAdd, reg_src, reg_tmp);
+  LoadValueDirect(info->args[3], reg_tmp);
+  OpCmpImmBranch(kCondLt, reg_tmp, 0, launch_pad);
+  LoadWordDisp(reg_dst, len_offset, reg_limit);
+  OpRegReg(kOpSub, reg_limit, reg_count);
+  OpCmpBranch(kCondLt, reg_limit, reg_tmp, launch_pad);
+  OpRegImm(kOpLsl, reg_tmp, 1);
+  OpRegReg(kOpAdd, reg_dst, reg_tmp);
+  FreeTemp(reg_limit);
+
+  LIR* loop = NewLIR0(kPseudoTargetLabel);
+  LIR* done = OpCmpImmBranch(kCondEq, reg_count, 0, NULL);
+  LoadBaseDisp(reg_src, data_offset, reg_tmp, kUnsignedHalf, INVALID_SREG);
+  StoreBaseDisp(reg_dst, data_offset, reg_tmp, kUnsignedHalf);
+  OpRegImm(kOpAdd, reg_src, sizeof(uint16_t));
+  OpRegImm(kOpAdd, reg_dst, sizeof(uint16_t));
+  OpRegImm(kOpSub, reg_count, 1);
+  OpUnconditionalBranch(loop);
+  LIR* resume_tgt = NewLIR0(kPseudoTargetLabel);
+  done->target = resume_tgt;
+  launch_pad->operands[2] = WrapPointer(resume_tgt);
+  FreeTemp(reg_src);
+  FreeTemp(reg_dst);
+  FreeTemp(reg_tmp);
+  FreeTemp(reg_count);
+  return true;
+}
+
+/* Fast Arrays.fill() of a whole byte, char or int array. */
+bool Mir2Lir::GenInlinedArrayFill(CallInfo* info, OpSize size) {
+  if (cu_->instruction_set != kThumb2) {
+    // TODO - x86 needs byte registers for byte arrays, add Mips implementation
+    return false;
+  }
+  int element_size = (size == kWord) ? sizeof(int32_t) :
+      ((size == kUnsignedHalf) ? sizeof(uint16_t) : sizeof(uint8_t));
+  int len_offset = mirror::Array::LengthOffset().Int32Value();
+  int data_offset = mirror::Array::DataOffset(element_size).Int32Value();
+
+  RegLocation rl_array = LoadValue(info->args[0], kCoreReg);
+  RegLocation rl_value = LoadValue(info->args[1], kCoreReg);
+  GenNullCheck(rl_array.s_reg_low, rl_array.low_reg, info->opt_flags);
+  int reg_count = AllocTemp();
+  int reg_ptr = AllocTemp();
+  LoadWordDisp(rl_array.low_reg, len_offset, reg_count);
+  OpRegRegImm(kOpAdd, reg_ptr, rl_array.low_reg, data_offset);
+  FreeTemp(rl_array.low_reg);
+  LIR* loop = NewLIR0(kPseudoTargetLabel);
+  LIR* done = OpCmpImmBranch(kCondEq, reg_count, 0, NULL);
+  StoreBaseDisp(reg_ptr, 0, rl_value.low_reg, size);
+  OpRegImm(kOpAdd, reg_ptr, element_size);
+  OpRegImm(kOpSub, reg_count, 1);
+  OpUnconditionalBranch(loop);
+  done->target = NewLIR0(kPseudoTargetLabel);
+  FreeTemp(reg_count);
+  FreeTemp(reg_ptr);
+  FreeTemp(rl_value.low_reg);
+  // Record that we've already null checked
+  info->opt_flags |= MIR_IGNORE_NULL_CHECK;
+  return true;
+}
+
 bool Mir2Lir::GenInlinedUnsafeGet(CallInfo* info,
                                   bool is_long, bool is_volatile) {
   if (cu_->instruction_set == kMips) {
@@ -1261,6 +1555,45 @@ bool Mir2Lir::GenInlinedUnsafePut(CallInfo* info, bool is_long,
   return true;
 }
 
+/*
+ * Finish an interface call set up by NextSingleImplementationCallInsn.  If the
+ * receiver's class is the one class hierarchy analysis found implementing the
+ * method, call the implementation through the vtable.  Otherwise load the IMT
+ * entry as NextInterfaceCallInsn would, for the caller to call kInvokeTgt.
+ * Returns the branch to patch to the end of the call sequence.
+ */
+LIR* Mir2Lir::GenSingleImplementationCall(const MethodReference& target_method,
+                                          uint32_t method_idx, uint16_t impl_type_idx,
+                                          int impl_vtable_idx) {
+  int32_t data_offset = mirror::Array::DataOffset(sizeof(mirror::Object*)).Int32Value();
+  // The resolved type is NULL until the class has been resolved, failing the check.
+  LoadWordDisp(TargetReg(kArg0), data_offset + sizeof(int32_t*) * impl_type_idx,
+               TargetReg(kHiddenArg));
+  LIR* not_impl = OpCmpBranch(kCondNe, TargetReg(kInvokeTgt), TargetReg(kHiddenArg), NULL);
+  LoadWordDisp(TargetReg(kInvokeTgt), mirror::Class::VTableOffset().Int32Value(),
+               TargetReg(kInvokeTgt));
+  LoadWordDisp(TargetReg(kInvokeTgt), data_offset + sizeof(int32_t*) * impl_vtable_idx,
+               TargetReg(kArg0));
+  LoadWordDisp(TargetReg(kArg0),
+               mirror::ArtMethod::GetEntryPointFromCompiledCodeOffset().Int32Value(),
+               TargetReg(kInvokeTgt));
+  LIR* call_inst = OpReg(kOpBlx, TargetReg(kInvokeTgt));
+  MarkSafepointPC(call_inst);
+  LIR* done = OpUnconditionalBranch(NULL);
+
+  // Any other receiver goes through the IMT.
+  not_impl->target = NewLIR0(kPseudoTargetLabel);
+  LoadConstant(TargetReg(kHiddenArg), target_method.dex_method_index);
+  LoadWordDisp(TargetReg(kInvokeTgt), mirror::Class::ImTableOffset().Int32Value(),
+               TargetReg(kInvokeTgt));
+  LoadWordDisp(TargetReg(kInvokeTgt), ((method_idx % ClassLinker::kImtSize) * 4) + data_offset,
+               TargetReg(kArg0));
+  LoadWordDisp(TargetReg(kArg0),
+               mirror::ArtMethod::GetEntryPointFromCompiledCodeOffset().Int32Value(),
+               TargetReg(kInvokeTgt));
+  return done;
+}
+
 void Mir2Lir::GenInvoke(CallInfo* info) {
   if (!(info->opt_flags & MIR_INLINED)) {
     DCHECK(cu_->compiler_driver->GetMethodInlinerMap() != nullptr);
@@ -1291,7 +1624,17 @@ void Mir2Lir::GenInvoke(CallInfo* info) {
                                               &info->type, &target_method,
                                               &vtable_idx,
                                               &direct_code, &direct_method) && !SLOW_INVOKE_PATH;
-  if (info->type == kInterface) {
+  uint16_t impl_type_idx = 0;
+  int impl_vtable_idx = -1;
+  bool single_impl = fast_path && (info->type == kInterface) &&
+      (cu_->instruction_set != kX86) &&
+      !(cu_->disable_opt & (1 << kGuardedDevirtualization)) &&
+      cu_->compiler_driver->ComputeSingleImplementation(cUnit, target_method, &impl_type_idx,
+                                                        &impl_vtable_idx);
+  if (single_impl) {
+    next_call_insn = NextSingleImplementationCallInsn;
+    skip_this = true;
+  } else if (info->type == kInterface) {
     next_call_insn = fast_path ? NextInterfaceCallInsn : NextInterfaceCallInsnWithAccessCheck;
     skip_this = fast_path;
   } else if (info->type == kDirect) {
@@ -1329,6 +1672,11 @@ void Mir2Lir::GenInvoke(CallInfo* info) {
                                 vtable_idx, direct_code, direct_method,
                                 original_type);
   }
+  LIR* single_impl_done = NULL;
+  if (single_impl) {
+    single_impl_done = GenSingleImplementationCall(target_method, vtable_idx, impl_type_idx,
+                                                   impl_vtable_idx);
+  }
   LIR* call_inst;
   if (cu_->instruction_set != kX86) {
     call_inst = OpReg(kOpBlx, TargetReg(kInvokeTgt));
@@ -1361,6 +1709,9 @@ void Mir2Lir::GenInvoke(CallInfo* info) {
     }
   }
   MarkSafepointPC(call_inst);
+  if (single_impl_done != NULL) {
+    single_impl_done->target = NewLIR0(kPseudoTargetLabel);
+  }
 
   ClobberCallerSave();
   if (info->result.location != kLocInvalid) {
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include "dex/compiler_internals.h"
 
 namespace art {
@@ -28,6 +30,8 @@ namespace art {
 #define MAX_HOIST_DISTANCE 20
 #define LDLD_DISTANCE 4
 #define LD_LATENCY 2
+/* Limits the cost of the dependency graph, and lets a region's edges fit a uint64_t */
+#define MAX_SCHED_REGION 64
 
 static bool IsDalvikRegisterClobbered(LIR* lir1, LIR* lir2) {
   int reg1Lo = DECODE_ALIAS_INFO_REG(lir1->flags.alias_info);
@@ -458,6 +462,194 @@ void Mir2Lir::ApplyLoadHoisting(LIR* head_lir, LIR* tail_lir) {
   }
 }
 
+/*
+ * Whether lir2, which follows lir1, must stay after it: one of them writes a register,
+ * the condition codes or memory the other reads or writes.
+ */
+bool Mir2Lir::IsSchedulingDependent(LIR* lir1, LIR* lir2) {
+  uint64_t use_reg_mask = lir1->u.m.use_mask & ~ENCODE_MEM;
+  uint64_t def_reg_mask = lir1->u.m.def_mask & ~ENCODE_MEM;
+  if (CHECK_REG_DEP(use_reg_mask, def_reg_mask, lir2)) {
+    return true;
+  }
+  uint64_t alias_condition = (lir1->u.m.use_mask | lir1->u.m.def_mask) &
+      (lir2->u.m.use_mask | lir2->u.m.def_mask) & ENCODE_MEM;
+  if (alias_condition == 0) {
+    return false;
+  }
+  /*
+   * Instructions that both read and write memory only carry the memory type in
+   * their use mask, so look at the flags to find the stores.
+   */
+  if (!((GetTargetInstFlags(lir1->opcode) | GetTargetInstFlags(lir2->opcode)) & IS_STORE)) {
+    return false;
+  }
+  /* We can fully disambiguate Dalvik references */
+  if (alias_condition == ENCODE_DALVIK_REG) {
+    return IsDalvikRegisterClobbered(lir1, lir2);
+  }
+  /* Conservatively treat all heap refs as may-alias */
+  return true;
+}
+
+/*
+ * List schedule the instructions between prev_lir and end_lir, both excluded, which
+ * hold no scheduling barrier. The instructions are issued in order of their distance
+ * to the end of the region along the dependency graph, and an instruction is only
+ * picked once the results it depends on are expected to be available, so that
+ * independent work fills the load and multiply latencies of the target.
+ */
+void Mir2Lir::ScheduleRegion(LIR* prev_lir, LIR* end_lir) {
+  LIR* insns[MAX_SCHED_REGION];
+  int num_insns = 0;
+  for (LIR* this_lir = NEXT_LIR(prev_lir); this_lir != end_lir; this_lir = NEXT_LIR(this_lir)) {
+    if (!this_lir->flags.is_nop && !IsPseudoLirOp(this_lir->opcode)) {
+      DCHECK_LT(num_insns, MAX_SCHED_REGION);
+      insns[num_insns++] = this_lir;
+    }
+  }
+  if (num_insns < 2) {
+    return;
+  }
+
+  /* Successors of each instruction, and how many of its predecessors are unscheduled */
+  uint64_t succs[MAX_SCHED_REGION];
+  int num_preds[MAX_SCHED_REGION];
+  int latency[MAX_SCHED_REGION];
+  for (int i = 0; i < num_insns; i++) {
+    succs[i] = 0;
+    num_preds[i] = 0;
+    latency[i] = GetInstructionLatency(insns[i]);
+    for (int j = 0; j < i; j++) {
+      if (IsSchedulingDependent(insns[j], insns[i])) {
+        succs[j] |= (1ULL << i);
+        num_preds[i]++;
+      }
+    }
+  }
+
+  /* Longest latency path from each instruction to the end of the region */
+  int height[MAX_SCHED_REGION];
+  for (int i = num_insns - 1; i >= 0; i--) {
+    int max_succ_height = 0;
+    for (int j = i + 1; j < num_insns; j++) {
+      if ((succs[i] & (1ULL << j)) && (height[j] > max_succ_height)) {
+        max_succ_height = height[j];
+      }
+    }
+    height[i] = latency[i] + max_succ_height;
+  }
+
+  const int issue_width = GetSchedulingModel().issue_width;
+  int ready_cycle[MAX_SCHED_REGION];
+  uint64_t ready = 0;
+  for (int i = 0; i < num_insns; i++) {
+    ready_cycle[i] = 0;
+    if (num_preds[i] == 0) {
+      ready |= (1ULL << i);
+    }
+  }
+  int order[MAX_SCHED_REGION];
+  int num_scheduled = 0;
+  bool reordered = false;
+  int cycle = 0;
+  int issued = 0;
+  while (num_scheduled < num_insns) {
+    /* Pick the ready instruction on the longest path, earliest in program order on a tie */
+    int best = -1;
+    int next_cycle = -1;
+    for (int i = 0; i < num_insns; i++) {
+      if (!(ready & (1ULL << i))) {
+        continue;
+      }
+      if (ready_cycle[i] <= cycle) {
+        if ((best < 0) || (height[i] > height[best])) {
+          best = i;
+        }
+      } else if ((next_cycle < 0) || (ready_cycle[i] < next_cycle)) {
+        next_cycle = ready_cycle[i];
+      }
+    }
+    if (best < 0) {
+      /* Everything left waits on a result - stall until the first one is available */
+      DCHECK_GT(next_cycle, cycle);
+      cycle = next_cycle;
+      issued = 0;
+      continue;
+    }
+    reordered |= (best != num_scheduled);
+    order[num_scheduled++] = best;
+    ready &= ~(1ULL << best);
+    for (int j = best + 1; j < num_insns; j++) {
+      if (succs[best] & (1ULL << j)) {
+        ready_cycle[j] = std::max(ready_cycle[j], cycle + latency[best]);
+        if (--num_preds[j] == 0) {
+          ready |= (1ULL << j);
+        }
+      }
+    }
+    if (++issued == issue_width) {
+      cycle++;
+      issued = 0;
+    }
+  }
+
+  if (reordered) {
+    for (int i = 0; i < num_insns; i++) {
+      LIR* this_lir = insns[order[i]];
+      UnlinkLIR(this_lir);
+      InsertLIRBefore(end_lir, this_lir);
+    }
+  }
+}
+
+/*
+ * Perform a pass of top-down walk over the superblock, splitting it into regions
+ * at the scheduling barriers and list scheduling each of them.
+ */
+void Mir2Lir::ApplyListScheduling(LIR* head_lir, LIR* tail_lir) {
+  /* Empty block */
+  if (head_lir == tail_lir) {
+    return;
+  }
+
+  LIR* prev_lir = head_lir;
+  int num_insns = 0;
+  bool in_it_block = false;
+  for (LIR* this_lir = NEXT_LIR(head_lir); this_lir != tail_lir; this_lir = NEXT_LIR(this_lir)) {
+    /* Dead instructions and line markers stay where they are */
+    if (this_lir->flags.is_nop || (this_lir->opcode == kPseudoDalvikByteCodeBoundary)) {
+      continue;
+    }
+    /* Labels, branches, calls and barriers end a region */
+    bool is_barrier = IsPseudoLirOp(this_lir->opcode) ||
+        (this_lir->u.m.use_mask == ENCODE_ALL) || (this_lir->u.m.def_mask == ENCODE_ALL);
+    if (!is_barrier && (num_insns < MAX_SCHED_REGION)) {
+      num_insns++;
+      continue;
+    }
+    if (!in_it_block) {
+      ScheduleRegion(prev_lir, this_lir);
+    }
+    if (is_barrier) {
+      prev_lir = this_lir;
+      num_insns = 0;
+      /*
+       * The instructions predicated by an IT must stay right behind it, leave the
+       * region it starts alone.
+       */
+      in_it_block = !IsPseudoLirOp(this_lir->opcode) &&
+          (GetTargetInstFlags(this_lir->opcode) & IS_IT);
+    } else {
+      prev_lir = PREV_LIR(this_lir);
+      num_insns = 1;
+    }
+  }
+  if (!in_it_block) {
+    ScheduleRegion(prev_lir, tail_lir);
+  }
+}
+
 void Mir2Lir::ApplyLocalOptimizations(LIR* head_lir, LIR* tail_lir) {
   if (!(cu_->disable_opt & (1 << kLoadStoreElimination))) {
     ApplyLoadStoreElimination(head_lir, tail_lir);
@@ -465,6 +657,9 @@ void Mir2Lir::ApplyLocalOptimizations(LIR* head_lir, LIR* tail_lir) {
   if (!(cu_->disable_opt & (1 << kLoadHoisting))) {
     ApplyLoadHoisting(head_lir, tail_lir);
   }
+  if (!(cu_->disable_opt & (1 << kListScheduling))) {
+    ApplyListScheduling(head_lir, tail_lir);
+  }
 }
 
 }  // namespace art
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "dex/mir_graph_test.h"
+#include "dex/quick/arm/arm_lir.h"
+#include "dex/quick/mir_to_lir-inl.h"
+
+namespace art {
+
+static const InstructionSet kScheduledInstructionSets[] = { kThumb2, kX86 };
+
+class LocalOptimizationsTest : public MirGraphTest {
+ protected:
+  LocalOptimizationsTest() : head_lir_(NULL) {
+  }
+
+  // A code generator for instruction_set with a label to start the LIR to schedule. No method is
+  // compiled, the tests lay down the LIR themselves.
+  Mir2Lir* CreateCodeGenerator(InstructionSet instruction_set) {
+    cu_->compiler_driver = compiler_driver_.get();
+    cu_->instruction_set = instruction_set;
+    Mir2Lir* cg = (instruction_set == kThumb2) ?
+        ArmCodeGenerator(cu_.get(), NULL, &cu_->arena) :
+        X86CodeGenerator(cu_.get(), NULL, &cu_->arena);
+    cu_->cg.reset(cg);
+    head_lir_ = cg->NewLIR0(kPseudoTargetLabel);
+    return cg;
+  }
+
+  // List schedules the LIR laid down since CreateCodeGenerator as a block of its own, and returns
+  // its instructions in their new order.
+  std::vector<LIR*> Schedule(Mir2Lir* cg) {
+    LIR* tail_lir = cg->NewLIR0(kPseudoTargetLabel);
+    cg->ApplyListScheduling(head_lir_, tail_lir);
+    std::vector<LIR*> insns;
+    for (LIR* lir = head_lir_->next; lir != tail_lir; lir = lir->next) {
+      if (!lir->flags.is_nop && !cg->IsPseudoLirOp(lir->opcode)) {
+        insns.push_back(lir);
+      }
+    }
+    return insns;
+  }
+
+  static size_t IndexOf(const std::vector<LIR*>& insns, LIR* lir) {
+    return std::find(insns.begin(), insns.end(), lir) - insns.begin();
+  }
+
+  // Lays down count increments of arg0, which depend on each other, then a load into arg2.
+  LIR* GenIncrementsThenLoad(Mir2Lir* cg, int count) {
+    for (int i = 0; i < count; i++) {
+      cg->OpRegImm(kOpAdd, cg->TargetReg(kArg0), 1);
+    }
+    return cg->LoadWordDisp(cg->TargetReg(kArg1), 8, cg->TargetReg(kArg2));
+  }
+
+  LIR* head_lir_;
+};
+
+TEST_F(LocalOptimizationsTest, ListSchedulingHoistsLoad) {
+  for (InstructionSet instruction_set : kScheduledInstructionSets) {
+    Mir2Lir* cg = CreateCodeGenerator(instruction_set);
+    LIR* load = GenIncrementsThenLoad(cg, 2);
+    cg->OpRegReg(kOpAdd, cg->TargetReg(kArg2), cg->TargetReg(kArg2));
+    std::vector<LIR*> insns(Schedule(cg));
+    ASSERT_EQ(4U, insns.size()) << instruction_set;
+    // The load starts the longest path, the increments fill its latency.
+    EXPECT_EQ(0U, IndexOf(insns, load)) << instruction_set;
+  }
+}
+
+#if ANDROID_SMP != 0
+TEST_F(LocalOptimizationsTest, ListSchedulingStopsAtBarrier) {
+  for (InstructionSet instruction_set : kScheduledInstructionSets) {
+    Mir2Lir* cg = CreateCodeGenerator(instruction_set);
+    LIR* increment = cg->OpRegImm(kOpAdd, cg->TargetReg(kArg0), 1);
+    cg->GenMemBarrier(kStoreLoad);
+    LIR* barrier = increment->next;
+    LIR* load = cg->LoadWordDisp(cg->TargetReg(kArg1), 8, cg->TargetReg(kArg2));
+    cg->OpRegReg(kOpAdd, cg->TargetReg(kArg2), cg->TargetReg(kArg2));
+    std::vector<LIR*> insns(Schedule(cg));
+    ASSERT_EQ(4U, insns.size()) << instruction_set;
+    // A dmb on ARM, an mfence on x86.
+    EXPECT_EQ(ENCODE_ALL, barrier->u.m.def_mask) << instruction_set;
+    EXPECT_EQ(0U, IndexOf(insns, increment)) << instruction_set;
+    EXPECT_EQ(1U, IndexOf(insns, barrier)) << instruction_set;
+    EXPECT_EQ(2U, IndexOf(insns, load)) << instruction_set;
+  }
+}
+#endif
+
+TEST_F(LocalOptimizationsTest, ListSchedulingAliasingDalvikRegisterStores) {
+  for (InstructionSet instruction_set : kScheduledInstructionSets) {
+    Mir2Lir* cg = CreateCodeGenerator(instruction_set);
+    int r_sp = cg->TargetReg(kSp);
+    LIR* load = cg->LoadWordDisp(cg->TargetReg(kArg1), 8, cg->TargetReg(kArg0));
+    LIR* first_store = cg->StoreWordDisp(r_sp, 8, cg->TargetReg(kArg0));
+    LIR* second_store = cg->StoreWordDisp(r_sp, 8, cg->TargetReg(kArg2));
+    std::vector<LIR*> insns(Schedule(cg));
+    ASSERT_EQ(3U, insns.size()) << instruction_set;
+    EXPECT_EQ(0U, IndexOf(insns, load)) << instruction_set;
+    EXPECT_EQ(1U, IndexOf(insns, first_store)) << instruction_set;
+    EXPECT_EQ(2U, IndexOf(insns, second_store)) << instruction_set;
+  }
+}
+
+TEST_F(LocalOptimizationsTest, ListSchedulingOtherDalvikRegisterStores) {
+  for (InstructionSet instruction_set : kScheduledInstructionSets) {
+    Mir2Lir* cg = CreateCodeGenerator(instruction_set);
+    int r_sp = cg->TargetReg(kSp);
+    LIR* load = cg->LoadWordDisp(cg->TargetReg(kArg1), 8, cg->TargetReg(kArg0));
+    LIR* first_store = cg->StoreWordDisp(r_sp, 8, cg->TargetReg(kArg0));
+    LIR* second_store = cg->StoreWordDisp(r_sp, 12, cg->TargetReg(kArg2));
+    std::vector<LIR*> insns(Schedule(cg));
+    ASSERT_EQ(3U, insns.size()) << instruction_set;
+    // The second store does not wait for the loaded value.
+    EXPECT_EQ(0U, IndexOf(insns, load)) << instruction_set;
+    EXPECT_EQ(1U, IndexOf(insns, second_store)) << instruction_set;
+    EXPECT_EQ(2U, IndexOf(insns, first_store)) << instruction_set;
+  }
+}
+
+TEST_F(LocalOptimizationsTest, ListSchedulingRegionCap) {
+  for (InstructionSet instruction_set : kScheduledInstructionSets) {
+    // 63 increments and the load make a full region, the load issues with the first increment.
+    Mir2Lir* cg = CreateCodeGenerator(instruction_set);
+    LIR* load = GenIncrementsThenLoad(cg, 63);
+    std::vector<LIR*> insns(Schedule(cg));
+    ASSERT_EQ(64U, insns.size()) << instruction_set;
+    EXPECT_EQ(1U, IndexOf(insns, load)) << instruction_set;
+
+    // One more increment pushes the load into a region of its own.
+    cg = CreateCodeGenerator(instruction_set);
+    load = GenIncrementsThenLoad(cg, 64);
+    insns = Schedule(cg);
+    ASSERT_EQ(65U, insns.size()) << instruction_set;
+    EXPECT_EQ(64U, IndexOf(insns, load)) << instruction_set;
+  }
+}
+
+TEST_F(LocalOptimizationsTest, ListSchedulingConditionCodes) {
+  Mir2Lir* cg = CreateCodeGenerator(kThumb2);
+  LIR* cmp = cg->NewLIR3(kThumb2CmpRR, r0, r1, 0);
+  LIR* add = cg->NewLIR3(kThumb2AddRRI12, r5, r5, 1);
+  LIR* sel = cg->NewLIR3(kThumb2Sel, r2, r6, r7);
+  LIR* load = cg->NewLIR3(kThumb2LdrRRI12, r3, r4, 8);
+  LIR* adds = cg->NewLIR4(kThumb2AddRRR, r3, r3, r3, 0);
+  EXPECT_TRUE(cg->IsSchedulingDependent(cmp, sel));
+  EXPECT_TRUE(cg->IsSchedulingDependent(sel, adds));
+  EXPECT_FALSE(cg->IsSchedulingDependent(cmp, add));
+  std::vector<LIR*> insns(Schedule(cg));
+  ASSERT_EQ(5U, insns.size());
+  EXPECT_EQ(0U, IndexOf(insns, load));
+  // Nothing setting the condition codes gets between the cmp and the sel.
+  EXPECT_LT(IndexOf(insns, cmp), IndexOf(insns, sel));
+  EXPECT_LT(IndexOf(insns, sel), IndexOf(insns, adds));
+}
+
+TEST_F(LocalOptimizationsTest, ListSchedulingFpStatus) {
+  Mir2Lir* cg = CreateCodeGenerator(kThumb2);
+  LIR* vcmp = cg->NewLIR2(kThumb2Vcmps, fr0, fr2);
+  LIR* load = cg->NewLIR3(kThumb2LdrRRI12, r3, r4, 8);
+  LIR* fmstat = cg->NewLIR0(kThumb2Fmstat);
+  LIR* sel = cg->NewLIR3(kThumb2Sel, r2, r6, r7);
+  cg->NewLIR3(kThumb2MulRRR, r3, r3, r3);
+  EXPECT_TRUE(cg->IsSchedulingDependent(vcmp, fmstat));
+  EXPECT_FALSE(cg->IsSchedulingDependent(vcmp, load));
+  std::vector<LIR*> insns(Schedule(cg));
+  ASSERT_EQ(5U, insns.size());
+  EXPECT_EQ(0U, IndexOf(insns, load));
+  EXPECT_LT(IndexOf(insns, vcmp), IndexOf(insns, fmstat));
+  EXPECT_LT(IndexOf(insns, fmstat), IndexOf(insns, sel));
+}
+
+TEST_F(LocalOptimizationsTest, ListSchedulingItBlock) {
+  Mir2Lir* cg = CreateCodeGenerator(kThumb2);
+  LIR* cmp = cg->NewLIR3(kThumb2CmpRR, r0, r1, 0);
+  LIR* it = cg->OpIT(kCondEq, "E");
+  LIR* then_mov = cg->NewLIR2(kThumb2MovImm16, r2, 1);
+  LIR* else_mov = cg->NewLIR2(kThumb2MovImm16, r3, 0);
+  LIR* load = cg->NewLIR3(kThumb2LdrRRI12, r5, r4, 8);
+  cg->NewLIR3(kThumb2MulRRR, r5, r5, r5);
+  std::vector<LIR*> insns(Schedule(cg));
+  ASSERT_EQ(6U, insns.size());
+  // The predicated instructions stay right behind the IT, the load is not hoisted above them.
+  EXPECT_EQ(0U, IndexOf(insns, cmp));
+  EXPECT_EQ(1U, IndexOf(insns, it));
+  EXPECT_EQ(2U, IndexOf(insns, then_mov));
+  EXPECT_EQ(3U, IndexOf(insns, else_mov));
+  EXPECT_EQ(4U, IndexOf(insns, load));
+}
+
+}  // namespace art
@@ -239,4 +239,9 @@ bool MipsMir2Lir::GenInlinedMinMaxInt(CallInfo* info, bool is_min) {
   return false;
 }
 
+bool MipsMir2Lir::GenInlinedMinMaxLong(CallInfo* info, bool is_min) {
+  // TODO: need Mips implementation
+  return false;
+}
+
 }  // namespace art
@@ -279,6 +279,11 @@ bool MipsMir2Lir::GenInlinedSqrt(CallInfo* info) {
   return false;
 }
 
+bool MipsMir2Lir::GenInlinedNumberOfZeros(CallInfo* info, OpSize size, bool is_trailing) {
+  // TODO: need Mips implementation
+  return false;
+}
+
 bool MipsMir2Lir::GenInlinedPeek(CallInfo* info, OpSize size) {
   if (size != kSignedByte) {
     // MIPS supports only aligned access. Defer unaligned access to JNI implementation.
@@ -325,6 +330,35 @@ LIR* MipsMir2Lir::OpVstm(int rBase, int count) {
   return NULL;
 }
 
+int MipsMir2Lir::AllocPackedTemp() {
+  LOG(FATAL) << "Unexpected use of AllocPackedTemp for Mips";
+  return -1;
+}
+
+void MipsMir2Lir::FreePackedTemp(int v_reg) {
+  LOG(FATAL) << "Unexpected use of FreePackedTemp for Mips";
+}
+
+void MipsMir2Lir::OpPackedLoad(int v_dest, int r_base, int r_index, int offset) {
+  LOG(FATAL) << "Unexpected use of OpPackedLoad for Mips";
+}
+
+void MipsMir2Lir::OpPackedStore(int r_base, int r_index, int offset, int v_src) {
+  LOG(FATAL) << "Unexpected use of OpPackedStore for Mips";
+}
+
+void MipsMir2Lir::OpPackedBroadcast(int v_dest, int r_src) {
+  LOG(FATAL) << "Unexpected use of OpPackedBroadcast for Mips";
+}
+
+void MipsMir2Lir::OpPackedRegReg(OpKind op, int v_dest_src1, int v_src2) {
+  LOG(FATAL) << "Unexpected use of OpPackedRegReg for Mips";
+}
+
+void MipsMir2Lir::OpPackedReduce(OpKind op, int r_dest_src1, int v_src) {
+  LOG(FATAL) << "Unexpected use of OpPackedReduce for Mips";
+}
+
 void MipsMir2Lir::GenMultiplyByTwoBitMultiplier(RegLocation rl_src,
                                                 RegLocation rl_result, int lit,
                                                 int first_bit, int second_bit) {
@@ -543,6 +543,22 @@ bool MipsMir2Lir::IsUnconditionalBranch(LIR* lir) {
   return (lir->opcode == kMipsB);
 }
 
+// Single issue, with a load delay slot.
+//                                      issue alu load mul div fp fp_div vector
+static const SchedulingModel kMipsModel = { 1,   1,  2,   2,  2,  2,  2,     1 };
+
+const SchedulingModel& MipsMir2Lir::GetSchedulingModel() {
+  return kMipsModel;
+}
+
+int MipsMir2Lir::GetInstructionLatency(LIR* lir) {
+  const SchedulingModel& model = GetSchedulingModel();
+  if (GetTargetInstFlags(lir->opcode) & IS_LOAD) {
+    return model.load_latency;
+  }
+  return model.alu_latency;
+}
+
 MipsMir2Lir::MipsMir2Lir(CompilationUnit* cu, MIRGraph* mir_graph, ArenaAllocator* arena)
     : Mir2Lir(cu, mir_graph, arena) {
   for (int i = 0; i < kMipsLast; i++) {
@@ -688,13 +688,30 @@ void Mir2Lir::HandleExtendedMethodMIR(BasicBlock* bb, MIR* mir) {
     case kMirOpSelect:
       GenSelect(bb, mir);
       break;
+    case kMirOpPackedArrayLoop:
+      GenPackedArrayLoop(mir);
+      break;
     default:
       break;
   }
 }
 
 // Handle the content in each basic block.
-bool Mir2Lir::MethodBlockCodeGen(BasicBlock* bb) {
+/*
+ * Whether bb is only entered by falling through from prev_bb, the block generated just before
+ * it, so that the temps live at the end of prev_bb still hold their values.
+ */
+static bool IsFallThroughOnly(CompilationUnit* cu, BasicBlock* prev_bb, BasicBlock* bb) {
+  if ((cu->disable_opt & ((1 << kTrackLiveTemps) | (1 << kTrackLiveTempsAcrossBlocks))) != 0) {
+    return false;
+  }
+  return (prev_bb != NULL) && (prev_bb->block_type == kDalvikByteCode) &&
+      (bb->block_type == kDalvikByteCode) && !bb->catch_entry &&
+      (prev_bb->fall_through == bb->id) && (prev_bb->taken != bb->id) &&
+      (bb->predecessors->Size() == 1);
+}
+
+bool Mir2Lir::MethodBlockCodeGen(BasicBlock* bb, bool keep_live_temps) {
   if (bb->block_type == kDead) return false;
   current_dalvik_offset_ = bb->start_offset;
   MIR* mir;
@@ -714,8 +731,13 @@ bool Mir2Lir::MethodBlockCodeGen(BasicBlock* bb) {
     head_lir = NewLIR0(kPseudoExportedPC);
   }
 
-  // Free temp registers and reset redundant store tracking.
-  ClobberAllRegs();
+  if (keep_live_temps) {
+    // Keep the temps, but the stores of the previous block are needed on its other edges.
+    ResetDefTracking();
+  } else {
+    // Free temp registers and reset redundant store tracking.
+    ClobberAllRegs();
+  }
 
   if (bb->block_type == kEntryBlock) {
     ResetRegPool();
@@ -825,15 +847,17 @@ void Mir2Lir::MethodMIR2LIR() {
                                       ArenaAllocator::kAllocLIR));
 
   PreOrderDfsIterator iter(mir_graph_);
+  BasicBlock* prev_bb = NULL;
   BasicBlock* curr_bb = iter.Next();
   BasicBlock* next_bb = iter.Next();
   while (curr_bb != NULL) {
-    MethodBlockCodeGen(curr_bb);
+    MethodBlockCodeGen(curr_bb, IsFallThroughOnly(cu_, prev_bb, curr_bb));
     // If the fall_through block is no longer laid out consecutively, drop in a branch.
     BasicBlock* curr_bb_fall_through = mir_graph_->GetBasicBlock(curr_bb->fall_through);
     if ((curr_bb_fall_through != NULL) && (curr_bb_fall_through != next_bb)) {
       OpUnconditionalBranch(&block_label_list_[curr_bb->fall_through]);
     }
+    prev_bb = curr_bb;
     curr_bb = next_bb;
     do {
       next_bb = iter.Next();
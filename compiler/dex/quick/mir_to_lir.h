@@ -23,7 +23,7 @@
 #include "dex/compiler_ir.h"
 #include "dex/backend.h"
 #include "dex/growable_array.h"
-#include "dex/arena_allocator.h"
+#include "base/arena_allocator.h"
 #include "driver/compiler_driver.h"
 #include "leb128_encoder.h"
 #include "safe_map.h"
@@ -153,6 +153,22 @@ struct LIR {
   int32_t operands[5];           // [0..4] = [dest, src1, src2, extra, extra2].
 };
 
+/*
+ * Pipeline description used by the list scheduler: how many independent instructions
+ * the core issues per cycle, and the cycles until the result of each class of
+ * instruction can be used.
+ */
+struct SchedulingModel {
+  int issue_width;
+  int alu_latency;
+  int load_latency;
+  int mul_latency;
+  int div_latency;
+  int fp_latency;
+  int fp_div_latency;
+  int vector_latency;
+};
+
 // Target-specific initialization.
 Mir2Lir* ArmCodeGenerator(CompilationUnit* const cu, MIRGraph* const mir_graph,
                           ArenaAllocator* const arena);
@@ -360,6 +376,9 @@ class Mir2Lir : public Backend {
     void ConvertMemOpIntoMove(LIR* orig_lir, int dest, int src);
     void ApplyLoadStoreElimination(LIR* head_lir, LIR* tail_lir);
     void ApplyLoadHoisting(LIR* head_lir, LIR* tail_lir);
+    bool IsSchedulingDependent(LIR* lir1, LIR* lir2);
+    void ScheduleRegion(LIR* prev_lir, LIR* end_lir);
+    void ApplyListScheduling(LIR* head_lir, LIR* tail_lir);
     void ApplyLocalOptimizations(LIR* head_lir, LIR* tail_lir);
 
     // Shared by all targets - implemented in ralloc_util.cc
@@ -507,6 +526,7 @@ class Mir2Lir : public Backend {
                            RegLocation rl_src);
     void GenSuspendTest(int opt_flags);
     void GenSuspendTestAndBranch(int opt_flags, LIR* target);
+    void GenPackedArrayLoop(MIR* mir);
     // This will be overridden by x86 implementation.
     virtual void GenConstWide(RegLocation rl_dest, int64_t value);
 
@@ -551,6 +571,8 @@ class Mir2Lir : public Backend {
                                                             RegLocation arg2,
                                                             bool safepoint_pc);
     void GenInvoke(CallInfo* info);
+    LIR* GenSingleImplementationCall(const MethodReference& target_method, uint32_t method_idx,
+                                     uint16_t impl_type_idx, int impl_vtable_idx);
     void FlushIns(RegLocation* ArgLocs, RegLocation rl_method);
     int GenDalvikArgsNoRange(CallInfo* info, int call_state, LIR** pcrLabel,
                              NextCallInsn next_call_insn,
@@ -587,11 +609,16 @@ class Mir2Lir : public Backend {
     bool GenInlinedReverseBytes(CallInfo* info, OpSize size);
     bool GenInlinedAbsInt(CallInfo* info);
     bool GenInlinedAbsLong(CallInfo* info);
+    void GenBitCount(int r_dest, int r_src, int r_tmp);
+    bool GenInlinedBitCount(CallInfo* info, OpSize size);
     bool GenInlinedFloatCvt(CallInfo* info);
     bool GenInlinedDoubleCvt(CallInfo* info);
     bool GenInlinedIndexOf(CallInfo* info, bool zero_based);
     bool GenInlinedStringCompareTo(CallInfo* info);
+    bool GenInlinedStringEquals(CallInfo* info);
     bool GenInlinedCurrentThread(CallInfo* info);
+    bool GenInlinedSystemArrayCopy(CallInfo* info);
+    bool GenInlinedArrayFill(CallInfo* info, OpSize size);
     bool GenInlinedUnsafeGet(CallInfo* info, bool is_long, bool is_volatile);
     bool GenInlinedUnsafePut(CallInfo* info, bool is_long, bool is_object,
                              bool is_volatile, bool is_ordered);
@@ -645,7 +672,7 @@ class Mir2Lir : public Backend {
     // Shared by all targets - implemented in mir_to_lir.cc.
     void CompileDalvikInstruction(MIR* mir, BasicBlock* bb, LIR* label_list);
     void HandleExtendedMethodMIR(BasicBlock* bb, MIR* mir);
-    bool MethodBlockCodeGen(BasicBlock* bb);
+    bool MethodBlockCodeGen(BasicBlock* bb, bool keep_live_temps);
     void SpecialMIR2LIR(const InlineMethod& special);
     void MethodMIR2LIR();
 
@@ -706,6 +733,8 @@ class Mir2Lir : public Backend {
     virtual uint64_t GetTargetInstFlags(int opcode) = 0;
     virtual int GetInsnSize(LIR* lir) = 0;
     virtual bool IsUnconditionalBranch(LIR* lir) = 0;
+    virtual const SchedulingModel& GetSchedulingModel() = 0;
+    virtual int GetInstructionLatency(LIR* lir) = 0;
 
     // Required for target - Dalvik-level generators.
     virtual void GenArithImmOpLong(Instruction::Code opcode, RegLocation rl_dest,
@@ -741,6 +770,24 @@ class Mir2Lir : public Backend {
      */
     virtual bool GenInlinedMinMaxInt(CallInfo* info, bool is_min) = 0;
 
+    /**
+     * @brief Used to generate code for intrinsic java\.lang\.Math methods min and max on longs.
+     * @param info Information about the invoke.
+     * @param is_min If true generates code that computes minimum. Otherwise computes maximum.
+     * @return Returns true if successfully generated
+     */
+    virtual bool GenInlinedMinMaxLong(CallInfo* info, bool is_min) = 0;
+
+    /**
+     * @brief Used to generate code for intrinsic numberOfLeadingZeros and numberOfTrailingZeros
+     * of java\.lang\.Integer and java\.lang\.Long.
+     * @param info Information about the invoke.
+     * @param size kWord for an int argument, kLong for a long one.
+     * @param is_trailing If true counts the trailing zeros. Otherwise counts the leading zeros.
+     * @return Returns true if successfully generated
+     */
+    virtual bool GenInlinedNumberOfZeros(CallInfo* info, OpSize size, bool is_trailing) = 0;
+
     virtual bool GenInlinedSqrt(CallInfo* info) = 0;
     virtual bool GenInlinedPeek(CallInfo* info, OpSize size) = 0;
     virtual bool GenInlinedPoke(CallInfo* info, OpSize size) = 0;
@@ -864,6 +911,16 @@ class Mir2Lir : public Backend {
     virtual void OpLea(int rBase, int reg1, int reg2, int scale, int offset) = 0;
     virtual void OpRegCopyWide(int dest_lo, int dest_hi, int src_lo, int src_hi) = 0;
     virtual void OpTlsCmp(ThreadOffset offset, int val) = 0;
+
+    // Packed operations on four ints, held in a vector register.
+    virtual int AllocPackedTemp() = 0;
+    virtual void FreePackedTemp(int v_reg) = 0;
+    virtual void OpPackedLoad(int v_dest, int r_base, int r_index, int offset) = 0;
+    virtual void OpPackedStore(int r_base, int r_index, int offset, int v_src) = 0;
+    virtual void OpPackedBroadcast(int v_dest, int r_src) = 0;
+    virtual void OpPackedRegReg(OpKind op, int v_dest_src1, int v_src2) = 0;
+    // Folds the four ints of v_src into r_dest_src1.
+    virtual void OpPackedReduce(OpKind op, int r_dest_src1, int v_src) = 0;
     virtual bool InexpensiveConstantInt(int32_t value) = 0;
     virtual bool InexpensiveConstantFloat(int32_t value) = 0;
     virtual bool InexpensiveConstantLong(int64_t value) = 0;
@@ -990,6 +1047,8 @@ class Mir2Lir : public Backend {
     unsigned int fp_spill_mask_;
     LIR* first_lir_insn_;
     LIR* last_lir_insn_;
+
+    friend class MirGraphTest;  // To allow access to the LIR list and the block labels.
 };  // Class Mir2Lir
 
 }  // namespace art
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "dex/mir_graph_test.h"
+
+namespace art {
+
+class MirToLirTest : public MirGraphTest {
+ protected:
+  virtual void SetUp() {
+    MirGraphTest::SetUp();
+    // Keep Dalvik registers in the frame and every load in place, so that the loads tell which
+    // values the temps still held.
+    cu_->disable_opt |= (1 << kPromoteRegs) | (1 << kLoadStoreElimination) | (1 << kLoadHoisting);
+  }
+
+  // The number of loads of v_reg from the frame in the LIR of bb.
+  size_t CountDalvikRegLoads(Mir2Lir* cg, BasicBlock* bb, int v_reg) {
+    size_t count = 0;
+    for (LIR* lir = GetBlockLabel(cg, bb)->next;
+         (lir != NULL) && (lir->opcode != kPseudoNormalBlockLabel); lir = lir->next) {
+      if (lir->flags.is_nop || cg->IsPseudoLirOp(lir->opcode) ||
+          ((cg->GetTargetInstFlags(lir->opcode) & IS_LOAD) == 0) ||
+          ((lir->u.m.use_mask & ENCODE_DALVIK_REG) == 0)) {
+        continue;
+      }
+      if (DECODE_ALIAS_INFO_REG(lir->flags.alias_info) == v_reg) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  // Generates the code of LiveTemps.incrementIfNonZero and counts the loads of a in the block
+  // computing a + 1, which the test falls through to, and of b in the block joining the paths.
+  void CountLiveTempLoads(size_t* increment_loads, size_t* join_loads) {
+    BuildMIRGraph("LiveTemps", "LiveTemps", "incrementIfNonZero", "(I)I");
+    Mir2Lir* cg = GenerateLIR();
+    std::vector<MIR*> increments(FindMIRs(Instruction::ADD_INT_LIT8));
+    std::vector<MIR*> returns(FindMIRs(Instruction::RETURN));
+    ASSERT_EQ(1U, increments.size());
+    ASSERT_EQ(1U, returns.size());
+    BasicBlock* increment_bb = GetBlockOf(increments[0]);
+    BasicBlock* join_bb = GetBlockOf(returns[0]);
+    ASSERT_TRUE(increment_bb != NULL);
+    ASSERT_TRUE(join_bb != NULL);
+    ASSERT_EQ(1U, increment_bb->predecessors->Size());
+    ASSERT_EQ(2U, join_bb->predecessors->Size());
+    ASSERT_EQ(join_bb->id, increment_bb->fall_through);
+    int a = increments[0]->dalvikInsn.vB;
+    int b = returns[0]->dalvikInsn.vA;
+    ASSERT_NE(a, b);
+    *increment_loads = CountDalvikRegLoads(cg, increment_bb, a);
+    *join_loads = CountDalvikRegLoads(cg, join_bb, b);
+  }
+};
+
+TEST_F(MirToLirTest, LiveTempsAcrossFallThrough) {
+  TEST_DISABLED_FOR_PORTABLE();
+  size_t increment_loads;
+  size_t join_loads;
+  CountLiveTempLoads(&increment_loads, &join_loads);
+  // a was loaded for the test, the block falling through from it still has it.
+  EXPECT_EQ(0U, increment_loads);
+  // The other path reaches the join with b in no particular register.
+  EXPECT_NE(0U, join_loads);
+}
+
+TEST_F(MirToLirTest, LiveTempsAcrossFallThroughDisabled) {
+  TEST_DISABLED_FOR_PORTABLE();
+  cu_->disable_opt |= (1 << kTrackLiveTempsAcrossBlocks);
+  size_t increment_loads;
+  size_t join_loads;
+  CountLiveTempLoads(&increment_loads, &join_loads);
+  EXPECT_NE(0U, increment_loads);
+  EXPECT_NE(0U, join_loads);
+}
+
+}  // namespace art
@@ -302,6 +302,16 @@ ENCODING_MAP(Cmp, IS_LOAD, 0, 0,
   { kX86MovdrxMR, kMemReg,      IS_STORE | IS_TERTIARY_OP | REG_USE02,  { 0x66, 0, 0x0F, 0x7E, 0, 0, 0, 0 }, "MovdrxMR", "[!0r+!1d],!2r" },
   { kX86MovdrxAR, kArrayReg,    IS_STORE | IS_QUIN_OP     | REG_USE014, { 0x66, 0, 0x0F, 0x7E, 0, 0, 0, 0 }, "MovdrxAR", "[!0r+!1r<<!2d+!3d],!4r" },
 
+  EXT_0F_ENCODING_MAP(Movdqu,    0xF3, 0x6F, REG_DEF0),
+  { kX86MovdquMR, kMemReg,   IS_STORE | IS_TERTIARY_OP | REG_USE02,  { 0xF3, 0, 0x0F, 0x7F, 0, 0, 0, 0 }, "MovdquMR", "[!0r+!1d],!2r" },
+  { kX86MovdquAR, kArrayReg, IS_STORE | IS_QUIN_OP     | REG_USE014, { 0xF3, 0, 0x0F, 0x7F, 0, 0, 0, 0 }, "MovdquAR", "[!0r+!1r<<!2d+!3d],!4r" },
+  EXT_0F_ENCODING_MAP(Paddd,     0x66, 0xFE, REG_DEF0),
+  EXT_0F_ENCODING_MAP(Psubd,     0x66, 0xFA, REG_DEF0),
+  EXT_0F_ENCODING_MAP(Pand,      0x66, 0xDB, REG_DEF0),
+  EXT_0F_ENCODING_MAP(Por,       0x66, 0xEB, REG_DEF0),
+  EXT_0F_ENCODING_MAP(Pxor,      0x66, 0xEF, REG_DEF0),
+  { kX86PshufdRRI, kRegRegImm, IS_TERTIARY_OP | REG_DEF0_USE1, { 0x66, 0, 0x0F, 0x70, 0, 0, 0, 1 }, "PshufdRRI", "!0r,!1r,!2d" },
+
   { kX86Set8R, kRegCond,              IS_BINARY_OP   | REG_DEF0  | USES_CCODES, { 0, 0, 0x0F, 0x90, 0, 0, 0, 0 }, "Set8R", "!1c !0r" },
   { kX86Set8M, kMemCond,   IS_STORE | IS_TERTIARY_OP | REG_USE0  | USES_CCODES, { 0, 0, 0x0F, 0x90, 0, 0, 0, 0 }, "Set8M", "!2c [!0r+!1d]" },
   { kX86Set8A, kArrayCond, IS_STORE | IS_QUIN_OP     | REG_USE01 | USES_CCODES, { 0, 0, 0x0F, 0x90, 0, 0, 0, 0 }, "Set8A", "!4c [!0r+!1r<<!2d+!3d]" },
@@ -84,6 +84,8 @@ class X86Mir2Lir : public Mir2Lir {
     uint64_t GetTargetInstFlags(int opcode);
     int GetInsnSize(LIR* lir);
     bool IsUnconditionalBranch(LIR* lir);
+    const SchedulingModel& GetSchedulingModel();
+    int GetInstructionLatency(LIR* lir);
 
     // Required for target - Dalvik-level generators.
     void GenArithImmOpLong(Instruction::Code opcode, RegLocation rl_dest,
@@ -106,6 +108,8 @@ class X86Mir2Lir : public Mir2Lir {
     void GenConversion(Instruction::Code opcode, RegLocation rl_dest, RegLocation rl_src);
     bool GenInlinedCas(CallInfo* info, bool is_long, bool is_object);
     bool GenInlinedMinMaxInt(CallInfo* info, bool is_min);
+    bool GenInlinedMinMaxLong(CallInfo* info, bool is_min);
+    bool GenInlinedNumberOfZeros(CallInfo* info, OpSize size, bool is_trailing);
     bool GenInlinedSqrt(CallInfo* info);
     bool GenInlinedPeek(CallInfo* info, OpSize size);
     bool GenInlinedPoke(CallInfo* info, OpSize size);
@@ -206,6 +210,13 @@ class X86Mir2Lir : public Mir2Lir {
     void OpLea(int rBase, int reg1, int reg2, int scale, int offset);
     void OpRegCopyWide(int dest_lo, int dest_hi, int src_lo, int src_hi);
     void OpTlsCmp(ThreadOffset offset, int val);
+    int AllocPackedTemp();
+    void FreePackedTemp(int v_reg);
+    void OpPackedLoad(int v_dest, int r_base, int r_index, int offset);
+    void OpPackedStore(int r_base, int r_index, int offset, int v_src);
+    void OpPackedBroadcast(int v_dest, int r_src);
+    void OpPackedRegReg(OpKind op, int v_dest_src1, int v_src2);
+    void OpPackedReduce(OpKind op, int r_dest_src1, int v_src);
 
     void OpRegThreadMem(OpKind op, int r_dest, ThreadOffset thread_offset);
     void SpillCoreRegs();
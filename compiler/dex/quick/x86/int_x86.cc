@@ -668,6 +668,16 @@ bool X86Mir2Lir::GenInlinedMinMaxInt(CallInfo* info, bool is_min) {
   return true;
 }
 
+bool X86Mir2Lir::GenInlinedMinMaxLong(CallInfo* info, bool is_min) {
+  // TODO: two register pairs, the result pair and a temp don't fit in the x86 temps.
+  return false;
+}
+
+bool X86Mir2Lir::GenInlinedNumberOfZeros(CallInfo* info, OpSize size, bool is_trailing) {
+  // TODO: need x86 implementation, BSR and BSF leave their result undefined for zero.
+  return false;
+}
+
 bool X86Mir2Lir::GenInlinedPeek(CallInfo* info, OpSize size) {
   RegLocation rl_src_address = info->args[0];  // long address
   rl_src_address.wide = 0;  // ignore high half in info->args[1]
@@ -401,7 +401,8 @@ void X86Mir2Lir::FreeCallTemps() {
 void X86Mir2Lir::GenMemBarrier(MemBarrierKind barrier_kind) {
 #if ANDROID_SMP != 0
   // TODO: optimize fences
-  NewLIR0(kX86Mfence);
+  LIR* mfence = NewLIR0(kX86Mfence);
+  mfence->u.m.def_mask = ENCODE_ALL;
 #endif
 }
 /*
@@ -434,6 +435,15 @@ int X86Mir2Lir::AllocTypedTemp(bool fp_hint, int reg_class) {
   return AllocTemp();
 }
 
+// Any XMM register holds four ints.
+int X86Mir2Lir::AllocPackedTemp() {
+  return AllocTempFloat();
+}
+
+void X86Mir2Lir::FreePackedTemp(int v_reg) {
+  FreeTemp(v_reg);
+}
+
 void X86Mir2Lir::CompilerInitializeRegAlloc() {
   int num_regs = sizeof(core_regs)/sizeof(*core_regs);
   int num_reserved = sizeof(ReservedRegs)/sizeof(*ReservedRegs);
@@ -509,6 +519,56 @@ bool X86Mir2Lir::IsUnconditionalBranch(LIR* lir) {
   return (lir->opcode == kX86Jmp8 || lir->opcode == kX86Jmp32);
 }
 
+/*
+ * Pipeline of the Atom. Silvermont reorders on its own and is scheduled the same way.
+ */
+//                                      issue alu load mul div fp fp_div vector
+static const SchedulingModel kAtomModel = { 2,   1,  3,   5,  30, 5,  30,    1 };
+
+const SchedulingModel& X86Mir2Lir::GetSchedulingModel() {
+  return kAtomModel;
+}
+
+int X86Mir2Lir::GetInstructionLatency(LIR* lir) {
+  const SchedulingModel& model = GetSchedulingModel();
+  int opcode = lir->opcode;
+  if ((opcode >= kX86Mul8DaR && opcode <= kX86Imul32DaA) ||
+      (opcode >= kX86Imul16RRI && opcode <= kX86Imul32RAI8) ||
+      (opcode >= kX86Imul16RR && opcode <= kX86Imul32RA)) {
+    return model.mul_latency;
+  }
+  if (opcode >= kX86Divmod8DaR && opcode <= kX86Idivmod32DaA) {
+    return model.div_latency;
+  }
+  switch (opcode) {
+    case kX86DivsdRR:
+    case kX86DivsdRM:
+    case kX86DivsdRA:
+    case kX86DivssRR:
+    case kX86DivssRM:
+    case kX86DivssRA:
+    case kX86SqrtsdRR:
+      return model.fp_div_latency;
+    case kX86PadddRR:
+    case kX86PsubdRR:
+    case kX86PandRR:
+    case kX86PorRR:
+    case kX86PxorRR:
+    case kX86PshufdRRI:
+      return model.vector_latency;
+    default:
+      break;
+  }
+  uint64_t flags = GetTargetInstFlags(opcode);
+  if (flags & IS_LOAD) {
+    return model.load_latency;
+  }
+  if ((flags & REG_DEF0) && X86_FPREG(lir->operands[0])) {
+    return model.fp_latency;
+  }
+  return model.alu_latency;
+}
+
 X86Mir2Lir::X86Mir2Lir(CompilationUnit* cu, MIRGraph* mir_graph, ArenaAllocator* arena)
     : Mir2Lir(cu, mir_graph, arena) {
   for (int i = 0; i < kX86Last; i++) {
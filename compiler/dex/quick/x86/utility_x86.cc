@@ -604,4 +604,54 @@ void X86Mir2Lir::OpVectorRegCopyWide(uint8_t fp_reg, uint8_t low_reg, uint8_t hi
   FreeTemp(tmp_reg);
 }
 
+void X86Mir2Lir::OpPackedLoad(int v_dest, int r_base, int r_index, int offset) {
+  NewLIR5(kX86MovdquRA, v_dest, r_base, r_index, 2, offset);
+}
+
+void X86Mir2Lir::OpPackedStore(int r_base, int r_index, int offset, int v_src) {
+  NewLIR5(kX86MovdquAR, r_base, r_index, 2, offset, v_src);
+}
+
+void X86Mir2Lir::OpPackedBroadcast(int v_dest, int r_src) {
+  NewLIR2(kX86MovdxrRR, v_dest, r_src);
+  NewLIR3(kX86PshufdRRI, v_dest, v_dest, 0);
+}
+
+void X86Mir2Lir::OpPackedRegReg(OpKind op, int v_dest_src1, int v_src2) {
+  X86OpCode opcode = kX86Bkpt;
+  switch (op) {
+    case kOpAdd:
+      opcode = kX86PadddRR;
+      break;
+    case kOpSub:
+      opcode = kX86PsubdRR;
+      break;
+    case kOpAnd:
+      opcode = kX86PandRR;
+      break;
+    case kOpOr:
+      opcode = kX86PorRR;
+      break;
+    case kOpXor:
+      opcode = kX86PxorRR;
+      break;
+    default:
+      LOG(FATAL) << "Bad packed opcode: " << op;
+  }
+  NewLIR2(opcode, v_dest_src1, v_src2);
+}
+
+// Each int of v_src is folded in from the low one, rotating v_src by an int to bring the next.
+void X86Mir2Lir::OpPackedReduce(OpKind op, int r_dest_src1, int v_src) {
+  int r_lane = AllocTemp();
+  for (int lane = 0; lane < 4; lane++) {
+    if (lane != 0) {
+      NewLIR3(kX86PshufdRRI, v_src, v_src, 0x39);
+    }
+    NewLIR2(kX86MovdrxRR, r_lane, v_src);
+    OpRegReg(op, r_dest_src1, r_lane);
+  }
+  FreeTemp(r_lane);
+}
+
 }  // namespace art
@@ -359,6 +359,14 @@ enum X86OpCode {
   kX86FstpdM,                   // Store and pop top x87 fp stack
   Binary0fOpCode(kX86Movdxr),   // move into xmm from gpr
   kX86MovdrxRR, kX86MovdrxMR, kX86MovdrxAR,  // move into reg from xmm
+  Binary0fOpCode(kX86Movdqu),   // move packed ints into xmm
+  kX86MovdquMR, kX86MovdquAR,   // move packed ints from xmm
+  Binary0fOpCode(kX86Paddd),    // packed int add
+  Binary0fOpCode(kX86Psubd),    // packed int subtract
+  Binary0fOpCode(kX86Pand),     // and of packed ints
+  Binary0fOpCode(kX86Por),      // or of packed ints
+  Binary0fOpCode(kX86Pxor),     // xor of packed ints
+  kX86PshufdRRI,                // shuffle packed ints
   kX86Set8R, kX86Set8M, kX86Set8A,  // set byte depending on condition operand
   kX86Mfence,                   // memory barrier
   Binary0fOpCode(kX86Imul16),   // 16bit multiply
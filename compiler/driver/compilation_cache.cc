@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilation_cache.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <vector>
+
+#include "base/logging.h"
+#include "base/mutex-inl.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "compiled_method.h"
+#include "dex/verified_method.h"
+#include "dex_instruction-inl.h"
+#include "driver/compiler_driver.h"
+#include "driver/dex_compilation_unit.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/dex_cache-inl.h"
+#include "oat.h"
+#include "os.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+
+// The start of a cache file. Bump the version when the format or the contents of keys change.
+static const char kCompilationCacheMagic[] = "art-compilation-cache 4\n";
+
+// Appends values to a key or a serialized CompiledMethod.
+class CacheWriter {
+ public:
+  explicit CacheWriter(std::string* out) : out_(out) {}
+
+  void WriteU32(uint32_t value) {
+    out_->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void WriteU64(uint64_t value) {
+    out_->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void WriteBool(bool value) {
+    out_->push_back(value ? 1 : 0);
+  }
+
+  void WriteBytes(const void* data, size_t size) {
+    WriteU32(size);
+    if (size != 0) {
+      out_->append(reinterpret_cast<const char*>(data), size);
+    }
+  }
+
+  void WriteString(const std::string& s) {
+    WriteBytes(s.data(), s.size());
+  }
+
+  void WriteVector(const std::vector<uint8_t>& v) {
+    WriteBytes(v.empty() ? NULL : &v[0], v.size());
+  }
+
+ private:
+  std::string* const out_;
+};
+
+// Reads the values written by CacheWriter, failing rather than reading past the end.
+class CacheReader {
+ public:
+  CacheReader(const char* begin, const char* end) : current_(begin), end_(end) {}
+
+  bool ReadU32(uint32_t* value) {
+    return Read(value, sizeof(*value));
+  }
+
+  bool ReadString(std::string* s) {
+    uint32_t size;
+    if (!ReadU32(&size) || static_cast<size_t>(end_ - current_) < size) {
+      return false;
+    }
+    s->assign(current_, size);
+    current_ += size;
+    return true;
+  }
+
+  bool ReadVector(std::vector<uint8_t>* v) {
+    uint32_t size;
+    if (!ReadU32(&size) || static_cast<size_t>(end_ - current_) < size) {
+      return false;
+    }
+    v->assign(current_, current_ + size);
+    current_ += size;
+    return true;
+  }
+
+  bool AtEnd() const {
+    return current_ == end_;
+  }
+
+ private:
+  bool Read(void* data, size_t size) {
+    if (static_cast<size_t>(end_ - current_) < size) {
+      return false;
+    }
+    memcpy(data, current_, size);
+    current_ += size;
+    return true;
+  }
+
+  const char* current_;
+  const char* const end_;
+};
+
+CompilationCache::CompilationCache(CompilerDriver* driver, const std::string& filename)
+    : driver_(driver),
+      filename_(filename),
+      lock_("compilation cache lock"),
+      hits_(0),
+      misses_(0) {}
+
+// Adds the checksum of a file of the compiler build to the fingerprint.
+static bool WriteFileChecksum(CacheWriter* writer, const char* filename) {
+  std::string contents;
+  if (!ReadFileToString(filename, &contents)) {
+    PLOG(WARNING) << "Failed to read " << filename;
+    return false;
+  }
+  uLong checksum = adler32(0L, Z_NULL, 0);
+  checksum = adler32(checksum, reinterpret_cast<const Bytef*>(contents.data()), contents.size());
+  writer->WriteU32(contents.size());
+  writer->WriteU32(checksum);
+  return true;
+}
+
+// Returns an empty fingerprint if the compiler build can't be identified, the cache isn't used
+// then.
+std::string CompilationCache::ComputeFingerprint() const {
+  std::string fingerprint;
+  CacheWriter writer(&fingerprint);
+  // Code compiled by any other build of dex2oat or of the compiler may be wrong, even when
+  // kOatVersion is the same.
+  if (!WriteFileChecksum(&writer, "/proc/self/exe")) {
+    return "";
+  }
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&WriteFileChecksum), &info) != 0 &&
+      info.dli_fname != NULL && !WriteFileChecksum(&writer, info.dli_fname)) {
+    return "";
+  }
+  writer.WriteBytes(OatHeader::kOatVersion, sizeof(OatHeader::kOatVersion));
+  writer.WriteU32(driver_->GetInstructionSet());
+  writer.WriteU32(driver_->GetInstructionSetFeatures().get_mask());
+  writer.WriteU32(driver_->GetCompilerBackend());
+  const Runtime* runtime = Runtime::Current();
+  writer.WriteU32(runtime->GetCompilerFilter());
+  writer.WriteU32(runtime->GetHugeMethodThreshold());
+  writer.WriteU32(runtime->GetLargeMethodThreshold());
+  writer.WriteU32(runtime->GetSmallMethodThreshold());
+  writer.WriteU32(runtime->GetTinyMethodThreshold());
+  // Code calls directly into the boot image.
+  gc::space::ImageSpace* image_space = runtime->GetHeap()->GetImageSpace();
+  writer.WriteU32(image_space != NULL ? image_space->GetImageHeader().GetOatChecksum() : 0);
+  return fingerprint;
+}
+
+// The file holds the fingerprint followed by the entries, each a key and a value.
+bool CompilationCache::Load() {
+  fingerprint_ = ComputeFingerprint();
+  if (fingerprint_.empty()) {
+    LOG(WARNING) << "Not using compilation cache " << filename_
+                 << ", the compiler build can't be identified";
+    return false;
+  }
+  std::string contents;
+  if (!ReadFileToString(filename_, &contents)) {
+    VLOG(compiler) << "No compilation cache at " << filename_;
+    return false;
+  }
+  const size_t magic_length = strlen(kCompilationCacheMagic);
+  if (contents.compare(0, magic_length, kCompilationCacheMagic) != 0) {
+    LOG(WARNING) << "Discarding compilation cache " << filename_ << " with a bad header";
+    return false;
+  }
+  CacheReader reader(contents.data() + magic_length, contents.data() + contents.size());
+  std::string fingerprint;
+  if (!reader.ReadString(&fingerprint) || fingerprint != fingerprint_) {
+    VLOG(compiler) << "Discarding compilation cache " << filename_
+                   << " written for a different configuration";
+    return false;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  while (!reader.AtEnd()) {
+    std::string key;
+    Entry entry;
+    entry.used = false;
+    if (!reader.ReadString(&key) || !reader.ReadString(&entry.value)) {
+      LOG(WARNING) << "Discarding truncated compilation cache " << filename_;
+      entries_.clear();
+      return false;
+    }
+    entries_.Overwrite(key, entry);
+  }
+  return true;
+}
+
+bool CompilationCache::Save() {
+  if (fingerprint_.empty()) {
+    return false;
+  }
+  std::string contents(kCompilationCacheMagic);
+  CacheWriter writer(&contents);
+  writer.WriteString(fingerprint_);
+  size_t saved = 0;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    for (const auto& it : entries_) {
+      if (it.second.used) {
+        writer.WriteString(it.first);
+        writer.WriteString(it.second.value);
+        ++saved;
+      }
+    }
+    VLOG(compiler) << "Compilation cache: " << hits_ << " hits, " << misses_ << " misses, saving "
+                   << saved << " of " << entries_.size() << " methods";
+  }
+  // Write to a temporary file and rename it into place so that a concurrent compile never sees a
+  // partially written cache.
+  std::string tmp_filename(filename_ + ".tmp");
+  UniquePtr<File> file(OS::CreateEmptyFile(tmp_filename.c_str()));
+  if (file.get() == NULL) {
+    PLOG(WARNING) << "Failed to create compilation cache " << tmp_filename;
+    return false;
+  }
+  if (!file->WriteFully(contents.data(), contents.size()) || file->Close() != 0) {
+    PLOG(WARNING) << "Failed to write compilation cache " << tmp_filename;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename " << tmp_filename << " to " << filename_;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+static InvokeType InvokeTypeOf(Instruction::Code opcode) {
+  switch (opcode) {
+    case Instruction::INVOKE_VIRTUAL:
+    case Instruction::INVOKE_VIRTUAL_RANGE:
+      return kVirtual;
+    case Instruction::INVOKE_SUPER:
+    case Instruction::INVOKE_SUPER_RANGE:
+      return kSuper;
+    case Instruction::INVOKE_DIRECT:
+    case Instruction::INVOKE_DIRECT_RANGE:
+      return kDirect;
+    case Instruction::INVOKE_STATIC:
+    case Instruction::INVOKE_STATIC_RANGE:
+      return kStatic;
+    case Instruction::INVOKE_INTERFACE:
+    case Instruction::INVOKE_INTERFACE_RANGE:
+      return kInterface;
+    default:
+      LOG(FATAL) << "Unexpected invoke " << Instruction::Name(opcode);
+      return kVirtual;
+  }
+}
+
+// The compiled code may embed the index, so it is part of the key along with what it refers to.
+// The dex file is identified by its location, its checksum changes with any edit to it.
+static void WriteMethodReference(CacheWriter* writer, const MethodReference& ref) {
+  writer->WriteString(ref.dex_file->GetLocation());
+  writer->WriteU32(ref.dex_method_index);
+  writer->WriteString(PrettyMethod(ref.dex_method_index, *ref.dex_file, true));
+}
+
+// The MethodInlining pass may copy the code of a direct or static target in the same dex file
+// into the caller, so the caller's code depends on it.
+static void WriteInlinableCode(CacheWriter* writer, const DexFile& dex_file,
+                               const MethodReference& target)
+    LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  const DexFile::CodeItem* code_item = NULL;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::ArtMethod* method = Runtime::Current()->GetClassLinker()->FindDexCache(dex_file)
+        ->GetResolvedMethod(target.dex_method_index);
+    if (method != NULL) {
+      code_item = dex_file.GetCodeItem(method->GetCodeItemOffset());
+    }
+  }
+  if (code_item == NULL) {
+    writer->WriteU32(0);
+    return;
+  }
+  writer->WriteU32(code_item->insns_size_in_code_units_);
+  writer->WriteBytes(code_item->insns_, code_item->insns_size_in_code_units_ * sizeof(uint16_t));
+}
+
+// The ScalarReplacement pass looks at the members of the classes defined in the same dex file
+// that the method instantiates. Their constructors are keyed along with the invokes.
+static void WriteClassMembers(CacheWriter* writer, const DexFile& dex_file, uint16_t type_idx) {
+  const DexFile::ClassDef* class_def = dex_file.FindClassDef(type_idx);
+  if (class_def == NULL) {
+    writer->WriteBool(false);
+    return;
+  }
+  writer->WriteBool(true);
+  writer->WriteString(class_def->superclass_idx_ == DexFile::kDexNoIndex16 ? "" :
+                      dex_file.StringByTypeIdx(class_def->superclass_idx_));
+  const byte* class_data = dex_file.GetClassData(*class_def);
+  if (class_data == NULL) {
+    writer->WriteU32(0);
+    return;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  writer->WriteU32(it.NumStaticFields() + it.NumInstanceFields() + it.NumDirectMethods() +
+                   it.NumVirtualMethods());
+  for (; it.HasNext(); it.Next()) {
+    if (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      writer->WriteString(PrettyField(it.GetMemberIndex(), dex_file, true));
+    } else {
+      writer->WriteString(PrettyMethod(it.GetMemberIndex(), dex_file, true));
+    }
+    writer->WriteU32(it.GetMemberAccessFlags());
+  }
+}
+
+static void WriteTypeInfo(CacheWriter* writer, CompilerDriver* driver, const DexFile& dex_file,
+                          uint32_t referrer_idx, uint32_t type_idx) {
+  writer->WriteString(dex_file.StringByTypeIdx(type_idx));
+  bool type_known_final = false;
+  bool type_known_abstract = false;
+  bool equals_referrers_class = false;
+  writer->WriteBool(driver->CanAccessTypeWithoutChecks(referrer_idx, dex_file, type_idx,
+                                                       &type_known_final, &type_known_abstract,
+                                                       &equals_referrers_class));
+  writer->WriteBool(type_known_final);
+  writer->WriteBool(type_known_abstract);
+  writer->WriteBool(equals_referrers_class);
+  writer->WriteBool(driver->CanAccessInstantiableTypeWithoutChecks(referrer_idx, dex_file,
+                                                                   type_idx));
+  writer->WriteBool(driver->CanAssumeTypeIsPresentInDexCache(dex_file, type_idx));
+  bool is_type_initialized = false;
+  bool use_direct_type_ptr = false;
+  uintptr_t direct_type_ptr = 0;
+  writer->WriteBool(driver->CanEmbedTypeInCode(dex_file, type_idx, &is_type_initialized,
+                                               &use_direct_type_ptr, &direct_type_ptr));
+  writer->WriteBool(is_type_initialized);
+  writer->WriteBool(use_direct_type_ptr);
+  writer->WriteU64(direct_type_ptr);
+}
+
+std::string CompilationCache::ComputeKey(const DexFile& dex_file,
+                                         const DexFile::CodeItem* code_item,
+                                         uint32_t access_flags, InvokeType invoke_type,
+                                         uint16_t class_def_idx, uint32_t method_idx,
+                                         jobject class_loader) {
+  std::string key;
+  CacheWriter writer(&key);
+  writer.WriteString(PrettyMethod(method_idx, dex_file, true));
+  writer.WriteU32(access_flags);
+  writer.WriteU32(invoke_type);
+
+  // The code item, with the types of the exceptions it catches.
+  writer.WriteU32(code_item->registers_size_);
+  writer.WriteU32(code_item->ins_size_);
+  writer.WriteU32(code_item->outs_size_);
+  writer.WriteBytes(code_item->insns_, code_item->insns_size_in_code_units_ * sizeof(uint16_t));
+  for (uint32_t i = 0; i < code_item->tries_size_; ++i) {
+    const DexFile::TryItem* try_item = DexFile::GetTryItems(*code_item, i);
+    writer.WriteU32(try_item->start_addr_);
+    writer.WriteU32(try_item->insn_count_);
+    for (CatchHandlerIterator it(*code_item, *try_item); it.HasNext(); it.Next()) {
+      uint16_t type_idx = it.GetHandlerTypeIndex();
+      writer.WriteString(type_idx == DexFile::kDexNoIndex16 ? "" :
+                         dex_file.StringByTypeIdx(type_idx));
+      writer.WriteU32(it.GetHandlerAddress());
+    }
+  }
+
+  // What the verifier found out about the method.
+  const VerifiedMethod* verified_method = driver_->GetVerifiedMethod(&dex_file, method_idx);
+  CHECK(verified_method != NULL);
+  writer.WriteVector(verified_method->GetDexGcMap());
+  for (const auto& it : verified_method->GetDevirtMap()) {
+    writer.WriteU32(it.first);
+    WriteMethodReference(&writer, it.second);
+  }
+  for (uint32_t dex_pc : verified_method->GetSafeCastSet()) {
+    writer.WriteU32(dex_pc);
+  }
+  Thread* self = Thread::Current();
+  writer.WriteBool(driver_->RequiresConstructorBarrier(self, &dex_file, class_def_idx));
+
+  // The ids referenced by the code and what the driver tells the backend about them. The
+  // backend asks these questions with the same arguments, so code compiled when the answers were
+  // the same is still valid.
+  DexCompilationUnit unit(NULL, class_loader, Runtime::Current()->GetClassLinker(), dex_file,
+                          code_item, class_def_idx, method_idx, access_flags, verified_method);
+  const uint16_t* insns = code_item->insns_;
+  for (uint32_t dex_pc = 0; dex_pc < code_item->insns_size_in_code_units_; ) {
+    const Instruction* inst = Instruction::At(insns + dex_pc);
+    Instruction::Code opcode = inst->Opcode();
+    int verify_b = inst->GetVerifyTypeArgumentB();
+    int verify_c = inst->GetVerifyTypeArgumentC();
+    if (verify_b == Instruction::kVerifyRegBString) {
+      uint32_t string_idx = inst->VRegB();
+      writer.WriteString(dex_file.StringDataByIdx(string_idx));
+      writer.WriteBool(driver_->CanAssumeStringIsPresentInDexCache(dex_file, string_idx));
+    } else if (verify_b == Instruction::kVerifyRegBType ||
+               verify_b == Instruction::kVerifyRegBNewInstance) {
+      WriteTypeInfo(&writer, driver_, dex_file, method_idx, inst->VRegB());
+      if (opcode == Instruction::NEW_INSTANCE) {
+        WriteClassMembers(&writer, dex_file, inst->VRegB());
+      }
+    } else if (verify_c == Instruction::kVerifyRegCType ||
+               verify_c == Instruction::kVerifyRegCNewArray) {
+      WriteTypeInfo(&writer, driver_, dex_file, method_idx, inst->VRegC());
+    } else if (verify_b == Instruction::kVerifyRegBField) {
+      uint32_t field_idx = inst->VRegB();
+      writer.WriteString(PrettyField(field_idx, dex_file, true));
+      bool is_put = opcode >= Instruction::SPUT && opcode <= Instruction::SPUT_SHORT;
+      int field_offset = 0;
+      int storage_index = 0;
+      bool is_referrers_class = false;
+      bool is_volatile = false;
+      bool is_initialized = false;
+      writer.WriteBool(driver_->ComputeStaticFieldInfo(field_idx, &unit, is_put, &field_offset,
+                                                       &storage_index, &is_referrers_class,
+                                                       &is_volatile, &is_initialized));
+      writer.WriteU32(field_offset);
+      writer.WriteU32(storage_index);
+      writer.WriteBool(is_referrers_class);
+      writer.WriteBool(is_volatile);
+      writer.WriteBool(is_initialized);
+    } else if (verify_c == Instruction::kVerifyRegCField) {
+      uint32_t field_idx = inst->VRegC();
+      writer.WriteString(PrettyField(field_idx, dex_file, true));
+      bool is_put = opcode >= Instruction::IPUT && opcode <= Instruction::IPUT_SHORT;
+      int field_offset = 0;
+      bool is_volatile = false;
+      writer.WriteBool(driver_->ComputeInstanceFieldInfo(field_idx, &unit, is_put, &field_offset,
+                                                         &is_volatile));
+      writer.WriteU32(field_offset);
+      writer.WriteBool(is_volatile);
+    } else if (verify_b == Instruction::kVerifyRegBMethod) {
+      uint32_t target_method_idx = inst->VRegB();
+      writer.WriteString(PrettyMethod(target_method_idx, dex_file, true));
+      // The backend asks both with and without devirtualization.
+      for (size_t devirtualize = 0; devirtualize < 2; ++devirtualize) {
+        InvokeType type = InvokeTypeOf(opcode);
+        MethodReference target_method(&dex_file, target_method_idx);
+        int vtable_idx = 0;
+        uintptr_t direct_code = 0;
+        uintptr_t direct_method = 0;
+        writer.WriteBool(driver_->ComputeInvokeInfo(&unit, dex_pc, false, devirtualize != 0,
+                                                    &type, &target_method, &vtable_idx,
+                                                    &direct_code, &direct_method));
+        writer.WriteU32(type);
+        WriteMethodReference(&writer, target_method);
+        writer.WriteU32(vtable_idx);
+        writer.WriteU64(direct_code);
+        writer.WriteU64(direct_method);
+        if ((type == kStatic || type == kDirect) && target_method.dex_file == &dex_file) {
+          WriteInlinableCode(&writer, dex_file, target_method);
+        }
+      }
+      if (InvokeTypeOf(opcode) == kInterface) {
+        MethodReference target_method(&dex_file, target_method_idx);
+        uint16_t type_idx = 0;
+        int vtable_idx = 0;
+        bool single_impl = driver_->ComputeSingleImplementation(&unit, target_method, &type_idx,
+                                                                &vtable_idx);
+        writer.WriteBool(single_impl);
+        writer.WriteString(single_impl ? dex_file.StringByTypeIdx(type_idx) : "");
+        writer.WriteU32(type_idx);
+        writer.WriteU32(vtable_idx);
+      }
+    }
+    dex_pc += inst->SizeInCodeUnits();
+  }
+  return key;
+}
+
+// A serialized CompiledMethod holds the frame size, the spill masks, the code and the mapping,
+// vmap and gc tables. The instruction set is part of the fingerprint.
+CompiledMethod* CompilationCache::Lookup(const std::string& key) {
+  std::string value;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      ++misses_;
+      return NULL;
+    }
+    ++hits_;
+    it->second.used = true;
+    value = it->second.value;
+  }
+  CacheReader reader(value.data(), value.data() + value.size());
+  uint32_t frame_size_in_bytes;
+  uint32_t core_spill_mask;
+  uint32_t fp_spill_mask;
+  std::vector<uint8_t> code;
+  std::vector<uint8_t> mapping_table;
+  std::vector<uint8_t> vmap_table;
+  std::vector<uint8_t> gc_map;
+  if (!reader.ReadU32(&frame_size_in_bytes) || !reader.ReadU32(&core_spill_mask) ||
+      !reader.ReadU32(&fp_spill_mask) || !reader.ReadVector(&code) ||
+      !reader.ReadVector(&mapping_table) || !reader.ReadVector(&vmap_table) ||
+      !reader.ReadVector(&gc_map) || !reader.AtEnd()) {
+    // The method is compiled again and its entry replaced, or dropped by Save.
+    LOG(WARNING) << "Ignoring corrupt compilation cache entry in " << filename_;
+    MutexLock mu(Thread::Current(), lock_);
+    --hits_;
+    ++misses_;
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.value == value) {
+      it->second.used = false;
+    }
+    return NULL;
+  }
+  return new CompiledMethod(*driver_, driver_->GetInstructionSet(), code, frame_size_in_bytes,
+                            core_spill_mask, fp_spill_mask, mapping_table, vmap_table, gc_map);
+}
+
+void CompilationCache::Insert(const std::string& key, const CompiledMethod& compiled_method) {
+  Entry entry;
+  entry.used = true;
+  CacheWriter writer(&entry.value);
+  writer.WriteU32(compiled_method.GetFrameSizeInBytes());
+  writer.WriteU32(compiled_method.GetCoreSpillMask());
+  writer.WriteU32(compiled_method.GetFpSpillMask());
+  writer.WriteVector(compiled_method.GetCode());
+  writer.WriteVector(compiled_method.GetMappingTable());
+  writer.WriteVector(compiled_method.GetVmapTable());
+  writer.WriteVector(compiled_method.GetGcMap());
+  MutexLock mu(Thread::Current(), lock_);
+  entries_.Overwrite(key, entry);
+}
+
+}  // namespace art
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+#define ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "dex_file.h"
+#include "invoke_type.h"
+#include "jni.h"
+#include "safe_map.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompilerDriver;
+
+// Methods compiled by earlier runs of the compiler, kept in a file between runs so that
+// recompiling an application after a small change only compiles the methods that are affected.
+//
+// A method is found by a key describing everything its compiled code depends on: the code item,
+// the ids it references and the answers the driver gives to the questions the backend asks about
+// them, such as field offsets and invoke targets. The compiler build, its configuration and the
+// boot image are recorded once for the whole file, a file written by a different one is ignored.
+class CompilationCache {
+ public:
+  CompilationCache(CompilerDriver* driver, const std::string& filename);
+
+  // Read the methods compiled by an earlier run. Returns false if the file is missing, malformed
+  // or written for a different configuration, in which case the cache starts out empty.
+  bool Load() LOCKS_EXCLUDED(lock_);
+
+  // Write the methods that were looked up or added by this run, dropping those that weren't.
+  bool Save() LOCKS_EXCLUDED(lock_);
+
+  // Compute the key of a method, this resolves what the method references.
+  std::string ComputeKey(const DexFile& dex_file, const DexFile::CodeItem* code_item,
+                         uint32_t access_flags, InvokeType invoke_type, uint16_t class_def_idx,
+                         uint32_t method_idx, jobject class_loader)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // Returns a new CompiledMethod for key, or NULL if there is none or its entry is corrupt.
+  CompiledMethod* Lookup(const std::string& key) LOCKS_EXCLUDED(lock_);
+
+  void Insert(const std::string& key, const CompiledMethod& compiled_method)
+      LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Entry {
+    // The serialized CompiledMethod.
+    std::string value;
+    // Whether the entry was looked up or added by this run.
+    bool used;
+  };
+
+  // Describes the compiler build, its configuration and the boot image, all entries of a file
+  // share it.
+  std::string ComputeFingerprint() const;
+
+  CompilerDriver* const driver_;
+  const std::string filename_;
+  std::string fingerprint_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<std::string, Entry> entries_ GUARDED_BY(lock_);
+  size_t hits_ GUARDED_BY(lock_);
+  size_t misses_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(CompilationCache);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/compilation_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "UniquePtr.h"
+#include "common_test.h"
+#include "compiled_method.h"
+#include "mirror/art_method-inl.h"
+#include "object_utils.h"
+
+namespace art {
+
+class CompilationCacheTest : public CommonTest {
+ protected:
+  // Compiles StaticLeafMethods.name, which verifies its class, and returns the key of the method.
+  std::string ComputeKey(CompilationCache* cache, jobject class_loader, const char* name,
+                         const char* signature) {
+    const DexFile* dex_file;
+    const DexFile::CodeItem* code_item;
+    uint32_t access_flags;
+    InvokeType invoke_type;
+    uint16_t class_def_idx;
+    uint32_t method_idx;
+    {
+      ScopedObjectAccess soa(Thread::Current());
+      SirtRef<mirror::ClassLoader> loader(soa.Self(),
+                                          soa.Decode<mirror::ClassLoader*>(class_loader));
+      CompileDirectMethod(loader, "StaticLeafMethods", name, signature);
+      mirror::Class* klass = class_linker_->FindClass("LStaticLeafMethods;", loader);
+      mirror::ArtMethod* method = klass->FindDirectMethod(name, signature);
+      MethodHelper mh(method);
+      dex_file = &mh.GetDexFile();
+      code_item = mh.GetCodeItem();
+      access_flags = method->GetAccessFlags();
+      invoke_type = method->GetInvokeType();
+      class_def_idx = mh.GetClassDefIndex();
+      method_idx = method->GetDexMethodIndex();
+    }
+    return cache->ComputeKey(*dex_file, code_item, access_flags, invoke_type, class_def_idx,
+                             method_idx, class_loader);
+  }
+};
+
+TEST_F(CompilationCacheTest, InsertSaveLoad) {
+  ScratchFile tmp;
+  std::vector<uint8_t> code(16, 0x42);
+  std::vector<uint8_t> mapping_table(3, 1);
+  std::vector<uint8_t> vmap_table(5, 2);
+  std::vector<uint8_t> gc_map;
+  CompiledMethod compiled_method(*compiler_driver_, compiler_driver_->GetInstructionSet(), code,
+                                 64, 0x4010, 0, mapping_table, vmap_table, gc_map);
+  {
+    CompilationCache cache(compiler_driver_.get(), tmp.GetFilename());
+    EXPECT_FALSE(cache.Load());
+    EXPECT_TRUE(cache.Lookup("key") == NULL);
+    cache.Insert("key", compiled_method);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  CompilationCache cache(compiler_driver_.get(), tmp.GetFilename());
+  ASSERT_TRUE(cache.Load());
+  EXPECT_TRUE(cache.Lookup("other key") == NULL);
+  UniquePtr<CompiledMethod> loaded(cache.Lookup("key"));
+  ASSERT_TRUE(loaded.get() != NULL);
+  EXPECT_EQ(code, loaded->GetCode());
+  EXPECT_EQ(64U, loaded->GetFrameSizeInBytes());
+  EXPECT_EQ(0x4010U, loaded->GetCoreSpillMask());
+  EXPECT_EQ(0U, loaded->GetFpSpillMask());
+  EXPECT_EQ(mapping_table, loaded->GetMappingTable());
+  EXPECT_EQ(vmap_table, loaded->GetVmapTable());
+  EXPECT_EQ(gc_map, loaded->GetGcMap());
+}
+
+TEST_F(CompilationCacheTest, CorruptEntryIsMiss) {
+  ScratchFile tmp;
+  std::vector<uint8_t> code(16, 0x42);
+  std::vector<uint8_t> empty;
+  CompiledMethod compiled_method(*compiler_driver_, compiler_driver_->GetInstructionSet(), code,
+                                 64, 0x4010, 0, empty, empty, empty);
+  {
+    CompilationCache cache(compiler_driver_.get(), tmp.GetFilename());
+    cache.Load();
+    cache.Insert("key", compiled_method);
+    ASSERT_TRUE(cache.Save());
+  }
+  // The entry is last in the file and ends with the size of its empty gc map, make it claim a
+  // byte that isn't there.
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(tmp.GetFilename(), &contents));
+  ASSERT_LE(4U, contents.size());
+  contents[contents.size() - 4] = 1;
+  UniquePtr<File> file(OS::CreateEmptyFile(tmp.GetFilename().c_str()));
+  ASSERT_TRUE(file.get() != NULL);
+  ASSERT_TRUE(file->WriteFully(contents.data(), contents.size()));
+  ASSERT_EQ(0, file->Close());
+
+  CompilationCache cache(compiler_driver_.get(), tmp.GetFilename());
+  ASSERT_TRUE(cache.Load());
+  EXPECT_TRUE(cache.Lookup("key") == NULL);
+}
+
+TEST_F(CompilationCacheTest, ComputeKey) {
+  TEST_DISABLED_FOR_PORTABLE();
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("StaticLeafMethods");
+  }
+  ASSERT_TRUE(class_loader != NULL);
+  ScratchFile tmp;
+  CompilationCache cache(compiler_driver_.get(), tmp.GetFilename());
+
+  std::string sum2 = ComputeKey(&cache, class_loader, "sum", "(II)I");
+  EXPECT_FALSE(sum2.empty());
+  // The key only depends on the method and what it references.
+  EXPECT_EQ(sum2, ComputeKey(&cache, class_loader, "sum", "(II)I"));
+  // Different code.
+  EXPECT_NE(sum2, ComputeKey(&cache, class_loader, "sum", "(III)I"));
+  // The same code in methods of different signatures.
+  std::string int_identity = ComputeKey(&cache, class_loader, "identity", "(I)I");
+  std::string byte_identity = ComputeKey(&cache, class_loader, "identity", "(B)B");
+  EXPECT_NE(int_identity, byte_identity);
+  EXPECT_NE(sum2, int_identity);
+}
+
+}  // namespace art
@@ -19,12 +19,15 @@
 #define ATRACE_TAG ATRACE_TAG_DALVIK
 #include <utils/Trace.h>
 
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <unistd.h>
 
 #include "base/stl_util.h"
 #include "base/timing_logger.h"
 #include "class_linker.h"
+#include "compilation_cache.h"
 #include "dex_compilation_unit.h"
 #include "dex_file-inl.h"
 #include "dex/verification_results.h"
@@ -40,11 +43,13 @@
 #include "mirror/class_loader.h"
 #include "mirror/class-inl.h"
 #include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/throwable.h"
 #include "scoped_thread_state_change.h"
 #include "ScopedLocalRef.h"
+#include "strutil.h"
 #include "thread.h"
 #include "thread_pool.h"
 #include "trampolines/trampoline_compiler.h"
@@ -350,6 +355,8 @@ CompilerDriver::CompilerDriver(VerificationResults* verification_results,
       instruction_set_features_(instruction_set_features),
       freezing_constructor_lock_("freezing constructor lock"),
       compiled_classes_lock_("compiled classes lock"),
+      clinit_classes_lock_("clinit classes lock"),
+      compile_work_lock_("compile work lock"),
       compiled_methods_lock_("compiled method lock"),
       image_(image),
       image_classes_(image_classes),
@@ -422,6 +429,13 @@ std::vector<uint8_t>* CompilerDriver::DeduplicateGCMap(const std::vector<uint8_t
   return dedupe_gc_map_.Add(Thread::Current(), code);
 }
 
+void CompilerDriver::SealDedupeSets() {
+  dedupe_code_.Seal();
+  dedupe_mapping_table_.Seal();
+  dedupe_vmap_table_.Seal();
+  dedupe_gc_map_.Seal();
+}
+
 CompilerDriver::~CompilerDriver() {
   Thread* self = Thread::Current();
   {
@@ -516,8 +530,23 @@ void CompilerDriver::CompileAll(jobject class_loader,
                                 TimingLogger& timings) {
   DCHECK(!Runtime::Current()->IsStarted());
   UniquePtr<ThreadPool> thread_pool(new ThreadPool("Compiler driver thread pool", thread_count_ - 1));
+  if (compilation_cache_.get() != NULL) {
+    // Image code is patched after compilation, and computing cache keys asks the driver the same
+    // questions as the backend, so the statistics would count them twice.
+    if (image_ || compiler_backend_ != kQuick || dump_stats_) {
+      LOG(WARNING) << "Compilation cache only supports Quick application compiles without stats";
+      compilation_cache_.reset();
+    } else {
+      timings.NewSplit("Load Compilation Cache");
+      compilation_cache_->Load();
+    }
+  }
   PreCompile(class_loader, dex_files, *thread_pool.get(), timings);
   Compile(class_loader, dex_files, *thread_pool.get(), timings);
+  if (compilation_cache_.get() != NULL) {
+    timings.NewSplit("Save Compilation Cache");
+    compilation_cache_->Save();
+  }
   if (dump_stats_) {
     stats_->Dump();
   }
@@ -600,15 +629,6 @@ void CompilerDriver::CompileOne(const mirror::ArtMethod* method, TimingLogger& t
   self->TransitionFromSuspendedToRunnable();
 }
 
-void CompilerDriver::Resolve(jobject class_loader, const std::vector<const DexFile*>& dex_files,
-                             ThreadPool& thread_pool, TimingLogger& timings) {
-  for (size_t i = 0; i != dex_files.size(); ++i) {
-    const DexFile* dex_file = dex_files[i];
-    CHECK(dex_file != NULL);
-    ResolveDexFile(class_loader, *dex_file, thread_pool, timings);
-  }
-}
-
 void CompilerDriver::PreCompile(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                                 ThreadPool& thread_pool, TimingLogger& timings) {
   LoadImageClasses(timings);
@@ -620,6 +640,8 @@ void CompilerDriver::PreCompile(jobject class_loader, const std::vector<const De
   InitializeClasses(class_loader, dex_files, thread_pool, timings);
 
   UpdateImageClasses(timings);
+
+  AnalyzeClassHierarchy(timings);
 }
 
 bool CompilerDriver::IsImageClass(const char* descriptor) const {
@@ -799,6 +821,72 @@ void CompilerDriver::UpdateImageClasses(TimingLogger& timings) {
   }
 }
 
+// The implementations of an interface method seen by AnalyzeClassHierarchyCallback.
+struct InterfaceMethodImplementation {
+  mirror::Class* klass;
+  mirror::ArtMethod* method;
+  bool several;
+};
+typedef SafeMap<MethodReference, InterfaceMethodImplementation, MethodReferenceComparator>
+    InterfaceMethodImplementations;
+
+bool CompilerDriver::AnalyzeClassHierarchyCallback(mirror::Class* klass, void* arg) {
+  if (klass->IsInterface() || klass->IsAbstract() || klass->IsArrayClass() ||
+      klass->IsPrimitive() || !klass->IsResolved()) {
+    return true;
+  }
+  InterfaceMethodImplementations* implementations =
+      reinterpret_cast<InterfaceMethodImplementations*>(arg);
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (int32_t i = 0; i < klass->GetIfTableCount(); ++i) {
+    mirror::Class* interface = iftable->GetInterface(i);
+    size_t num_methods = iftable->GetMethodArrayCount(i);
+    for (size_t j = 0; j < num_methods; ++j) {
+      mirror::ArtMethod* interface_method = interface->GetVirtualMethod(j);
+      mirror::ArtMethod* method = iftable->GetMethodArray(i)->Get(j);
+      MethodReference ref(&MethodHelper(interface_method).GetDexFile(),
+                          interface_method->GetDexMethodIndex());
+      // A call can only check for the class declaring the implementation, so an inherited
+      // implementation counts as another one.
+      bool several = method->IsAbstract() || method->GetDeclaringClass() != klass;
+      auto it = implementations->find(ref);
+      if (it == implementations->end()) {
+        InterfaceMethodImplementation implementation = { klass, method, several };
+        implementations->Put(ref, implementation);
+      } else {
+        it->second.several |= several || it->second.klass != klass;
+      }
+    }
+  }
+  return true;
+}
+
+void CompilerDriver::AnalyzeClassHierarchy(TimingLogger& timings) {
+  if (compiler_backend_ != kQuick) {
+    return;
+  }
+  timings.NewSplit("AnalyzeClassHierarchy");
+  ScopedObjectAccess soa(Thread::Current());
+  InterfaceMethodImplementations implementations;
+  Runtime::Current()->GetClassLinker()->VisitClasses(AnalyzeClassHierarchyCallback,
+                                                     &implementations);
+  mirror::ArtMethod* imt_conflict_method = Runtime::Current()->GetImtConflictMethod();
+  single_implementations_.clear();
+  for (const auto& it : implementations) {
+    SingleImplementation single;
+    single.vtable_idx = -1;
+    single.imt_conflict = false;
+    if (!it.second.several) {
+      mirror::Class* klass = it.second.klass;
+      single.descriptor = ClassHelper(klass).GetDescriptor();
+      single.vtable_idx = it.second.method->GetMethodIndex();
+      uint32_t imt_index = it.first.dex_method_index % ClassLinker::kImtSize;
+      single.imt_conflict = klass->GetImTable()->Get(imt_index) == imt_conflict_method;
+    }
+    single_implementations_.Put(it.first, single);
+  }
+}
+
 bool CompilerDriver::CanAssumeTypeIsPresentInDexCache(const DexFile& dex_file, uint32_t type_idx) {
   if (IsImage() &&
       IsImageClass(dex_file.StringDataByIdx(dex_file.GetTypeId(type_idx).descriptor_idx_))) {
@@ -994,7 +1082,8 @@ static mirror::ArtMethod* ComputeMethodReferencedFromCompilingMethod(ScopedObjec
 }
 
 bool CompilerDriver::ComputeInstanceFieldInfo(uint32_t field_idx, const DexCompilationUnit* mUnit,
-                                              bool is_put, int* field_offset, bool* is_volatile) {
+                                              bool is_put, int* field_offset, bool* is_volatile,
+                                              bool update_stats) {
   ScopedObjectAccess soa(Thread::Current());
   // Conservative defaults.
   *field_offset = -1;
@@ -1015,7 +1104,9 @@ bool CompilerDriver::ComputeInstanceFieldInfo(uint32_t field_idx, const DexCompi
       if (access_ok && !is_write_to_final_from_wrong_class) {
         *field_offset = resolved_field->GetOffset().Int32Value();
         *is_volatile = resolved_field->IsVolatile();
-        stats_->ResolvedInstanceField();
+        if (update_stats) {
+          stats_->ResolvedInstanceField();
+        }
         return true;  // Fast path.
       }
     }
@@ -1024,14 +1115,16 @@ bool CompilerDriver::ComputeInstanceFieldInfo(uint32_t field_idx, const DexCompi
   if (soa.Self()->IsExceptionPending()) {
     soa.Self()->ClearException();
   }
-  stats_->UnresolvedInstanceField();
+  if (update_stats) {
+    stats_->UnresolvedInstanceField();
+  }
   return false;  // Incomplete knowledge needs slow path.
 }
 
 bool CompilerDriver::ComputeStaticFieldInfo(uint32_t field_idx, const DexCompilationUnit* mUnit,
                                             bool is_put, int* field_offset, int* storage_index,
                                             bool* is_referrers_class, bool* is_volatile,
-                                            bool* is_initialized) {
+                                            bool* is_initialized, bool update_stats) {
   ScopedObjectAccess soa(Thread::Current());
   // Conservative defaults.
   *field_offset = -1;
@@ -1052,7 +1145,9 @@ bool CompilerDriver::ComputeStaticFieldInfo(uint32_t field_idx, const DexCompila
         *is_initialized = true;
         *field_offset = resolved_field->GetOffset().Int32Value();
         *is_volatile = resolved_field->IsVolatile();
-        stats_->ResolvedLocalStaticField();
+        if (update_stats) {
+          stats_->ResolvedLocalStaticField();
+        }
         return true;  // fast path
       } else {
         bool access_ok =
@@ -1072,7 +1167,9 @@ bool CompilerDriver::ComputeStaticFieldInfo(uint32_t field_idx, const DexCompila
             *is_volatile = resolved_field->IsVolatile();
             *is_initialized = fields_class->IsInitialized() &&
                 CanAssumeTypeIsPresentInDexCache(*mUnit->GetDexFile(), *storage_index);
-            stats_->ResolvedStaticField();
+            if (update_stats) {
+              stats_->ResolvedStaticField();
+            }
             return true;
           }
           // Search dex file for localized ssb index, may fail if field's class is a parent
@@ -1089,7 +1186,9 @@ bool CompilerDriver::ComputeStaticFieldInfo(uint32_t field_idx, const DexCompila
               *is_volatile = resolved_field->IsVolatile();
               *is_initialized = fields_class->IsInitialized() &&
                   CanAssumeTypeIsPresentInDexCache(*mUnit->GetDexFile(), *storage_index);
-              stats_->ResolvedStaticField();
+              if (update_stats) {
+                stats_->ResolvedStaticField();
+              }
               return true;
             }
           }
@@ -1101,7 +1200,9 @@ bool CompilerDriver::ComputeStaticFieldInfo(uint32_t field_idx, const DexCompila
   if (soa.Self()->IsExceptionPending()) {
     soa.Self()->ClearException();
   }
-  stats_->UnresolvedStaticField();
+  if (update_stats) {
+    stats_->UnresolvedStaticField();
+  }
   return false;  // Incomplete knowledge needs slow path.
 }
 
@@ -1213,6 +1314,40 @@ void CompilerDriver::GetCodeAndMethodForDirectCall(InvokeType* type, InvokeType
   }
 }
 
+bool CompilerDriver::ComputeSingleImplementation(const DexCompilationUnit* mUnit,
+                                                 const MethodReference& target_method,
+                                                 uint16_t* type_idx, int* vtable_idx) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::ArtMethod* resolved_method =
+      ComputeMethodReferencedFromCompilingMethod(soa, mUnit, target_method.dex_method_index,
+                                                 kInterface);
+  if (resolved_method == NULL) {
+    // Clean up any exception left by method resolution.
+    soa.Self()->ClearException();
+    return false;
+  }
+  MethodReference interface_method(&MethodHelper(resolved_method).GetDexFile(),
+                                   resolved_method->GetDexMethodIndex());
+  auto it = single_implementations_.find(interface_method);
+  if (it == single_implementations_.end() || it->second.descriptor.empty() ||
+      !it->second.imt_conflict) {
+    return false;
+  }
+  const DexFile* dex_file = mUnit->GetDexFile();
+  const DexFile::StringId* string_id = dex_file->FindStringId(it->second.descriptor.c_str());
+  if (string_id == NULL) {
+    return false;
+  }
+  const DexFile::TypeId* type_id =
+      dex_file->FindTypeId(dex_file->GetIndexForStringId(*string_id));
+  if (type_id == NULL) {
+    return false;
+  }
+  *type_idx = dex_file->GetIndexForTypeId(*type_id);
+  *vtable_idx = it->second.vtable_idx;
+  return true;
+}
+
 bool CompilerDriver::ComputeInvokeInfo(const DexCompilationUnit* mUnit, const uint32_t dex_pc,
                                        bool update_stats, bool enable_devirtualization,
                                        InvokeType* invoke_type, MethodReference* target_method,
@@ -1420,8 +1555,10 @@ class ParallelCompilationManager {
     return dex_file_;
   }
 
-  void ForAll(size_t begin, size_t end, Callback callback, size_t work_units) {
-    Thread* self = Thread::Current();
+  // Queue work_units tasks calling callback for the indices in [begin, end) without running
+  // them, so that the work of several managers can be run by a single RunTasks. The manager must
+  // outlive the RunTasks.
+  void AddTasks(Thread* self, size_t begin, size_t end, Callback callback, size_t work_units) {
     self->AssertNoPendingException();
     CHECK_GT(work_units, 0U);
 
@@ -1429,14 +1566,18 @@ class ParallelCompilationManager {
     for (size_t i = 0; i < work_units; ++i) {
       thread_pool_->AddTask(self, new ForAllClosure(this, end, callback));
     }
-    thread_pool_->StartWorkers(self);
+  }
+
+  // Run the tasks queued on thread_pool, using the calling thread as one of the workers.
+  static void RunTasks(Thread* self, ThreadPool* thread_pool) {
+    thread_pool->StartWorkers(self);
 
     // Ensure we're suspended while we're blocked waiting for the other threads to finish (worker
     // thread destructor's called below perform join).
     CHECK_NE(self->GetState(), kRunnable);
 
     // Wait for all the worker threads to finish.
-    thread_pool_->Wait(self, true, false);
+    thread_pool->Wait(self, true, false);
   }
 
   size_t NextIndex() {
@@ -1482,6 +1623,28 @@ class ParallelCompilationManager {
   DISALLOW_COPY_AND_ASSIGN(ParallelCompilationManager);
 };
 
+// Call callback for each index in [0, (dex_file->*count)()) of every dex file. The work for all
+// of the dex files is queued up front, so that threads move on to the next dex file rather than
+// waiting at a barrier for the last items of the previous one.
+static void ForAllDexFiles(CompilerDriver* driver, jobject class_loader,
+                           const std::vector<const DexFile*>& dex_files, ThreadPool& thread_pool,
+                           size_t (DexFile::*count)() const,
+                           ParallelCompilationManager::Callback callback, size_t work_units) {
+  Thread* self = Thread::Current();
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  std::vector<ParallelCompilationManager*> contexts;
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile* dex_file = dex_files[i];
+    CHECK(dex_file != NULL);
+    ParallelCompilationManager* context =
+        new ParallelCompilationManager(class_linker, class_loader, driver, dex_file, thread_pool);
+    context->AddTasks(self, 0, (dex_file->*count)(), callback, work_units);
+    contexts.push_back(context);
+  }
+  ParallelCompilationManager::RunTasks(self, &thread_pool);
+  STLDeleteElements(&contexts);
+}
+
 // Return true if the class should be skipped during compilation.
 //
 // The first case where we skip is for redundant class definitions in
@@ -1652,31 +1815,17 @@ static void ResolveType(const ParallelCompilationManager* manager, size_t type_i
   }
 }
 
-void CompilerDriver::ResolveDexFile(jobject class_loader, const DexFile& dex_file,
-                                    ThreadPool& thread_pool, TimingLogger& timings) {
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-
+void CompilerDriver::Resolve(jobject class_loader, const std::vector<const DexFile*>& dex_files,
+                             ThreadPool& thread_pool, TimingLogger& timings) {
   // TODO: we could resolve strings here, although the string table is largely filled with class
   //       and method names.
 
-  ParallelCompilationManager context(class_linker, class_loader, this, &dex_file, thread_pool);
   if (IsImage()) {
     // For images we resolve all types, such as array, whereas for applications just those with
     // classdefs are resolved by ResolveClassFieldsAndMethods.
     timings.NewSplit("Resolve Types");
-    context.ForAll(0, dex_file.NumTypeIds(), ResolveType, thread_count_);
-  }
-
-  timings.NewSplit("Resolve MethodsAndFields");
-  context.ForAll(0, dex_file.NumClassDefs(), ResolveClassFieldsAndMethods, thread_count_);
-}
-
-void CompilerDriver::Verify(jobject class_loader, const std::vector<const DexFile*>& dex_files,
-                            ThreadPool& thread_pool, TimingLogger& timings) {
-  for (size_t i = 0; i != dex_files.size(); ++i) {
-    const DexFile* dex_file = dex_files[i];
-    CHECK(dex_file != NULL);
-    VerifyDexFile(class_loader, *dex_file, thread_pool, timings);
+    ForAllDexFiles(this, class_loader, dex_files, thread_pool, &DexFile::NumTypeIds, ResolveType,
+                   thread_count_);
   }
 }
 
@@ -1725,12 +1874,19 @@ static void VerifyClass(const ParallelCompilationManager* manager, size_t class_
   soa.Self()->AssertNoPendingException();
 }
 
-void CompilerDriver::VerifyDexFile(jobject class_loader, const DexFile& dex_file,
-                                   ThreadPool& thread_pool, TimingLogger& timings) {
-  timings.NewSplit("Verify Dex File");
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-  ParallelCompilationManager context(class_linker, class_loader, this, &dex_file, thread_pool);
-  context.ForAll(0, dex_file.NumClassDefs(), VerifyClass, thread_count_);
+// Resolving the fields and methods of a class and verifying it don't depend on other classes
+// having been through either step, so do both at once rather than with a barrier in between.
+static void ResolveAndVerifyClass(const ParallelCompilationManager* manager,
+                                  size_t class_def_index) LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  ResolveClassFieldsAndMethods(manager, class_def_index);
+  VerifyClass(manager, class_def_index);
+}
+
+void CompilerDriver::Verify(jobject class_loader, const std::vector<const DexFile*>& dex_files,
+                            ThreadPool& thread_pool, TimingLogger& timings) {
+  timings.NewSplit("Resolve MethodsAndFields and Verify");
+  ForAllDexFiles(this, class_loader, dex_files, thread_pool, &DexFile::NumClassDefs,
+                 ResolveAndVerifyClass, thread_count_);
 }
 
 static const char* class_initializer_black_list[] = {
@@ -2151,6 +2307,11 @@ static const char* class_initializer_black_list[] = {
   "Lorg/apache/http/conn/util/InetAddressUtils;",  // Calls regex.Pattern.compile -..-> regex.Pattern.compileImpl.
 };
 
+// Defer running the static initializers of image classes until all other classes have been
+// initialized, then run them concurrently in groups of classes that may depend on each other. When
+// false the initializers run serially from InitializeClass.
+static constexpr bool kParallelClassInitialization = true;
+
 static void InitializeClass(const ParallelCompilationManager* manager, size_t class_def_index)
     LOCKS_EXCLUDED(Locks::mutator_lock_) {
   ATRACE_CALL();
@@ -2202,7 +2363,12 @@ static void InitializeClass(const ParallelCompilationManager* manager, size_t cl
                 }
               }
             }
-            if (!is_black_listed) {
+            if (!is_black_listed && kParallelClassInitialization &&
+                strcmp("Ljava/lang/Void;", descriptor) != 0) {
+              // Run the static initializer once every class has been through here, see
+              // CompilerDriver::InitializeClinitClasses.
+              manager->GetCompiler()->AddClinitClass(ClassReference(&dex_file, class_def_index));
+            } else if (!is_black_listed) {
               VLOG(compiler) << "Initializing: " << descriptor;
               if (strcmp("Ljava/lang/Void;", descriptor) == 0) {
                 // Hand initialize j.l.Void to avoid Dex file operations in un-started runtime.
@@ -2229,7 +2395,8 @@ static void InitializeClass(const ParallelCompilationManager* manager, size_t cl
   soa.Self()->ClearException();
 }
 
-void CompilerDriver::InitializeClasses(jobject jni_class_loader, const DexFile& dex_file,
+void CompilerDriver::InitializeClasses(jobject class_loader,
+                                       const std::vector<const DexFile*>& dex_files,
                                        ThreadPool& thread_pool, TimingLogger& timings) {
   timings.NewSplit("InitializeNoClinit");
 #ifndef NDEBUG
@@ -2241,31 +2408,434 @@ void CompilerDriver::InitializeClasses(jobject jni_class_loader, const DexFile&
     }
   }
 #endif
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-  ParallelCompilationManager context(class_linker, jni_class_loader, this, &dex_file, thread_pool);
-  context.ForAll(0, dex_file.NumClassDefs(), InitializeClass, thread_count_);
+  ForAllDexFiles(this, class_loader, dex_files, thread_pool, &DexFile::NumClassDefs,
+                 InitializeClass, thread_count_);
+  InitializeClinitClasses(class_loader, dex_files, thread_pool, timings);
 }
 
-void CompilerDriver::InitializeClasses(jobject class_loader,
-                                       const std::vector<const DexFile*>& dex_files,
-                                       ThreadPool& thread_pool, TimingLogger& timings) {
+void CompilerDriver::AddClinitClass(ClassReference ref) {
+  MutexLock mu(Thread::Current(), clinit_classes_lock_);
+  clinit_classes_.push_back(ref);
+}
+
+// Strip the array dimensions from a type descriptor.
+static const char* ElementDescriptor(const char* descriptor) {
+  while (*descriptor == '[') {
+    ++descriptor;
+  }
+  return descriptor;
+}
+
+// Whether a call to a method of the class descriptor may initialize classes its caller does not
+// name: reflection, class loading and service lookup.
+static bool IsReflectiveClass(const char* descriptor) {
+  return (strcmp(descriptor, "Ljava/lang/Class;") == 0) ||
+      (strcmp(descriptor, "Ljava/lang/ClassLoader;") == 0) ||
+      (strcmp(descriptor, "Ljava/util/ServiceLoader;") == 0) ||
+      StringPiece(descriptor).starts_with("Ljava/lang/reflect/");
+}
+
+// Add the descriptors of the classes referenced by the code of class_def, these are the classes
+// that running its static initializer may directly cause to be initialized. Set uses_reflection
+// when its code may also reach classes it does not name, through reflection or native methods.
+static void CollectReferencedClasses(const DexFile& dex_file, const DexFile::ClassDef& class_def,
+                                     std::set<const char*, CStringLt>* descriptors,
+                                     bool* uses_reflection) {
+  if (class_def.superclass_idx_ != DexFile::kDexNoIndex16) {
+    descriptors->insert(dex_file.StringByTypeIdx(class_def.superclass_idx_));
+  }
+  const DexFile::TypeList* interfaces = dex_file.GetInterfacesList(class_def);
+  if (interfaces != nullptr) {
+    for (size_t i = 0; i < interfaces->Size(); ++i) {
+      descriptors->insert(dex_file.StringByTypeIdx(interfaces->GetTypeItem(i).type_idx_));
+    }
+  }
+  const byte* class_data = dex_file.GetClassData(class_def);
+  if (class_data == nullptr) {
+    return;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    if ((it.GetMemberAccessFlags() & kAccNative) != 0) {
+      *uses_reflection = true;
+    }
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    if (code_item == nullptr) {
+      continue;
+    }
+    const Instruction* inst = Instruction::At(code_item->insns_);
+    const Instruction* end = Instruction::At(code_item->insns_ +
+                                             code_item->insns_size_in_code_units_);
+    for (; inst < end; inst = inst->Next()) {
+      switch (inst->GetVerifyTypeArgumentB()) {
+        case Instruction::kVerifyRegBField:
+          descriptors->insert(dex_file.GetFieldDeclaringClassDescriptor(
+              dex_file.GetFieldId(inst->VRegB())));
+          break;
+        case Instruction::kVerifyRegBMethod: {
+          const char* declaring_class = dex_file.GetMethodDeclaringClassDescriptor(
+              dex_file.GetMethodId(inst->VRegB()));
+          descriptors->insert(declaring_class);
+          if (IsReflectiveClass(declaring_class)) {
+            *uses_reflection = true;
+          }
+          break;
+        }
+        case Instruction::kVerifyRegBNewInstance:
+        case Instruction::kVerifyRegBType:
+          descriptors->insert(ElementDescriptor(dex_file.StringByTypeIdx(inst->VRegB())));
+          break;
+        default:
+          break;
+      }
+      switch (inst->GetVerifyTypeArgumentC()) {
+        case Instruction::kVerifyRegCField:
+          descriptors->insert(dex_file.GetFieldDeclaringClassDescriptor(
+              dex_file.GetFieldId(inst->VRegC())));
+          break;
+        case Instruction::kVerifyRegCNewArray:
+        case Instruction::kVerifyRegCType:
+          descriptors->insert(ElementDescriptor(dex_file.StringByTypeIdx(inst->VRegC())));
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+static size_t FindClinitGroup(std::vector<size_t>* parents, size_t index) {
+  while ((*parents)[index] != index) {
+    (*parents)[index] = (*parents)[(*parents)[index]];
+    index = (*parents)[index];
+  }
+  return index;
+}
+
+static const size_t kNoClinitNode = static_cast<size_t>(-1);
+
+// Number the strongly connected components of the graph given by succs, so that a component is
+// numbered after every component it reaches. Returns the number of components.
+static size_t FindClinitComponents(const std::vector<std::vector<size_t> >& succs,
+                                   std::vector<size_t>* components) {
+  size_t num_nodes = succs.size();
+  std::vector<size_t> indexes(num_nodes, kNoClinitNode);
+  std::vector<size_t> low_links(num_nodes);
+  std::vector<bool> on_stack(num_nodes, false);
+  std::vector<size_t> stack;
+  // Tarjan's algorithm without recursion, the nodes being visited along with the position of
+  // their next successor.
+  std::vector<std::pair<size_t, size_t> > visits;
+  size_t next_index = 0;
+  size_t num_components = 0;
+  components->assign(num_nodes, kNoClinitNode);
+  for (size_t root = 0; root != num_nodes; ++root) {
+    if (indexes[root] != kNoClinitNode) {
+      continue;
+    }
+    indexes[root] = low_links[root] = next_index++;
+    stack.push_back(root);
+    on_stack[root] = true;
+    visits.push_back(std::make_pair(root, 0U));
+    while (!visits.empty()) {
+      size_t node = visits.back().first;
+      if (visits.back().second != succs[node].size()) {
+        size_t succ = succs[node][visits.back().second++];
+        if (indexes[succ] == kNoClinitNode) {
+          indexes[succ] = low_links[succ] = next_index++;
+          stack.push_back(succ);
+          on_stack[succ] = true;
+          visits.push_back(std::make_pair(succ, 0U));
+        } else if (on_stack[succ]) {
+          low_links[node] = std::min(low_links[node], indexes[succ]);
+        }
+        continue;
+      }
+      visits.pop_back();
+      if (!visits.empty()) {
+        size_t parent = visits.back().first;
+        low_links[parent] = std::min(low_links[parent], low_links[node]);
+      }
+      if (low_links[node] == indexes[node]) {
+        size_t member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = false;
+          (*components)[member] = num_components;
+        } while (member != node);
+        ++num_components;
+      }
+    }
+  }
+  return num_components;
+}
+
+// Runs the static initializers of a group of classes, in order, on a single thread. A group that
+// is not known to be independent of the others is run holding the lock InitializeClass takes.
+class InitializeClinitGroupTask : public Task {
+ public:
+  InitializeClinitGroupTask(CompilerDriver* driver, jobject class_loader,
+                            const std::vector<ClassReference>& classes, bool serial)
+      : driver_(driver), class_loader_(class_loader), classes_(classes), serial_(serial) {}
+
+  virtual void Run(Thread* self) {
+    ATRACE_CALL();
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    for (const ClassReference& ref : classes_) {
+      const DexFile& dex_file = *ref.first;
+      const DexFile::ClassDef& class_def = dex_file.GetClassDef(ref.second);
+      const char* descriptor = dex_file.GetClassDescriptor(class_def);
+      ScopedObjectAccess soa(self);
+      SirtRef<mirror::ClassLoader> class_loader(soa.Self(),
+                                                soa.Decode<mirror::ClassLoader*>(class_loader_));
+      SirtRef<mirror::Class> klass(soa.Self(), class_linker->FindClass(descriptor, class_loader));
+      if (klass.get() != nullptr) {
+        VLOG(compiler) << "Initializing: " << descriptor;
+        if (serial_) {
+          SirtRef<mirror::Class> sirt_klass(soa.Self(), klass->GetClass());
+          ObjectLock<mirror::Class> lock(soa.Self(), &sirt_klass);
+          class_linker->EnsureInitialized(klass, true, true);
+        } else {
+          class_linker->EnsureInitialized(klass, true, true);
+        }
+        soa.Self()->AssertNoPendingException();
+        if (klass->IsInitialized()) {
+          driver_->RecordClassStatus(ref, klass->GetStatus());
+        }
+      }
+      soa.Self()->ClearException();
+    }
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  CompilerDriver* const driver_;
+  const jobject class_loader_;
+  const std::vector<ClassReference> classes_;
+  const bool serial_;
+};
+
+void CompilerDriver::InitializeClinitClasses(jobject class_loader,
+                                             const std::vector<const DexFile*>& dex_files,
+                                             ThreadPool& thread_pool, TimingLogger& timings) {
+  Thread* self = Thread::Current();
+  std::vector<ClassReference> classes;
+  {
+    MutexLock mu(self, clinit_classes_lock_);
+    classes.swap(clinit_classes_);
+  }
+  if (classes.empty()) {
+    return;
+  }
+  timings.NewSplit("InitializeClinit");
+  // Initialize in dex file and class def order, which puts super classes ahead of their
+  // sub-classes, rather than in the order the classes were found by the worker threads.
+  std::map<const DexFile*, size_t> dex_file_order;
   for (size_t i = 0; i != dex_files.size(); ++i) {
-    const DexFile* dex_file = dex_files[i];
-    CHECK(dex_file != NULL);
-    InitializeClasses(class_loader, *dex_file, thread_pool, timings);
+    dex_file_order.insert(std::make_pair(dex_files[i], i));
+  }
+  std::sort(classes.begin(), classes.end(),
+            [&dex_file_order](const ClassReference& lhs, const ClassReference& rhs) {
+    size_t lhs_order = dex_file_order[lhs.first];
+    size_t rhs_order = dex_file_order[rhs.first];
+    return lhs_order != rhs_order ? lhs_order < rhs_order : lhs.second < rhs.second;
+  });
+
+  // Two threads running static initializers that need each other's classes would deadlock, as
+  // would a thread initializing a super class while another initializes a sub-class, and a class
+  // initialized by another thread may see its dependencies initialized in a different order than
+  // the runtime would use. Put each class in the same group as every class with a deferred
+  // initializer that running its own may reach, through the code of any class of the dex files,
+  // deferred or not. Only different groups run concurrently. A group that may reach classes
+  // through reflection or native code has dependencies that can't be seen here, it is run after
+  // the others, like InitializeClass would.
+  std::map<const char*, ClassReference, CStringLt> defined_classes;
+  for (const DexFile* dex_file : dex_files) {
+    for (size_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      // The first definition of a class in the class path is the one that gets loaded.
+      defined_classes.insert(std::make_pair(
+          dex_file->GetClassDescriptor(dex_file->GetClassDef(i)), ClassReference(dex_file, i)));
+    }
+  }
+  // The graph of the classes reachable from the deferred ones, which come first.
+  std::vector<ClassReference> nodes(classes);
+  std::map<ClassReference, size_t> node_indexes;
+  for (size_t i = 0; i != classes.size(); ++i) {
+    node_indexes.insert(std::make_pair(classes[i], i));
+  }
+  std::vector<std::vector<size_t> > succs;
+  std::vector<bool> reflective_nodes;
+  for (size_t i = 0; i != nodes.size(); ++i) {
+    const DexFile& dex_file = *nodes[i].first;
+    std::set<const char*, CStringLt> referenced;
+    bool uses_reflection = false;
+    CollectReferencedClasses(dex_file, dex_file.GetClassDef(nodes[i].second), &referenced,
+                             &uses_reflection);
+    reflective_nodes.push_back(uses_reflection);
+    std::vector<size_t> node_succs;
+    for (const char* descriptor : referenced) {
+      auto defined_it = defined_classes.find(descriptor);
+      if (defined_it == defined_classes.end()) {
+        continue;
+      }
+      auto it = node_indexes.find(defined_it->second);
+      if (it == node_indexes.end()) {
+        it = node_indexes.insert(std::make_pair(defined_it->second, nodes.size())).first;
+        nodes.push_back(defined_it->second);
+      }
+      node_succs.push_back(it->second);
+    }
+    succs.push_back(node_succs);
+  }
+  std::vector<size_t> components;
+  size_t num_components = FindClinitComponents(succs, &components);
+  std::vector<std::vector<size_t> > component_nodes(num_components);
+  for (size_t i = 0; i != nodes.size(); ++i) {
+    component_nodes[components[i]].push_back(i);
+  }
+  std::vector<size_t> parents(classes.size());
+  for (size_t i = 0; i != classes.size(); ++i) {
+    parents[i] = i;
+  }
+  // Every node is reached from a deferred class, so all the deferred classes a component reaches
+  // end up in the same group, and one of them stands for all. Components come after the ones
+  // they reach, so those are done first.
+  std::vector<size_t> reached_classes(num_components, kNoClinitNode);
+  std::vector<bool> reflective_components(num_components, false);
+  for (size_t component = 0; component != num_components; ++component) {
+    size_t reached = kNoClinitNode;
+    bool reflective = false;
+    for (size_t node : component_nodes[component]) {
+      std::vector<size_t> candidates;
+      if (node < classes.size()) {
+        candidates.push_back(node);
+      }
+      reflective = reflective || reflective_nodes[node];
+      for (size_t succ : succs[node]) {
+        if (components[succ] != component) {
+          candidates.push_back(reached_classes[components[succ]]);
+          reflective = reflective || reflective_components[components[succ]];
+        }
+      }
+      for (size_t candidate : candidates) {
+        if (candidate == kNoClinitNode) {
+          continue;
+        }
+        if (reached == kNoClinitNode) {
+          reached = candidate;
+        } else {
+          parents[FindClinitGroup(&parents, candidate)] = FindClinitGroup(&parents, reached);
+        }
+      }
+    }
+    reached_classes[component] = reached;
+    reflective_components[component] = reflective;
+  }
+  std::map<size_t, std::vector<ClassReference> > groups;
+  std::set<size_t> serial_groups;
+  for (size_t i = 0; i != classes.size(); ++i) {
+    size_t group = FindClinitGroup(&parents, i);
+    groups[group].push_back(classes[i]);
+    if (reflective_components[components[i]]) {
+      serial_groups.insert(group);
+    }
+  }
+
+  // Start the largest groups first so that they don't end up running alone at the end.
+  std::vector<const std::vector<ClassReference>*> ordered_groups;
+  std::vector<ClassReference> serial_classes;
+  for (const auto& group : groups) {
+    if (serial_groups.find(group.first) == serial_groups.end()) {
+      ordered_groups.push_back(&group.second);
+    } else {
+      serial_classes.insert(serial_classes.end(), group.second.begin(), group.second.end());
+    }
+  }
+  std::stable_sort(ordered_groups.begin(), ordered_groups.end(),
+                   [](const std::vector<ClassReference>* lhs,
+                      const std::vector<ClassReference>* rhs) {
+    return lhs->size() > rhs->size();
+  });
+  VLOG(compiler) << "Initializing " << (classes.size() - serial_classes.size()) << " classes in "
+                 << ordered_groups.size() << " groups, then " << serial_classes.size()
+                 << " classes serially";
+  self->AssertNoPendingException();
+  for (const std::vector<ClassReference>* group : ordered_groups) {
+    thread_pool.AddTask(self, new InitializeClinitGroupTask(this, class_loader, *group, false));
+  }
+  thread_pool.StartWorkers(self);
+  CHECK_NE(self->GetState(), kRunnable);
+  thread_pool.Wait(self, true, false);
+  if (!serial_classes.empty()) {
+    // Back in dex file and class def order.
+    std::sort(serial_classes.begin(), serial_classes.end(),
+              [&dex_file_order](const ClassReference& lhs, const ClassReference& rhs) {
+      size_t lhs_order = dex_file_order[lhs.first];
+      size_t rhs_order = dex_file_order[rhs.first];
+      return lhs_order != rhs_order ? lhs_order < rhs_order : lhs.second < rhs.second;
+    });
+    InitializeClinitGroupTask serial_task(this, class_loader, serial_classes, true);
+    serial_task.Run(self);
   }
 }
 
 void CompilerDriver::Compile(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                        ThreadPool& thread_pool, TimingLogger& timings) {
+  timings.NewSplit("Collect Methods");
+  ForAllDexFiles(this, class_loader, dex_files, thread_pool, &DexFile::NumClassDefs,
+                 CompilerDriver::CollectCompileWork, thread_count_);
+
+  // Start with the largest methods, so that the threads finish at about the same time rather than
+  // one thread picking up a huge method when the others are almost done. Native and abstract
+  // methods have no code item and are cheap to compile.
+  timings.NewSplit("Sort Methods");
+  std::map<const DexFile*, size_t> dex_file_order;
   for (size_t i = 0; i != dex_files.size(); ++i) {
-    const DexFile* dex_file = dex_files[i];
-    CHECK(dex_file != NULL);
-    CompileDexFile(class_loader, *dex_file, thread_pool, timings);
-  }
+    dex_file_order.insert(std::make_pair(dex_files[i], i));
+  }
+  std::sort(compile_work_.begin(), compile_work_.end(),
+            [&dex_file_order](const MethodWork& lhs, const MethodWork& rhs) {
+    uint32_t lhs_size = (lhs.code_item != NULL) ? lhs.code_item->insns_size_in_code_units_ : 0;
+    uint32_t rhs_size = (rhs.code_item != NULL) ? rhs.code_item->insns_size_in_code_units_ : 0;
+    if (lhs_size != rhs_size) {
+      return lhs_size > rhs_size;
+    }
+    // Collection order depends on thread timing and the dex files' addresses on the heap, don't
+    // let them leak into the compile order.
+    if (lhs.method_idx != rhs.method_idx) {
+      return lhs.method_idx < rhs.method_idx;
+    }
+    return dex_file_order[lhs.dex_file] < dex_file_order[rhs.dex_file];
+  });
+
+  timings.NewSplit("Compile Methods");
+  Thread* self = Thread::Current();
+  ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
+                                     NULL, thread_pool);
+  context.AddTasks(self, 0, compile_work_.size(), CompilerDriver::CompileMethodWork,
+                   thread_count_);
+  ParallelCompilationManager::RunTasks(self, &thread_pool);
+  compile_work_.clear();
 }
 
-void CompilerDriver::CompileClass(const ParallelCompilationManager* manager, size_t class_def_index) {
+void CompilerDriver::CompileMethodWork(const ParallelCompilationManager* manager, size_t index) {
+  ATRACE_CALL();
+  CompilerDriver* driver = manager->GetCompiler();
+  const MethodWork& work = driver->compile_work_[index];
+  driver->CompileMethod(work.code_item, work.access_flags, work.invoke_type, work.class_def_idx,
+                        work.method_idx, manager->GetClassLoader(), *work.dex_file,
+                        work.dex_to_dex_compilation_level);
+}
+
+void CompilerDriver::CollectCompileWork(const ParallelCompilationManager* manager,
+                                        size_t class_def_index) {
   ATRACE_CALL();
   jobject jclass_loader = manager->GetClassLoader();
   const DexFile& dex_file = *manager->GetDexFile();
@@ -2301,8 +2871,8 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager, siz
   while (it.HasNextInstanceField()) {
     it.Next();
   }
-  CompilerDriver* driver = manager->GetCompiler();
-  // Compile direct methods
+  std::vector<MethodWork> work_list;
+  // Collect direct methods
   int64_t previous_direct_method_idx = -1;
   while (it.HasNextDirectMethod()) {
     uint32_t method_idx = it.GetMemberIndex();
@@ -2313,12 +2883,13 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager, siz
       continue;
     }
     previous_direct_method_idx = method_idx;
-    driver->CompileMethod(it.GetMethodCodeItem(), it.GetMemberAccessFlags(),
-                          it.GetMethodInvokeType(class_def), class_def_index,
-                          method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level);
+    MethodWork work = { &dex_file, it.GetMethodCodeItem(), it.GetMemberAccessFlags(),
+                        it.GetMethodInvokeType(class_def), static_cast<uint16_t>(class_def_index),
+                        method_idx, dex_to_dex_compilation_level };
+    work_list.push_back(work);
     it.Next();
   }
-  // Compile virtual methods
+  // Collect virtual methods
   int64_t previous_virtual_method_idx = -1;
   while (it.HasNextVirtualMethod()) {
     uint32_t method_idx = it.GetMemberIndex();
@@ -2329,20 +2900,16 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager, siz
       continue;
     }
     previous_virtual_method_idx = method_idx;
-    driver->CompileMethod(it.GetMethodCodeItem(), it.GetMemberAccessFlags(),
-                          it.GetMethodInvokeType(class_def), class_def_index,
-                          method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level);
+    MethodWork work = { &dex_file, it.GetMethodCodeItem(), it.GetMemberAccessFlags(),
+                        it.GetMethodInvokeType(class_def), static_cast<uint16_t>(class_def_index),
+                        method_idx, dex_to_dex_compilation_level };
+    work_list.push_back(work);
     it.Next();
   }
   DCHECK(!it.HasNext());
-}
-
-void CompilerDriver::CompileDexFile(jobject class_loader, const DexFile& dex_file,
-                                    ThreadPool& thread_pool, TimingLogger& timings) {
-  timings.NewSplit("Compile Dex File");
-  ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
-                                     &dex_file, thread_pool);
-  context.ForAll(0, dex_file.NumClassDefs(), CompilerDriver::CompileClass, thread_count_);
+  CompilerDriver* driver = manager->GetCompiler();
+  MutexLock mu(Thread::Current(), driver->compile_work_lock_);
+  driver->compile_work_.insert(driver->compile_work_.end(), work_list.begin(), work_list.end());
 }
 
 void CompilerDriver::CompileMethod(const DexFile::CodeItem* code_item, uint32_t access_flags,
@@ -2359,7 +2926,8 @@ void CompilerDriver::CompileMethod(const DexFile::CodeItem* code_item, uint32_t
   } else if ((access_flags & kAccAbstract) != 0) {
   } else {
     MethodReference method_ref(&dex_file, method_idx);
-    bool compile = VerificationResults::IsCandidateForCompilation(method_ref, access_flags);
+    bool compile = VerificationResults::IsCandidateForCompilation(method_ref, access_flags) &&
+        IsHotMethod(method_idx, dex_file);
 
     if (compile) {
       CompilerFn compiler = compiler_;
@@ -2372,9 +2940,20 @@ void CompilerDriver::CompileMethod(const DexFile::CodeItem* code_item, uint32_t
         LOG(INFO) << "Using SEA IR to compile..." << std::endl;
       }
 #endif
-      // NOTE: if compiler declines to compile this method, it will return NULL.
-      compiled_method = (*compiler)(*this, code_item, access_flags, invoke_type, class_def_idx,
-                                    method_idx, class_loader, dex_file);
+      std::string cache_key;
+      if (compilation_cache_.get() != NULL) {
+        cache_key = compilation_cache_->ComputeKey(dex_file, code_item, access_flags, invoke_type,
+                                                   class_def_idx, method_idx, class_loader);
+        compiled_method = compilation_cache_->Lookup(cache_key);
+      }
+      if (compiled_method == NULL) {
+        // NOTE: if compiler declines to compile this method, it will return NULL.
+        compiled_method = (*compiler)(*this, code_item, access_flags, invoke_type, class_def_idx,
+                                      method_idx, class_loader, dex_file);
+        if (compiled_method != NULL && compilation_cache_.get() != NULL) {
+          compilation_cache_->Insert(cache_key, *compiled_method);
+        }
+      }
     } else if (dex_to_dex_compilation_level != kDontDexToDexCompile) {
       // TODO: add a mode to disable DEX-to-DEX compilation ?
       (*dex_to_dex_compiler_)(*this, code_item, access_flags,
@@ -2458,6 +3037,24 @@ CompiledMethod* CompilerDriver::GetCompiledMethod(MethodReference ref) const {
   return it->second;
 }
 
+bool CompilerDriver::IsHotMethod(uint32_t method_idx, const DexFile& dex_file) const {
+  if (hot_methods_.get() == NULL) {
+    return true;
+  }
+  return hot_methods_->count(PrettyMethod(method_idx, dex_file, true)) != 0;
+}
+
+bool CompilerDriver::IsHotCodeMethod(uint32_t method_idx, const DexFile& dex_file) const {
+  if (hot_code_methods_.get() == NULL) {
+    return false;
+  }
+  return hot_code_methods_->count(PrettyMethod(method_idx, dex_file, true)) != 0;
+}
+
+void CompilerDriver::SetCompilationCacheFileName(const std::string& filename) {
+  compilation_cache_.reset(new CompilationCache(this, filename));
+}
+
 void CompilerDriver::SetBitcodeFileName(std::string const& filename) {
   typedef void (*SetBitcodeFileNameFn)(CompilerDriver&, std::string const&);
 
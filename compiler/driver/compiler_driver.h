@@ -26,7 +26,7 @@
 #include "compiled_class.h"
 #include "compiled_method.h"
 #include "dex_file.h"
-#include "dex/arena_allocator.h"
+#include "base/arena_allocator.h"
 #include "instruction_set.h"
 #include "invoke_type.h"
 #include "method_reference.h"
@@ -39,6 +39,7 @@
 namespace art {
 
 class AOTCompilationStats;
+class CompilationCache;
 class ParallelCompilationManager;
 class DexCompilationUnit;
 class DexFileToMethodInlinerMap;
@@ -194,16 +195,18 @@ class CompilerDriver {
                           bool* is_type_initialized, bool* use_direct_type_ptr,
                           uintptr_t* direct_type_ptr);
 
-  // Can we fast path instance field access? Computes field's offset and volatility.
+  // Can we fast path instance field access? Computes field's offset and volatility. Optimizations
+  // that only query a field pass update_stats false, so that its access is counted once.
   bool ComputeInstanceFieldInfo(uint32_t field_idx, const DexCompilationUnit* mUnit, bool is_put,
-                                int* field_offset, bool* is_volatile)
+                                int* field_offset, bool* is_volatile, bool update_stats = true)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
   // Can we fastpath static field access? Computes field's offset, volatility and whether the
   // field is within the referrer (which can avoid checking class initialization).
   bool ComputeStaticFieldInfo(uint32_t field_idx, const DexCompilationUnit* mUnit, bool is_put,
                               int* field_offset, int* storage_index,
-                              bool* is_referrers_class, bool* is_volatile, bool* is_initialized)
+                              bool* is_referrers_class, bool* is_volatile, bool* is_initialized,
+                              bool update_stats = true)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
   // Can we fastpath a interface, super class or virtual method call? Computes method's vtable
@@ -214,6 +217,16 @@ class CompilerDriver {
                          uintptr_t* direct_code, uintptr_t* direct_method)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
+  // Is the interface method target_method implemented by a single class, according to class
+  // hierarchy analysis of the classes loaded before compilation, and does that class send the
+  // method to the IMT conflict trampoline? Computes the class's type index in the caller's dex
+  // file and the method's vtable index. The class may not be the only implementation at runtime,
+  // so calls must check for it.
+  bool ComputeSingleImplementation(const DexCompilationUnit* mUnit,
+                                   const MethodReference& target_method, uint16_t* type_idx,
+                                   int* vtable_idx)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
   const VerifiedMethod* GetVerifiedMethod(const DexFile* dex_file, uint32_t method_idx) const;
   bool IsSafeCast(const DexCompilationUnit* mUnit, uint32_t dex_pc);
 
@@ -243,6 +256,36 @@ class CompilerDriver {
 
   void SetBitcodeFileName(std::string const& filename);
 
+  // Reuse methods compiled by earlier runs that were saved to filename, see CompilationCache.
+  void SetCompilationCacheFileName(const std::string& filename);
+
+  // Only compile the methods named in hot_methods, leaving the others to the interpreter. Takes
+  // ownership of hot_methods, which holds PrettyMethod names.
+  void SetHotMethods(std::set<std::string>* hot_methods) {
+    hot_methods_.reset(hot_methods);
+  }
+
+  bool HasHotMethods() const {
+    return hot_methods_.get() != NULL;
+  }
+
+  // Whether a method is to be compiled, true for all methods unless SetHotMethods was called.
+  bool IsHotMethod(uint32_t method_idx, const DexFile& dex_file) const;
+
+  // Lay out the code of the methods named in hot_code_methods ahead of the code of the other
+  // methods, so that the code run at startup shares as few pages as possible with code that
+  // isn't. Takes ownership of hot_code_methods, which holds PrettyMethod names.
+  void SetHotCodeMethods(std::set<std::string>* hot_code_methods) {
+    hot_code_methods_.reset(hot_code_methods);
+  }
+
+  bool HasHotCodeMethods() const {
+    return hot_code_methods_.get() != NULL;
+  }
+
+  // Whether the code of a method goes with the hot code, false unless SetHotCodeMethods was called.
+  bool IsHotCodeMethod(uint32_t method_idx, const DexFile& dex_file) const;
+
   bool GetSupportBootImageFixup() const {
     return support_boot_image_fixup_;
   }
@@ -417,6 +460,10 @@ class CompilerDriver {
   // Checks if class specified by type_idx is one of the image_classes_
   bool IsImageClass(const char* descriptor) const;
 
+  // Record an image class whose static initializer should run once all classes have been
+  // through InitializeClasses.
+  void AddClinitClass(ClassReference ref) LOCKS_EXCLUDED(clinit_classes_lock_);
+
   void RecordClassStatus(ClassReference ref, mirror::Class::Status status)
       LOCKS_EXCLUDED(compiled_classes_lock_);
 
@@ -425,6 +472,13 @@ class CompilerDriver {
   std::vector<uint8_t>* DeduplicateVMapTable(const std::vector<uint8_t>& code);
   std::vector<uint8_t>* DeduplicateGCMap(const std::vector<uint8_t>& code);
 
+  // Stop deduplicating compiled code and tables once compilation is done. OatWriter then frees
+  // each of them once written, so nothing may read the code of compiled methods afterwards.
+  void SealDedupeSets();
+  bool AreDedupeSetsSealed() const {
+    return dedupe_code_.IsSealed();
+  }
+
  private:
   // Compute constant code and method pointers when possible
   void GetCodeAndMethodForDirectCall(InvokeType* type, InvokeType sharp_type,
@@ -442,46 +496,49 @@ class CompilerDriver {
 
   void LoadImageClasses(TimingLogger& timings);
 
-  // Attempt to resolve all type, methods, fields, and strings
-  // referenced from code in the dex file following PathClassLoader
-  // ordering semantics.
+  // Attempt to resolve all types referenced from code in the dex files following
+  // PathClassLoader ordering semantics. Only done for images, see Verify.
   void Resolve(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                ThreadPool& thread_pool, TimingLogger& timings)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
-  void ResolveDexFile(jobject class_loader, const DexFile& dex_file,
-                      ThreadPool& thread_pool, TimingLogger& timings)
-      LOCKS_EXCLUDED(Locks::mutator_lock_);
 
+  // Resolve the fields and methods of each class and verify it.
   void Verify(jobject class_loader, const std::vector<const DexFile*>& dex_files,
-              ThreadPool& thread_pool, TimingLogger& timings);
-  void VerifyDexFile(jobject class_loader, const DexFile& dex_file,
-                     ThreadPool& thread_pool, TimingLogger& timings)
+              ThreadPool& thread_pool, TimingLogger& timings)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
   void InitializeClasses(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                          ThreadPool& thread_pool, TimingLogger& timings)
-      LOCKS_EXCLUDED(Locks::mutator_lock_);
-  void InitializeClasses(jobject class_loader, const DexFile& dex_file,
-                         ThreadPool& thread_pool, TimingLogger& timings)
       LOCKS_EXCLUDED(Locks::mutator_lock_, compiled_classes_lock_);
+  // Run the static initializers deferred by InitializeClasses, see AddClinitClass.
+  void InitializeClinitClasses(jobject class_loader, const std::vector<const DexFile*>& dex_files,
+                               ThreadPool& thread_pool, TimingLogger& timings)
+      LOCKS_EXCLUDED(Locks::mutator_lock_, clinit_classes_lock_);
 
   void UpdateImageClasses(TimingLogger& timings)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // Find the interface methods implemented by a single loaded class, for
+  // ComputeSingleImplementation.
+  void AnalyzeClassHierarchy(TimingLogger& timings)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+  static bool AnalyzeClassHierarchyCallback(mirror::Class* klass, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void FindClinitImageClassesCallback(mirror::Object* object, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   void Compile(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                ThreadPool& thread_pool, TimingLogger& timings);
-  void CompileDexFile(jobject class_loader, const DexFile& dex_file,
-                      ThreadPool& thread_pool, TimingLogger& timings)
-      LOCKS_EXCLUDED(Locks::mutator_lock_);
   void CompileMethod(const DexFile::CodeItem* code_item, uint32_t access_flags,
                      InvokeType invoke_type, uint16_t class_def_idx, uint32_t method_idx,
                      jobject class_loader, const DexFile& dex_file,
                      DexToDexCompilationLevel dex_to_dex_compilation_level)
       LOCKS_EXCLUDED(compiled_methods_lock_);
 
-  static void CompileClass(const ParallelCompilationManager* context, size_t class_def_index)
+  // Queue the methods of a class for CompileMethodWork.
+  static void CollectCompileWork(const ParallelCompilationManager* context, size_t class_def_index)
+      LOCKS_EXCLUDED(Locks::mutator_lock_, compile_work_lock_);
+  static void CompileMethodWork(const ParallelCompilationManager* context, size_t index)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
   std::vector<const CallPatchInformation*> code_to_patch_;
@@ -505,6 +562,26 @@ class CompilerDriver {
   mutable Mutex compiled_classes_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ClassTable compiled_classes_ GUARDED_BY(compiled_classes_lock_);
 
+  // Image classes with static initializers left to run, see AddClinitClass.
+  Mutex clinit_classes_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::vector<ClassReference> clinit_classes_ GUARDED_BY(clinit_classes_lock_);
+
+  // A method waiting to be compiled by Compile.
+  struct MethodWork {
+    const DexFile* dex_file;
+    const DexFile::CodeItem* code_item;
+    uint32_t access_flags;
+    InvokeType invoke_type;
+    uint16_t class_def_idx;
+    uint32_t method_idx;
+    DexToDexCompilationLevel dex_to_dex_compilation_level;
+  };
+  // Methods are compiled rather than classes so that a class with many large methods doesn't
+  // leave a single thread compiling it after the others have run out of work. Appended to by
+  // CollectCompileWork, then sorted and only read while compiling.
+  Mutex compile_work_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::vector<MethodWork> compile_work_;
+
   typedef SafeMap<const MethodReference, CompiledMethod*, MethodReferenceComparator> MethodTable;
   // All method references that this compiler has compiled.
   mutable Mutex compiled_methods_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -520,6 +597,26 @@ class CompilerDriver {
   size_t thread_count_;
   uint64_t start_ns_;
 
+  UniquePtr<CompilationCache> compilation_cache_;
+
+  // The class implementing an interface method, found by AnalyzeClassHierarchy.
+  struct SingleImplementation {
+    // Descriptor of the class, empty if several classes implement the method.
+    std::string descriptor;
+    int vtable_idx;
+    // Whether the class's IMT slot for the method is a conflict.
+    bool imt_conflict;
+  };
+  // Keyed by the interface method. Written before the compile phase, read-only during it.
+  SafeMap<MethodReference, SingleImplementation, MethodReferenceComparator>
+      single_implementations_;
+
+  // The methods a profile found to be hot, NULL if there is no profile.
+  UniquePtr<std::set<std::string> > hot_methods_;
+
+  // The methods whose code is laid out first, NULL if there is no profile for the layout.
+  UniquePtr<std::set<std::string> > hot_code_methods_;
+
   UniquePtr<AOTCompilationStats> stats_;
 
   bool dump_stats_;
@@ -603,10 +700,12 @@ class CompilerDriver {
       return hash;
     }
   };
-  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, 4> dedupe_code_;
-  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, 4> dedupe_mapping_table_;
-  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, 4> dedupe_vmap_table_;
-  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, 4> dedupe_gc_map_;
+  // Enough shards that the compiler threads rarely contend on a lock.
+  static constexpr size_t kDedupeShards = 16;
+  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, kDedupeShards> dedupe_code_;
+  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, kDedupeShards> dedupe_mapping_table_;
+  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, kDedupeShards> dedupe_vmap_table_;
+  DedupeSet<std::vector<uint8_t>, size_t, DedupeHashFunc, kDedupeShards> dedupe_gc_map_;
 
   DISALLOW_COPY_AND_ASSIGN(CompilerDriver);
 };
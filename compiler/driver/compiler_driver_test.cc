@@ -23,6 +23,7 @@
 #include "class_linker.h"
 #include "common_test.h"
 #include "dex_file.h"
+#include "driver/dex_compilation_unit.h"
 #include "gc/heap.h"
 #include "mirror/art_method-inl.h"
 #include "mirror/class.h"
@@ -30,6 +31,7 @@
 #include "mirror/dex_cache-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/object-inl.h"
+#include "object_utils.h"
 
 namespace art {
 
@@ -169,6 +171,60 @@ TEST_F(CompilerDriverTest, AbstractMethodErrorStub) {
   Thread::Current()->ClearException();
 }
 
+TEST_F(CompilerDriverTest, SingleImplementationInterfaceCall) {
+  TEST_DISABLED_FOR_PORTABLE();
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("SingleImplementation");
+  }
+  ASSERT_TRUE(class_loader != NULL);
+  EnsureCompiled(class_loader, "SingleImplementation", "callWithImplementation", "()I", false);
+
+  jclass many_class = env_->FindClass("SingleImplementation$Many");
+  ASSERT_TRUE(many_class != NULL);
+  jmethodID m00 = env_->GetMethodID(many_class, "m00", "()I");
+  jmethodID m01 = env_->GetMethodID(many_class, "m01", "()I");
+  jclass implementation_class = env_->FindClass("SingleImplementation$OnlyImplementation");
+  ASSERT_TRUE(m00 != NULL);
+  ASSERT_TRUE(m01 != NULL);
+  ASSERT_TRUE(implementation_class != NULL);
+  const DexFile* dex_file;
+  uint32_t m00_idx;
+  uint32_t m01_idx;
+  uint16_t implementation_type_idx;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::ArtMethod* method = soa.DecodeMethod(m00);
+    dex_file = &MethodHelper(method).GetDexFile();
+    m00_idx = method->GetDexMethodIndex();
+    m01_idx = soa.DecodeMethod(m01)->GetDexMethodIndex();
+    implementation_type_idx = soa.Decode<mirror::Class*>(implementation_class)->GetDexTypeIndex();
+  }
+
+  // OnlyImplementation is the only class implementing Many, and its IMT slot for m00 is a
+  // conflict, so calls to m00 check for it and call its method directly.
+  DexCompilationUnit unit(NULL, class_loader, class_linker_, *dex_file, NULL, 0, 0, 0, NULL);
+  uint16_t type_idx = 0;
+  int vtable_idx = -1;
+  EXPECT_TRUE(compiler_driver_->ComputeSingleImplementation(
+      &unit, MethodReference(dex_file, m00_idx), &type_idx, &vtable_idx));
+  EXPECT_EQ(implementation_type_idx, type_idx);
+  EXPECT_NE(-1, vtable_idx);
+  // m01 has an IMT slot of its own, which is as fast as the check.
+  EXPECT_FALSE(compiler_driver_->ComputeSingleImplementation(
+      &unit, MethodReference(dex_file, m01_idx), &type_idx, &vtable_idx));
+
+  EXPECT_EQ(1, env_->CallStaticIntMethod(class_, mid_));
+  EXPECT_FALSE(env_->ExceptionCheck());
+
+  // A proxy of Many fails the check and goes through the IMT.
+  jmethodID call_with_proxy = env_->GetStaticMethodID(class_, "callWithProxy", "()I");
+  ASSERT_TRUE(call_with_proxy != NULL);
+  EXPECT_EQ(2, env_->CallStaticIntMethod(class_, call_with_proxy));
+  EXPECT_FALSE(env_->ExceptionCheck());
+}
+
 // TODO: need check-cast test (when stub complete & we can throw/catch
 
 }  // namespace art
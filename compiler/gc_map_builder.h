@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_GC_MAP_BUILDER_H_
+#define ART_COMPILER_GC_MAP_BUILDER_H_
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "gc_map.h"
+#include "safe_map.h"
+
+namespace art {
+
+// Builds the native GC map of a method, read by NativePcOffsetToReferenceMap.
+class NativePcToReferenceMapBuilder {
+ public:
+  NativePcToReferenceMapBuilder(std::vector<uint8_t>* table, size_t references_width)
+      : references_width_(references_width), table_(table) {
+  }
+
+  void AddEntry(uint32_t native_offset, uint32_t dex_pc, const uint8_t* references) {
+    std::vector<uint8_t> bitmap(references, references + references_width_);
+    auto it = bitmap_indexes_.find(bitmap);
+    size_t bitmap_index;
+    if (it != bitmap_indexes_.end()) {
+      bitmap_index = it->second;
+    } else {
+      bitmap_index = bitmaps_.size();
+      bitmap_indexes_.Put(bitmap, bitmap_index);
+      bitmaps_.push_back(bitmap);
+    }
+    Entry entry = { native_offset, dex_pc, bitmap_index };
+    entries_.push_back(entry);
+  }
+
+  // Write the table, see NativePcOffsetToReferenceMap for the layout.
+  void Finish() {
+    // Entries are mostly added in native offset order already.
+    std::stable_sort(entries_.begin(), entries_.end());
+    uint32_t max_native_offset = 0;
+    uint32_t max_dex_pc = 0;
+    for (const Entry& entry : entries_) {
+      max_native_offset = std::max(max_native_offset, entry.native_offset);
+      max_dex_pc = std::max(max_dex_pc, entry.dex_pc);
+    }
+    size_t native_offset_width = ValueWidth(max_native_offset);
+    size_t dex_pc_width = ValueWidth(max_dex_pc);
+    size_t bitmap_index_width = bitmaps_.empty() ? 0 : ValueWidth(bitmaps_.size() - 1);
+    size_t entry_width = native_offset_width + dex_pc_width + bitmap_index_width;
+    table_->resize(NativePcOffsetToReferenceMap::kHeaderSize + entry_width * entries_.size() +
+                   references_width_ * bitmaps_.size());
+    CHECK_LT(native_offset_width, 1U << 3);
+    (*table_)[0] = native_offset_width & 7;
+    CHECK_LT(references_width_, 1U << 13);
+    (*table_)[0] |= (references_width_ << 3) & 0xFF;
+    (*table_)[1] = (references_width_ >> 5) & 0xFF;
+    CHECK_LT(entries_.size(), 1U << 16);
+    (*table_)[2] = entries_.size() & 0xFF;
+    (*table_)[3] = (entries_.size() >> 8) & 0xFF;
+    CHECK_LT(bitmaps_.size(), 1U << 16);
+    (*table_)[4] = bitmaps_.size() & 0xFF;
+    (*table_)[5] = (bitmaps_.size() >> 8) & 0xFF;
+    (*table_)[6] = dex_pc_width;
+    (*table_)[7] = bitmap_index_width;
+    uint8_t* write_pos = &(*table_)[NativePcOffsetToReferenceMap::kHeaderSize];
+    for (const Entry& entry : entries_) {
+      write_pos = WriteValue(write_pos, entry.native_offset, native_offset_width);
+      write_pos = WriteValue(write_pos, entry.dex_pc, dex_pc_width);
+      write_pos = WriteValue(write_pos, entry.bitmap_index, bitmap_index_width);
+    }
+    for (const std::vector<uint8_t>& bitmap : bitmaps_) {
+      if (references_width_ != 0) {
+        memcpy(write_pos, &bitmap[0], references_width_);
+        write_pos += references_width_;
+      }
+    }
+    DCHECK_EQ(static_cast<size_t>(write_pos - &(*table_)[0]), table_->size());
+  }
+
+ private:
+  struct Entry {
+    uint32_t native_offset;
+    uint32_t dex_pc;
+    size_t bitmap_index;
+
+    bool operator<(const Entry& other) const {
+      return native_offset < other.native_offset;
+    }
+  };
+
+  // Width in bytes needed to hold value.
+  static size_t ValueWidth(uint32_t value) {
+    size_t width = 0;
+    while (value != 0) {
+      width++;
+      value >>= 8;
+    }
+    return width;
+  }
+
+  static uint8_t* WriteValue(uint8_t* write_pos, uint32_t value, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+      *write_pos++ = (value >> (i * 8)) & 0xFF;
+    }
+    return write_pos;
+  }
+
+  // Number of bytes used to encode the reference bitmap.
+  const size_t references_width_;
+  std::vector<Entry> entries_;
+  // The distinct bitmaps in the order they were first seen, and their indexes.
+  std::vector<std::vector<uint8_t> > bitmaps_;
+  SafeMap<std::vector<uint8_t>, size_t> bitmap_indexes_;
+  // The table we're building.
+  std::vector<uint8_t>* const table_;
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_GC_MAP_BUILDER_H_
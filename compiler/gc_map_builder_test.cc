@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "gc_map.h"
+#include "gc_map_builder.h"
+#include "gtest/gtest.h"
+
+namespace art {
+
+TEST(GcMapBuilderTest, Empty) {
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, 2);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  EXPECT_EQ(0U, map.NumEntries());
+  EXPECT_EQ(0U, map.NumBitMaps());
+  EXPECT_EQ(2U, map.RegWidth());
+  EXPECT_EQ(table.size(), map.RawSize());
+  EXPECT_EQ(0U, map.FindEntry(0));
+  EXPECT_FALSE(map.HasEntry(0));
+}
+
+TEST(GcMapBuilderTest, SortedByNativePc) {
+  const uint8_t references[] = { 0x01 };
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, sizeof(references));
+  // Slow paths are laid out after the main body, so their entries come out of order.
+  builder.AddEntry(8, 2, references);
+  builder.AddEntry(40, 9, references);
+  builder.AddEntry(2, 0, references);
+  builder.AddEntry(20, 5, references);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(4U, map.NumEntries());
+  EXPECT_EQ(table.size(), map.RawSize());
+  const uint32_t native_pcs[] = { 2, 8, 20, 40 };
+  const uint32_t dex_pcs[] = { 0, 2, 5, 9 };
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(native_pcs[i], map.GetNativePcOffset(i));
+    EXPECT_EQ(dex_pcs[i], map.GetDexPc(i));
+  }
+}
+
+TEST(GcMapBuilderTest, FindEntry) {
+  const uint8_t references[] = { 0x03 };
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, sizeof(references));
+  builder.AddEntry(4, 1, references);
+  builder.AddEntry(10, 3, references);
+  builder.AddEntry(16, 6, references);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(3U, map.NumEntries());
+  // Hits, including the first and last entries.
+  EXPECT_EQ(0U, map.FindEntry(4));
+  EXPECT_EQ(1U, map.FindEntry(10));
+  EXPECT_EQ(2U, map.FindEntry(16));
+  EXPECT_TRUE(map.HasEntry(10));
+  EXPECT_EQ(3U, map.GetDexPc(map.FindEntry(10)));
+  // Misses before the first entry, between entries and past the last one.
+  EXPECT_EQ(3U, map.FindEntry(0));
+  EXPECT_EQ(3U, map.FindEntry(3));
+  EXPECT_EQ(3U, map.FindEntry(5));
+  EXPECT_EQ(3U, map.FindEntry(15));
+  EXPECT_EQ(3U, map.FindEntry(17));
+  EXPECT_EQ(3U, map.FindEntry(0xFFFFFFFFU));
+  EXPECT_FALSE(map.HasEntry(9));
+}
+
+TEST(GcMapBuilderTest, SingleEntry) {
+  const uint8_t references[] = { 0x00 };
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, sizeof(references));
+  builder.AddEntry(0, 0, references);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(1U, map.NumEntries());
+  // An offset and dex pc of 0 take no bytes, the entry is still found.
+  EXPECT_EQ(0U, map.FindEntry(0));
+  EXPECT_EQ(0U, map.GetDexPc(0));
+  EXPECT_EQ(1U, map.FindEntry(1));
+  EXPECT_EQ(table.size(), map.RawSize());
+}
+
+TEST(GcMapBuilderTest, WideValues) {
+  const uint8_t references[] = { 0x80, 0x01 };
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, sizeof(references));
+  builder.AddEntry(0x12345, 0x1FF, references);
+  builder.AddEntry(0xFF, 0x100, references);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(2U, map.NumEntries());
+  EXPECT_EQ(0xFFU, map.GetNativePcOffset(0));
+  EXPECT_EQ(0x100U, map.GetDexPc(0));
+  EXPECT_EQ(0x12345U, map.GetNativePcOffset(1));
+  EXPECT_EQ(0x1FFU, map.GetDexPc(1));
+  EXPECT_EQ(1U, map.FindEntry(0x12345));
+  EXPECT_EQ(2U, map.FindEntry(0x12344));
+  EXPECT_EQ(0, memcmp(references, map.FindBitMap(0xFF), sizeof(references)));
+}
+
+TEST(GcMapBuilderTest, SharedBitMaps) {
+  const uint8_t first[] = { 0x05, 0x00 };
+  const uint8_t second[] = { 0x00, 0x80 };
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, sizeof(first));
+  builder.AddEntry(2, 0, first);
+  builder.AddEntry(6, 2, second);
+  builder.AddEntry(10, 4, first);
+  builder.AddEntry(14, 6, first);
+  builder.AddEntry(18, 8, second);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(5U, map.NumEntries());
+  // Each distinct bitmap is stored once.
+  EXPECT_EQ(2U, map.NumBitMaps());
+  EXPECT_EQ(table.size(), map.RawSize());
+  EXPECT_EQ(map.GetBitMap(0), map.GetBitMap(2));
+  EXPECT_EQ(map.GetBitMap(0), map.GetBitMap(3));
+  EXPECT_EQ(map.GetBitMap(1), map.GetBitMap(4));
+  EXPECT_NE(map.GetBitMap(0), map.GetBitMap(1));
+  EXPECT_EQ(0, memcmp(first, map.FindBitMap(14), sizeof(first)));
+  EXPECT_EQ(0, memcmp(second, map.FindBitMap(18), sizeof(second)));
+}
+
+TEST(GcMapBuilderTest, NoReferences) {
+  std::vector<uint8_t> table;
+  NativePcToReferenceMapBuilder builder(&table, 0);
+  builder.AddEntry(4, 1, NULL);
+  builder.AddEntry(8, 2, NULL);
+  builder.Finish();
+  NativePcOffsetToReferenceMap map(&table[0]);
+  ASSERT_EQ(2U, map.NumEntries());
+  EXPECT_EQ(0U, map.RegWidth());
+  EXPECT_EQ(1U, map.NumBitMaps());
+  EXPECT_EQ(table.size(), map.RawSize());
+  EXPECT_EQ(2U, map.GetDexPc(map.FindEntry(8)));
+}
+
+}  // namespace art
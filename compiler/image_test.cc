@@ -38,9 +38,13 @@ class ImageTest : public CommonTest {
     ReserveImageSpace();
     CommonTest::SetUp();
   }
+
+  // Write an image and load it in a new runtime. If relocate, the first page of where the image
+  // was linked to go is taken, so that it has to be relocated.
+  void TestWriteRead(bool relocate);
 };
 
-TEST_F(ImageTest, WriteRead) {
+void ImageTest::TestWriteRead(bool relocate) {
   ScratchFile tmp_elf;
   {
     {
@@ -122,6 +126,14 @@ TEST_F(ImageTest, WriteRead) {
   // Remove the reservation of the memory for use to load the image.
   UnreserveImageSpace();
 
+  UniquePtr<MemMap> blocker;
+  if (relocate) {
+    byte* blocked = reinterpret_cast<byte*>(requested_image_base);
+    blocker.reset(MemMap::MapAnonymous("image blocker", blocked, kPageSize, PROT_NONE, &error_msg));
+    ASSERT_TRUE(blocker.get() != nullptr) << error_msg;
+    ASSERT_EQ(blocked, blocker->Begin());
+  }
+
   Runtime::Options options;
   std::string image("-Ximage:");
   image.append(tmp_image.GetFilename());
@@ -147,7 +159,11 @@ TEST_F(ImageTest, WriteRead) {
   image_space->VerifyImageAllocations();
   byte* image_begin = image_space->Begin();
   byte* image_end = image_space->End();
-  CHECK_EQ(requested_image_base, reinterpret_cast<uintptr_t>(image_begin));
+  if (relocate) {
+    CHECK_NE(requested_image_base, reinterpret_cast<uintptr_t>(image_begin));
+  } else {
+    CHECK_EQ(requested_image_base, reinterpret_cast<uintptr_t>(image_begin));
+  }
   for (size_t i = 0; i < dex->NumClassDefs(); ++i) {
     const DexFile::ClassDef& class_def = dex->GetClassDef(i);
     const char* descriptor = dex->GetClassDescriptor(class_def);
@@ -165,6 +181,14 @@ TEST_F(ImageTest, WriteRead) {
   }
 }
 
+TEST_F(ImageTest, WriteRead) {
+  TestWriteRead(false);
+}
+
+TEST_F(ImageTest, WriteReadRelocated) {
+  TestWriteRead(true);
+}
+
 TEST_F(ImageTest, ImageHeaderIsValid) {
     uint32_t image_begin = ART_BASE_ADDRESS;
     uint32_t image_size_ = 16 * KB;
@@ -18,6 +18,7 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "base/logging.h"
@@ -165,47 +166,91 @@ bool ImageWriter::Write(const std::string& image_filename,
     return false;
   }
 
+  if (!WriteRelocations(image_file.get())) {
+    PLOG(ERROR) << "Failed to write image file " << image_filename;
+    return false;
+  }
+
   return true;
 }
 
-void ImageWriter::SetImageOffset(mirror::Object* object, size_t offset) {
+// Sort the relocations so that they are applied in address order, a string that had an interned
+// duplicate was copied, and so recorded, twice.
+static void SortRelocations(std::vector<uint32_t>* relocations) {
+  std::sort(relocations->begin(), relocations->end());
+  relocations->erase(std::unique(relocations->begin(), relocations->end()), relocations->end());
+}
+
+bool ImageWriter::WriteRelocations(File* image_file) {
+  const ImageHeader* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
+  CHECK_EQ(image_relocations_.size(), image_header->GetImageRelocationsCount());
+  CHECK_EQ(oat_relocations_.size(), image_header->GetOatRelocationsCount());
+  std::vector<uint32_t> relocations(image_relocations_);
+  relocations.insert(relocations.end(), oat_relocations_.begin(), oat_relocations_.end());
+  CHECK(!relocations.empty());
+  CHECK_EQ(relocations.size() * sizeof(uint32_t), image_header->GetRelocationsSize());
+  return image_file->Write(reinterpret_cast<const char*>(&relocations[0]),
+                           image_header->GetRelocationsSize(),
+                           image_header->GetRelocationsOffset());
+}
+
+void ImageWriter::SetImageBinSlot(mirror::Object* object, uint32_t bin_slot) {
   DCHECK(object != nullptr);
-  DCHECK_NE(offset, 0U);
-  DCHECK(!IsImageOffsetAssigned(object));
-  mirror::Object* obj = reinterpret_cast<mirror::Object*>(image_->Begin() + offset);
-  DCHECK_ALIGNED(obj, kObjectAlignment);
-  image_bitmap_->Set(obj);
+  DCHECK(!IsImageBinSlotAssigned(object));
   // Before we stomp over the lock word, save the hash code for later.
   Monitor::Deflate(Thread::Current(), object);;
   LockWord lw(object->GetLockWord());
   switch (lw.GetState()) {
     case LockWord::kFatLocked: {
-      LOG(FATAL) << "Fat locked object " << obj << " found during object copy";
+      LOG(FATAL) << "Fat locked object " << object << " found during object copy";
       break;
     }
     case LockWord::kThinLocked: {
-      LOG(FATAL) << "Thin locked object " << obj << " found during object copy";
+      LOG(FATAL) << "Thin locked object " << object << " found during object copy";
       break;
     }
     case LockWord::kUnlocked:
       // No hash, don't need to save it.
       break;
     case LockWord::kHashCode:
-      saved_hashes_.push_back(std::make_pair(obj, lw.GetHashCode()));
+      saved_hashes_.push_back(std::make_pair(object, lw.GetHashCode()));
       break;
     default:
       LOG(FATAL) << "Unreachable.";
       break;
   }
-  object->SetLockWord(LockWord::FromForwardingAddress(offset));
-  DCHECK(IsImageOffsetAssigned(object));
+  object->SetLockWord(LockWord::FromForwardingAddress(bin_slot));
+  DCHECK(IsImageBinSlotAssigned(object));
+}
+
+void ImageWriter::AssignImageBinSlot(mirror::Object* object) {
+  COMPILE_ASSERT(kImageObjectBinCount <= (1 << kBinBits), image_object_bin_wont_fit_in_bin_slot);
+  DCHECK(object != nullptr);
+  ImageObjectBin bin = GetImageObjectBin(object, dex_cache_objects_);
+  size_t offset_in_bin = bin_sizes_[bin];
+  CHECK_LE(offset_in_bin, static_cast<size_t>(kBinSlotOffsetMask));
+  SetImageBinSlot(object, (static_cast<uint32_t>(bin) << kBinShift) | offset_in_bin);
+  bin_sizes_[bin] += RoundUp(object->SizeOf(), 8);  // 64-bit alignment
+}
+
+bool ImageWriter::IsImageBinSlotAssigned(const mirror::Object* object) const {
+  DCHECK(object != nullptr);
+  return object->GetLockWord().GetState() == LockWord::kForwardingAddress;
+}
+
+uint32_t ImageWriter::GetImageBinSlot(const mirror::Object* object) const {
+  DCHECK(IsImageBinSlotAssigned(object));
+  return object->GetLockWord().ForwardingAddress();
 }
 
-void ImageWriter::AssignImageOffset(mirror::Object* object) {
+void ImageWriter::SetImageOffset(mirror::Object* object, size_t offset) {
   DCHECK(object != nullptr);
-  SetImageOffset(object, image_end_);
-  image_end_ += RoundUp(object->SizeOf(), 8);  // 64-bit alignment
-  DCHECK_LT(image_end_, image_->Size());
+  DCHECK_NE(offset, 0U);
+  mirror::Object* obj = reinterpret_cast<mirror::Object*>(image_->Begin() + offset);
+  DCHECK_ALIGNED(obj, kObjectAlignment);
+  image_bitmap_->Set(obj);
+  object->SetLockWord(LockWord::FromForwardingAddress(offset));
+  DCHECK(IsImageOffsetAssigned(object));
 }
 
 bool ImageWriter::IsImageOffsetAssigned(const mirror::Object* object) const {
@@ -375,7 +420,7 @@ void ImageWriter::CalculateObjectOffsets(Object* obj) {
   // if it is a string, we want to intern it if its not interned.
   if (obj->GetClass()->IsStringClass()) {
     // we must be an interned string that was forward referenced and already assigned
-    if (IsImageOffsetAssigned(obj)) {
+    if (IsImageBinSlotAssigned(obj)) {
       DCHECK_EQ(obj, obj->AsString()->Intern());
       return;
     }
@@ -383,18 +428,18 @@ void ImageWriter::CalculateObjectOffsets(Object* obj) {
     SirtRef<Object> sirt_obj(self, obj);
     mirror::String* interned = obj->AsString()->Intern();
     if (sirt_obj.get() != interned) {
-      if (!IsImageOffsetAssigned(interned)) {
+      if (!IsImageBinSlotAssigned(interned)) {
         // interned obj is after us, allocate its location early
-        AssignImageOffset(interned);
+        AssignImageBinSlot(interned);
       }
       // point those looking for this object to the interned version.
-      SetImageOffset(sirt_obj.get(), GetImageOffset(interned));
+      SetImageBinSlot(sirt_obj.get(), GetImageBinSlot(interned));
       return;
     }
     // else (obj == interned), nothing to do but fall through to the normal case
   }
 
-  AssignImageOffset(obj);
+  AssignImageBinSlot(obj);
 }
 
 ObjectArray<Object>* ImageWriter::CreateImageRoots() const {
@@ -456,7 +501,7 @@ void ImageWriter::WalkInstanceFields(mirror::Object* obj, mirror::Class* klass)
 
 // For an unvisited object, visit it then all its children found via fields.
 void ImageWriter::WalkFieldsInOrder(mirror::Object* obj) {
-  if (!IsImageOffsetAssigned(obj)) {
+  if (!IsImageBinSlotAssigned(obj)) {
     // Walk instance fields of all objects
     Thread* self = Thread::Current();
     SirtRef<mirror::Object> sirt_obj(self, obj);
@@ -495,11 +540,26 @@ void ImageWriter::WalkFieldsCallback(mirror::Object* obj, void* arg) {
   writer->WalkFieldsInOrder(obj);
 }
 
+void ImageWriter::UnbinObjectIntoOffset(mirror::Object* obj) {
+  uint32_t bin_slot = GetImageBinSlot(obj);
+  SetImageOffset(obj, bin_offsets_[bin_slot >> kBinShift] + (bin_slot & kBinSlotOffsetMask));
+}
+
+void ImageWriter::UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg) {
+  ImageWriter* writer = reinterpret_cast<ImageWriter*>(arg);
+  DCHECK(writer != nullptr);
+  writer->UnbinObjectIntoOffset(obj);
+}
+
 void ImageWriter::CalculateNewObjectOffsets(size_t oat_loaded_size, size_t oat_data_offset) {
   CHECK_NE(0U, oat_loaded_size);
   Thread* self = Thread::Current();
   SirtRef<ObjectArray<Object> > image_roots(self, CreateImageRoots());
 
+  for (DexCache* dex_cache : Runtime::Current()->GetClassLinker()->GetDexCaches()) {
+    AddDexCacheObjects(dex_cache, &dex_cache_objects_);
+  }
+
   gc::Heap* heap = Runtime::Current()->GetHeap();
   DCHECK_EQ(0U, image_end_);
 
@@ -512,10 +572,25 @@ void ImageWriter::CalculateNewObjectOffsets(size_t oat_loaded_size, size_t oat_d
     // TODO: Image spaces only?
     const char* old = self->StartAssertNoThreadSuspension("ImageWriter");
     DCHECK_LT(image_end_, image_->Size());
-    // Clear any pre-existing monitors which may have been in the monitor words.
+    // Clear any pre-existing monitors which may have been in the monitor words, and give every
+    // object a slot in its bin.
     heap->VisitObjects(WalkFieldsCallback, this);
+    // Place the bins one after the other. The likely dirty objects start on a page of their own, so
+    // that writing them doesn't unshare the pages of the clean objects.
+    for (size_t i = 0; i != kImageObjectBinCount; ++i) {
+      if (i == kImageObjectBinLikelyDirty) {
+        image_end_ = RoundUp(image_end_, kPageSize);
+      }
+      bin_offsets_[i] = image_end_;
+      image_end_ += bin_sizes_[i];
+    }
+    CHECK_LT(image_end_, image_->Size());
+    heap->VisitObjects(UnbinObjectsIntoOffsetCallback, this);
     self->EndAssertNoThreadSuspension(old);
   }
+  VLOG(compiler) << "Image object bins: strings=" << PrettySize(bin_sizes_[kImageObjectBinString])
+                 << " clean=" << PrettySize(bin_sizes_[kImageObjectBinClean])
+                 << " likely dirty=" << PrettySize(bin_sizes_[kImageObjectBinLikelyDirty]);
 
   const byte* oat_file_begin = image_begin_ + RoundUp(image_end_, kPageSize);
   const byte* oat_file_end = oat_file_begin + oat_loaded_size;
@@ -554,7 +629,7 @@ void ImageWriter::CopyAndFixupObjects()
   heap->VisitObjects(CopyAndFixupObjectsCallback, this);
   // Fix up the object previously had hash codes.
   for (const std::pair<mirror::Object*, uint32_t>& hash_pair : saved_hashes_) {
-    hash_pair.first->SetLockWord(LockWord::FromHashCode(hash_pair.second));
+    GetLocalAddress(hash_pair.first)->SetLockWord(LockWord::FromHashCode(hash_pair.second));
   }
   saved_hashes_.clear();
   self->EndAssertNoThreadSuspension(old_cause);
@@ -582,6 +657,7 @@ void ImageWriter::FixupObject(const Object* orig, Object* copy) {
   DCHECK(orig != NULL);
   DCHECK(copy != NULL);
   copy->SetClass(down_cast<Class*>(GetImageAddress(orig->GetClass())));
+  AddImageRelocation(copy, Object::ClassOffset());
   // TODO: special case init of pointers to malloc data (or removal of these pointers)
   if (orig->IsClass()) {
     FixupClass(orig->AsClass(), down_cast<Class*>(copy));
@@ -649,6 +725,7 @@ void ImageWriter::FixupMethod(const ArtMethod* orig, ArtMethod* copy) {
         // The native method's pointer is set to a stub to lookup via dlsym.
         // Note this is not the code_ pointer, that is handled above.
         copy->SetNativeMethod(GetOatAddress(jni_dlsym_lookup_offset_));
+        AddImageRelocation(copy, ArtMethod::NativeMethodOffset());
       } else {
         // Normal (non-abstract non-native) methods have various tables to relocate.
         uint32_t mapping_table_off = orig->GetOatMappingTableOffset();
@@ -662,15 +739,23 @@ void ImageWriter::FixupMethod(const ArtMethod* orig, ArtMethod* copy) {
         uint32_t native_gc_map_offset = orig->GetOatNativeGcMapOffset();
         const byte* native_gc_map = GetOatAddress(native_gc_map_offset);
         copy->SetNativeGcMap(reinterpret_cast<const uint8_t*>(native_gc_map));
+
+        AddImageRelocation(copy, ArtMethod::MappingTableOffset());
+        AddImageRelocation(copy, ArtMethod::VmapTableOffset());
+        AddImageRelocation(copy, ArtMethod::NativeGcMapOffset());
       }
     }
+    AddImageRelocation(copy, ArtMethod::EntryPointFromInterpreterOffset());
   }
+  AddImageRelocation(copy, ArtMethod::EntryPointFromCompiledCodeOffset());
 }
 
 void ImageWriter::FixupObjectArray(const ObjectArray<Object>* orig, ObjectArray<Object>* copy) {
+  const size_t data_offset = ObjectArray<Object>::DataOffset(sizeof(Object*)).Uint32Value();
   for (int32_t i = 0; i < orig->GetLength(); ++i) {
     const Object* element = orig->Get(i);
     copy->SetPtrWithoutChecks(i, GetImageAddress(element));
+    AddImageRelocation(copy, MemberOffset(data_offset + i * sizeof(Object*)));
   }
 }
 
@@ -700,6 +785,7 @@ void ImageWriter::FixupFields(const Object* orig,
       const Object* ref = orig->GetFieldObject<const Object*>(byte_offset, false);
       // Use SetFieldPtr to avoid card marking since we are writing to the image.
       copy->SetFieldPtr(byte_offset, GetImageAddress(ref), false);
+      AddImageRelocation(copy, byte_offset);
       ref_offsets &= ~(CLASS_HIGH_BIT >> right_shift);
     }
   } else {
@@ -721,6 +807,7 @@ void ImageWriter::FixupFields(const Object* orig,
         const Object* ref = orig->GetFieldObject<const Object*>(field_offset, false);
         // Use SetFieldPtr to avoid card marking since we are writing to the image.
         copy->SetFieldPtr(field_offset, GetImageAddress(ref), false);
+        AddImageRelocation(copy, field_offset);
       }
     }
   }
@@ -731,6 +818,14 @@ void ImageWriter::FixupFields(const Object* orig,
     const Object* ref = orig->GetFieldObject<const Object*>(field_offset, false);
     // Use SetFieldPtr to avoid card marking since we are writing to the image.
     copy->SetFieldPtr(field_offset, GetImageAddress(ref), false);
+    AddImageRelocation(copy, field_offset);
+  }
+}
+
+void ImageWriter::AddImageRelocation(const Object* copy, MemberOffset offset) {
+  const byte* word = reinterpret_cast<const byte*>(copy) + offset.Uint32Value();
+  if (*reinterpret_cast<const uint32_t*>(word) != 0) {
+    image_relocations_.push_back(word - image_->Begin());
   }
 }
 
@@ -807,9 +902,12 @@ void ImageWriter::PatchOatCodeAndMethods() {
     SetPatchLocation(patch, reinterpret_cast<uint32_t>(GetImageAddress(target)));
   }
 
-  // Update the image header with the new checksum after patching
+  // Update the image header with the new checksum and the relocations after patching
   ImageHeader* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
   image_header->SetOatChecksum(oat_file_->GetOatHeader().GetChecksum());
+  SortRelocations(&image_relocations_);
+  SortRelocations(&oat_relocations_);
+  image_header->SetRelocationsCounts(image_relocations_.size(), oat_relocations_.size());
   self->EndAssertNoThreadSuspension(old_cause);
 }
 
@@ -846,6 +944,8 @@ void ImageWriter::SetPatchLocation(const CompilerDriver::PatchInformation* patch
   }
   *patch_location = value;
   oat_header.UpdateChecksum(patch_location, sizeof(value));
+  oat_relocations_.push_back(reinterpret_cast<uint8_t*>(patch_location) -
+                             reinterpret_cast<uint8_t*>(&oat_header));
 }
 
 }  // namespace art
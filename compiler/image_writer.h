@@ -19,11 +19,13 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <set>
 #include <string>
 
 #include "driver/compiler_driver.h"
+#include "image.h"
 #include "mem_map.h"
 #include "oat_file.h"
 #include "mirror/dex_cache.h"
@@ -42,7 +44,10 @@ class ImageWriter {
         oat_data_begin_(NULL), interpreter_to_interpreter_bridge_offset_(0),
         interpreter_to_compiled_code_bridge_offset_(0), portable_imt_conflict_trampoline_offset_(0),
         portable_resolution_trampoline_offset_(0), quick_imt_conflict_trampoline_offset_(0),
-        quick_resolution_trampoline_offset_(0) {}
+        quick_resolution_trampoline_offset_(0) {
+    std::fill(bin_sizes_, bin_sizes_ + kImageObjectBinCount, 0);
+    std::fill(bin_offsets_, bin_offsets_ + kImageObjectBinCount, 0);
+  }
 
   ~ImageWriter() {}
 
@@ -62,8 +67,18 @@ class ImageWriter {
   // Mark the objects defined in this space in the given live bitmap.
   void RecordImageAllocations() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  // We use the lock word to store the offset of the object in the image.
-  void AssignImageOffset(mirror::Object* object) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // A bin slot holds the bin of an object in the top kBinBits and its offset within the bin below.
+  static constexpr size_t kBinBits = 2;
+  static constexpr size_t kBinShift = 32 - kBinBits;
+  static constexpr uint32_t kBinSlotOffsetMask = (1U << kBinShift) - 1;
+
+  // We use the lock word to store the bin slot of the object while objects are laid out, and its
+  // offset in the image once the bins have been placed.
+  void AssignImageBinSlot(mirror::Object* object) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void SetImageBinSlot(mirror::Object* object, uint32_t bin_slot)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  bool IsImageBinSlotAssigned(const mirror::Object* object) const;
+  uint32_t GetImageBinSlot(const mirror::Object* object) const;
   void SetImageOffset(mirror::Object* object, size_t offset)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   bool IsImageOffsetAssigned(const mirror::Object* object) const;
@@ -137,6 +152,12 @@ class ImageWriter {
   static void WalkFieldsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Turns the bin slot of an object into its offset, once the bins have been placed.
+  void UnbinObjectIntoOffset(mirror::Object* obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Creates the contiguous image in memory and adjusts pointers.
   void CopyAndFixupObjects();
   static void CopyAndFixupObjectsCallback(mirror::Object* obj, void* arg)
@@ -158,12 +179,19 @@ class ImageWriter {
                    bool is_static)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Record that the field at offset in copy holds an address that moves with the image, unless it
+  // is null.
+  void AddImageRelocation(const mirror::Object* copy, MemberOffset offset);
+
   // Patches references in OatFile to expect runtime addresses.
   void PatchOatCodeAndMethods()
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void SetPatchLocation(const CompilerDriver::PatchInformation* patch, uint32_t value)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Writes the relocations after the image bitmap.
+  bool WriteRelocations(File* image_file);
+
 
   const CompilerDriver& compiler_driver_;
 
@@ -179,9 +207,20 @@ class ImageWriter {
   // Beginning target image address for the output image.
   byte* image_begin_;
 
-  // Saved hashes (objects are inside of the image so that they don't move).
+  // Saved hashes of the objects whose lock words were taken over by their bin slot.
   std::vector<std::pair<mirror::Object*, uint32_t> > saved_hashes_;
 
+  // The dex caches and their arrays, for GetImageObjectBin.
+  std::set<mirror::Object*> dex_cache_objects_;
+
+  // Offsets of the words holding addresses in the image and in the oat data.
+  std::vector<uint32_t> image_relocations_;
+  std::vector<uint32_t> oat_relocations_;
+
+  // Number of bytes laid out in each bin, and where each bin starts in the image.
+  size_t bin_sizes_[kImageObjectBinCount];
+  size_t bin_offsets_[kImageObjectBinCount];
+
   // Beginning target oat address for the pointers from the output image to its oat file.
   const byte* oat_data_begin_;
 
@@ -18,6 +18,8 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+
 #include "base/bit_vector.h"
 #include "base/stl_util.h"
 #include "base/unix_file/fd_file.h"
@@ -33,10 +35,33 @@
 #include "output_stream.h"
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
+#include "thread_pool.h"
 #include "verifier/method_verifier.h"
 
 namespace art {
 
+// Number of ClassDefs laid out by one task.
+static constexpr size_t kClassDefsPerSegment = 256;
+
+class OatWriter::SegmentTask : public Task {
+ public:
+  SegmentTask(OatWriter* oat_writer, SegmentVisitor visitor, CodeSegment* segment)
+      : oat_writer_(oat_writer), visitor_(visitor), segment_(segment) {}
+
+  virtual void Run(Thread* self) {
+    (oat_writer_->*visitor_)(segment_);
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  OatWriter* const oat_writer_;
+  const SegmentVisitor visitor_;
+  CodeSegment* const segment_;
+};
+
 OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
                      uint32_t image_file_location_oat_checksum,
                      uint32_t image_file_location_oat_begin,
@@ -81,28 +106,37 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     size_oat_class_method_offsets_(0) {
   size_t offset;
   {
-    TimingLogger::ScopedSplit split("InitOatHeader", timings);
-    offset = InitOatHeader();
-  }
-  {
-    TimingLogger::ScopedSplit split("InitOatDexFiles", timings);
-    offset = InitOatDexFiles(offset);
-  }
-  {
-    TimingLogger::ScopedSplit split("InitDexFiles", timings);
-    offset = InitDexFiles(offset);
-  }
-  {
-    TimingLogger::ScopedSplit split("InitOatClasses", timings);
-    offset = InitOatClasses(offset);
-  }
-  {
-    TimingLogger::ScopedSplit split("InitOatCode", timings);
-    offset = InitOatCode(offset);
+    // The thread pool is waited on, which mustn't be done while holding the mutator lock.
+    ScopedThreadStateChange tsc(Thread::Current(), kNative);
+    ThreadPool thread_pool("Oat writer thread pool", compiler->GetThreadCount() - 1);
+    {
+      TimingLogger::ScopedSplit split("InitOatHeader", timings);
+      offset = InitOatHeader();
+    }
+    {
+      TimingLogger::ScopedSplit split("InitOatDexFiles", timings);
+      offset = InitOatDexFiles(offset);
+    }
+    {
+      TimingLogger::ScopedSplit split("InitDexFiles", timings);
+      offset = InitDexFiles(offset);
+    }
+    {
+      TimingLogger::ScopedSplit split("InitOatClasses", timings);
+      offset = InitOatClasses(offset, &thread_pool);
+    }
+    {
+      TimingLogger::ScopedSplit split("InitOatCode", timings);
+      offset = InitOatCode(offset);
+    }
+    {
+      TimingLogger::ScopedSplit split("InitOatCodeSegments", timings);
+      offset = InitOatCodeSegments(offset, &thread_pool);
+    }
   }
-  {
-    TimingLogger::ScopedSplit split("InitOatCodeDexFiles", timings);
-    offset = InitOatCodeDexFiles(offset);
+  if (compiler->IsImage()) {
+    TimingLogger::ScopedSplit split("InitImageMethods", timings);
+    InitImageMethods();
   }
   size_ = offset;
 
@@ -114,6 +148,7 @@ OatWriter::~OatWriter() {
   delete oat_header_;
   STLDeleteElements(&oat_dex_files_);
   STLDeleteElements(&oat_classes_);
+  STLDeleteElements(&code_segments_);
 }
 
 size_t OatWriter::InitOatHeader() {
@@ -158,80 +193,104 @@ size_t OatWriter::InitDexFiles(size_t offset) {
   return offset;
 }
 
-size_t OatWriter::InitOatClasses(size_t offset) {
+size_t OatWriter::InitOatClasses(size_t offset, ThreadPool* thread_pool) {
+  // split the ClassDefs into segments
+  size_t oat_class_index = 0;
+  for (size_t i = 0; i != dex_files_->size(); ++i) {
+    const DexFile* dex_file = (*dex_files_)[i];
+    for (size_t class_def_begin = 0;
+         class_def_begin < dex_file->NumClassDefs();
+         class_def_begin += kClassDefsPerSegment) {
+      size_t class_def_end = std::min<size_t>(class_def_begin + kClassDefsPerSegment,
+                                              dex_file->NumClassDefs());
+      code_segments_.push_back(new CodeSegment(dex_file, class_def_begin, class_def_end,
+                                               oat_class_index + class_def_begin));
+    }
+    oat_class_index += dex_file->NumClassDefs();
+  }
+
   // create the OatClasses
+  oat_classes_.resize(oat_class_index, NULL);
+  ForAllSegments(thread_pool, &OatWriter::InitOatClassesSegment);
+
   // calculate the offsets within OatDexFiles to OatClasses
+  oat_class_index = 0;
   for (size_t i = 0; i != dex_files_->size(); ++i) {
     const DexFile* dex_file = (*dex_files_)[i];
     for (size_t class_def_index = 0;
          class_def_index < dex_file->NumClassDefs();
-         class_def_index++) {
+         class_def_index++, oat_class_index++) {
       oat_dex_files_[i]->methods_offsets_[class_def_index] = offset;
-      const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
-      const byte* class_data = dex_file->GetClassData(class_def);
-      uint32_t num_non_null_compiled_methods = 0;
-      UniquePtr<std::vector<CompiledMethod*> > compiled_methods(new std::vector<CompiledMethod*>());
-      if (class_data != NULL) {  // ie not an empty class, such as a marker interface
-        ClassDataItemIterator it(*dex_file, class_data);
-        size_t num_direct_methods = it.NumDirectMethods();
-        size_t num_virtual_methods = it.NumVirtualMethods();
-        size_t num_methods = num_direct_methods + num_virtual_methods;
-
-        // Fill in the compiled_methods_ array for methods that have a
-        // CompiledMethod. We track the number of non-null entries in
-        // num_non_null_compiled_methods since we only want to allocate
-        // OatMethodOffsets for the compiled methods.
-        compiled_methods->reserve(num_methods);
-        while (it.HasNextStaticField()) {
-          it.Next();
-        }
-        while (it.HasNextInstanceField()) {
-          it.Next();
-        }
-        size_t class_def_method_index = 0;
-        while (it.HasNextDirectMethod()) {
-          uint32_t method_idx = it.GetMemberIndex();
-          CompiledMethod* compiled_method =
-              compiler_driver_->GetCompiledMethod(MethodReference(dex_file, method_idx));
-          compiled_methods->push_back(compiled_method);
-          if (compiled_method != NULL) {
-              num_non_null_compiled_methods++;
-          }
-          class_def_method_index++;
-          it.Next();
+      OatClass* oat_class = oat_classes_[oat_class_index];
+      oat_class->offset_ = offset;
+      offset += oat_class->SizeOf();
+    }
+    oat_dex_files_[i]->UpdateChecksum(*oat_header_);
+  }
+  return offset;
+}
+
+void OatWriter::InitOatClassesSegment(CodeSegment* segment) {
+  const DexFile* dex_file = segment->dex_file_;
+  for (size_t class_def_index = segment->class_def_begin_;
+       class_def_index < segment->class_def_end_;
+       class_def_index++) {
+    const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+    const byte* class_data = dex_file->GetClassData(class_def);
+    uint32_t num_non_null_compiled_methods = 0;
+    UniquePtr<std::vector<CompiledMethod*> > compiled_methods(new std::vector<CompiledMethod*>());
+    std::vector<bool> hot_code;
+    if (class_data != NULL) {  // ie not an empty class, such as a marker interface
+      ClassDataItemIterator it(*dex_file, class_data);
+      size_t num_direct_methods = it.NumDirectMethods();
+      size_t num_virtual_methods = it.NumVirtualMethods();
+      size_t num_methods = num_direct_methods + num_virtual_methods;
+
+      // Fill in the compiled_methods_ array for methods that have a
+      // CompiledMethod. We track the number of non-null entries in
+      // num_non_null_compiled_methods since we only want to allocate
+      // OatMethodOffsets for the compiled methods.
+      compiled_methods->reserve(num_methods);
+      while (it.HasNextStaticField()) {
+        it.Next();
+      }
+      while (it.HasNextInstanceField()) {
+        it.Next();
+      }
+      while (it.HasNext()) {
+        uint32_t method_idx = it.GetMemberIndex();
+        CompiledMethod* compiled_method =
+            compiler_driver_->GetCompiledMethod(MethodReference(dex_file, method_idx));
+        compiled_methods->push_back(compiled_method);
+        if (compiled_method != NULL) {
+            num_non_null_compiled_methods++;
         }
-        while (it.HasNextVirtualMethod()) {
-          uint32_t method_idx = it.GetMemberIndex();
-          CompiledMethod* compiled_method =
-              compiler_driver_->GetCompiledMethod(MethodReference(dex_file, method_idx));
-          compiled_methods->push_back(compiled_method);
-          if (compiled_method != NULL) {
-              num_non_null_compiled_methods++;
-          }
-          class_def_method_index++;
-          it.Next();
+        if (compiler_driver_->HasHotCodeMethods()) {
+          hot_code.push_back(compiled_method != NULL &&
+                             compiler_driver_->IsHotCodeMethod(method_idx, *dex_file));
         }
+        it.Next();
       }
+    }
 
-      ClassReference class_ref(dex_file, class_def_index);
-      CompiledClass* compiled_class = compiler_driver_->GetCompiledClass(class_ref);
-      mirror::Class::Status status;
-      if (compiled_class != NULL) {
-        status = compiled_class->GetStatus();
-      } else if (compiler_driver_->GetVerificationResults()->IsClassRejected(class_ref)) {
-        status = mirror::Class::kStatusError;
-      } else {
-        status = mirror::Class::kStatusNotReady;
-      }
-
-      OatClass* oat_class = new OatClass(offset, compiled_methods.release(),
-                                         num_non_null_compiled_methods, status);
-      oat_classes_.push_back(oat_class);
-      offset += oat_class->SizeOf();
+    ClassReference class_ref(dex_file, class_def_index);
+    CompiledClass* compiled_class = compiler_driver_->GetCompiledClass(class_ref);
+    mirror::Class::Status status;
+    if (compiled_class != NULL) {
+      status = compiled_class->GetStatus();
+    } else if (compiler_driver_->GetVerificationResults()->IsClassRejected(class_ref)) {
+      status = mirror::Class::kStatusError;
+    } else {
+      status = mirror::Class::kStatusNotReady;
     }
-    oat_dex_files_[i]->UpdateChecksum(*oat_header_);
+
+    size_t oat_class_index =
+        segment->oat_class_begin_ + class_def_index - segment->class_def_begin_;
+    OatClass* oat_class = new OatClass(compiled_methods.release(),
+                                       num_non_null_compiled_methods, status);
+    oat_class->hot_code_.swap(hot_code);
+    oat_classes_[oat_class_index] = oat_class;
   }
-  return offset;
 }
 
 size_t OatWriter::InitOatCode(size_t offset) {
@@ -275,223 +334,287 @@ size_t OatWriter::InitOatCode(size_t offset) {
   return offset;
 }
 
-size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
-  size_t oat_class_index = 0;
-  for (size_t i = 0; i != dex_files_->size(); ++i) {
-    const DexFile* dex_file = (*dex_files_)[i];
-    CHECK(dex_file != NULL);
-    offset = InitOatCodeDexFile(offset, &oat_class_index, *dex_file);
+size_t OatWriter::InitOatCodeSegments(size_t offset, ThreadPool* thread_pool) {
+  // Each code array and table is written by the first segment that uses it, in the hot region if
+  // any hot method uses it.
+  for (CodeSegment* segment : code_segments_) {
+    for (size_t i = segment->oat_class_begin_;
+         i != segment->oat_class_begin_ + segment->class_def_end_ - segment->class_def_begin_;
+         ++i) {
+      const OatClass* oat_class = oat_classes_[i];
+      for (size_t j = 0; j != oat_class->compiled_methods_->size(); ++j) {
+        const CompiledMethod* compiled_method = (*oat_class->compiled_methods_)[j];
+        if (compiled_method == NULL) {
+          continue;
+        }
+        DataPlacement placement = { segment, oat_class->GetCodeRegion(j) };
+        CodeChunk chunks[kMaxMethodChunks];
+        size_t num_chunks = GetMethodChunks(*compiled_method, chunks);
+        for (size_t k = 0; k != num_chunks; ++k) {
+          auto it = data_placements_.find(chunks[k].data);
+          if (it == data_placements_.end()) {
+            data_placements_.Put(chunks[k].data, placement);
+          } else if (placement.region == kHotCode && it->second.region != kHotCode) {
+            it->second = placement;
+          }
+        }
+      }
+    }
+  }
+
+  // Lay out each segment on its own, then place them one after the other, the hot code of all
+  // segments before the cold code. Aligning the start of each segment keeps the code aligned
+  // within it. The cold code starts on a new page so that the hot code pages hold nothing else.
+  ForAllSegments(thread_pool, &OatWriter::InitOatCodeSegmentLayout);
+  InstructionSet instruction_set = compiler_driver_->GetInstructionSet();
+  bool has_cold_code = false;
+  for (const CodeSegment* segment : code_segments_) {
+    has_cold_code = has_cold_code || segment->size_[kColdCode] != 0;
+  }
+  size_t hot_code_begin = offset;
+  for (size_t region = 0; region != kNumCodeRegions; ++region) {
+    if (region == kColdCode && offset != hot_code_begin) {
+      VLOG(compiler) << "Hot code: " << PrettySize(offset - hot_code_begin);
+      if (has_cold_code) {
+        offset = RoundUp(offset, kPageSize);
+      }
+    }
+    for (CodeSegment* segment : code_segments_) {
+      if (segment->size_[region] != 0) {
+        offset = CompiledCode::AlignCode(offset, instruction_set);
+      }
+      segment->offset_[region] = offset;
+      offset += segment->size_[region];
+      oat_header_->CombineChecksum(segment->checksum_[region], segment->checksum_size_[region]);
+    }
   }
-  return offset;
-}
 
-size_t OatWriter::InitOatCodeDexFile(size_t offset,
-                                     size_t* oat_class_index,
-                                     const DexFile& dex_file) {
-  for (size_t class_def_index = 0;
-       class_def_index < dex_file.NumClassDefs();
-       class_def_index++, (*oat_class_index)++) {
-    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
-    offset = InitOatCodeClassDef(offset, *oat_class_index, class_def_index, dex_file, class_def);
-    oat_classes_[*oat_class_index]->UpdateChecksum(*oat_header_);
+  // Now that everything has an offset, fill in the OatMethodOffsets.
+  ForAllSegments(thread_pool, &OatWriter::InitOatCodeSegmentOffsets);
+  for (OatClass* oat_class : oat_classes_) {
+    oat_class->UpdateChecksum(*oat_header_);
   }
   return offset;
 }
 
-size_t OatWriter::InitOatCodeClassDef(size_t offset,
-                                      size_t oat_class_index, size_t class_def_index,
-                                      const DexFile& dex_file,
-                                      const DexFile::ClassDef& class_def) {
-  const byte* class_data = dex_file.GetClassData(class_def);
-  if (class_data == NULL) {
-    // empty class, such as a marker interface
-    return offset;
+size_t OatWriter::GetMethodChunks(const CompiledMethod& compiled_method, CodeChunk* chunks) {
+  size_t num_chunks = 0;
+#if !defined(ART_USE_PORTABLE_COMPILER)
+  CHECK_NE(compiled_method.GetCode().size(), 0U);
+  chunks[num_chunks].kind = kCode;
+  chunks[num_chunks++].data = &compiled_method.GetCode();
+#endif
+  if (!compiled_method.GetMappingTable().empty()) {
+    chunks[num_chunks].kind = kMappingTable;
+    chunks[num_chunks++].data = &compiled_method.GetMappingTable();
   }
-  ClassDataItemIterator it(dex_file, class_data);
-  CHECK_LE(oat_classes_[oat_class_index]->method_offsets_.size(),
-           it.NumDirectMethods() + it.NumVirtualMethods());
-  // Skip fields
-  while (it.HasNextStaticField()) {
-    it.Next();
+  if (!compiled_method.GetVmapTable().empty()) {
+    chunks[num_chunks].kind = kVmapTable;
+    chunks[num_chunks++].data = &compiled_method.GetVmapTable();
   }
-  while (it.HasNextInstanceField()) {
-    it.Next();
+  if (!compiled_method.GetGcMap().empty()) {
+    chunks[num_chunks].kind = kGcMap;
+    chunks[num_chunks++].data = &compiled_method.GetGcMap();
   }
-  // Process methods
-  size_t class_def_method_index = 0;
-  size_t method_offsets_index = 0;
-  while (it.HasNextDirectMethod()) {
-    bool is_native = (it.GetMemberAccessFlags() & kAccNative) != 0;
-    offset = InitOatCodeMethod(offset, oat_class_index, class_def_index, class_def_method_index,
-                               &method_offsets_index, is_native,
-                               it.GetMethodInvokeType(class_def), it.GetMemberIndex(), dex_file);
-    class_def_method_index++;
-    it.Next();
+  DCHECK_LE(num_chunks, kMaxMethodChunks);
+  return num_chunks;
+}
+
+void OatWriter::InitOatCodeSegmentLayout(CodeSegment* segment) {
+  for (size_t region = 0; region != kNumCodeRegions; ++region) {
+    segment->checksum_[region] = adler32(0L, Z_NULL, 0);
+  }
+  for (size_t i = segment->oat_class_begin_;
+       i != segment->oat_class_begin_ + segment->class_def_end_ - segment->class_def_begin_;
+       ++i) {
+    for (const CompiledMethod* compiled_method : *oat_classes_[i]->compiled_methods_) {
+      if (compiled_method == NULL) {
+        continue;
+      }
+      CodeChunk chunks[kMaxMethodChunks];
+      size_t num_chunks = GetMethodChunks(*compiled_method, chunks);
+      for (size_t j = 0; j != num_chunks; ++j) {
+        CodeChunk& chunk = chunks[j];
+        const DataPlacement placement = data_placements_.Get(chunk.data);
+        if (placement.segment != segment ||
+            segment->chunk_offsets_.find(chunk.data) != segment->chunk_offsets_.end()) {
+          continue;  // Written by an earlier segment or method.
+        }
+        const std::vector<uint8_t>& data = *chunk.data;
+        uint32_t data_size = data.size() * sizeof(data[0]);
+        uint32_t& offset = segment->size_[placement.region];
+        if (chunk.kind == kCode) {
+          offset = compiled_method->AlignCode(offset);
+          DCHECK_ALIGNED(offset, kArmAlignment);
+        }
+        chunk.offset = offset;
+        segment->chunks_[placement.region].push_back(chunk);
+        segment->chunk_offsets_.Put(chunk.data, offset);
+        if (chunk.kind == kCode) {
+          offset += sizeof(data_size);  // code size is prepended before code
+        }
+        offset += data_size;
+        segment->checksum_[placement.region] =
+            adler32(segment->checksum_[placement.region], &data[0], data_size);
+        segment->checksum_size_[placement.region] += data_size;
+      }
+    }
   }
-  while (it.HasNextVirtualMethod()) {
-    bool is_native = (it.GetMemberAccessFlags() & kAccNative) != 0;
-    offset = InitOatCodeMethod(offset, oat_class_index, class_def_index, class_def_method_index,
-                               &method_offsets_index, is_native,
-                               it.GetMethodInvokeType(class_def), it.GetMemberIndex(), dex_file);
-    class_def_method_index++;
-    it.Next();
+}
+
+uint32_t OatWriter::GetDataOffset(const std::vector<uint8_t>* data) const {
+  const DataPlacement placement = data_placements_.Get(data);
+  return placement.segment->offset_[placement.region] +
+      placement.segment->chunk_offsets_.Get(data);
+}
+
+void OatWriter::InitOatCodeSegmentOffsets(CodeSegment* segment) {
+  const DexFile& dex_file = *segment->dex_file_;
+  for (size_t class_def_index = segment->class_def_begin_;
+       class_def_index < segment->class_def_end_;
+       class_def_index++) {
+    const byte* class_data = dex_file.GetClassData(dex_file.GetClassDef(class_def_index));
+    if (class_data == NULL) {
+      // empty class, such as a marker interface
+      continue;
+    }
+    OatClass* oat_class =
+        oat_classes_[segment->oat_class_begin_ + class_def_index - segment->class_def_begin_];
+    ClassDataItemIterator it(dex_file, class_data);
+    CHECK_LE(oat_class->method_offsets_.size(), it.NumDirectMethods() + it.NumVirtualMethods());
+    // Skip fields
+    while (it.HasNextStaticField()) {
+      it.Next();
+    }
+    while (it.HasNextInstanceField()) {
+      it.Next();
+    }
+    // Process methods
+    size_t class_def_method_index = 0;
+    size_t method_offsets_index = 0;
+    while (it.HasNext()) {
+      bool is_native = (it.GetMemberAccessFlags() & kAccNative) != 0;
+      InitOatCodeMethodOffsets(oat_class, class_def_method_index, &method_offsets_index,
+                               is_native, it.GetMemberIndex(), dex_file);
+      class_def_method_index++;
+      it.Next();
+    }
+    CHECK_EQ(method_offsets_index, oat_class->method_offsets_.size());
   }
-  DCHECK(!it.HasNext());
-  CHECK_LE(method_offsets_index, class_def_method_index);
-  return offset;
 }
 
-size_t OatWriter::InitOatCodeMethod(size_t offset, size_t oat_class_index,
-                                    size_t __attribute__((unused)) class_def_index,
-                                    size_t class_def_method_index,
-                                    size_t* method_offsets_index,
-                                    bool __attribute__((unused)) is_native,
-                                    InvokeType invoke_type,
-                                    uint32_t method_idx, const DexFile& dex_file) {
-  // derived from CompiledMethod if available
+void OatWriter::InitOatCodeMethodOffsets(OatClass* oat_class, size_t class_def_method_index,
+                                         size_t* method_offsets_index,
+                                         bool __attribute__((unused)) is_native,
+                                         uint32_t method_idx, const DexFile& dex_file) {
+  CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
+  if (compiled_method == NULL) {
+    return;
+  }
+
   uint32_t code_offset = 0;
-  uint32_t frame_size_in_bytes = kStackAlignment;
-  uint32_t core_spill_mask = 0;
-  uint32_t fp_spill_mask = 0;
-  uint32_t mapping_table_offset = 0;
-  uint32_t vmap_table_offset = 0;
-  uint32_t gc_map_offset = 0;
-
-  OatClass* oat_class = oat_classes_[oat_class_index];
 #if defined(ART_USE_PORTABLE_COMPILER)
   size_t oat_method_offsets_offset =
       oat_class->GetOatMethodOffsetsOffsetFromOatHeader(class_def_method_index);
-#endif
-
-  CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
-  if (compiled_method != NULL) {
-#if defined(ART_USE_PORTABLE_COMPILER)
-    compiled_method->AddOatdataOffsetToCompliledCodeOffset(
-        oat_method_offsets_offset + OFFSETOF_MEMBER(OatMethodOffsets, code_offset_));
+  compiled_method->AddOatdataOffsetToCompliledCodeOffset(
+      oat_method_offsets_offset + OFFSETOF_MEMBER(OatMethodOffsets, code_offset_));
 #else
-    const std::vector<uint8_t>& code = compiled_method->GetCode();
-    offset = compiled_method->AlignCode(offset);
-    DCHECK_ALIGNED(offset, kArmAlignment);
-    uint32_t code_size = code.size() * sizeof(code[0]);
-    CHECK_NE(code_size, 0U);
-    uint32_t thumb_offset = compiled_method->CodeDelta();
-    code_offset = offset + sizeof(code_size) + thumb_offset;
-
-    // Deduplicate code arrays
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator code_iter = code_offsets_.find(&code);
-    if (code_iter != code_offsets_.end()) {
-      code_offset = code_iter->second;
-    } else {
-      code_offsets_.Put(&code, code_offset);
-      offset += sizeof(code_size);  // code size is prepended before code
-      offset += code_size;
-      oat_header_->UpdateChecksum(&code[0], code_size);
-    }
+  uint32_t code_size_offset = GetDataOffset(&compiled_method->GetCode());
+  DCHECK_ALIGNED(code_size_offset, kArmAlignment);
+  code_offset = code_size_offset + sizeof(uint32_t) + compiled_method->CodeDelta();
 #endif
-    frame_size_in_bytes = compiled_method->GetFrameSizeInBytes();
-    core_spill_mask = compiled_method->GetCoreSpillMask();
-    fp_spill_mask = compiled_method->GetFpSpillMask();
-
-    const std::vector<uint8_t>& mapping_table = compiled_method->GetMappingTable();
-    size_t mapping_table_size = mapping_table.size() * sizeof(mapping_table[0]);
-    mapping_table_offset = (mapping_table_size == 0) ? 0 : offset;
-
-    // Deduplicate mapping tables
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator mapping_iter =
-        mapping_table_offsets_.find(&mapping_table);
-    if (mapping_iter != mapping_table_offsets_.end()) {
-      mapping_table_offset = mapping_iter->second;
-    } else {
-      mapping_table_offsets_.Put(&mapping_table, mapping_table_offset);
-      offset += mapping_table_size;
-      oat_header_->UpdateChecksum(&mapping_table[0], mapping_table_size);
-    }
 
-    const std::vector<uint8_t>& vmap_table = compiled_method->GetVmapTable();
-    size_t vmap_table_size = vmap_table.size() * sizeof(vmap_table[0]);
-    vmap_table_offset = (vmap_table_size == 0) ? 0 : offset;
+  const std::vector<uint8_t>& mapping_table = compiled_method->GetMappingTable();
+  uint32_t mapping_table_offset = mapping_table.empty() ? 0 : GetDataOffset(&mapping_table);
+  const std::vector<uint8_t>& vmap_table = compiled_method->GetVmapTable();
+  uint32_t vmap_table_offset = vmap_table.empty() ? 0 : GetDataOffset(&vmap_table);
+  const std::vector<uint8_t>& gc_map = compiled_method->GetGcMap();
+  uint32_t gc_map_offset = gc_map.empty() ? 0 : GetDataOffset(&gc_map);
 
-    // Deduplicate vmap tables
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator vmap_iter =
-        vmap_table_offsets_.find(&vmap_table);
-    if (vmap_iter != vmap_table_offsets_.end()) {
-      vmap_table_offset = vmap_iter->second;
-    } else {
-      vmap_table_offsets_.Put(&vmap_table, vmap_table_offset);
-      offset += vmap_table_size;
-      oat_header_->UpdateChecksum(&vmap_table[0], vmap_table_size);
-    }
-
-    const std::vector<uint8_t>& gc_map = compiled_method->GetGcMap();
-    size_t gc_map_size = gc_map.size() * sizeof(gc_map[0]);
-    gc_map_offset = (gc_map_size == 0) ? 0 : offset;
-
-    if (kIsDebugBuild) {
-      // We expect GC maps except when the class hasn't been verified or the method is native
-      ClassReference class_ref(&dex_file, class_def_index);
-      CompiledClass* compiled_class = compiler_driver_->GetCompiledClass(class_ref);
-      mirror::Class::Status status;
-      if (compiled_class != NULL) {
-        status = compiled_class->GetStatus();
-      } else if (compiler_driver_->GetVerificationResults()->IsClassRejected(class_ref)) {
-        status = mirror::Class::kStatusError;
-      } else {
-        status = mirror::Class::kStatusNotReady;
-      }
-      CHECK(gc_map_size != 0 || is_native || status < mirror::Class::kStatusVerified)
-          << &gc_map << " " << gc_map_size << " " << (is_native ? "true" : "false") << " "
-          << (status < mirror::Class::kStatusVerified) << " " << status << " "
-          << PrettyMethod(method_idx, dex_file);
-    }
-
-    // Deduplicate GC maps
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator gc_map_iter =
-        gc_map_offsets_.find(&gc_map);
-    if (gc_map_iter != gc_map_offsets_.end()) {
-      gc_map_offset = gc_map_iter->second;
-    } else {
-      gc_map_offsets_.Put(&gc_map, gc_map_offset);
-      offset += gc_map_size;
-      oat_header_->UpdateChecksum(&gc_map[0], gc_map_size);
-    }
-
-    oat_class->method_offsets_[*method_offsets_index] =
-        OatMethodOffsets(code_offset,
-                         frame_size_in_bytes,
-                         core_spill_mask,
-                         fp_spill_mask,
-                         mapping_table_offset,
-                         vmap_table_offset,
-                         gc_map_offset);
-    (*method_offsets_index)++;
+  if (kIsDebugBuild) {
+    // We expect GC maps except when the class hasn't been verified or the method is native
+    mirror::Class::Status status = static_cast<mirror::Class::Status>(oat_class->status_);
+    CHECK(!gc_map.empty() || is_native || status < mirror::Class::kStatusVerified)
+        << &gc_map << " " << gc_map.size() << " " << (is_native ? "true" : "false") << " "
+        << (status < mirror::Class::kStatusVerified) << " " << status << " "
+        << PrettyMethod(method_idx, dex_file);
   }
 
+  oat_class->method_offsets_[*method_offsets_index] =
+      OatMethodOffsets(code_offset,
+                       compiled_method->GetFrameSizeInBytes(),
+                       compiled_method->GetCoreSpillMask(),
+                       compiled_method->GetFpSpillMask(),
+                       mapping_table_offset,
+                       vmap_table_offset,
+                       gc_map_offset);
+  (*method_offsets_index)++;
+}
 
-  if (compiler_driver_->IsImage()) {
-    ClassLinker* linker = Runtime::Current()->GetClassLinker();
-    // Unchecked as we hold mutator_lock_ on entry.
-    ScopedObjectAccessUnchecked soa(Thread::Current());
+void OatWriter::InitImageMethods() {
+  ClassLinker* linker = Runtime::Current()->GetClassLinker();
+  ScopedObjectAccess soa(Thread::Current());
+  size_t oat_class_index = 0;
+  for (size_t i = 0; i != dex_files_->size(); ++i) {
+    const DexFile& dex_file = *(*dex_files_)[i];
     SirtRef<mirror::DexCache> dex_cache(soa.Self(), linker->FindDexCache(dex_file));
     SirtRef<mirror::ClassLoader> class_loader(soa.Self(), nullptr);
-    mirror::ArtMethod* method = linker->ResolveMethod(dex_file, method_idx, dex_cache,
-                                                      class_loader, nullptr, invoke_type);
-    CHECK(method != NULL);
-    method->SetFrameSizeInBytes(frame_size_in_bytes);
-    method->SetCoreSpillMask(core_spill_mask);
-    method->SetFpSpillMask(fp_spill_mask);
-    method->SetOatMappingTableOffset(mapping_table_offset);
-    // Don't overwrite static method trampoline
-    if (!method->IsStatic() || method->IsConstructor() ||
-        method->GetDeclaringClass()->IsInitialized()) {
-      method->SetOatCodeOffset(code_offset);
-    } else {
-      method->SetEntryPointFromCompiledCode(NULL);
+    for (size_t class_def_index = 0;
+         class_def_index < dex_file.NumClassDefs();
+         class_def_index++, oat_class_index++) {
+      const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
+      const byte* class_data = dex_file.GetClassData(class_def);
+      if (class_data == NULL) {
+        continue;
+      }
+      const OatClass* oat_class = oat_classes_[oat_class_index];
+      ClassDataItemIterator it(dex_file, class_data);
+      while (it.HasNextStaticField()) {
+        it.Next();
+      }
+      while (it.HasNextInstanceField()) {
+        it.Next();
+      }
+      size_t class_def_method_index = 0;
+      size_t method_offsets_index = 0;
+      while (it.HasNext()) {
+        // derived from CompiledMethod if available
+        OatMethodOffsets method_offsets(0, kStackAlignment, 0, 0, 0, 0, 0);
+        if (oat_class->GetCompiledMethod(class_def_method_index) != NULL) {
+          method_offsets = oat_class->method_offsets_[method_offsets_index++];
+        }
+        mirror::ArtMethod* method = linker->ResolveMethod(dex_file, it.GetMemberIndex(),
+                                                          dex_cache, class_loader, nullptr,
+                                                          it.GetMethodInvokeType(class_def));
+        CHECK(method != NULL);
+        method->SetFrameSizeInBytes(method_offsets.frame_size_in_bytes_);
+        method->SetCoreSpillMask(method_offsets.core_spill_mask_);
+        method->SetFpSpillMask(method_offsets.fp_spill_mask_);
+        method->SetOatMappingTableOffset(method_offsets.mapping_table_offset_);
+        // Don't overwrite static method trampoline
+        if (!method->IsStatic() || method->IsConstructor() ||
+            method->GetDeclaringClass()->IsInitialized()) {
+          method->SetOatCodeOffset(method_offsets.code_offset_);
+        } else {
+          method->SetEntryPointFromCompiledCode(NULL);
+        }
+        method->SetOatVmapTableOffset(method_offsets.vmap_table_offset_);
+        method->SetOatNativeGcMapOffset(method_offsets.gc_map_offset_);
+        class_def_method_index++;
+        it.Next();
+      }
     }
-    method->SetOatVmapTableOffset(vmap_table_offset);
-    method->SetOatNativeGcMapOffset(gc_map_offset);
   }
+}
 
-  return offset;
+void OatWriter::ForAllSegments(ThreadPool* thread_pool, SegmentVisitor visitor) {
+  Thread* self = Thread::Current();
+  for (CodeSegment* segment : code_segments_) {
+    thread_pool->AddTask(self, new SegmentTask(this, visitor, segment));
+  }
+  thread_pool->StartWorkers(self);
+  // Wait for the segments to be done, working on them from this thread too.
+  thread_pool->Wait(self, true, false);
 }
 
 #define DCHECK_OFFSET() \
@@ -528,7 +651,7 @@ bool OatWriter::Write(OutputStream& out) {
     return false;
   }
 
-  relative_offset = WriteCodeDexFiles(out, file_offset, relative_offset);
+  relative_offset = WriteCodeSegments(out, file_offset, relative_offset);
   if (relative_offset == 0) {
     LOG(ERROR) << "Failed to write oat code for dex files to " << out.GetLocation();
     return false;
@@ -658,220 +781,76 @@ size_t OatWriter::WriteCode(OutputStream& out, const size_t file_offset) {
   return relative_offset;
 }
 
-size_t OatWriter::WriteCodeDexFiles(OutputStream& out,
+size_t OatWriter::WriteCodeSegments(OutputStream& out,
                                     const size_t file_offset,
                                     size_t relative_offset) {
-  size_t oat_class_index = 0;
-  for (size_t i = 0; i != oat_dex_files_.size(); ++i) {
-    const DexFile* dex_file = (*dex_files_)[i];
-    CHECK(dex_file != NULL);
-    relative_offset = WriteCodeDexFile(out, file_offset, relative_offset, &oat_class_index,
-                                       *dex_file);
-    if (relative_offset == 0) {
-      return 0;
-    }
-  }
-  return relative_offset;
-}
-
-size_t OatWriter::WriteCodeDexFile(OutputStream& out, const size_t file_offset,
-                                   size_t relative_offset, size_t* oat_class_index,
-                                   const DexFile& dex_file) {
-  for (size_t class_def_index = 0; class_def_index < dex_file.NumClassDefs();
-      class_def_index++, (*oat_class_index)++) {
-    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
-    relative_offset = WriteCodeClassDef(out, file_offset, relative_offset, *oat_class_index,
-                                        dex_file, class_def);
-    if (relative_offset == 0) {
-      return 0;
-    }
-  }
-  return relative_offset;
-}
-
-void OatWriter::ReportWriteFailure(const char* what, uint32_t method_idx,
-                                   const DexFile& dex_file, OutputStream& out) const {
-  PLOG(ERROR) << "Failed to write " << what << " for " << PrettyMethod(method_idx, dex_file)
-      << " to " << out.GetLocation();
-}
-
-size_t OatWriter::WriteCodeClassDef(OutputStream& out,
-                                    const size_t file_offset,
-                                    size_t relative_offset,
-                                    size_t oat_class_index,
-                                    const DexFile& dex_file,
-                                    const DexFile::ClassDef& class_def) {
-  const byte* class_data = dex_file.GetClassData(class_def);
-  if (class_data == NULL) {
-    // ie. an empty class such as a marker interface
-    return relative_offset;
-  }
-  ClassDataItemIterator it(dex_file, class_data);
-  // Skip fields
-  while (it.HasNextStaticField()) {
-    it.Next();
-  }
-  while (it.HasNextInstanceField()) {
-    it.Next();
-  }
-  // Process methods
-  size_t class_def_method_index = 0;
-  size_t method_offsets_index = 0;
-  while (it.HasNextDirectMethod()) {
-    bool is_static = (it.GetMemberAccessFlags() & kAccStatic) != 0;
-    relative_offset = WriteCodeMethod(out, file_offset, relative_offset, oat_class_index,
-                                      class_def_method_index, &method_offsets_index, is_static,
-                                      it.GetMemberIndex(), dex_file);
-    if (relative_offset == 0) {
-      return 0;
-    }
-    class_def_method_index++;
-    it.Next();
-  }
-  while (it.HasNextVirtualMethod()) {
-    relative_offset = WriteCodeMethod(out, file_offset, relative_offset, oat_class_index,
-                                      class_def_method_index, &method_offsets_index, false,
-                                      it.GetMemberIndex(), dex_file);
-    if (relative_offset == 0) {
-      return 0;
-    }
-    class_def_method_index++;
-    it.Next();
-  }
-  DCHECK(!it.HasNext());
-  CHECK_LE(method_offsets_index, class_def_method_index);
-  return relative_offset;
-}
-
-size_t OatWriter::WriteCodeMethod(OutputStream& out, const size_t file_offset,
-                                  size_t relative_offset, size_t oat_class_index,
-                                  size_t class_def_method_index, size_t* method_offsets_index,
-                                  bool is_static, uint32_t method_idx, const DexFile& dex_file) {
-  OatClass* oat_class = oat_classes_[oat_class_index];
-  const CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
-
-  if (compiled_method != NULL) {  // ie. not an abstract method
-    const OatMethodOffsets method_offsets = oat_class->method_offsets_[*method_offsets_index];
-    (*method_offsets_index)++;
-
-#if !defined(ART_USE_PORTABLE_COMPILER)
-    uint32_t aligned_offset = compiled_method->AlignCode(relative_offset);
-    uint32_t aligned_code_delta = aligned_offset - relative_offset;
-    if (aligned_code_delta != 0) {
-      off_t new_offset = out.Seek(aligned_code_delta, kSeekCurrent);
-      size_code_alignment_ += aligned_code_delta;
-      uint32_t expected_offset = file_offset + aligned_offset;
-      if (static_cast<uint32_t>(new_offset) != expected_offset) {
-        PLOG(ERROR) << "Failed to seek to align oat code. Actual: " << new_offset
-                    << " Expected: " << expected_offset << " File: " << out.GetLocation();
-        return 0;
-      }
-      relative_offset += aligned_code_delta;
-      DCHECK_OFFSET();
-    }
-    DCHECK_ALIGNED(relative_offset, kArmAlignment);
-    const std::vector<uint8_t>& code = compiled_method->GetCode();
-    uint32_t code_size = code.size() * sizeof(code[0]);
-    CHECK_NE(code_size, 0U);
-
-    // Deduplicate code arrays
-    size_t code_offset = relative_offset + sizeof(code_size) + compiled_method->CodeDelta();
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator code_iter = code_offsets_.find(&code);
-    if (code_iter != code_offsets_.end() && code_offset != method_offsets.code_offset_) {
-      DCHECK(code_iter->second == method_offsets.code_offset_)
-          << PrettyMethod(method_idx, dex_file);
-    } else {
-      DCHECK(code_offset == method_offsets.code_offset_) << PrettyMethod(method_idx, dex_file);
-      if (!out.WriteFully(&code_size, sizeof(code_size))) {
-        ReportWriteFailure("method code size", method_idx, dex_file, out);
-        return 0;
-      }
-      size_code_size_ += sizeof(code_size);
-      relative_offset += sizeof(code_size);
-      DCHECK_OFFSET();
-      if (!out.WriteFully(&code[0], code_size)) {
-        ReportWriteFailure("method code", method_idx, dex_file, out);
-        return 0;
-      }
-      size_code_ += code_size;
-      relative_offset += code_size;
-    }
-    DCHECK_OFFSET();
-#endif
+  for (size_t region = 0; region != kNumCodeRegions; ++region) {
+    for (const CodeSegment* segment : code_segments_) {
+      for (const CodeChunk& chunk : segment->chunks_[region]) {
+        size_t chunk_offset = segment->offset_[region] + chunk.offset;
+        DCHECK_LE(relative_offset, chunk_offset);
+        uint32_t alignment_padding = chunk_offset - relative_offset;
+        if (alignment_padding != 0) {
+          off_t new_offset = out.Seek(alignment_padding, kSeekCurrent);
+          size_code_alignment_ += alignment_padding;
+          uint32_t expected_offset = file_offset + chunk_offset;
+          if (static_cast<uint32_t>(new_offset) != expected_offset) {
+            PLOG(ERROR) << "Failed to seek to align oat code. Actual: " << new_offset
+                        << " Expected: " << expected_offset << " File: " << out.GetLocation();
+            return 0;
+          }
+          relative_offset = chunk_offset;
+          DCHECK_OFFSET();
+        }
 
-    const std::vector<uint8_t>& mapping_table = compiled_method->GetMappingTable();
-    size_t mapping_table_size = mapping_table.size() * sizeof(mapping_table[0]);
-
-    // Deduplicate mapping tables
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator mapping_iter =
-        mapping_table_offsets_.find(&mapping_table);
-    if (mapping_iter != mapping_table_offsets_.end() &&
-        relative_offset != method_offsets.mapping_table_offset_) {
-      DCHECK((mapping_table_size == 0 && method_offsets.mapping_table_offset_ == 0)
-          || mapping_iter->second == method_offsets.mapping_table_offset_)
-          << PrettyMethod(method_idx, dex_file);
-    } else {
-      DCHECK((mapping_table_size == 0 && method_offsets.mapping_table_offset_ == 0)
-          || relative_offset == method_offsets.mapping_table_offset_)
-          << PrettyMethod(method_idx, dex_file);
-      if (!out.WriteFully(&mapping_table[0], mapping_table_size)) {
-        ReportWriteFailure("mapping table", method_idx, dex_file, out);
-        return 0;
-      }
-      size_mapping_table_ += mapping_table_size;
-      relative_offset += mapping_table_size;
-    }
-    DCHECK_OFFSET();
-
-    const std::vector<uint8_t>& vmap_table = compiled_method->GetVmapTable();
-    size_t vmap_table_size = vmap_table.size() * sizeof(vmap_table[0]);
-
-    // Deduplicate vmap tables
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator vmap_iter =
-        vmap_table_offsets_.find(&vmap_table);
-    if (vmap_iter != vmap_table_offsets_.end() &&
-        relative_offset != method_offsets.vmap_table_offset_) {
-      DCHECK((vmap_table_size == 0 && method_offsets.vmap_table_offset_ == 0)
-          || vmap_iter->second == method_offsets.vmap_table_offset_)
-          << PrettyMethod(method_idx, dex_file);
-    } else {
-      DCHECK((vmap_table_size == 0 && method_offsets.vmap_table_offset_ == 0)
-          || relative_offset == method_offsets.vmap_table_offset_)
-          << PrettyMethod(method_idx, dex_file);
-      if (!out.WriteFully(&vmap_table[0], vmap_table_size)) {
-        ReportWriteFailure("vmap table", method_idx, dex_file, out);
-        return 0;
-      }
-      size_vmap_table_ += vmap_table_size;
-      relative_offset += vmap_table_size;
-    }
-    DCHECK_OFFSET();
-
-    const std::vector<uint8_t>& gc_map = compiled_method->GetGcMap();
-    size_t gc_map_size = gc_map.size() * sizeof(gc_map[0]);
-
-    // Deduplicate GC maps
-    SafeMap<const std::vector<uint8_t>*, uint32_t>::iterator gc_map_iter =
-        gc_map_offsets_.find(&gc_map);
-    if (gc_map_iter != gc_map_offsets_.end() &&
-        relative_offset != method_offsets.gc_map_offset_) {
-      DCHECK((gc_map_size == 0 && method_offsets.gc_map_offset_ == 0)
-          || gc_map_iter->second == method_offsets.gc_map_offset_)
-          << PrettyMethod(method_idx, dex_file);
-    } else {
-      DCHECK((gc_map_size == 0 && method_offsets.gc_map_offset_ == 0)
-          || relative_offset == method_offsets.gc_map_offset_)
-          << PrettyMethod(method_idx, dex_file);
-      if (!out.WriteFully(&gc_map[0], gc_map_size)) {
-        ReportWriteFailure("GC map", method_idx, dex_file, out);
-        return 0;
+        const std::vector<uint8_t>& data = *chunk.data;
+        uint32_t data_size = data.size() * sizeof(data[0]);
+        const char* what;
+        uint32_t* size_stat;
+        switch (chunk.kind) {
+          case kCode:
+            if (!out.WriteFully(&data_size, sizeof(data_size))) {
+              PLOG(ERROR) << "Failed to write method code size to " << out.GetLocation();
+              return 0;
+            }
+            size_code_size_ += sizeof(data_size);
+            relative_offset += sizeof(data_size);
+            what = "method code";
+            size_stat = &size_code_;
+            break;
+          case kMappingTable:
+            what = "mapping table";
+            size_stat = &size_mapping_table_;
+            break;
+          case kVmapTable:
+            what = "vmap table";
+            size_stat = &size_vmap_table_;
+            break;
+          case kGcMap:
+            what = "GC map";
+            size_stat = &size_gc_map_;
+            break;
+          default:
+            LOG(FATAL) << "Unexpected chunk kind " << chunk.kind;
+            return 0;
+        }
+        if (!out.WriteFully(&data[0], data_size)) {
+          PLOG(ERROR) << "Failed to write " << what << " to " << out.GetLocation();
+          return 0;
+        }
+        *size_stat += data_size;
+        relative_offset += data_size;
+        DCHECK_OFFSET();
+
+        // The vectors belong to the compiler driver's dedupe sets. Once those are sealed nothing
+        // reads the data after it is written, free it to keep the memory use of large
+        // compilations down.
+        if (compiler_driver_->AreDedupeSetsSealed()) {
+          std::vector<uint8_t>().swap(const_cast<std::vector<uint8_t>&>(data));
+        }
       }
-      size_gc_map_ += gc_map_size;
-      relative_offset += gc_map_size;
     }
-    DCHECK_OFFSET();
   }
-
   return relative_offset;
 }
 
@@ -936,15 +915,14 @@ bool OatWriter::OatDexFile::Write(OatWriter* oat_writer,
   return true;
 }
 
-OatWriter::OatClass::OatClass(size_t offset,
-                              std::vector<CompiledMethod*>* compiled_methods,
+OatWriter::OatClass::OatClass(std::vector<CompiledMethod*>* compiled_methods,
                               uint32_t num_non_null_compiled_methods,
                               mirror::Class::Status status) {
   CHECK(compiled_methods !=  NULL);
   uint32_t num_methods = compiled_methods->size();
   CHECK_LE(num_non_null_compiled_methods, num_methods);
 
-  offset_ = offset;
+  offset_ = 0;
   compiled_methods_ = compiled_methods;
   oat_method_offsets_offsets_from_oat_class_.resize(num_methods);
 
@@ -1066,4 +1044,18 @@ bool OatWriter::OatClass::Write(OatWriter* oat_writer,
   return true;
 }
 
+OatWriter::CodeSegment::CodeSegment(const DexFile* dex_file,
+                                    size_t class_def_begin,
+                                    size_t class_def_end,
+                                    size_t oat_class_begin)
+    : dex_file_(dex_file),
+      class_def_begin_(class_def_begin),
+      class_def_end_(class_def_end),
+      oat_class_begin_(oat_class_begin),
+      offset_(),
+      size_(),
+      checksum_(),
+      checksum_size_() {
+}
+
 }  // namespace art
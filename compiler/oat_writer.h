@@ -32,6 +32,7 @@ namespace art {
 
 class BitVector;
 class OutputStream;
+class ThreadPool;
 
 // OatHeader         variable length with count of D OatDexFiles
 //
@@ -83,43 +84,47 @@ class OatWriter {
   ~OatWriter();
 
  private:
+  class CodeSegment;
+  class OatClass;
+  struct CodeChunk;
+  class SegmentTask;
+
+  // The code of hot methods is written before the code of the other methods, see
+  // CompilerDriver::SetHotCodeMethods.
+  enum CodeRegion {
+    kHotCode,
+    kColdCode,
+    kNumCodeRegions,
+  };
+  typedef void (OatWriter::*SegmentVisitor)(CodeSegment* segment);
+
   size_t InitOatHeader();
   size_t InitOatDexFiles(size_t offset);
   size_t InitDexFiles(size_t offset);
-  size_t InitOatClasses(size_t offset);
-  size_t InitOatCode(size_t offset)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  size_t InitOatCodeDexFiles(size_t offset)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  size_t InitOatCodeDexFile(size_t offset,
-                            size_t* oat_class_index,
-                            const DexFile& dex_file)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  size_t InitOatCodeClassDef(size_t offset,
-                             size_t oat_class_index, size_t class_def_index,
-                             const DexFile& dex_file,
-                             const DexFile::ClassDef& class_def)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  size_t InitOatCodeMethod(size_t offset, size_t oat_class_index, size_t class_def_index,
-                           size_t class_def_method_index, size_t* method_offsets_index,
-                           bool is_native, InvokeType type, uint32_t method_idx, const DexFile&)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  size_t InitOatClasses(size_t offset, ThreadPool* thread_pool);
+  void InitOatClassesSegment(CodeSegment* segment);
+  size_t InitOatCode(size_t offset);
+  size_t InitOatCodeSegments(size_t offset, ThreadPool* thread_pool);
+  void InitOatCodeSegmentLayout(CodeSegment* segment);
+  void InitOatCodeSegmentOffsets(CodeSegment* segment);
+  void InitOatCodeMethodOffsets(OatClass* oat_class, size_t class_def_method_index,
+                                size_t* method_offsets_index, bool is_native, uint32_t method_idx,
+                                const DexFile& dex_file);
+  void InitImageMethods();
+
+  // Run visitor on each segment, spreading the segments over thread_pool.
+  void ForAllSegments(ThreadPool* thread_pool, SegmentVisitor visitor);
+
+  // Fill chunks with the code array and tables of compiled_method that are written to the file,
+  // in the order they are written. Returns how many there are.
+  static size_t GetMethodChunks(const CompiledMethod& compiled_method, CodeChunk* chunks);
+
+  // Offset of data laid out by InitOatCodeSegmentLayout from the beginning of OatHeader.
+  uint32_t GetDataOffset(const std::vector<uint8_t>* data) const;
 
   bool WriteTables(OutputStream& out, const size_t file_offset);
   size_t WriteCode(OutputStream& out, const size_t file_offset);
-  size_t WriteCodeDexFiles(OutputStream& out, const size_t file_offset, size_t relative_offset);
-  size_t WriteCodeDexFile(OutputStream& out, const size_t file_offset, size_t relative_offset,
-                          size_t* oat_class_index, const DexFile& dex_file);
-  size_t WriteCodeClassDef(OutputStream& out, const size_t file_offset, size_t relative_offset,
-                           size_t oat_class_index, const DexFile& dex_file,
-                           const DexFile::ClassDef& class_def);
-  size_t WriteCodeMethod(OutputStream& out, const size_t file_offset, size_t relative_offset,
-                         size_t oat_class_index, size_t class_def_method_index,
-                         size_t* method_offsets_index, bool is_static, uint32_t method_idx,
-                         const DexFile& dex_file);
-
-  void ReportWriteFailure(const char* what, uint32_t method_idx, const DexFile& dex_file,
-                          OutputStream& out) const;
+  size_t WriteCodeSegments(OutputStream& out, const size_t file_offset, size_t relative_offset);
 
   class OatDexFile {
    public:
@@ -145,8 +150,7 @@ class OatWriter {
 
   class OatClass {
    public:
-    explicit OatClass(size_t offset,
-                      std::vector<CompiledMethod*>* compiled_methods,
+    explicit OatClass(std::vector<CompiledMethod*>* compiled_methods,
                       uint32_t num_non_null_compiled_methods,
                       mirror::Class::Status status);
     ~OatClass();
@@ -163,6 +167,10 @@ class OatWriter {
       return (*compiled_methods_)[class_def_method_index];
     }
 
+    CodeRegion GetCodeRegion(size_t class_def_method_index) const {
+      return (!hot_code_.empty() && hot_code_[class_def_method_index]) ? kHotCode : kColdCode;
+    }
+
     // Offset of start of OatClass from beginning of OatHeader. It is
     // used to validate file position when writing. For Portable, it
     // is also used to calculate the position of the OatMethodOffsets
@@ -173,6 +181,10 @@ class OatWriter {
     // CompiledMethods for each class_def_method_index, or NULL if no method is available.
     std::vector<CompiledMethod*>* compiled_methods_;
 
+    // Whether the code for each class_def_method_index is hot, empty if there is no profile for
+    // the code layout.
+    std::vector<bool> hot_code_;
+
     // Offset from OatClass::offset_ to the OatMethodOffsets for the
     // class_def_method_index. If 0, it means the corresponding
     // CompiledMethod entry in OatClass::compiled_methods_ should be
@@ -207,6 +219,57 @@ class OatWriter {
     DISALLOW_COPY_AND_ASSIGN(OatClass);
   };
 
+  // What a CodeChunk holds, for the output stats.
+  enum CodeChunkKind {
+    kCode,
+    kMappingTable,
+    kVmapTable,
+    kGcMap,
+  };
+
+  // At most a code array and three tables are written for a method.
+  static constexpr size_t kMaxMethodChunks = 4;
+
+  // A code array or table written to the executable part of the file.
+  struct CodeChunk {
+    CodeChunkKind kind;
+    const std::vector<uint8_t>* data;
+    // Offset from the start of its part of the CodeSegment, of the code size for code arrays
+    // which is written before the code.
+    uint32_t offset;
+  };
+
+  // The code and tables of the methods of a range of ClassDefs of one dex file. Segments are laid
+  // out in parallel, relative to their own start, and then placed one after the other.
+  class CodeSegment {
+   public:
+    CodeSegment(const DexFile* dex_file, size_t class_def_begin, size_t class_def_end,
+                size_t oat_class_begin);
+
+    const DexFile* const dex_file_;
+    const size_t class_def_begin_;
+    const size_t class_def_end_;
+    // Index in oat_classes_ of the OatClass for class_def_begin_.
+    const size_t oat_class_begin_;
+
+    // A segment is written in two parts, one in each CodeRegion. Offset of each part from the
+    // beginning of OatHeader, and its size.
+    uint32_t offset_[kNumCodeRegions];
+    uint32_t size_[kNumCodeRegions];
+
+    // adler32 checksum of the data of the chunks of each part, and the number of bytes it covers.
+    uint32_t checksum_[kNumCodeRegions];
+    uint32_t checksum_size_[kNumCodeRegions];
+
+    // Chunks of each part in the order they are written, and their offsets from the start of
+    // their part by data. Only data placed in this segment is written here.
+    std::vector<CodeChunk> chunks_[kNumCodeRegions];
+    SafeMap<const std::vector<uint8_t>*, uint32_t> chunk_offsets_;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(CodeSegment);
+  };
+
   const CompilerDriver* const compiler_driver_;
 
   // note OatFile does not take ownership of the DexFiles
@@ -224,6 +287,7 @@ class OatWriter {
   OatHeader* oat_header_;
   std::vector<OatDexFile*> oat_dex_files_;
   std::vector<OatClass*> oat_classes_;
+  std::vector<CodeSegment*> code_segments_;
   UniquePtr<const std::vector<uint8_t> > interpreter_to_interpreter_bridge_;
   UniquePtr<const std::vector<uint8_t> > interpreter_to_compiled_code_bridge_;
   UniquePtr<const std::vector<uint8_t> > jni_dlsym_lookup_;
@@ -266,12 +330,16 @@ class OatWriter {
   uint32_t size_oat_class_method_bitmaps_;
   uint32_t size_oat_class_method_offsets_;
 
-  // Code mappings for deduplication. Deduplication is already done on a pointer basis by the
-  // compiler driver, so we can simply compare the pointers to find out if things are duplicated.
-  SafeMap<const std::vector<uint8_t>*, uint32_t> code_offsets_;
-  SafeMap<const std::vector<uint8_t>*, uint32_t> vmap_table_offsets_;
-  SafeMap<const std::vector<uint8_t>*, uint32_t> mapping_table_offsets_;
-  SafeMap<const std::vector<uint8_t>*, uint32_t> gc_map_offsets_;
+  // Where a code array or table is written.
+  struct DataPlacement {
+    CodeSegment* segment;
+    CodeRegion region;
+  };
+
+  // Where each code array and table is written. Deduplication is already done on a pointer basis
+  // by the compiler driver, so data is written by the first segment that uses it and later uses
+  // simply refer to its offset.
+  SafeMap<const std::vector<uint8_t>*, DataPlacement> data_placements_;
 
   DISALLOW_COPY_AND_ASSIGN(OatWriter);
 };
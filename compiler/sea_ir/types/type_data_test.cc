@@ -24,7 +24,8 @@ class TypeDataTest : public art::CommonTest {
 
 TEST_F(TypeDataTest, Basics) {
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   int first_instruction_id = 1;
   int second_instruction_id = 3;
   EXPECT_TRUE(NULL == td.FindTypeOf(first_instruction_id));
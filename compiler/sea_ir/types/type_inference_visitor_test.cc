@@ -36,7 +36,8 @@ class TypeInferenceVisitorTest : public art::CommonTest {
 
 TEST_F(TypeInferenceVisitorTest, MergeIntWithByte) {
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   const Type* int_type = &type_cache.Integer();
   const Type* byte_type = &type_cache.Byte();
@@ -48,7 +49,8 @@ TEST_F(TypeInferenceVisitorTest, MergeIntWithByte) {
 
 TEST_F(TypeInferenceVisitorTest, MergeIntWithShort) {
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   const Type* int_type = &type_cache.Integer();
   const Type* short_type = &type_cache.Short();
@@ -61,7 +63,8 @@ TEST_F(TypeInferenceVisitorTest, MergeIntWithShort) {
 TEST_F(TypeInferenceVisitorTest, MergeMultipleInts) {
   int N = 10;  // Number of types to merge.
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   std::vector<const Type*> types;
   for (int i = 0; i < N; i++) {
@@ -75,7 +78,8 @@ TEST_F(TypeInferenceVisitorTest, MergeMultipleInts) {
 TEST_F(TypeInferenceVisitorTest, MergeMultipleShorts) {
   int N = 10;  // Number of types to merge.
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   std::vector<const Type*> types;
   for (int i = 0; i < N; i++) {
@@ -89,7 +93,8 @@ TEST_F(TypeInferenceVisitorTest, MergeMultipleShorts) {
 TEST_F(TypeInferenceVisitorTest, MergeMultipleIntsWithShorts) {
   int N = 10;  // Number of types to merge.
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   std::vector<const Type*> types;
   for (int i = 0; i < N; i++) {
@@ -105,7 +110,8 @@ TEST_F(TypeInferenceVisitorTest, MergeMultipleIntsWithShorts) {
 TEST_F(TypeInferenceVisitorTest, GetOperandTypes) {
   int N = 10;  // Number of types to merge.
   TypeData td;
-  art::verifier::RegTypeCache type_cache(false);
+  art::ArenaAllocator arena(art::Runtime::Current()->GetArenaPool());
+  art::verifier::RegTypeCache type_cache(false, &arena);
   TypeInferenceVisitor tiv(NULL, &td, &type_cache);
   std::vector<const Type*> types;
   std::vector<InstructionNode*> preds;
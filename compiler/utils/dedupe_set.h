@@ -17,66 +17,134 @@
 #ifndef ART_COMPILER_UTILS_DEDUPE_SET_H_
 #define ART_COMPILER_UTILS_DEDUPE_SET_H_
 
-#include <set>
 #include <string>
+#include <vector>
 
 #include "base/mutex.h"
-#include "base/stl_util.h"
 #include "base/stringprintf.h"
+#include "UniquePtr.h"
 
 namespace art {
 
 // A set of Keys that support a HashFunc returning HashType. Used to find duplicates of Key in the
 // Add method. The data-structure is thread-safe through the use of internal locks, it also
-// supports the lock being sharded.
+// supports the lock being sharded. Each shard is an open addressing hash table, and the copy of a
+// new key is made without holding the shard's lock.
 template <typename Key, typename HashType, typename HashFunc, HashType kShard = 1>
 class DedupeSet {
-  typedef std::pair<HashType, Key*> HashedKey;
-
-  class Comparator {
-   public:
-    bool operator()(const HashedKey& a, const HashedKey& b) const {
-      if (a.first != b.first) {
-        return a.first < b.first;
-      } else {
-        return *a.second < *b.second;
-      }
-    }
+  struct Slot {
+    HashType hash;
+    // NULL for an empty slot.
+    Key* key;
+  };
+
+  struct Shard {
+    std::string lock_name;
+    UniquePtr<Mutex> lock;
+    // Number of slots in use, the number of slots is a power of 2.
+    size_t size;
+    std::vector<Slot> slots;
   };
 
  public:
   Key* Add(Thread* self, const Key& key) {
+    DCHECK(!sealed_);
     HashType raw_hash = HashFunc()(key);
     HashType shard_hash = raw_hash / kShard;
     HashType shard_bin = raw_hash % kShard;
-    HashedKey hashed_key(shard_hash, const_cast<Key*>(&key));
-    MutexLock lock(self, *lock_[shard_bin]);
-    auto it = keys_[shard_bin].find(hashed_key);
-    if (it != keys_[shard_bin].end()) {
-      return it->second;
+    Shard& shard = shards_[shard_bin];
+    {
+      MutexLock lock(self, *shard.lock);
+      Key* existing = Find(shard, shard_hash, key);
+      if (existing != NULL) {
+        return existing;
+      }
+    }
+    // Another thread may add an equal key while we copy it, check again once the lock is held.
+    Key* new_key = new Key(key);
+    Key* existing;
+    {
+      MutexLock lock(self, *shard.lock);
+      existing = Find(shard, shard_hash, key);
+      if (existing == NULL) {
+        Insert(shard, shard_hash, new_key);
+        return new_key;
+      }
     }
-    hashed_key.second = new Key(key);
-    keys_[shard_bin].insert(hashed_key);
-    return hashed_key.second;
+    delete new_key;
+    return existing;
+  }
+
+  // Stop deduplicating. The set no longer reads its keys, so their users may clear them once done
+  // with them, but it still deletes them. Add must not be called afterwards.
+  void Seal() {
+    sealed_ = true;
   }
 
-  explicit DedupeSet(const char* set_name) {
+  bool IsSealed() const {
+    return sealed_;
+  }
+
+  explicit DedupeSet(const char* set_name) : sealed_(false) {
+    const size_t kInitialSlots = 64;
     for (HashType i = 0; i < kShard; ++i) {
-      lock_name_[i] = StringPrintf("%s lock %d", set_name, i);
-      lock_[i].reset(new Mutex(lock_name_[i].c_str()));
+      Shard& shard = shards_[i];
+      shard.lock_name = StringPrintf("%s lock %d", set_name, static_cast<int>(i));
+      shard.lock.reset(new Mutex(shard.lock_name.c_str()));
+      shard.size = 0;
+      shard.slots.resize(kInitialSlots);
     }
   }
 
   ~DedupeSet() {
     for (HashType i = 0; i < kShard; ++i) {
-      STLDeleteValues(&keys_[i]);
+      for (const Slot& slot : shards_[i].slots) {
+        delete slot.key;
+      }
     }
   }
 
  private:
-  std::string lock_name_[kShard];
-  UniquePtr<Mutex> lock_[kShard];
-  std::set<HashedKey, Comparator> keys_[kShard];
+  static Key* Find(const Shard& shard, HashType hash, const Key& key) {
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t i = static_cast<size_t>(hash) & mask; ; i = (i + 1) & mask) {
+      const Slot& slot = shard.slots[i];
+      if (slot.key == NULL) {
+        return NULL;
+      }
+      if (slot.hash == hash && *slot.key == key) {
+        return slot.key;
+      }
+    }
+  }
+
+  static void Insert(Shard& shard, HashType hash, Key* key) {
+    // Keep the table at most half full so that probe sequences stay short.
+    if ((shard.size + 1) * 2 > shard.slots.size()) {
+      std::vector<Slot> old_slots(shard.slots.size() * 2);
+      old_slots.swap(shard.slots);
+      for (const Slot& slot : old_slots) {
+        if (slot.key != NULL) {
+          InsertSlot(shard, slot.hash, slot.key);
+        }
+      }
+    }
+    InsertSlot(shard, hash, key);
+    ++shard.size;
+  }
+
+  static void InsertSlot(Shard& shard, HashType hash, Key* key) {
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = static_cast<size_t>(hash) & mask;
+    while (shard.slots[i].key != NULL) {
+      i = (i + 1) & mask;
+    }
+    shard.slots[i].hash = hash;
+    shard.slots[i].key = key;
+  }
+
+  Shard shards_[kShard];
+  bool sealed_;
 
   DISALLOW_COPY_AND_ASSIGN(DedupeSet);
 };
@@ -72,4 +72,47 @@ TEST(DedupeSetTest, Test) {
   }
 }
 
+// Sends every key to the same slot to exercise probing and growing the table.
+class CollidingHashFunc {
+ public:
+  size_t operator()(const std::vector<uint8_t>& array) const {
+    return 0;
+  }
+};
+
+TEST(DedupeSetTest, Collisions) {
+  Thread* self = Thread::Current();
+  typedef std::vector<uint8_t> ByteArray;
+  DedupeSet<ByteArray, size_t, CollidingHashFunc, 4> deduplicator("test");
+  std::vector<ByteArray*> arrays;
+  for (size_t i = 0; i < 256; ++i) {
+    ByteArray test(2);
+    test[0] = i & 0xff;
+    test[1] = 42;
+    ByteArray* array = deduplicator.Add(self, test);
+    ASSERT_EQ(test, *array);
+    arrays.push_back(array);
+  }
+  for (size_t i = 0; i < 256; ++i) {
+    ByteArray test(2);
+    test[0] = i & 0xff;
+    test[1] = 42;
+    ASSERT_EQ(arrays[i], deduplicator.Add(self, test));
+  }
+}
+
+TEST(DedupeSetTest, Seal) {
+  Thread* self = Thread::Current();
+  typedef std::vector<uint8_t> ByteArray;
+  DedupeSet<ByteArray, size_t, DedupeHashFunc> deduplicator("test");
+  ByteArray test(3, 7);
+  ByteArray* array = deduplicator.Add(self, test);
+  EXPECT_FALSE(deduplicator.IsSealed());
+  deduplicator.Seal();
+  EXPECT_TRUE(deduplicator.IsSealed());
+  // The key may be released by its user, the set still deletes it.
+  ByteArray().swap(*array);
+  EXPECT_TRUE(array->empty());
+}
+
 }  // namespace art
@@ -48,6 +48,7 @@
 #include "oat_writer.h"
 #include "object_utils.h"
 #include "os.h"
+#include "profiler.h"
 #include "runtime.h"
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
@@ -62,6 +63,8 @@
 
 namespace art {
 
+static constexpr double kDefaultTopKProfileThreshold = 90.0;
+
 static void UsageErrorV(const char* fmt, va_list ap) {
   std::string error;
   StringAppendV(&error, fmt, ap);
@@ -148,6 +151,28 @@ static void Usage(const char* fmt, ...) {
   UsageError("");
   UsageError("  --host: used with Portable backend to link against host runtime libraries");
   UsageError("");
+  UsageError("  --compilation-cache=<file>: reuse methods compiled by earlier runs using the same");
+  UsageError("      cache file, and update it with the methods compiled by this run. Only used");
+  UsageError("      when compiling applications with the Quick backend. A cache written by a");
+  UsageError("      different build of dex2oat is ignored.");
+  UsageError("      Example: --compilation-cache=/tmp/app.cache");
+  UsageError("");
+  UsageError("  --profile-file=<filename>: specify a profile written by the runtime's method");
+  UsageError("      sampling profiler. Only the hot methods it names are compiled, the others");
+  UsageError("      are left to the interpreter.");
+  UsageError("      Example: --profile-file=/data/dalvik-cache/profiles/com.example.app");
+  UsageError("");
+  UsageError("  --top-k-profile-threshold=<percentage>: the hot methods are the most sampled");
+  UsageError("      ones that together account for this percentage of the samples.");
+  UsageError("      Default: %.1f", kDefaultTopKProfileThreshold);
+  UsageError("");
+  UsageError("  --hot-code-profile-file=<filename>: specify a profile written by the runtime's");
+  UsageError("      method sampling profiler. The code of every method it saw run is placed");
+  UsageError("      together at the start of the oat file's code, ahead of the code of the");
+  UsageError("      methods it didn't. Unlike --profile-file, this doesn't change what is");
+  UsageError("      compiled.");
+  UsageError("      Example: --hot-code-profile-file=/data/dalvik-cache/profiles/com.example.app");
+  UsageError("");
   UsageError("  --dump-timing: display a breakdown of where time was spent");
   UsageError("");
   UsageError("  --runtime-arg <argument>: used to specify various arguments for the runtime,");
@@ -246,8 +271,11 @@ class Dex2Oat {
                                       const std::vector<const DexFile*>& dex_files,
                                       File* oat_file,
                                       const std::string& bitcode_filename,
+                                      const std::string& compilation_cache_filename,
                                       bool image,
                                       UniquePtr<CompilerDriver::DescriptorSet>& image_classes,
+                                      UniquePtr<std::set<std::string> >& hot_methods,
+                                      UniquePtr<std::set<std::string> >& hot_code_methods,
                                       bool dump_stats,
                                       TimingLogger& timings) {
     // SirtRef and ClassLoader creation needs to come after Runtime::Create
@@ -281,8 +309,19 @@ class Dex2Oat {
     if (compiler_backend_ == kPortable) {
       driver->SetBitcodeFileName(bitcode_filename);
     }
+    if (!compilation_cache_filename.empty()) {
+      driver->SetCompilationCacheFileName(compilation_cache_filename);
+    }
+    if (hot_methods.get() != NULL) {
+      driver->SetHotMethods(hot_methods.release());
+    }
+    if (hot_code_methods.get() != NULL) {
+      driver->SetHotCodeMethods(hot_code_methods.release());
+    }
 
     driver->CompileAll(class_loader, dex_files, timings);
+    // Nothing reads the compiled code once it is in the oat file, let OatWriter free it.
+    driver->SealDedupeSets();
 
     timings.NewSplit("dex2oat OatWriter");
     std::string image_file_location;
@@ -456,6 +495,16 @@ class Dex2Oat {
   DISALLOW_IMPLICIT_CONSTRUCTORS(Dex2Oat);
 };
 
+static bool ParseDouble(const char* in, double* out) {
+  char* end;
+  double result = strtod(in, &end);
+  if (in == end || *end != '\0') {
+    return false;
+  }
+  *out = result;
+  return true;
+}
+
 static bool ParseInt(const char* in, int* out) {
   char* end;
   int result = strtol(in, &end, 10);
@@ -640,6 +689,12 @@ static InstructionSetFeatures ParseFeatureList(std::string str) {
     } else if (feature == "nodiv") {
       // Turn off support for divide instruction.
       result.SetHasDivideInstruction(false);
+    } else if (feature == "neon") {
+      // Supports the Advanced SIMD instructions.
+      result.SetHasNeon(true);
+    } else if (feature == "noneon") {
+      // Turn off support for the Advanced SIMD instructions.
+      result.SetHasNeon(false);
     } else {
       Usage("Unknown instruction set feature: '%s'", feature.c_str());
     }
@@ -670,6 +725,10 @@ static int dex2oat(int argc, char** argv) {
   std::string oat_location;
   int oat_fd = -1;
   std::string bitcode_filename;
+  std::string compilation_cache_filename;
+  std::string profile_filename;
+  std::string hot_code_profile_filename;
+  double top_k_profile_threshold = kDefaultTopKProfileThreshold;
   const char* image_classes_zip_filename = NULL;
   const char* image_classes_filename = NULL;
   std::string image_filename;
@@ -746,6 +805,18 @@ static int dex2oat(int argc, char** argv) {
       oat_location = option.substr(strlen("--oat-location=")).data();
     } else if (option.starts_with("--bitcode=")) {
       bitcode_filename = option.substr(strlen("--bitcode=")).data();
+    } else if (option.starts_with("--compilation-cache=")) {
+      compilation_cache_filename = option.substr(strlen("--compilation-cache=")).data();
+    } else if (option.starts_with("--profile-file=")) {
+      profile_filename = option.substr(strlen("--profile-file=")).data();
+    } else if (option.starts_with("--hot-code-profile-file=")) {
+      hot_code_profile_filename = option.substr(strlen("--hot-code-profile-file=")).data();
+    } else if (option.starts_with("--top-k-profile-threshold=")) {
+      const char* threshold_str = option.substr(strlen("--top-k-profile-threshold=")).data();
+      if (!ParseDouble(threshold_str, &top_k_profile_threshold) ||
+          top_k_profile_threshold < 0.0 || top_k_profile_threshold > 100.0) {
+        Usage("Failed to parse --top-k-profile-threshold '%s' as a percentage", threshold_str);
+      }
     } else if (option.starts_with("--image=")) {
       image_filename = option.substr(strlen("--image=")).data();
     } else if (option.starts_with("--image-classes=")) {
@@ -1002,6 +1073,33 @@ static int dex2oat(int argc, char** argv) {
     }
   }
 
+  // If --profile-file was specified, only compile the methods it found to be hot.
+  UniquePtr<std::set<std::string> > hot_methods(NULL);
+  if (!profile_filename.empty()) {
+    hot_methods.reset(new std::set<std::string>);
+    if (!ProfileHelper::LoadTopKMethods(profile_filename, top_k_profile_threshold,
+                                        hot_methods.get())) {
+      LOG(WARNING) << "Failed to read profile '" << profile_filename
+                   << "', compiling without it";
+      hot_methods.reset();
+    } else {
+      VLOG(compiler) << "Compiling the " << hot_methods->size() << " hot methods of profile '"
+                     << profile_filename << "'";
+    }
+  }
+
+  // If --hot-code-profile-file was specified, lay out the code of all the methods it saw run first.
+  UniquePtr<std::set<std::string> > hot_code_methods(NULL);
+  if (!hot_code_profile_filename.empty()) {
+    hot_code_methods.reset(new std::set<std::string>);
+    if (!ProfileHelper::LoadTopKMethods(hot_code_profile_filename, 100.0,
+                                        hot_code_methods.get())) {
+      LOG(WARNING) << "Failed to read profile '" << hot_code_profile_filename
+                   << "', laying out code without it";
+      hot_code_methods.reset();
+    }
+  }
+
   std::vector<const DexFile*> dex_files;
   if (boot_image_option.empty()) {
     dex_files = Runtime::Current()->GetClassLinker()->GetBootClassPath();
@@ -1064,8 +1162,11 @@ static int dex2oat(int argc, char** argv) {
                                                                   dex_files,
                                                                   oat_file.get(),
                                                                   bitcode_filename,
+                                                                  compilation_cache_filename,
                                                                   image,
                                                                   image_classes,
+                                                                  hot_methods,
+                                                                  hot_code_methods,
                                                                   dump_stats,
                                                                   timings));
 
@@ -430,6 +430,19 @@ DISASSEMBLER_ENTRY(cmp,
         load = true;
         has_modrm = true;
         break;
+      case 0x70:
+        if (prefix[2] == 0x66) {
+          src_reg_file = dst_reg_file = SSE;
+          opcode << "pshufd";
+          prefix[2] = 0;  // clear prefix now it's served its purpose as part of the opcode
+        } else {
+          src_reg_file = dst_reg_file = MMX;
+          opcode << "pshufw";
+        }
+        load = true;
+        has_modrm = true;
+        immediate_bytes = 1;
+        break;
       case 0x71:
         if (prefix[2] == 0x66) {
           dst_reg_file = SSE;
@@ -483,6 +496,22 @@ DISASSEMBLER_ENTRY(cmp,
         has_modrm = true;
         store = true;
         break;
+      case 0x7F:
+        if (prefix[2] == 0x66) {
+          src_reg_file = SSE;
+          opcode << "movdqa";
+          prefix[2] = 0;  // clear prefix now it's served its purpose as part of the opcode
+        } else if (prefix[0] == 0xF3) {
+          src_reg_file = SSE;
+          opcode << "movdqu";
+          prefix[0] = 0;  // clear prefix now it's served its purpose as part of the opcode
+        } else {
+          src_reg_file = MMX;
+          opcode << "movq";
+        }
+        has_modrm = true;
+        store = true;
+        break;
       case 0x80: case 0x81: case 0x82: case 0x83: case 0x84: case 0x85: case 0x86: case 0x87:
       case 0x88: case 0x89: case 0x8A: case 0x8B: case 0x8C: case 0x8D: case 0x8E: case 0x8F:
         opcode << "j" << condition_codes[*instr & 0xF];
@@ -563,6 +592,23 @@ DISASSEMBLER_ENTRY(cmp,
         opcode << "bswap";
         reg_in_opcode = true;
         break;
+      case 0xDB: case 0xEB: case 0xEF: case 0xFA: case 0xFE:
+        if (prefix[2] == 0x66) {
+          src_reg_file = dst_reg_file = SSE;
+          prefix[2] = 0;  // clear prefix now it's served its purpose as part of the opcode
+        } else {
+          src_reg_file = dst_reg_file = MMX;
+        }
+        switch (*instr) {
+          case 0xDB: opcode << "pand"; break;
+          case 0xEB: opcode << "por"; break;
+          case 0xEF: opcode << "pxor"; break;
+          case 0xFA: opcode << "psubd"; break;
+          case 0xFE: opcode << "paddd"; break;
+        }
+        load = true;
+        has_modrm = true;
+        break;
       default:
         opcode << StringPrintf("unknown opcode '0F %02X'", *instr);
         break;
@@ -41,6 +41,7 @@
 #include "mirror/art_method-inl.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/dex_cache.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "oat.h"
@@ -479,7 +480,7 @@ class OatDumper {
     for (size_t entry = 0; entry < map.NumEntries(); entry++) {
       const uint8_t* native_pc = reinterpret_cast<const uint8_t*>(code) +
                                  map.GetNativePcOffset(entry);
-      os << StringPrintf("%p", native_pc);
+      os << StringPrintf("%p (dex PC 0x%04x)", native_pc, map.GetDexPc(entry));
       size_t num_regs = map.RegWidth() * 8;
       const uint8_t* reg_bitmap = map.GetBitMap(entry);
       bool first = true;
@@ -690,6 +691,11 @@ class ImageDumper {
     os << "IMAGE BITMAP OFFSET: " << reinterpret_cast<void*>(image_header_.GetImageBitmapOffset())
        << " SIZE: " << reinterpret_cast<void*>(image_header_.GetImageBitmapSize()) << "\n\n";
 
+    os << "IMAGE RELOCATIONS OFFSET: "
+       << reinterpret_cast<void*>(image_header_.GetRelocationsOffset())
+       << StringPrintf(" IMAGE: %zd OAT: %zd\n\n", image_header_.GetImageRelocationsCount(),
+                       image_header_.GetOatRelocationsCount());
+
     os << "OAT CHECKSUM: " << StringPrintf("0x%08x\n\n", image_header_.GetOatChecksum());
 
     os << "OAT FILE BEGIN:" << reinterpret_cast<void*>(image_header_.GetOatFileBegin()) << "\n\n";
@@ -769,6 +775,13 @@ class ImageDumper {
                                                          oat_dex_file->FileSize()));
     }
 
+    mirror::ObjectArray<mirror::Object>* dex_caches =
+        image_header_.GetImageRoot(ImageHeader::kDexCaches)->AsObjectArray<mirror::Object>();
+    for (int32_t i = 0; i < dex_caches->GetLength(); ++i) {
+      AddDexCacheObjects(down_cast<mirror::DexCache*>(dex_caches->Get(i)), &dex_cache_objects_);
+    }
+    stats_.page_bins.resize(RoundUp(image_header_.GetImageSize(), kPageSize) / kPageSize, 0);
+
     os << "OBJECTS:\n" << std::flush;
 
     // Loop through all the image spaces and dump their objects.
@@ -814,8 +827,12 @@ class ImageDumper {
     stats_.header_bytes = header_bytes;
     size_t alignment_bytes = RoundUp(header_bytes, kObjectAlignment) - header_bytes;
     stats_.alignment_bytes += alignment_bytes;
+    // The likely dirty objects start on a page of their own.
+    stats_.alignment_bytes += image_header_.GetImageSize() -
+        (stats_.header_bytes + stats_.object_bytes + stats_.alignment_bytes);
     stats_.alignment_bytes += image_header_.GetImageBitmapOffset() - image_header_.GetImageSize();
     stats_.bitmap_bytes += image_header_.GetImageBitmapSize();
+    stats_.relocation_bytes += image_header_.GetRelocationsSize();
     stats_.Dump(os);
     os << "\n";
 
@@ -945,6 +962,7 @@ class ImageDumper {
     size_t alignment_bytes = RoundUp(object_bytes, kObjectAlignment) - object_bytes;
     state->stats_.object_bytes += object_bytes;
     state->stats_.alignment_bytes += alignment_bytes;
+    state->UpdatePageCensus(obj, object_bytes);
 
     std::ostream& os = *state->os_;
     mirror::Class* obj_class = obj->GetClass();
@@ -1083,6 +1101,20 @@ class ImageDumper {
     state->stats_.Update(ClassHelper(obj_class).GetDescriptor(), object_bytes);
   }
 
+  // Record the bin of obj against the image pages it is on.
+  void UpdatePageCensus(mirror::Object* obj, size_t object_bytes)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    ImageObjectBin bin = GetImageObjectBin(obj, dex_cache_objects_);
+    stats_.bin_bytes[bin] += object_bytes;
+    size_t offset = reinterpret_cast<byte*>(obj) - image_space_.Begin();
+    size_t first_page = offset / kPageSize;
+    size_t last_page = (offset + object_bytes - 1) / kPageSize;
+    CHECK_LT(last_page, stats_.page_bins.size());
+    for (size_t page = first_page; page <= last_page; ++page) {
+      stats_.page_bins[page] |= 1 << bin;
+    }
+  }
+
   std::set<const void*> already_seen_;
   // Compute the size of the given data within the oat file and whether this is the first time
   // this data has been requested
@@ -1104,6 +1136,7 @@ class ImageDumper {
     size_t header_bytes;
     size_t object_bytes;
     size_t bitmap_bytes;
+    size_t relocation_bytes;
     size_t alignment_bytes;
 
     size_t managed_code_bytes;
@@ -1125,12 +1158,17 @@ class ImageDumper {
     std::vector<double> method_outlier_expansion;
     std::vector<std::pair<std::string, size_t> > oat_dex_file_sizes;
 
+    // Object bytes by ImageObjectBin, and the mask of the bins found on each image page.
+    std::vector<size_t> bin_bytes;
+    std::vector<uint8_t> page_bins;
+
     explicit Stats()
         : oat_file_bytes(0),
           file_bytes(0),
           header_bytes(0),
           object_bytes(0),
           bitmap_bytes(0),
+          relocation_bytes(0),
           alignment_bytes(0),
           managed_code_bytes(0),
           managed_code_bytes_ignoring_deduplication(0),
@@ -1142,7 +1180,8 @@ class ImageDumper {
           gc_map_bytes(0),
           pc_mapping_table_bytes(0),
           vmap_table_bytes(0),
-          dex_instruction_bytes(0) {}
+          dex_instruction_bytes(0),
+          bin_bytes(kImageObjectBinCount, 0) {}
 
     struct SizeAndCount {
       SizeAndCount(size_t bytes, size_t count) : bytes(bytes), count(count) {}
@@ -1180,6 +1219,46 @@ class ImageDumper {
       method_outlier.push_back(method);
     }
 
+    // Pages without likely dirty objects should stay shared between the processes that map the
+    // image, the others are likely to become private to each of them.
+    void DumpPageCensus(std::ostream& os) {
+      size_t dirty_pages = 0;
+      size_t mixed_pages = 0;
+      const uint8_t dirty_mask = 1 << kImageObjectBinLikelyDirty;
+      for (uint8_t bins : page_bins) {
+        if ((bins & dirty_mask) != 0) {
+          dirty_pages++;
+          if ((bins & ~dirty_mask) != 0) {
+            mixed_pages++;
+          }
+        }
+      }
+      size_t image_pages = page_bins.size();
+      double percent_of_pages = 100.0 / static_cast<double>(image_pages);
+      os << "image page census:\n";
+      Indenter indent_filter(os.rdbuf(), kIndentChar, kIndentBy1Count);
+      std::ostream indent_os(&indent_filter);
+      indent_os << StringPrintf("string_bytes       = %8zd (%2.0f%% of object_bytes)\n"
+                                "clean_bytes        = %8zd (%2.0f%% of object_bytes)\n"
+                                "likely_dirty_bytes = %8zd (%2.0f%% of object_bytes)\n\n"
+                                "image_pages        = %8zd\n"
+                                "shared_pages       = %8zd (%2.0f%% of image pages)\n"
+                                "likely_dirty_pages = %8zd (%2.0f%% of image pages)\n"
+                                "mixed_pages        = %8zd (%2.0f%% of image pages)\n\n",
+                                bin_bytes[kImageObjectBinString],
+                                PercentOfObjectBytes(bin_bytes[kImageObjectBinString]),
+                                bin_bytes[kImageObjectBinClean],
+                                PercentOfObjectBytes(bin_bytes[kImageObjectBinClean]),
+                                bin_bytes[kImageObjectBinLikelyDirty],
+                                PercentOfObjectBytes(bin_bytes[kImageObjectBinLikelyDirty]),
+                                image_pages,
+                                image_pages - dirty_pages,
+                                (image_pages - dirty_pages) * percent_of_pages,
+                                dirty_pages, dirty_pages * percent_of_pages,
+                                mixed_pages, mixed_pages * percent_of_pages)
+          << std::flush;
+    }
+
     void DumpOutliers(std::ostream& os)
         SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
       size_t sum_of_sizes = 0;
@@ -1284,19 +1363,23 @@ class ImageDumper {
     void Dump(std::ostream& os) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
       {
         os << "art_file_bytes = " << PrettySize(file_bytes) << "\n\n"
-           << "art_file_bytes = header_bytes + object_bytes + alignment_bytes\n";
+           << "art_file_bytes = header_bytes + object_bytes + bitmap_bytes + relocation_bytes + "
+              "alignment_bytes\n";
         Indenter indent_filter(os.rdbuf(), kIndentChar, kIndentBy1Count);
         std::ostream indent_os(&indent_filter);
-        indent_os << StringPrintf("header_bytes    =  %8zd (%2.0f%% of art file bytes)\n"
-                                  "object_bytes    =  %8zd (%2.0f%% of art file bytes)\n"
-                                  "bitmap_bytes    =  %8zd (%2.0f%% of art file bytes)\n"
-                                  "alignment_bytes =  %8zd (%2.0f%% of art file bytes)\n\n",
+        indent_os << StringPrintf("header_bytes     =  %8zd (%2.0f%% of art file bytes)\n"
+                                  "object_bytes     =  %8zd (%2.0f%% of art file bytes)\n"
+                                  "bitmap_bytes     =  %8zd (%2.0f%% of art file bytes)\n"
+                                  "relocation_bytes =  %8zd (%2.0f%% of art file bytes)\n"
+                                  "alignment_bytes  =  %8zd (%2.0f%% of art file bytes)\n\n",
                                   header_bytes, PercentOfFileBytes(header_bytes),
                                   object_bytes, PercentOfFileBytes(object_bytes),
                                   bitmap_bytes, PercentOfFileBytes(bitmap_bytes),
+                                  relocation_bytes, PercentOfFileBytes(relocation_bytes),
                                   alignment_bytes, PercentOfFileBytes(alignment_bytes))
             << std::flush;
-        CHECK_EQ(file_bytes, bitmap_bytes + header_bytes + object_bytes + alignment_bytes);
+        CHECK_EQ(file_bytes, bitmap_bytes + relocation_bytes + header_bytes + object_bytes +
+                 alignment_bytes);
       }
 
       os << "object_bytes breakdown:\n";
@@ -1315,6 +1398,8 @@ class ImageDumper {
       os << "\n" << std::flush;
       CHECK_EQ(object_bytes, object_bytes_total);
 
+      DumpPageCensus(os);
+
       os << StringPrintf("oat_file_bytes               = %8zd\n"
                          "managed_code_bytes           = %8zd (%2.0f%% of oat file bytes)\n"
                          "managed_to_native_code_bytes = %8zd (%2.0f%% of oat file bytes)\n"
@@ -1370,6 +1455,7 @@ class ImageDumper {
   const std::string host_prefix_;
   gc::space::ImageSpace& image_space_;
   const ImageHeader& image_header_;
+  std::set<mirror::Object*> dex_cache_objects_;
 
   DISALLOW_COPY_AND_ASSIGN(ImageDumper);
 };
@@ -22,6 +22,7 @@ LIBART_COMMON_SRC_FILES := \
 	atomic.cc.arm \
 	barrier.cc \
 	base/allocator.cc \
+	base/arena_allocator.cc \
 	base/bit_vector.cc \
 	base/logging.cc \
 	base/mutex.cc \
@@ -39,6 +40,7 @@ LIBART_COMMON_SRC_FILES := \
 	class_linker.cc \
 	common_throws.cc \
 	debugger.cc \
+	dex_cache_prefetcher.cc \
 	dex_file.cc \
 	dex_file_verifier.cc \
 	dex_instruction.cc \
@@ -143,6 +145,7 @@ LIBART_COMMON_SRC_FILES := \
 	verifier/reg_type.cc \
 	verifier/reg_type_cache.cc \
 	verifier/register_line.cc \
+	verifier/verification_cache.cc \
 	well_known_classes.cc \
 	zip_archive.cc
 
@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
-#include "compiler_internals.h"
-#include "dex_file-inl.h"
 #include "arena_allocator.h"
+
+#include <algorithm>
+#include <iomanip>
+
 #include "base/logging.h"
 #include "base/mutex.h"
 #include "thread-inl.h"
@@ -44,6 +46,7 @@ static const char* alloc_names[ArenaAllocator::kNumAllocKinds] = {
   "RegAlloc   ",
   "Data       ",
   "Preds      ",
+  "Verifier   ",
 };
 
 Arena::Arena(size_t size)
@@ -151,7 +154,7 @@ void ArenaAllocator::UpdateBytesAllocated() {
 }
 
 void* ArenaAllocator::AllocValgrind(size_t bytes, ArenaAllocKind kind) {
-  size_t rounded_bytes = (bytes + 3 + kValgrindRedZoneBytes) & ~3;
+  size_t rounded_bytes = (bytes + kAlignment - 1 + kValgrindRedZoneBytes) & ~(kAlignment - 1);
   if (UNLIKELY(ptr_ + rounded_bytes > end_)) {
     // Obtain a new block.
     ObtainNewArenaForAllocation(rounded_bytes);
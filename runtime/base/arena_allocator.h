@@ -14,14 +14,13 @@
  * limitations under the License.
  */
 
-#ifndef ART_COMPILER_DEX_ARENA_ALLOCATOR_H_
-#define ART_COMPILER_DEX_ARENA_ALLOCATOR_H_
+#ifndef ART_RUNTIME_BASE_ARENA_ALLOCATOR_H_
+#define ART_RUNTIME_BASE_ARENA_ALLOCATOR_H_
 
 #include <stdint.h>
 #include <stddef.h>
 
 #include "base/mutex.h"
-#include "compiler_enums.h"
 #include "mem_map.h"
 
 namespace art {
@@ -93,11 +92,15 @@ class ArenaAllocator {
     kAllocRegAlloc,
     kAllocData,
     kAllocPredecessors,
+    kAllocVerifier,
     kNumAllocKinds
   };
 
   static constexpr bool kCountAllocations = false;
 
+  // Allocations are aligned so that arena-backed objects may hold pointers and 64-bit fields.
+  static constexpr size_t kAlignment = 8;
+
   explicit ArenaAllocator(ArenaPool* pool);
   ~ArenaAllocator();
 
@@ -106,7 +109,7 @@ class ArenaAllocator {
     if (UNLIKELY(running_on_valgrind_)) {
       return AllocValgrind(bytes, kind);
     }
-    bytes = (bytes + 3) & ~3;
+    bytes = (bytes + kAlignment - 1) & ~(kAlignment - 1);
     if (UNLIKELY(ptr_ + bytes > end_)) {
       // Obtain a new block.
       ObtainNewArenaForAllocation(bytes);
@@ -155,4 +158,4 @@ struct MemStats {
 
 }  // namespace art
 
-#endif  // ART_COMPILER_DEX_ARENA_ALLOCATOR_H_
+#endif  // ART_RUNTIME_BASE_ARENA_ALLOCATOR_H_
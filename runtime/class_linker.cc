@@ -34,6 +34,7 @@
 #include "class_linker-inl.h"
 #include "compiler_callbacks.h"
 #include "debugger.h"
+#include "dex_cache_prefetcher.h"
 #include "dex_file-inl.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap.h"
@@ -67,6 +68,7 @@
 #include "UniquePtr.h"
 #include "utils.h"
 #include "verifier/method_verifier.h"
+#include "verifier/verification_cache.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -2505,9 +2507,34 @@ void ClassLinker::VerifyClass(const SirtRef<mirror::Class>& klass) {
   verifier::MethodVerifier::FailureKind verifier_failure = verifier::MethodVerifier::kNoFailure;
   std::string error_msg;
   if (!preverified) {
-    verifier_failure = verifier::MethodVerifier::VerifyClass(klass.get(),
-                                                             Runtime::Current()->IsCompiler(),
-                                                             &error_msg);
+    verifier::VerificationCache* verification_cache = Runtime::Current()->GetVerificationCache();
+    bool soft_failure;
+    if (verification_cache != nullptr && verification_cache->Lookup(klass.get(), &soft_failure)) {
+      VLOG(class_linker) << "Using cached verification result for " << PrettyDescriptor(klass.get())
+          << " in " << klass->GetDexCache()->GetLocation()->ToModifiedUtf8();
+      verifier_failure = soft_failure ? verifier::MethodVerifier::kSoftFailure
+                                      : verifier::MethodVerifier::kNoFailure;
+    } else {
+      verifier::VerificationDependencies dependencies;
+      verifier_failure = verifier::MethodVerifier::VerifyClass(klass.get(),
+                                                               Runtime::Current()->IsCompiler(),
+                                                               &error_msg,
+                                                               &dependencies);
+      if (verification_cache != nullptr &&
+          verifier_failure != verifier::MethodVerifier::kHardFailure) {
+        // The result also depends on the class hierarchy the verifier checked assignability
+        // against.
+        for (mirror::Class* c = klass->GetSuperClass(); c != nullptr; c = c->GetSuperClass()) {
+          dependencies.Add(c);
+        }
+        for (int32_t i = 0; i < klass->GetIfTableCount(); ++i) {
+          dependencies.Add(klass->GetIfTable()->GetInterface(i));
+        }
+        verification_cache->Record(klass.get(),
+                                   verifier_failure == verifier::MethodVerifier::kSoftFailure,
+                                   dependencies);
+      }
+    }
   }
   if (preverified || verifier_failure != verifier::MethodVerifier::kHardFailure) {
     if (!preverified && verifier_failure != verifier::MethodVerifier::kNoFailure) {
@@ -4054,6 +4081,10 @@ mirror::String* ClassLinker::ResolveString(const DexFile& dex_file, uint32_t str
   const char* utf8_data = dex_file.StringDataAndUtf16LengthByIdx(string_idx, &utf16_length);
   mirror::String* string = intern_table_->InternStrong(utf16_length, utf8_data);
   dex_cache->SetResolvedString(string_idx, string);
+  DexCachePrefetcher* prefetcher = Runtime::Current()->GetDexCachePrefetcher();
+  if (prefetcher != nullptr) {
+    prefetcher->RecordString(dex_file, string_idx);
+  }
   return string;
 }
 
@@ -4078,6 +4109,10 @@ mirror::Class* ClassLinker::ResolveType(const DexFile& dex_file, uint16_t type_i
       //       boot class loader. This was to permit different classes with the
       //       same name to be loaded simultaneously by different loaders
       dex_cache->SetResolvedType(type_idx, resolved);
+      DexCachePrefetcher* prefetcher = Runtime::Current()->GetDexCachePrefetcher();
+      if (prefetcher != nullptr) {
+        prefetcher->RecordType(dex_file, type_idx);
+      }
     } else {
       Thread* self = Thread::Current();
       CHECK(self->IsExceptionPending())
@@ -4162,6 +4197,10 @@ mirror::ArtMethod* ClassLinker::ResolveMethod(const DexFile& dex_file,
   if (resolved != NULL) {
     // Be a good citizen and update the dex cache to speed subsequent calls.
     dex_cache->SetResolvedMethod(method_idx, resolved);
+    DexCachePrefetcher* prefetcher = Runtime::Current()->GetDexCachePrefetcher();
+    if (prefetcher != nullptr) {
+      prefetcher->RecordMethod(dex_file, method_idx, type);
+    }
     return resolved;
   } else {
     // We failed to find the method which means either an access error, an incompatible class
@@ -4280,6 +4319,10 @@ mirror::ArtField* ClassLinker::ResolveField(const DexFile& dex_file, uint32_t fi
     }
   }
   dex_cache->SetResolvedField(field_idx, resolved);
+  DexCachePrefetcher* prefetcher = Runtime::Current()->GetDexCachePrefetcher();
+  if (prefetcher != nullptr) {
+    prefetcher->RecordField(dex_file, field_idx, is_static);
+  }
   return resolved;
 }
 
@@ -256,6 +256,12 @@ static InstructionSetFeatures ParseFeatureList(std::string str) {
     } else if (feature == "nodiv") {
       // Turn off support for divide instruction.
       result.SetHasDivideInstruction(false);
+    } else if (feature == "neon") {
+      // Supports the Advanced SIMD instructions.
+      result.SetHasNeon(true);
+    } else if (feature == "noneon") {
+      // Turn off support for the Advanced SIMD instructions.
+      result.SetHasNeon(false);
     } else {
       LOG(FATAL) << "Unknown instruction set feature: '" << feature << "'";
     }
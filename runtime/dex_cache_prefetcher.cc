@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_cache_prefetcher.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "base/logging.h"
+#include "base/mutex-inl.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "dex_file.h"
+#include "mirror/class_loader.h"
+#include "mirror/dex_cache.h"
+#include "os.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "sirt_ref.h"
+#include "thread.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+namespace art {
+
+// The first line of a profile file. Bump the version when the format changes.
+static const char* kDexCacheProfileHeader = "art-dex-cache-profile 1";
+
+// How entry kinds are written in the profile file, indexed by EntryKind.
+static const char kEntryKindChars[] = "stfm";
+
+class DexCachePrefetcher::PrefetchTask : public Task {
+ public:
+  PrefetchTask(const DexFile* dex_file, const Entries& entries)
+      : dex_file_(dex_file), entries_(entries) {}
+
+  virtual void Run(Thread* self) {
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    size_t resolved = 0;
+    for (const Entry& entry : entries_) {
+      // Only classes of the boot class path are resolved. Loading the application's own classes
+      // would run its class loader's code on this thread, earlier than the application expects.
+      if (!IsBootEntry(class_linker->GetBootClassPath(), entry)) {
+        continue;
+      }
+      // Resolve one entry at a time so that the worker doesn't hold off suspension for long.
+      ScopedObjectAccess soa(self);
+      SirtRef<mirror::DexCache> dex_cache(self, class_linker->FindDexCache(*dex_file_));
+      SirtRef<mirror::ClassLoader> boot_class_loader(self, nullptr);
+      bool success = false;
+      switch (entry.kind) {
+        case kString:
+          success = class_linker->ResolveString(*dex_file_, entry.index, dex_cache) != nullptr;
+          break;
+        case kType:
+          success = class_linker->ResolveType(*dex_file_, entry.index, dex_cache,
+                                              boot_class_loader) != nullptr;
+          break;
+        case kField:
+          success = class_linker->ResolveField(*dex_file_, entry.index, dex_cache,
+                                               boot_class_loader, entry.arg != 0) != nullptr;
+          break;
+        case kMethod:
+          success = class_linker->ResolveMethod(*dex_file_, entry.index, dex_cache,
+                                                boot_class_loader, nullptr,
+                                                static_cast<InvokeType>(entry.arg)) != nullptr;
+          break;
+        default:
+          LOG(FATAL) << "Unexpected entry kind " << entry.kind;
+      }
+      if (success) {
+        ++resolved;
+      }
+      // The application may legitimately fail to resolve an entry, it will see the error itself
+      // when it gets there.
+      self->ClearException();
+    }
+    VLOG(class_linker) << "Prefetched " << resolved << " of " << entries_.size()
+                       << " dex cache entries of " << dex_file_->GetLocation();
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  // Whether resolving entry only involves strings and classes of the boot class path.
+  bool IsBootEntry(const DexFile::ClassPath& boot_class_path, const Entry& entry) const {
+    const char* descriptor;
+    switch (entry.kind) {
+      case kString:
+        return true;
+      case kType:
+        descriptor = dex_file_->StringByTypeIdx(entry.index);
+        break;
+      case kField:
+        descriptor =
+            dex_file_->GetFieldDeclaringClassDescriptor(dex_file_->GetFieldId(entry.index));
+        break;
+      case kMethod:
+        descriptor =
+            dex_file_->GetMethodDeclaringClassDescriptor(dex_file_->GetMethodId(entry.index));
+        break;
+      default:
+        return false;
+    }
+    while (*descriptor == '[') {
+      ++descriptor;
+    }
+    // Primitive types are always there.
+    return descriptor[1] == '\0' ||
+        DexFile::FindInClassPath(descriptor, boot_class_path).second != nullptr;
+  }
+
+  const DexFile* const dex_file_;
+  const Entries entries_;
+};
+
+class DexCachePrefetcher::SaveTask : public Task {
+ public:
+  explicit SaveTask(DexCachePrefetcher* prefetcher) : prefetcher_(prefetcher) {}
+
+  virtual void Run(Thread* self) {
+    prefetcher_->Save();
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  DexCachePrefetcher* const prefetcher_;
+};
+
+DexCachePrefetcher::DexCachePrefetcher(const std::string& filename)
+    : filename_(filename),
+      start_ms_(MilliTime()),
+      recording_(true),
+      lock_("dex cache prefetcher lock"),
+      dirty_(false),
+      thread_pool_(new ThreadPool("Dex cache prefetcher thread pool", 1)) {
+  thread_pool_->StartWorkers(Thread::Current());
+}
+
+DexCachePrefetcher::~DexCachePrefetcher() {
+  // Stops the worker, abandoning any prefetching left to do.
+  thread_pool_.reset();
+}
+
+// Each line after the header describes one entry:
+//   <dex checksum> <kind> <index> <argument>
+bool DexCachePrefetcher::Parse(std::istream& is) {
+  std::string header;
+  if (!std::getline(is, header) || header != kDexCacheProfileHeader) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    uint32_t checksum;
+    char kind_char;
+    uint32_t index;
+    uint32_t arg;
+    if (!(ls >> checksum >> kind_char >> index >> arg)) {
+      return false;
+    }
+    const char* kind = strchr(kEntryKindChars, kind_char);
+    if (kind == nullptr) {
+      return false;
+    }
+    Entry entry(static_cast<EntryKind>(kind - kEntryKindChars), index, arg);
+    if (entry.kind == kMethod && arg > kMaxInvokeType) {
+      return false;
+    }
+    auto it = entries_.find(checksum);
+    if (it == entries_.end()) {
+      entries_.Put(checksum, Entries());
+      it = entries_.find(checksum);
+    }
+    it->second.insert(entry);
+  }
+  return true;
+}
+
+bool DexCachePrefetcher::Load() {
+  std::string contents;
+  if (!ReadFileToString(filename_, &contents)) {
+    VLOG(class_linker) << "No dex cache profile at " << filename_;
+    return false;
+  }
+  std::istringstream is(contents);
+  MutexLock mu(Thread::Current(), lock_);
+  if (!Parse(is)) {
+    LOG(WARNING) << "Discarding malformed dex cache profile " << filename_;
+    entries_.clear();
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+bool DexCachePrefetcher::Save() {
+  std::ostringstream os;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    if (!dirty_) {
+      return true;
+    }
+    os << kDexCacheProfileHeader << "\n";
+    for (const auto& it : entries_) {
+      for (const Entry& entry : it.second) {
+        os << it.first << " " << kEntryKindChars[entry.kind] << " " << entry.index << " "
+           << entry.arg << "\n";
+      }
+    }
+    dirty_ = false;
+  }
+  // Write to a temporary file and rename it into place so that a concurrently starting runtime
+  // never sees a partially written profile.
+  std::string tmp_filename(filename_ + ".tmp");
+  UniquePtr<File> file(OS::CreateEmptyFile(tmp_filename.c_str()));
+  if (file.get() == nullptr) {
+    PLOG(WARNING) << "Failed to create dex cache profile " << tmp_filename;
+    return false;
+  }
+  std::string data(os.str());
+  if (!file->WriteFully(data.c_str(), data.length()) || file->Close() != 0) {
+    PLOG(WARNING) << "Failed to write dex cache profile " << tmp_filename;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename " << tmp_filename << " to " << filename_;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+void DexCachePrefetcher::Prefetch(const DexFile& dex_file) {
+  Thread* self = Thread::Current();
+  Entries entries;
+  {
+    MutexLock mu(self, lock_);
+    if (!prefetched_.insert(&dex_file).second) {
+      return;
+    }
+    auto it = entries_.find(dex_file.GetLocationChecksum());
+    if (it == entries_.end()) {
+      return;
+    }
+    entries = it->second;
+  }
+  thread_pool_->AddTask(self, new PrefetchTask(&dex_file, entries));
+}
+
+void DexCachePrefetcher::WaitForPrefetching() {
+  thread_pool_->Wait(Thread::Current(), false, false);
+}
+
+void DexCachePrefetcher::Record(const DexFile& dex_file, const Entry& entry) {
+  if (!recording_) {
+    return;
+  }
+  Thread* self = Thread::Current();
+  bool save = false;
+  {
+    MutexLock mu(self, lock_);
+    if (!recording_) {
+      return;
+    }
+    if (MilliTime() - start_ms_ > kRecordingDurationMs) {
+      // Startup is over, write out what was seen. Applications are rarely shut down cleanly.
+      recording_ = false;
+      save = dirty_;
+    } else {
+      uint32_t checksum = dex_file.GetLocationChecksum();
+      auto it = entries_.find(checksum);
+      if (it == entries_.end()) {
+        entries_.Put(checksum, Entries());
+        it = entries_.find(checksum);
+      }
+      dirty_ |= it->second.insert(entry).second;
+    }
+  }
+  if (save) {
+    thread_pool_->AddTask(self, new SaveTask(this));
+  }
+}
+
+size_t DexCachePrefetcher::Size(const DexFile& dex_file) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = entries_.find(dex_file.GetLocationChecksum());
+  return it != entries_.end() ? it->second.size() : 0;
+}
+
+}  // namespace art
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_DEX_CACHE_PREFETCHER_H_
+#define ART_RUNTIME_DEX_CACHE_PREFETCHER_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <set>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "invoke_type.h"
+#include "safe_map.h"
+#include "UniquePtr.h"
+
+namespace art {
+
+class DexFile;
+class ThreadPool;
+
+// Records which dex cache entries get resolved through the ClassLinker slow paths while an
+// application starts up, and on the next launch resolves the same entries on a background thread
+// as soon as the application's dex files are used, ahead of the code that needs them.
+class DexCachePrefetcher {
+ public:
+  // Resolutions are only recorded for this long after the prefetcher is created.
+  static constexpr uint64_t kRecordingDurationMs = 5000;
+
+  // Starts a worker thread, so the runtime must have been started.
+  explicit DexCachePrefetcher(const std::string& filename);
+  ~DexCachePrefetcher();
+
+  // Read the entries recorded by a previous run. Returns false if the file is missing or
+  // malformed, in which case nothing is prefetched.
+  bool Load() LOCKS_EXCLUDED(lock_);
+
+  // Write the recorded entries if anything changed since they were loaded.
+  bool Save() LOCKS_EXCLUDED(lock_);
+
+  // Start resolving the entries recorded for dex_file that only involve the boot class path.
+  // Only the first call for a dex file has an effect.
+  void Prefetch(const DexFile& dex_file) LOCKS_EXCLUDED(lock_);
+
+  // Wait for the entries of the dex files passed to Prefetch so far to be resolved. The caller
+  // must not be runnable.
+  void WaitForPrefetching();
+
+  void RecordString(const DexFile& dex_file, uint32_t string_idx) LOCKS_EXCLUDED(lock_) {
+    Record(dex_file, Entry(kString, string_idx, 0));
+  }
+  void RecordType(const DexFile& dex_file, uint16_t type_idx) LOCKS_EXCLUDED(lock_) {
+    Record(dex_file, Entry(kType, type_idx, 0));
+  }
+  void RecordField(const DexFile& dex_file, uint32_t field_idx, bool is_static)
+      LOCKS_EXCLUDED(lock_) {
+    Record(dex_file, Entry(kField, field_idx, is_static ? 1 : 0));
+  }
+  void RecordMethod(const DexFile& dex_file, uint32_t method_idx, InvokeType type)
+      LOCKS_EXCLUDED(lock_) {
+    Record(dex_file, Entry(kMethod, method_idx, type));
+  }
+
+  // Number of entries recorded for dex_file.
+  size_t Size(const DexFile& dex_file) LOCKS_EXCLUDED(lock_);
+
+ private:
+  // Entries of a kind are resolved after those of the kinds before it, fields and methods need
+  // the types that declare them.
+  enum EntryKind {
+    kString,
+    kType,
+    kField,
+    kMethod,
+    kNumEntryKinds,
+  };
+
+  struct Entry {
+    Entry(EntryKind kind_in, uint32_t index_in, uint32_t arg_in)
+        : kind(kind_in), index(index_in), arg(arg_in) {}
+
+    bool operator<(const Entry& other) const {
+      if (kind != other.kind) {
+        return kind < other.kind;
+      }
+      return index != other.index ? index < other.index : arg < other.arg;
+    }
+
+    EntryKind kind;
+    uint32_t index;
+    // Whether a field is static, or the invoke type of a method.
+    uint32_t arg;
+  };
+  typedef std::set<Entry> Entries;
+
+  class PrefetchTask;
+  class SaveTask;
+
+  void Record(const DexFile& dex_file, const Entry& entry) LOCKS_EXCLUDED(lock_);
+  bool Parse(std::istream& is) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const std::string filename_;
+  const uint64_t start_ms_;
+  // Cleared once kRecordingDurationMs has passed, read without holding lock_.
+  volatile bool recording_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Entries keyed by the location checksum of their dex file.
+  SafeMap<uint32_t, Entries> entries_ GUARDED_BY(lock_);
+  // Dex files that Prefetch has been called for.
+  std::set<const DexFile*> prefetched_ GUARDED_BY(lock_);
+  bool dirty_ GUARDED_BY(lock_);
+
+  // Single worker running the prefetch and save tasks. Tasks are added without holding lock_, as
+  // the pool's own lock is at the same level.
+  UniquePtr<ThreadPool> thread_pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(DexCachePrefetcher);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_DEX_CACHE_PREFETCHER_H_
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_cache_prefetcher.h"
+
+#include "common_test.h"
+#include "mirror/dex_cache.h"
+
+namespace art {
+
+class DexCachePrefetcherTest : public CommonTest {};
+
+TEST_F(DexCachePrefetcherTest, RecordSaveLoad) {
+  ScratchFile tmp;
+  {
+    DexCachePrefetcher prefetcher(tmp.GetFilename());
+    prefetcher.RecordString(*java_lang_dex_file_, 1);
+    prefetcher.RecordType(*java_lang_dex_file_, 2);
+    prefetcher.RecordType(*java_lang_dex_file_, 2);
+    prefetcher.RecordField(*java_lang_dex_file_, 3, true);
+    prefetcher.RecordMethod(*java_lang_dex_file_, 4, kVirtual);
+    EXPECT_EQ(4U, prefetcher.Size(*java_lang_dex_file_));
+    ASSERT_TRUE(prefetcher.Save());
+  }
+
+  DexCachePrefetcher prefetcher(tmp.GetFilename());
+  ASSERT_TRUE(prefetcher.Load());
+  EXPECT_EQ(4U, prefetcher.Size(*java_lang_dex_file_));
+}
+
+TEST_F(DexCachePrefetcherTest, Malformed) {
+  ScratchFile tmp;
+  const char kGarbage[] = "art-dex-cache-profile 1\n1 x 2 3\n";
+  ASSERT_TRUE(tmp.GetFile()->WriteFully(kGarbage, sizeof(kGarbage) - 1));
+  DexCachePrefetcher prefetcher(tmp.GetFilename());
+  EXPECT_FALSE(prefetcher.Load());
+  EXPECT_EQ(0U, prefetcher.Size(*java_lang_dex_file_));
+}
+
+TEST_F(DexCachePrefetcherTest, PrefetchBootTypes) {
+  ScratchFile tmp;
+  const DexFile* dex_file;
+  uint16_t object_type_idx;
+  uint16_t nested_type_idx;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    dex_file = OpenTestDexFile("Nested");
+    class_linker_->RegisterDexFile(*dex_file);
+    const DexFile::StringId* object_string_id = dex_file->FindStringId("Ljava/lang/Object;");
+    ASSERT_TRUE(object_string_id != NULL);
+    object_type_idx = dex_file->GetIndexForTypeId(
+        *dex_file->FindTypeId(dex_file->GetIndexForStringId(*object_string_id)));
+    const DexFile::StringId* nested_string_id = dex_file->FindStringId("LNested;");
+    ASSERT_TRUE(nested_string_id != NULL);
+    nested_type_idx = dex_file->GetIndexForTypeId(
+        *dex_file->FindTypeId(dex_file->GetIndexForStringId(*nested_string_id)));
+  }
+  {
+    DexCachePrefetcher prefetcher(tmp.GetFilename());
+    prefetcher.RecordType(*dex_file, object_type_idx);
+    prefetcher.RecordType(*dex_file, nested_type_idx);
+    ASSERT_TRUE(prefetcher.Save());
+  }
+
+  DexCachePrefetcher prefetcher(tmp.GetFilename());
+  ASSERT_TRUE(prefetcher.Load());
+  prefetcher.Prefetch(*dex_file);
+  prefetcher.WaitForPrefetching();
+
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::DexCache* dex_cache = class_linker_->FindDexCache(*dex_file);
+  EXPECT_EQ(class_linker_->FindSystemClass("Ljava/lang/Object;"),
+            dex_cache->GetResolvedType(object_type_idx));
+  // Nested is not on the boot class path, only its own class loader may load it.
+  EXPECT_TRUE(dex_cache->GetResolvedType(nested_type_idx) == NULL);
+}
+
+}  // namespace art
@@ -605,9 +605,10 @@ size_t ElfFile::GetLoadedSize() {
   return loaded_size;
 }
 
-bool ElfFile::Load(bool executable, std::string* error_msg) {
+bool ElfFile::Load(bool executable, ptrdiff_t load_bias, std::string* error_msg) {
   // TODO: actually return false error
   CHECK(program_header_only_) << file_->GetPath();
+  base_address_ = reinterpret_cast<byte*>(load_bias);
   for (llvm::ELF::Elf32_Word i = 0; i < GetProgramHeaderNum(); i++) {
     llvm::ELF::Elf32_Phdr& program_header = GetProgramHeader(i);
 
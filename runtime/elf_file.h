@@ -114,8 +114,9 @@ class ElfFile {
   size_t GetLoadedSize();
 
   // Load segments into memory based on PT_LOAD program headers.
-  // executable is true at run time, false at compile time.
-  bool Load(bool executable, std::string* error_msg);
+  // executable is true at run time, false at compile time. Segments linked at fixed addresses are
+  // loaded load_bias bytes away from them.
+  bool Load(bool executable, ptrdiff_t load_bias, std::string* error_msg);
 
  private:
   ElfFile();
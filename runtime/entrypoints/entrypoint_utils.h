@@ -457,7 +457,7 @@ static inline mirror::ArtMethod* FindMethodFromCode(uint32_t method_idx, mirror:
         return imt_method;
       } else {
         mirror::ArtMethod* interface_method =
-            this_object->GetClass()->FindVirtualMethodForInterface(resolved_method);
+            self->FindVirtualMethodForInterface(this_object->GetClass(), resolved_method);
         if (UNLIKELY(interface_method == nullptr)) {
           ThrowIncompatibleClassChangeErrorClassForInterfaceDispatch(resolved_method, this_object,
                                                                      referrer);
@@ -579,7 +579,8 @@ static inline mirror::ArtMethod* FindMethodFast(uint32_t method_idx,
     }
   }
   if (type == kInterface) {  // Most common form of slow path dispatch.
-    return this_object->GetClass()->FindVirtualMethodForInterface(resolved_method);
+    return Thread::Current()->FindVirtualMethodForInterface(this_object->GetClass(),
+                                                            resolved_method);
   } else if (is_direct) {
     return resolved_method;
   } else if (type == kSuper) {
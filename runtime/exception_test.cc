@@ -17,7 +17,9 @@
 #include "class_linker.h"
 #include "common_test.h"
 #include "dex_file.h"
+#include "gc_map_builder.h"
 #include "gtest/gtest.h"
+#include "instrumentation.h"
 #include "leb128_encoder.h"
 #include "mirror/class-inl.h"
 #include "mirror/object_array-inl.h"
@@ -72,6 +74,10 @@ class ExceptionTest : public CommonTest {
     fake_gc_map_.push_back(0);
     fake_gc_map_.push_back(0);  // 0 entries.
     fake_gc_map_.push_back(0);
+    fake_gc_map_.push_back(0);  // 0 reference bitmaps.
+    fake_gc_map_.push_back(0);
+    fake_gc_map_.push_back(0);  // 0 bytes to encode dex pcs.
+    fake_gc_map_.push_back(0);  // 0 bytes to encode bitmap indexes.
 
     method_f_ = my_klass_->FindVirtualMethod("f", "()I");
     ASSERT_TRUE(method_f_ != NULL);
@@ -139,6 +145,33 @@ TEST_F(ExceptionTest, FindCatchHandler) {
   }
 }
 
+#if !defined(ART_USE_PORTABLE_COMPILER)
+TEST_F(ExceptionTest, ToDexPc) {
+  // Suspend points at native offsets 1, 5 and 9 of the fake code. Offset 3 is only in the
+  // mapping table created in SetUp, like a catch entry.
+  const uint8_t references[] = { 0x00 };
+  std::vector<uint8_t> gc_map;
+  NativePcToReferenceMapBuilder builder(&gc_map, sizeof(references));
+  builder.AddEntry(9, 8, references);
+  builder.AddEntry(1, 0, references);
+  builder.AddEntry(5, 4, references);
+  builder.Finish();
+
+  ScopedObjectAccess soa(Thread::Current());
+  method_f_->SetNativeGcMap(&gc_map[0]);
+  uintptr_t code = reinterpret_cast<uintptr_t>(
+      Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(method_f_));
+  // Found in the GC map, including its first and last entries.
+  EXPECT_EQ(0U, method_f_->ToDexPc(code + 1));
+  EXPECT_EQ(4U, method_f_->ToDexPc(code + 5));
+  EXPECT_EQ(8U, method_f_->ToDexPc(code + 9));
+  // Missing from the GC map, found in the mapping table.
+  EXPECT_EQ(3U, method_f_->ToDexPc(code + 3));
+  // Without suspend points everything comes from the mapping table.
+  EXPECT_EQ(3U, method_g_->ToDexPc(code + 3));
+}
+#endif
+
 TEST_F(ExceptionTest, StackTraceElement) {
   Thread* thread = Thread::Current();
   thread->TransitionFromSuspendedToRunnable();
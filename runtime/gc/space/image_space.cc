@@ -16,6 +16,7 @@
 
 #include "image_space.h"
 
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
@@ -167,11 +168,73 @@ ImageSpace* ImageSpace::Create(const char* original_image_file_name) {
   return space;
 }
 
+// Reserves the pages of the image and its oat file, preferably where they were linked to be
+// loaded, and returns where the image goes. The image and the oat segments are then mapped over
+// the reservation with MAP_FIXED, so no other mapping can take the range in between. Pages of the
+// reservation neither of them covers stay reserved.
+static byte* ReserveImageBegin(const ImageHeader& image_header, const char* image_file_name,
+                               std::string* error_msg) {
+  byte* linked_begin = image_header.GetImageBegin();
+#if defined(ART_USE_PORTABLE_COMPILER)
+  // The oat file is loaded with dlopen, which can't put it next to a relocated image, so only the
+  // image is reserved and only where it was linked.
+  size_t byte_count = RoundUp(image_header.GetImageSize(), kPageSize);
+#else
+  size_t byte_count = image_header.GetOatFileEnd() - linked_begin;
+#endif
+  void* actual = mmap(linked_begin, byte_count, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (actual == MAP_FAILED) {
+    *error_msg = StringPrintf("Failed to reserve %zd bytes for image '%s': %s", byte_count,
+                              image_file_name, strerror(errno));
+    return nullptr;
+  }
+#if defined(ART_USE_PORTABLE_COMPILER)
+  if (actual != linked_begin) {
+    CHECK_EQ(munmap(actual, byte_count), 0);
+    *error_msg = StringPrintf("Failed to reserve image '%s' at %p", image_file_name, linked_begin);
+    return nullptr;
+  }
+#endif
+  return reinterpret_cast<byte*>(actual);
+}
+
+// Adjust the addresses in the image mapped at map, loaded delta bytes away from where it was
+// linked, and return the relocations its oat file needs.
+static bool RelocateImage(File* file, MemMap* map, ptrdiff_t delta,
+                          std::vector<uint32_t>* relocations, std::string* error_msg) {
+  ImageHeader* image_header = reinterpret_cast<ImageHeader*>(map->Begin());
+  relocations->resize(image_header->GetRelocationsSize() / sizeof(uint32_t));
+  if (relocations->empty() ||
+      file->Read(reinterpret_cast<char*>(&(*relocations)[0]), image_header->GetRelocationsSize(),
+                 image_header->GetRelocationsOffset()) !=
+          static_cast<int64_t>(image_header->GetRelocationsSize())) {
+    *error_msg = StringPrintf("Failed to read relocations of image '%s'", file->GetPath().c_str());
+    return false;
+  }
+  // The relocations are sorted, so this walks the image once, front to back.
+  byte* begin = map->Begin();
+  size_t image_relocations_count = image_header->GetImageRelocationsCount();
+  for (size_t i = 0; i < image_relocations_count; ++i) {
+    uint32_t offset = (*relocations)[i];
+    CHECK_LE(offset + sizeof(uint32_t), map->Size()) << file->GetPath();
+    *reinterpret_cast<uint32_t*>(begin + offset) += delta;
+  }
+  image_header->Relocate(delta);
+  // Leave only the relocations of the oat file.
+  relocations->erase(relocations->begin(), relocations->begin() + image_relocations_count);
+  return true;
+}
+
 void ImageSpace::VerifyImageAllocations() {
   byte* current = Begin() + RoundUp(sizeof(ImageHeader), kObjectAlignment);
   while (current < End()) {
     DCHECK_ALIGNED(current, kObjectAlignment);
     const mirror::Object* obj = reinterpret_cast<const mirror::Object*>(current);
+    if (obj->GetClass() == nullptr && !live_bitmap_->Test(obj)) {
+      // Padding before the page aligned bin of likely dirty objects.
+      current += kObjectAlignment;
+      continue;
+    }
     CHECK(live_bitmap_->Test(obj));
     CHECK(obj->GetClass() != nullptr) << "Image object at address " << obj << " has null class";
     current += RoundUp(obj->SizeOf(), kObjectAlignment);
@@ -201,22 +264,38 @@ ImageSpace* ImageSpace::Init(const char* image_file_name, bool validate_oat_file
   }
 
   // Note: The image header is part of the image due to mmap page alignment required of offset.
-  UniquePtr<MemMap> map(MemMap::MapFileAtAddress(image_header.GetImageBegin(),
+  byte* image_begin = ReserveImageBegin(image_header, image_file_name, error_msg);
+  if (image_begin == nullptr) {
+    return nullptr;
+  }
+  UniquePtr<MemMap> map(MemMap::MapFileAtAddress(image_begin,
                                                  image_header.GetImageSize(),
                                                  PROT_READ | PROT_WRITE,
                                                  MAP_PRIVATE | MAP_FIXED,
                                                  file->Fd(),
                                                  0,
-                                                 false,
+                                                 true,
                                                  image_file_name,
                                                  error_msg));
   if (map.get() == NULL) {
     DCHECK(!error_msg->empty());
     return nullptr;
   }
-  CHECK_EQ(image_header.GetImageBegin(), map->Begin());
+  CHECK_EQ(image_begin, map->Begin());
   DCHECK_EQ(0, memcmp(&image_header, map->Begin(), sizeof(ImageHeader)));
 
+  ptrdiff_t relocation_delta = image_begin - image_header.GetImageBegin();
+  std::vector<uint32_t> oat_relocations;
+  if (relocation_delta != 0) {
+    LOG(INFO) << "Relocating image '" << image_file_name << "' from "
+              << reinterpret_cast<void*>(image_header.GetImageBegin()) << " to "
+              << reinterpret_cast<void*>(image_begin);
+    if (!RelocateImage(file.get(), map.get(), relocation_delta, &oat_relocations, error_msg)) {
+      return nullptr;
+    }
+    image_header = *reinterpret_cast<ImageHeader*>(map->Begin());
+  }
+
   UniquePtr<MemMap> image_map(MemMap::MapFileAtAddress(nullptr, image_header.GetImageBitmapSize(),
                                                        PROT_READ, MAP_PRIVATE,
                                                        file->Fd(), image_header.GetBitmapOffset(),
@@ -259,7 +338,7 @@ ImageSpace* ImageSpace::Init(const char* image_file_name, bool validate_oat_file
     space->VerifyImageAllocations();
   }
 
-  space->oat_file_.reset(space->OpenOatFile(error_msg));
+  space->oat_file_.reset(space->OpenOatFile(relocation_delta, oat_relocations, error_msg));
   if (space->oat_file_.get() == nullptr) {
     DCHECK(!error_msg->empty());
     return nullptr;
@@ -277,7 +356,9 @@ ImageSpace* ImageSpace::Init(const char* image_file_name, bool validate_oat_file
   return space.release();
 }
 
-OatFile* ImageSpace::OpenOatFile(std::string* error_msg) const {
+OatFile* ImageSpace::OpenOatFile(ptrdiff_t relocation_delta,
+                                 const std::vector<uint32_t>& relocations,
+                                 std::string* error_msg) const {
   const Runtime* runtime = Runtime::Current();
   const ImageHeader& image_header = GetImageHeader();
   // Grab location but don't use Object::AsString as we haven't yet initialized the roots to
@@ -287,8 +368,15 @@ OatFile* ImageSpace::OpenOatFile(std::string* error_msg) const {
   std::string oat_filename;
   oat_filename += runtime->GetHostPrefix();
   oat_filename += oat_location->ToModifiedUtf8();
-  OatFile* oat_file = OatFile::Open(oat_filename, oat_filename, image_header.GetOatDataBegin(),
-                                    !Runtime::Current()->IsCompiler(), error_msg);
+  OatFile* oat_file;
+  if (relocation_delta == 0) {
+    oat_file = OatFile::Open(oat_filename, oat_filename, image_header.GetOatDataBegin(),
+                             !Runtime::Current()->IsCompiler(), error_msg);
+  } else {
+    oat_file = OatFile::OpenRelocated(oat_filename, oat_filename, image_header.GetOatDataBegin(),
+                                      relocation_delta, &relocations[0], relocations.size(),
+                                      !Runtime::Current()->IsCompiler(), error_msg);
+  }
   if (oat_file == NULL) {
     *error_msg = StringPrintf("Failed to open oat file '%s' referenced from image %s: %s",
                               oat_filename.c_str(), GetName(), error_msg->c_str());
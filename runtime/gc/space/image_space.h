@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_GC_SPACE_IMAGE_SPACE_H_
 #define ART_RUNTIME_GC_SPACE_IMAGE_SPACE_H_
 
+#include <vector>
+
 #include "space.h"
 
 namespace art {
@@ -86,7 +88,9 @@ class ImageSpace : public MemMapSpace {
   static ImageSpace* Init(const char* image, bool validate_oat_file, std::string* error_msg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  OatFile* OpenOatFile(std::string* error_msg) const
+  // Open the oat file of the image, moving it relocation_delta bytes from where it was linked.
+  OatFile* OpenOatFile(ptrdiff_t relocation_delta, const std::vector<uint32_t>& relocations,
+                       std::string* error_msg) const
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   bool ValidateOatFile(std::string* error_msg) const
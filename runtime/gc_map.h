@@ -24,9 +24,23 @@
 
 namespace art {
 
-// Lightweight wrapper for native PC offset to reference bit maps.
+// Lightweight wrapper for native PC offset to reference bit maps, the maps the quick compiler emits
+// for each suspend point of a method.
+//
+// The map starts with an 8 byte header:
+//   [0] native offset width in bytes (bits 0-2), low bits of the register bitmap width (bits 3-7)
+//   [1] high bits of the register bitmap width
+//   [2,3] number of entries
+//   [4,5] number of distinct register bitmaps
+//   [6] dex pc width in bytes
+//   [7] bitmap index width in bytes
+// followed by the entries sorted by native offset, each holding its native offset, dex pc and the
+// index of its register bitmap, and then the bitmaps themselves. Suspend points mostly share the
+// same few live reference sets, so each bitmap is stored once.
 class NativePcOffsetToReferenceMap {
  public:
+  static constexpr size_t kHeaderSize = 8;
+
   explicit NativePcOffsetToReferenceMap(const uint8_t* data) : data_(data) {
     CHECK(data_ != NULL);
   }
@@ -36,50 +50,57 @@ class NativePcOffsetToReferenceMap {
     return data_[2] | (data_[3] << 8);
   }
 
+  // The number of distinct register bitmaps.
+  size_t NumBitMaps() const {
+    return data_[4] | (data_[5] << 8);
+  }
+
   // Return address of bitmap encoding what are live references.
   const uint8_t* GetBitMap(size_t index) const {
-    size_t entry_offset = index * EntryWidth();
-    return &Table()[entry_offset + NativeOffsetWidth()];
+    size_t bitmap_index = ReadValue(index * EntryWidth() + NativeOffsetWidth() + DexPcWidth(),
+                                    BitMapIndexWidth());
+    return &Table()[NumEntries() * EntryWidth() + bitmap_index * RegWidth()];
   }
 
   // Get the native PC encoded in the table at the given index.
   uintptr_t GetNativePcOffset(size_t index) const {
-    size_t entry_offset = index * EntryWidth();
-    uintptr_t result = 0;
-    for (size_t i = 0; i < NativeOffsetWidth(); ++i) {
-      result |= Table()[entry_offset + i] << (i * 8);
-    }
-    return result;
+    return ReadValue(index * EntryWidth(), NativeOffsetWidth());
   }
 
-  // Does the given offset have an entry?
-  bool HasEntry(uintptr_t native_pc_offset) {
-    for (size_t i = 0; i < NumEntries(); ++i) {
-      if (GetNativePcOffset(i) == native_pc_offset) {
-        return true;
-      }
-    }
-    return false;
+  // Get the dex PC of the suspend point at the given index.
+  uint32_t GetDexPc(size_t index) const {
+    return ReadValue(index * EntryWidth() + NativeOffsetWidth(), DexPcWidth());
   }
 
-  // Finds the bitmap associated with the native pc offset.
-  const uint8_t* FindBitMap(uintptr_t native_pc_offset) {
+  // Returns the index of the entry for the native pc offset, or NumEntries() if there is none.
+  size_t FindEntry(uintptr_t native_pc_offset) const {
     size_t num_entries = NumEntries();
-    size_t index = Hash(native_pc_offset) % num_entries;
-    size_t misses = 0;
-    while (GetNativePcOffset(index) != native_pc_offset) {
-      index = (index + 1) % num_entries;
-      misses++;
-      DCHECK_LT(misses, num_entries) << "Failed to find offset: " << native_pc_offset;
+    size_t lo = 0;
+    size_t hi = num_entries;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (GetNativePcOffset(mid) < native_pc_offset) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
     }
-    return GetBitMap(index);
+    if (lo < num_entries && GetNativePcOffset(lo) == native_pc_offset) {
+      return lo;
+    }
+    return num_entries;
   }
 
-  static uint32_t Hash(uint32_t native_offset) {
-    uint32_t hash = native_offset;
-    hash ^= (hash >> 20) ^ (hash >> 12);
-    hash ^= (hash >> 7) ^ (hash >> 4);
-    return hash;
+  // Does the given offset have an entry?
+  bool HasEntry(uintptr_t native_pc_offset) const {
+    return FindEntry(native_pc_offset) != NumEntries();
+  }
+
+  // Finds the bitmap associated with the native pc offset.
+  const uint8_t* FindBitMap(uintptr_t native_pc_offset) const {
+    size_t index = FindEntry(native_pc_offset);
+    DCHECK_NE(index, NumEntries()) << "Failed to find offset: " << native_pc_offset;
+    return GetBitMap(index);
   }
 
   // The number of bytes used to encode registers.
@@ -87,10 +108,24 @@ class NativePcOffsetToReferenceMap {
     return (static_cast<size_t>(data_[0]) | (static_cast<size_t>(data_[1]) << 8)) >> 3;
   }
 
+  // The number of bytes used by the map.
+  size_t RawSize() const {
+    return kHeaderSize + NumEntries() * EntryWidth() + NumBitMaps() * RegWidth();
+  }
+
  private:
   // Skip the size information at the beginning of data.
   const uint8_t* Table() const {
-    return data_ + 4;
+    return data_ + kHeaderSize;
+  }
+
+  // Reads a little endian value of width bytes at offset in the table.
+  uint32_t ReadValue(size_t offset, size_t width) const {
+    uint32_t result = 0;
+    for (size_t i = 0; i < width; ++i) {
+      result |= Table()[offset + i] << (i * 8);
+    }
+    return result;
   }
 
   // Number of bytes used to encode a native offset.
@@ -98,9 +133,19 @@ class NativePcOffsetToReferenceMap {
     return data_[0] & 7;
   }
 
+  // Number of bytes used to encode a dex pc.
+  size_t DexPcWidth() const {
+    return data_[6];
+  }
+
+  // Number of bytes used to encode the index of a bitmap.
+  size_t BitMapIndexWidth() const {
+    return data_[7];
+  }
+
   // The width of an entry in the table.
   size_t EntryWidth() const {
-    return NativeOffsetWidth() + RegWidth();
+    return NativeOffsetWidth() + DexPcWidth() + BitMapIndexWidth();
   }
 
   const uint8_t* const data_;  // The header and table data
@@ -16,6 +16,9 @@
 
 #include "image.h"
 
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/dex_cache.h"
 #include "mirror/object_array.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/object-inl.h"
@@ -24,7 +27,7 @@
 namespace art {
 
 const byte ImageHeader::kImageMagic[] = { 'a', 'r', 't', '\n' };
-const byte ImageHeader::kImageVersion[] = { '0', '0', '6', '\0' };
+const byte ImageHeader::kImageVersion[] = { '0', '0', '7', '\0' };
 
 ImageHeader::ImageHeader(uint32_t image_begin,
                          uint32_t image_size,
@@ -45,7 +48,9 @@ ImageHeader::ImageHeader(uint32_t image_begin,
     oat_data_begin_(oat_data_begin),
     oat_data_end_(oat_data_end),
     oat_file_end_(oat_file_end),
-    image_roots_(image_roots) {
+    image_roots_(image_roots),
+    image_relocations_count_(0),
+    oat_relocations_count_(0) {
   CHECK_EQ(image_begin, RoundUp(image_begin, kPageSize));
   CHECK_EQ(oat_file_begin, RoundUp(oat_file_begin, kPageSize));
   CHECK_EQ(oat_data_begin, RoundUp(oat_data_begin, kPageSize));
@@ -68,6 +73,15 @@ bool ImageHeader::IsValid() const {
   return true;
 }
 
+void ImageHeader::Relocate(int32_t delta) {
+  image_begin_ += delta;
+  oat_file_begin_ += delta;
+  oat_data_begin_ += delta;
+  oat_data_end_ += delta;
+  oat_file_end_ += delta;
+  image_roots_ += delta;
+}
+
 const char* ImageHeader::GetMagic() const {
   CHECK(IsValid());
   return reinterpret_cast<const char*>(magic_);
@@ -81,4 +95,42 @@ mirror::ObjectArray<mirror::Object>* ImageHeader::GetImageRoots() const {
   return reinterpret_cast<mirror::ObjectArray<mirror::Object>*>(image_roots_);
 }
 
+void AddDexCacheObjects(mirror::DexCache* dex_cache, std::set<mirror::Object*>* dex_cache_objects) {
+  dex_cache_objects->insert(dex_cache);
+  dex_cache_objects->insert(dex_cache->GetStrings());
+  dex_cache_objects->insert(dex_cache->GetResolvedTypes());
+  dex_cache_objects->insert(dex_cache->GetResolvedMethods());
+  dex_cache_objects->insert(dex_cache->GetResolvedFields());
+}
+
+ImageObjectBin GetImageObjectBin(mirror::Object* obj,
+                                 const std::set<mirror::Object*>& dex_cache_objects) {
+  if (obj->IsClass()) {
+    // Initializing a class writes its status and static fields, and static fields that are not
+    // final may be written at any time.
+    mirror::Class* klass = obj->AsClass();
+    if (!klass->IsInitialized() || klass->NumStaticFields() != 0) {
+      return kImageObjectBinLikelyDirty;
+    }
+    return kImageObjectBinClean;
+  }
+  if (obj->IsArtMethod()) {
+    // The resolution trampoline of a static method is replaced once its class is initialized, and
+    // the dlsym lookup stub of a native method once it is registered.
+    mirror::ArtMethod* method = obj->AsArtMethod();
+    if (method->IsNative() || (method->IsStatic() && !method->IsConstructor() &&
+                               !method->GetDeclaringClass()->IsInitialized())) {
+      return kImageObjectBinLikelyDirty;
+    }
+    return kImageObjectBinClean;
+  }
+  if (obj->GetClass()->IsStringClass()) {
+    return kImageObjectBinString;
+  }
+  if (dex_cache_objects.count(obj) != 0) {
+    return kImageObjectBinLikelyDirty;
+  }
+  return kImageObjectBinClean;
+}
+
 }  // namespace art
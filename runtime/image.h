@@ -19,11 +19,17 @@
 
 #include <string.h>
 
+#include <set>
+
+#include "base/mutex.h"
 #include "globals.h"
 #include "mirror/object.h"
 #include "utils.h"
 
 namespace art {
+namespace mirror {
+  class DexCache;
+}  // namespace mirror
 
 // header of image files written by ImageWriter, read and validated by Space.
 class PACKED(4) ImageHeader {
@@ -88,6 +94,33 @@ class PACKED(4) ImageHeader {
     return RoundUp(image_size_, kPageSize);
   }
 
+  // The relocations follow the bitmap. They are the offsets of the words holding an address in
+  // the image or oat file, first those in the image, then those in the oat data.
+  size_t GetRelocationsOffset() const {
+    return image_bitmap_offset_ + image_bitmap_size_;
+  }
+
+  size_t GetRelocationsSize() const {
+    return (image_relocations_count_ + oat_relocations_count_) * sizeof(uint32_t);
+  }
+
+  size_t GetImageRelocationsCount() const {
+    return image_relocations_count_;
+  }
+
+  size_t GetOatRelocationsCount() const {
+    return oat_relocations_count_;
+  }
+
+  void SetRelocationsCounts(uint32_t image_relocations_count, uint32_t oat_relocations_count) {
+    image_relocations_count_ = image_relocations_count;
+    oat_relocations_count_ = oat_relocations_count;
+  }
+
+  // Update the addresses for an image and oat file loaded delta bytes away from where they were
+  // linked.
+  void Relocate(int32_t delta);
+
   enum ImageRoot {
     kResolutionMethod,
     kImtConflictMethod,
@@ -144,10 +177,36 @@ class PACKED(4) ImageHeader {
   // Absolute address of an Object[] of objects needed to reinitialize from an image.
   uint32_t image_roots_;
 
+  // Number of relocations in the image and in the oat data.
+  uint32_t image_relocations_count_;
+  uint32_t oat_relocations_count_;
+
   friend class ImageWriter;
   friend class ImageDumper;  // For GetImageRoots()
 };
 
+// ImageWriter groups the objects of an image into bins by how likely the runtime is to write to
+// them. A written page of the image becomes private to the process that wrote it, so objects that
+// are likely to be written are kept apart from those that never are.
+enum ImageObjectBin {
+  kImageObjectBinString,       // Strings, which are never written.
+  kImageObjectBinClean,        // Other objects the runtime doesn't write.
+  kImageObjectBinLikelyDirty,  // Objects written as classes are initialized or ids are resolved.
+  kImageObjectBinCount,
+};
+
+// Add dex_cache and the arrays it resolves ids into to dex_cache_objects. These arrays look like
+// any other object array, GetImageObjectBin needs to be told about them.
+void AddDexCacheObjects(mirror::DexCache* dex_cache, std::set<mirror::Object*>* dex_cache_objects)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+// Returns the bin of obj. Classes with static fields or left to initialize, native methods and
+// methods whose entry point is replaced when their class is initialized, and dex cache objects are
+// likely dirty.
+ImageObjectBin GetImageObjectBin(mirror::Object* obj,
+                                 const std::set<mirror::Object*>& dex_cache_objects)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_IMAGE_H_
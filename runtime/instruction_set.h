@@ -33,7 +33,8 @@ enum InstructionSet {
 };
 
 enum InstructionFeatures {
-  kHwDiv = 1                  // Supports hardware divide.
+  kHwDiv = 1,                 // Supports hardware divide.
+  kNeon = 2,                  // Supports the Advanced SIMD (NEON) extension.
 };
 
 // This is a bitmask of supported features per architecture.
@@ -50,11 +51,25 @@ class PACKED(4) InstructionSetFeatures {
     mask_ = (mask_ & ~kHwDiv) | (v ? kHwDiv : 0);
   }
 
+  bool HasNeon() const {
+      return (mask_ & kNeon) != 0;
+  }
+
+  void SetHasNeon(bool v) {
+    mask_ = (mask_ & ~kNeon) | (v ? kNeon : 0);
+  }
+
   std::string GetFeatureString() const {
     std::string result;
     if ((mask_ & kHwDiv) != 0) {
       result += "div";
     }
+    if ((mask_ & kNeon) != 0) {
+      if (result.size() != 0) {
+        result += ",";
+      }
+      result += "neon";
+    }
     if (result.size() == 0) {
       result = "none";
     }
@@ -22,6 +22,7 @@
 #include "dex_file-inl.h"
 #include "dex_instruction.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc_map.h"
 #include "interpreter/interpreter.h"
 #include "jni_internal.h"
 #include "mapping_table.h"
@@ -161,6 +162,15 @@ uint32_t ArtMethod::ToDexPc(const uintptr_t pc) const {
   }
   const void* code = Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(this);
   uint32_t sought_offset = pc - reinterpret_cast<uintptr_t>(code);
+  // Suspend points, the usual case, are found by a binary search of the GC map.
+  const uint8_t* native_gc_map = GetNativeGcMap();
+  if (native_gc_map != nullptr) {
+    NativePcOffsetToReferenceMap map(native_gc_map);
+    size_t index = map.FindEntry(sought_offset);
+    if (index != map.NumEntries()) {
+      return map.GetDexPc(index);
+    }
+  }
   // Assume the caller wants a pc-to-dex mapping so check here first.
   typedef MappingTable::PcToDexIterator It;
   for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
@@ -199,6 +199,10 @@ class MANAGED ArtMethod : public Object {
   void Invoke(Thread* self, uint32_t* args, uint32_t args_size, JValue* result, char result_type)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  static MemberOffset EntryPointFromInterpreterOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, entry_point_from_interpreter_);
+  }
+
   EntryPointFromInterpreter* GetEntryPointFromInterpreter() const {
     return GetFieldPtr<EntryPointFromInterpreter*>(OFFSET_OF_OBJECT_MEMBER(ArtMethod, entry_point_from_interpreter_), false);
   }
@@ -242,6 +246,10 @@ class MANAGED ArtMethod : public Object {
     return OFFSET_OF_OBJECT_MEMBER(ArtMethod, entry_point_from_compiled_code_);
   }
 
+  static MemberOffset MappingTableOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, mapping_table_);
+  }
+
   // Callers should wrap the uint8_t* in a MappingTable instance for convenient access.
   const uint8_t* GetMappingTable() const {
     return GetFieldPtr<const uint8_t*>(OFFSET_OF_OBJECT_MEMBER(ArtMethod, mapping_table_), false);
@@ -256,6 +264,10 @@ class MANAGED ArtMethod : public Object {
 
   void SetOatMappingTableOffset(uint32_t mapping_table_offset);
 
+  static MemberOffset VmapTableOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, vmap_table_);
+  }
+
   // Callers should wrap the uint8_t* in a VmapTable instance for convenient access.
   const uint8_t* GetVmapTable() const {
     return GetFieldPtr<const uint8_t*>(OFFSET_OF_OBJECT_MEMBER(ArtMethod, vmap_table_), false);
@@ -269,6 +281,10 @@ class MANAGED ArtMethod : public Object {
 
   void SetOatVmapTableOffset(uint32_t vmap_table_offset);
 
+  static MemberOffset NativeGcMapOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, gc_map_);
+  }
+
   const uint8_t* GetNativeGcMap() const {
     return GetFieldPtr<uint8_t*>(OFFSET_OF_OBJECT_MEMBER(ArtMethod, gc_map_), false);
   }
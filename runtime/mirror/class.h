@@ -278,6 +278,10 @@ class MANAGED Class : public Object {
     SetField32(OFFSET_OF_OBJECT_MEMBER(Class, primitive_type_), new_type, false);
   }
 
+  static MemberOffset PrimitiveTypeOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(Class, primitive_type_);
+  }
+
   // Returns true if the class is a primitive type.
   bool IsPrimitive() const {
     return GetPrimitiveType() != Primitive::kPrimNot;
@@ -19,6 +19,7 @@
 #include "base/logging.h"
 #include "class_linker.h"
 #include "common_throws.h"
+#include "dex_cache_prefetcher.h"
 #include "dex_file-inl.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space-inl.h"
@@ -173,6 +174,10 @@ static jclass DexFile_defineClassNative(JNIEnv* env, jclass, jstring javaName, j
   SirtRef<mirror::ClassLoader> class_loader(soa.Self(), soa.Decode<mirror::ClassLoader*>(javaLoader));
   mirror::Class* result = class_linker->DefineClass(descriptor.c_str(), class_loader, *dex_file,
                                                     *dex_class_def);
+  DexCachePrefetcher* prefetcher = Runtime::Current()->GetDexCachePrefetcher();
+  if (prefetcher != nullptr) {
+    prefetcher->Prefetch(*dex_file);
+  }
   VLOG(class_linker) << "DexFile_defineClassNative returning " << result;
   return soa.AddLocalReference<jclass>(result);
 }
@@ -482,6 +482,8 @@ static void VMRuntime_registerAppInfo(JNIEnv* env, jclass, jstring appDir, jstri
   const char *procNameChars = env->GetStringUTFChars(procName, NULL);
   std::string profileFile = std::string(appDirChars) + "/art-profile-" + std::string(procNameChars);
   Runtime::Current()->StartProfiler(profileFile.c_str());
+  Runtime::Current()->StartDexCachePrefetcher(std::string(appDirChars) + "/art-dexcache-" +
+                                              std::string(procNameChars));
   env->ReleaseStringUTFChars(appDir, appDirChars);
   env->ReleaseStringUTFChars(procName, procNameChars);
 }
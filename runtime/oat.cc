@@ -22,7 +22,7 @@
 namespace art {
 
 const uint8_t OatHeader::kOatMagic[] = { 'o', 'a', 't', '\n' };
-const uint8_t OatHeader::kOatVersion[] = { '0', '1', '4', '\0' };
+const uint8_t OatHeader::kOatVersion[] = { '0', '1', '5', '\0' };
 
 OatHeader::OatHeader() {
   memset(this, 0, sizeof(*this));
@@ -98,6 +98,11 @@ void OatHeader::UpdateChecksum(const void* data, size_t length) {
   adler32_checksum_ = adler32(adler32_checksum_, bytes, length);
 }
 
+void OatHeader::CombineChecksum(uint32_t checksum, size_t length) {
+  DCHECK(IsValid());
+  adler32_checksum_ = adler32_combine(adler32_checksum_, checksum, length);
+}
+
 InstructionSet OatHeader::GetInstructionSet() const {
   CHECK(IsValid());
   return instruction_set_;
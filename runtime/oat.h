@@ -42,6 +42,8 @@ class PACKED(4) OatHeader {
   const char* GetMagic() const;
   uint32_t GetChecksum() const;
   void UpdateChecksum(const void* data, size_t length);
+  // Append length bytes whose adler32 checksum was computed separately, such as on another thread.
+  void CombineChecksum(uint32_t checksum, size_t length);
   uint32_t GetDexFileCount() const {
     DCHECK(IsValid());
     return dex_file_count_;
@@ -17,6 +17,7 @@
 #include "oat_file.h"
 
 #include <dlfcn.h>
+#include <sys/mman.h>
 
 #include "base/bit_vector.h"
 #include "base/stl_util.h"
@@ -86,12 +87,44 @@ OatFile* OatFile::Open(const std::string& filename,
   if (file.get() == NULL) {
     return NULL;
   }
-  return OpenElfFile(file.get(), location, requested_base, false, executable, error_msg);
+  return OpenElfFile(file.get(), location, requested_base, 0, false, executable, error_msg);
+}
+
+OatFile* OatFile::OpenRelocated(const std::string& filename,
+                                const std::string& location,
+                                byte* requested_base,
+                                ptrdiff_t relocation_delta,
+                                const uint32_t* relocations,
+                                size_t relocations_count,
+                                bool executable,
+                                std::string* error_msg) {
+  CHECK(!filename.empty()) << location;
+  CheckLocation(filename);
+#ifdef ART_USE_PORTABLE_COMPILER
+  // dlopen chooses where the code goes, it can't follow the image.
+  *error_msg = StringPrintf("Cannot relocate portable oat file '%s'", filename.c_str());
+  return NULL;
+#endif
+  UniquePtr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file.get() == NULL) {
+    *error_msg = StringPrintf("Failed to open oat file '%s'", filename.c_str());
+    return NULL;
+  }
+  UniquePtr<OatFile> oat_file(OpenElfFile(file.get(), location, requested_base, relocation_delta,
+                                          false, executable, error_msg));
+  if (oat_file.get() == NULL) {
+    return NULL;
+  }
+  if (!oat_file->Relocate(relocation_delta, relocations, relocations_count, executable,
+                          error_msg)) {
+    return NULL;
+  }
+  return oat_file.release();
 }
 
 OatFile* OatFile::OpenWritable(File* file, const std::string& location, std::string* error_msg) {
   CheckLocation(location);
-  return OpenElfFile(file, location, NULL, true, false, error_msg);
+  return OpenElfFile(file, location, NULL, 0, true, false, error_msg);
 }
 
 OatFile* OatFile::OpenDlopen(const std::string& elf_filename,
@@ -109,11 +142,13 @@ OatFile* OatFile::OpenDlopen(const std::string& elf_filename,
 OatFile* OatFile::OpenElfFile(File* file,
                               const std::string& location,
                               byte* requested_base,
+                              ptrdiff_t load_bias,
                               bool writable,
                               bool executable,
                               std::string* error_msg) {
   UniquePtr<OatFile> oat_file(new OatFile(location));
-  bool success = oat_file->ElfFileOpen(file, requested_base, writable, executable, error_msg);
+  bool success = oat_file->ElfFileOpen(file, requested_base, load_bias, writable, executable,
+                                       error_msg);
   if (!success) {
     CHECK(!error_msg->empty());
     return nullptr;
@@ -170,14 +205,14 @@ bool OatFile::Dlopen(const std::string& elf_filename, byte* requested_base,
   return Setup(error_msg);
 }
 
-bool OatFile::ElfFileOpen(File* file, byte* requested_base, bool writable, bool executable,
-                          std::string* error_msg) {
+bool OatFile::ElfFileOpen(File* file, byte* requested_base, ptrdiff_t load_bias, bool writable,
+                          bool executable, std::string* error_msg) {
   elf_file_.reset(ElfFile::Open(file, writable, true, error_msg));
   if (elf_file_.get() == nullptr) {
     DCHECK(!error_msg->empty());
     return false;
   }
-  bool loaded = elf_file_->Load(executable, error_msg);
+  bool loaded = elf_file_->Load(executable, load_bias, error_msg);
   if (!loaded) {
     DCHECK(!error_msg->empty());
     return false;
@@ -204,6 +239,41 @@ bool OatFile::ElfFileOpen(File* file, byte* requested_base, bool writable, bool
   return Setup(error_msg);
 }
 
+bool OatFile::Relocate(ptrdiff_t delta, const uint32_t* relocations, size_t relocations_count,
+                       bool executable, std::string* error_msg) {
+  byte* begin = const_cast<byte*>(Begin());
+  byte* page_begin = AlignDown(begin, kPageSize);
+  size_t page_length = AlignUp(const_cast<byte*>(End()), kPageSize) - page_begin;
+  if (mprotect(page_begin, page_length, PROT_READ | PROT_WRITE) != 0) {
+    *error_msg = StringPrintf("Failed to make oat file '%s' writable for relocation: %s",
+                              GetLocation().c_str(), strerror(errno));
+    return false;
+  }
+  for (size_t i = 0; i < relocations_count; ++i) {
+    CHECK_LE(relocations[i] + sizeof(uint32_t), Size()) << GetLocation();
+    *reinterpret_cast<uint32_t*>(begin + relocations[i]) += delta;
+  }
+  // The code starts on a page of its own at oatexec, everything before it is read only data.
+  byte* exec_begin = elf_file_->FindDynamicSymbolAddress("oatexec");
+  if (exec_begin == NULL || !IsAligned<kPageSize>(exec_begin) || exec_begin < page_begin ||
+      exec_begin > page_begin + page_length) {
+    *error_msg = StringPrintf("Failed to find page aligned oatexec symbol in oat file '%s'",
+                              GetLocation().c_str());
+    return false;
+  }
+  size_t exec_length = page_begin + page_length - exec_begin;
+  if (mprotect(page_begin, exec_begin - page_begin, PROT_READ) != 0 ||
+      mprotect(exec_begin, exec_length, executable ? PROT_READ | PROT_EXEC : PROT_READ) != 0) {
+    *error_msg = StringPrintf("Failed to protect oat file '%s' after relocation: %s",
+                              GetLocation().c_str(), strerror(errno));
+    return false;
+  }
+  // The relocations are in the literals of the code.
+  __builtin___clear_cache(reinterpret_cast<char*>(exec_begin),
+                          reinterpret_cast<char*>(exec_begin + exec_length));
+  return true;
+}
+
 bool OatFile::Setup(std::string* error_msg) {
   if (!GetOatHeader().IsValid()) {
     *error_msg = StringPrintf("Invalid oat magic for '%s'", GetLocation().c_str());
@@ -49,6 +49,18 @@ class OatFile {
                        bool executable,
                        std::string* error_msg);
 
+  // Open an oat file that was linked to be loaded relocation_delta bytes before requested_base,
+  // at requested_base. The words at the offsets in relocations hold addresses and are moved by
+  // relocation_delta. Returns NULL on failure.
+  static OatFile* OpenRelocated(const std::string& filename,
+                                const std::string& location,
+                                byte* requested_base,
+                                ptrdiff_t relocation_delta,
+                                const uint32_t* relocations,
+                                size_t relocations_count,
+                                bool executable,
+                                std::string* error_msg);
+
   // Open an oat file from an already opened File.
   // Does not use dlopen underneath so cannot be used for runtime use
   // where relocations may be required. Currently used from
@@ -245,15 +257,18 @@ class OatFile {
   static OatFile* OpenElfFile(File* file,
                               const std::string& location,
                               byte* requested_base,
+                              ptrdiff_t load_bias,
                               bool writable,
                               bool executable,
                               std::string* error_msg);
 
   explicit OatFile(const std::string& filename);
   bool Dlopen(const std::string& elf_filename, byte* requested_base, std::string* error_msg);
-  bool ElfFileOpen(File* file, byte* requested_base, bool writable, bool executable,
-                   std::string* error_msg);
+  bool ElfFileOpen(File* file, byte* requested_base, ptrdiff_t load_bias, bool writable,
+                   bool executable, std::string* error_msg);
   bool Setup(std::string* error_msg);
+  bool Relocate(ptrdiff_t delta, const uint32_t* relocations, size_t relocations_count,
+                bool executable, std::string* error_msg);
 
   const byte* Begin() const;
   const byte* End() const;
@@ -18,6 +18,9 @@
 
 #include <sys/uio.h>
 
+#include <algorithm>
+#include <sstream>
+
 #include "base/stl_util.h"
 #include "base/unix_file/fd_file.h"
 #include "class_linker.h"
@@ -36,6 +39,7 @@
 #include "ScopedLocalRef.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "utils.h"
 #if !defined(ART_USE_PORTABLE_COMPILER)
 #include "entrypoints/quick/quick_entrypoints.h"
 #endif
@@ -444,5 +448,58 @@ uint32_t ProfileSampleResults::Hash(mirror::ArtMethod* method) {
   return value % kHashSize;
 }
 
+// The first line holds the sample counts written by ProfileSampleResults::Write, each following
+// line describes a method:
+//   <method name>/<sample count>/<code size>
+bool ProfileHelper::LoadTopKMethods(const std::string& filename, double top_k_threshold,
+                                    std::set<std::string>* top_k_methods) {
+  std::string contents;
+  if (!ReadFileToString(filename, &contents)) {
+    return false;
+  }
+  std::istringstream is(contents);
+  std::string line;
+  if (!std::getline(is, line)) {
+    return false;
+  }
+  std::vector<std::pair<uint32_t, std::string> > samples;
+  uint64_t total_samples = 0;
+  while (std::getline(is, line)) {
+    // Method names contain no '/', split from the end.
+    size_t size_start = line.rfind('/');
+    if (size_start == std::string::npos || size_start == 0) {
+      return false;
+    }
+    size_t count_start = line.rfind('/', size_start - 1);
+    if (count_start == std::string::npos || count_start == 0) {
+      return false;
+    }
+    std::string count_str(line, count_start + 1, size_start - count_start - 1);
+    char* end;
+    uint32_t count = strtoul(count_str.c_str(), &end, 10);
+    if (count_str.empty() || *end != '\0') {
+      return false;
+    }
+    samples.push_back(std::make_pair(count, line.substr(0, count_start)));
+    total_samples += count;
+  }
+  // Most sampled first, by name for equal counts so that the result doesn't depend on the order
+  // of the file.
+  std::sort(samples.begin(), samples.end(),
+            [](const std::pair<uint32_t, std::string>& lhs,
+               const std::pair<uint32_t, std::string>& rhs) {
+    return (lhs.first != rhs.first) ? lhs.first > rhs.first : lhs.second < rhs.second;
+  });
+  uint64_t top_k_samples = 0;
+  for (const auto& sample : samples) {
+    if (top_k_samples * 100.0 >= top_k_threshold * total_samples) {
+      break;
+    }
+    top_k_methods->insert(sample.second);
+    top_k_samples += sample.first;
+  }
+  return true;
+}
+
 }  // namespace art
 
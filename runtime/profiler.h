@@ -169,6 +169,19 @@ class BackgroundMethodSamplingProfiler {
   DISALLOW_COPY_AND_ASSIGN(BackgroundMethodSamplingProfiler);
 };
 
+// Reads the profiles written by BackgroundMethodSamplingProfiler.
+class ProfileHelper {
+ public:
+  // Fill top_k_methods with the PrettyMethod names of the most sampled methods, taking methods
+  // until together they account for top_k_threshold percent of the samples. Returns false if
+  // the file can't be read or is malformed.
+  static bool LoadTopKMethods(const std::string& filename, double top_k_threshold,
+                              std::set<std::string>* top_k_methods);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ProfileHelper);
+};
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_PROFILER_H_
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "profiler.h"
+
+#include "common_test.h"
+
+namespace art {
+
+class ProfileHelperTest : public CommonTest {
+ protected:
+  void WriteProfile(const ScratchFile& file, const std::string& contents) {
+    ASSERT_TRUE(file.GetFile()->WriteFully(contents.c_str(), contents.length()));
+  }
+};
+
+TEST_F(ProfileHelperTest, LoadTopKMethods) {
+  ScratchFile tmp;
+  WriteProfile(tmp,
+               "100/0/0\n"
+               "void Foo.cold()/5/10\n"
+               "int Foo.hot(int, java.lang.String)/60/200\n"
+               "void Foo.warm()/30/40\n"
+               "void Foo.lukewarm()/5/12\n");
+
+  std::set<std::string> methods;
+  ASSERT_TRUE(ProfileHelper::LoadTopKMethods(tmp.GetFilename(), 90.0, &methods));
+  EXPECT_EQ(2U, methods.size());
+  EXPECT_EQ(1U, methods.count("int Foo.hot(int, java.lang.String)"));
+  EXPECT_EQ(1U, methods.count("void Foo.warm()"));
+
+  methods.clear();
+  ASSERT_TRUE(ProfileHelper::LoadTopKMethods(tmp.GetFilename(), 50.0, &methods));
+  EXPECT_EQ(1U, methods.size());
+
+  methods.clear();
+  ASSERT_TRUE(ProfileHelper::LoadTopKMethods(tmp.GetFilename(), 100.0, &methods));
+  EXPECT_EQ(4U, methods.size());
+}
+
+TEST_F(ProfileHelperTest, Malformed) {
+  ScratchFile tmp;
+  WriteProfile(tmp, "100/0/0\nvoid Foo.bar()/lots/10\n");
+  std::set<std::string> methods;
+  EXPECT_FALSE(ProfileHelper::LoadTopKMethods(tmp.GetFilename(), 90.0, &methods));
+  EXPECT_FALSE(ProfileHelper::LoadTopKMethods(tmp.GetFilename() + "-missing", 90.0, &methods));
+}
+
+}  // namespace art
@@ -32,8 +32,10 @@
 #include "arch/mips/registers_mips.h"
 #include "arch/x86/registers_x86.h"
 #include "atomic.h"
+#include "base/arena_allocator.h"
 #include "class_linker.h"
 #include "debugger.h"
+#include "dex_cache_prefetcher.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/heap.h"
 #include "gc/space/space.h"
@@ -62,6 +64,7 @@
 #include "profiler.h"
 #include "UniquePtr.h"
 #include "verifier/method_verifier.h"
+#include "verifier/verification_cache.h"
 #include "well_known_classes.h"
 
 #include "JniConstants.h"  // Last to avoid LOG redefinition in ics-mr1-plus-art.
@@ -82,6 +85,7 @@ Runtime::Runtime()
       thread_list_(NULL),
       intern_table_(NULL),
       class_linker_(NULL),
+      arena_pool_(NULL),
       signal_catcher_(NULL),
       java_vm_(NULL),
       pre_allocated_OutOfMemoryError_(NULL),
@@ -99,6 +103,10 @@ Runtime::Runtime()
       exit_(NULL),
       abort_(NULL),
       stats_enabled_(false),
+      verification_cache_(NULL),
+      dex_cache_prefetch_(false),
+      dex_cache_prefetcher_lock_("dex cache prefetcher lock"),
+      dex_cache_prefetcher_(NULL),
       method_trace_(0),
       method_trace_file_size_(0),
       instrumentation_(),
@@ -138,10 +146,20 @@ Runtime::~Runtime() {
   Dbg::StopJdwp();
   delete signal_catcher_;
 
+  if (verification_cache_ != NULL) {
+    verification_cache_->Save();
+    delete verification_cache_;
+  }
+  if (dex_cache_prefetcher_ != NULL) {
+    dex_cache_prefetcher_->Save();
+    delete dex_cache_prefetcher_;
+  }
+
   // Make sure all other non-daemon threads have terminated, and all daemon threads are suspended.
   delete thread_list_;
   delete monitor_list_;
   delete class_linker_;
+  delete arena_pool_;
   delete heap_;
   delete intern_table_;
   delete java_vm_;
@@ -241,6 +259,10 @@ void Runtime::Abort() {
 
 bool Runtime::PreZygoteFork() {
   heap_->PreZygoteFork();
+  // Write out the classes verified while preloading, the children are rarely shut down cleanly.
+  if (verification_cache_ != NULL) {
+    verification_cache_->Save();
+  }
   return true;
 }
 
@@ -451,6 +473,7 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
   parsed->profile_duration_s_ = 20;          // Seconds.
   parsed->profile_interval_us_ = 500;       // Microseconds.
   parsed->profile_backoff_coefficient_ = 2.0;
+  parsed->dex_cache_prefetch_ = false;
 
   for (size_t i = 0; i < options.size(); ++i) {
     const std::string option(options[i].first);
@@ -691,6 +714,13 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
       parsed->profile_backoff_coefficient_ = ParseDoubleOrDie(option, "-Xprofile-backoff:",
           1.0, 10.0, ignore_unrecognized,
           parsed->profile_backoff_coefficient_);
+    } else if (StartsWith(option, "-Xverificationcache:")) {
+      parsed->verification_cache_filename_ = option.substr(strlen("-Xverificationcache:"));
+    } else if (option == "-Xdexcacheprefetch") {
+      parsed->dex_cache_prefetch_ = true;
+    } else if (StartsWith(option, "-Xdexcacheprofile:")) {
+      parsed->dex_cache_prefetch_ = true;
+      parsed->dex_cache_profile_filename_ = option.substr(strlen("-Xdexcacheprofile:"));
     } else if (option == "-compiler-filter:interpret-only") {
       parsed->compiler_filter_ = kInterpretOnly;
     } else if (option == "-compiler-filter:space") {
@@ -841,11 +871,22 @@ bool Runtime::Start() {
 
   finished_starting_ = true;
 
+  // Write out what booting verified, a runtime that is killed never gets to its destructor.
+  if (verification_cache_ != NULL) {
+    verification_cache_->Save();
+  }
+
   if (profile_) {
     // User has asked for a profile using -Xprofile
     StartProfiler(profile_output_filename_.c_str(), true);
   }
 
+  // The zygote can't have the prefetcher's worker thread when it forks, applications start it
+  // from VMRuntime.registerAppInfo instead.
+  if (!IsZygote() && !dex_cache_profile_filename_.empty()) {
+    StartDexCachePrefetcher(dex_cache_profile_filename_);
+  }
+
   return true;
 }
 
@@ -1025,6 +1066,7 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   GetHeap()->EnableObjectValidation();
 
   CHECK_GE(GetHeap()->GetContinuousSpaces().size(), 1U);
+  arena_pool_ = new ArenaPool;
   class_linker_ = new ClassLinker(intern_table_);
   if (GetHeap()->HasImageSpace()) {
     class_linker_->InitFromImage();
@@ -1036,6 +1078,12 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   CHECK(class_linker_ != NULL);
   verifier::MethodVerifier::Init();
 
+  // The compiler records verification results in the oat file instead.
+  if (!IsCompiler() && !options->verification_cache_filename_.empty()) {
+    verification_cache_ = new verifier::VerificationCache(options->verification_cache_filename_);
+    verification_cache_->Load();
+  }
+
   method_trace_ = options->method_trace_;
   method_trace_file_ = options->method_trace_file_;
   method_trace_file_size_ = options->method_trace_file_size_;
@@ -1048,6 +1096,9 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   profile_ = options->profile_;
   profile_output_filename_ = options->profile_output_filename_;
 
+  dex_cache_prefetch_ = options->dex_cache_prefetch_ && !IsCompiler();
+  dex_cache_profile_filename_ = options->dex_cache_profile_filename_;
+
   if (options->method_trace_) {
     Trace::Start(options->method_trace_file_.c_str(), -1, options->method_trace_file_size_, 0,
                  false, false, 0);
@@ -1479,6 +1530,35 @@ void Runtime::RemoveMethodVerifier(verifier::MethodVerifier* verifier) {
   method_verifiers_.erase(it);
 }
 
+DexCachePrefetcher* Runtime::GetDexCachePrefetcher() const {
+  DexCachePrefetcher* prefetcher = dex_cache_prefetcher_;
+  if (prefetcher != NULL) {
+    // Pairs with the barrier in StartDexCachePrefetcher.
+    QuasiAtomic::MembarLoadLoad();
+  }
+  return prefetcher;
+}
+
+void Runtime::StartDexCachePrefetcher(const std::string& filename) {
+  if (!dex_cache_prefetch_ || GetDexCachePrefetcher() != NULL) {
+    return;
+  }
+  // Set up outside the lock, the prefetcher starts a thread.
+  DexCachePrefetcher* prefetcher = new DexCachePrefetcher(filename);
+  prefetcher->Load();
+  {
+    MutexLock mu(Thread::Current(), dex_cache_prefetcher_lock_);
+    if (dex_cache_prefetcher_ == NULL) {
+      // Make the prefetcher's state visible to the threads that find it without the lock.
+      QuasiAtomic::MembarStoreStore();
+      dex_cache_prefetcher_ = prefetcher;
+      return;
+    }
+  }
+  // Lost a race with another thread starting it.
+  delete prefetcher;
+}
+
 void Runtime::StartProfiler(const char *appDir, bool startImmediately) {
   BackgroundMethodSamplingProfiler::Start(profile_period_s_, profile_duration_s_, appDir, profile_interval_us_,
       profile_backoff_coefficient_, startImmediately);
@@ -43,6 +43,8 @@ namespace art {
 namespace gc {
   class Heap;
 }
+class ArenaPool;
+class DexCachePrefetcher;
 namespace mirror {
   class ArtMethod;
   class ClassLoader;
@@ -54,6 +56,7 @@ namespace mirror {
 }  // namespace mirror
 namespace verifier {
 class MethodVerifier;
+class VerificationCache;
 }
 class ClassLinker;
 class CompilerCallbacks;
@@ -148,6 +151,9 @@ class Runtime {
     int profile_duration_s_;
     int profile_interval_us_;
     double profile_backoff_coefficient_;
+    std::string verification_cache_filename_;
+    bool dex_cache_prefetch_;
+    std::string dex_cache_profile_filename_;
 
    private:
     ParsedOptions() {}
@@ -289,6 +295,22 @@ class Runtime {
     return class_linker_;
   }
 
+  ArenaPool* GetArenaPool() const {
+    return arena_pool_;
+  }
+
+  // Returns the persistent cache of runtime verification results, or null if there isn't one.
+  verifier::VerificationCache* GetVerificationCache() const {
+    return verification_cache_;
+  }
+
+  // Returns the recorder of startup dex cache resolutions, or null if there isn't one.
+  DexCachePrefetcher* GetDexCachePrefetcher() const;
+
+  // Record startup dex cache resolutions in filename and prefetch the ones recorded by earlier
+  // runs, if enabled by -Xdexcacheprefetch.
+  void StartDexCachePrefetcher(const std::string& filename);
+
   size_t GetDefaultStackSize() const {
     return default_stack_size_;
   }
@@ -531,6 +553,9 @@ class Runtime {
 
   ClassLinker* class_linker_;
 
+  // Arenas for short lived runtime data structures such as the verifier's.
+  ArenaPool* arena_pool_;
+
   SignalCatcher* signal_catcher_;
   std::string stack_trace_file_;
 
@@ -586,6 +611,16 @@ class Runtime {
   uint32_t profile_interval_us_;                // Microseconds between samples.
   double profile_backoff_coefficient_;  // Coefficient to exponential backoff.
 
+  // Verification results persisted across runs, set by -Xverificationcache.
+  verifier::VerificationCache* verification_cache_;
+
+  // Dex cache prefetching, set by -Xdexcacheprefetch and -Xdexcacheprofile.
+  bool dex_cache_prefetch_;
+  std::string dex_cache_profile_filename_;
+  // Read without holding dex_cache_prefetcher_lock_, see GetDexCachePrefetcher.
+  Mutex dex_cache_prefetcher_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  DexCachePrefetcher* volatile dex_cache_prefetcher_;
+
   bool method_trace_;
   std::string method_trace_file_;
   size_t method_trace_file_size_;
@@ -969,6 +969,7 @@ Thread::Thread(bool daemon)
   state_and_flags_.as_struct.state = kNative;
   memset(&held_mutexes_[0], 0, sizeof(held_mutexes_));
   memset(rosalloc_runs_, 0, sizeof(rosalloc_runs_));
+  memset(interface_cache_, 0, sizeof(interface_cache_));
   for (uint32_t i = 0; i < kMaxCheckpoints; ++i) {
     checkpoint_functions_[i] = nullptr;
   }
@@ -2008,6 +2009,30 @@ void Thread::VisitRoots(RootVisitor* visitor, void* arg) {
     DCHECK(frame.method_ != nullptr);
     frame.method_ = down_cast<mirror::ArtMethod*>(visitor(frame.method_, arg));
   }
+
+  for (InterfaceCacheEntry& entry : interface_cache_) {
+    if (entry.klass != nullptr) {
+      entry.klass = down_cast<mirror::Class*>(visitor(entry.klass, arg));
+      entry.interface_method =
+          down_cast<mirror::ArtMethod*>(visitor(entry.interface_method, arg));
+      entry.method = down_cast<mirror::ArtMethod*>(visitor(entry.method, arg));
+    }
+  }
+}
+
+mirror::ArtMethod* Thread::FindVirtualMethodForInterface(mirror::Class* klass,
+                                                         mirror::ArtMethod* interface_method) {
+  InterfaceCacheEntry& entry = interface_cache_[InterfaceCacheIndex(klass, interface_method)];
+  if (entry.klass == klass && entry.interface_method == interface_method) {
+    return entry.method;
+  }
+  mirror::ArtMethod* method = klass->FindVirtualMethodForInterface(interface_method);
+  if (method != nullptr) {
+    entry.klass = klass;
+    entry.interface_method = interface_method;
+    entry.method = method;
+  }
+  return method;
 }
 
 static mirror::Object* VerifyRoot(mirror::Object* root, void* arg) {
@@ -393,6 +393,12 @@ class PACKED(4) Thread {
 
   void VerifyStack() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Find the method implementing interface_method in klass, as Class::FindVirtualMethodForInterface
+  // does, remembering recent answers so that IMT conflicts don't search the iftable every call.
+  mirror::ArtMethod* FindVirtualMethodForInterface(mirror::Class* klass,
+                                                   mirror::ArtMethod* interface_method)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   //
   // Offsets of various members of native Thread class, used by compiled code.
   //
@@ -828,6 +834,22 @@ class PACKED(4) Thread {
   void* rosalloc_runs_[kRosAllocNumOfSizeBrackets];
 
  private:
+  // A direct mapped cache of interface method lookups. It is per thread so that entries are
+  // never read while another thread writes them, its references are roots.
+  struct InterfaceCacheEntry {
+    mirror::Class* klass;
+    mirror::ArtMethod* interface_method;
+    mirror::ArtMethod* method;
+  };
+  static constexpr size_t kInterfaceCacheSize = 64;
+  InterfaceCacheEntry interface_cache_[kInterfaceCacheSize];
+
+  static size_t InterfaceCacheIndex(mirror::Class* klass, mirror::ArtMethod* interface_method) {
+    uintptr_t hash = (reinterpret_cast<uintptr_t>(klass) ^
+                      reinterpret_cast<uintptr_t>(interface_method)) / kObjectAlignment;
+    return hash % kInterfaceCacheSize;
+  }
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class Monitor;
   friend class MonitorInfo;
@@ -835,6 +857,7 @@ class PACKED(4) Thread {
   friend class ScopedThreadStateChange;
   friend class SignalCatcher;  // For SetStateUnsafe.
   friend class ThreadList;  // For ~Thread and Destroy.
+  friend class ThreadTest;  // For the interface cache.
 
   DISALLOW_COPY_AND_ASSIGN(Thread);
 };
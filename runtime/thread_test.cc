@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread.h"
+
+#include "class_linker.h"
+#include "common_test.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/object_array-inl.h"
+#include "sirt_ref.h"
+
+namespace art {
+
+class ThreadTest : public CommonTest {
+ protected:
+  static size_t InterfaceCacheIndex(mirror::Class* klass, mirror::ArtMethod* interface_method) {
+    return Thread::InterfaceCacheIndex(klass, interface_method);
+  }
+
+  static bool IsCached(Thread* self, mirror::Class* klass, mirror::ArtMethod* interface_method) {
+    const Thread::InterfaceCacheEntry& entry =
+        self->interface_cache_[InterfaceCacheIndex(klass, interface_method)];
+    return entry.klass == klass && entry.interface_method == interface_method;
+  }
+};
+
+TEST_F(ThreadTest, InterfaceCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  Thread* self = soa.Self();
+  SirtRef<mirror::ClassLoader> class_loader(self,
+      soa.Decode<mirror::ClassLoader*>(LoadDex("SingleImplementation")));
+  mirror::Class* interface = class_linker_->FindClass("LSingleImplementation$Many;",
+                                                      class_loader);
+  ASSERT_TRUE(interface != NULL);
+  SirtRef<mirror::Class> klass(self,
+      class_linker_->FindClass("LSingleImplementation$OnlyImplementation;", class_loader));
+  ASSERT_TRUE(klass.get() != NULL);
+
+  // Many.m00 and Many.m64 share an IMT slot, so calls to them look up their implementation.
+  mirror::ArtMethod* m00 = interface->FindDeclaredVirtualMethod("m00", "()I");
+  mirror::ArtMethod* m64 = interface->FindDeclaredVirtualMethod("m64", "()I");
+  ASSERT_TRUE(m00 != NULL);
+  ASSERT_TRUE(m64 != NULL);
+  uint32_t imt_index = m00->GetDexMethodIndex() % ClassLinker::kImtSize;
+  ASSERT_EQ(imt_index, m64->GetDexMethodIndex() % ClassLinker::kImtSize);
+  ASSERT_EQ(runtime_->GetImtConflictMethod(), klass->GetImTable()->Get(imt_index));
+  mirror::ArtMethod* m00_implementation = klass->FindDeclaredVirtualMethod("m00", "()I");
+  mirror::ArtMethod* m64_implementation = klass->FindDeclaredVirtualMethod("m64", "()I");
+  ASSERT_TRUE(m00_implementation != NULL);
+  ASSERT_TRUE(m64_implementation != NULL);
+
+  // A miss searches the iftable and fills the entry, which later calls hit.
+  EXPECT_FALSE(IsCached(self, klass.get(), m00));
+  EXPECT_EQ(m00_implementation, self->FindVirtualMethodForInterface(klass.get(), m00));
+  EXPECT_TRUE(IsCached(self, klass.get(), m00));
+  EXPECT_EQ(m00_implementation, self->FindVirtualMethodForInterface(klass.get(), m00));
+  EXPECT_EQ(m64_implementation, self->FindVirtualMethodForInterface(klass.get(), m64));
+  EXPECT_EQ(m64_implementation, self->FindVirtualMethodForInterface(klass.get(), m64));
+
+  // Many has more methods than the cache has entries, so two of them share an entry.
+  mirror::ArtMethod* first = NULL;
+  mirror::ArtMethod* second = NULL;
+  for (size_t i = 0; i < interface->NumVirtualMethods() && second == NULL; ++i) {
+    for (size_t j = i + 1; j < interface->NumVirtualMethods(); ++j) {
+      if (InterfaceCacheIndex(klass.get(), interface->GetVirtualMethod(i)) ==
+          InterfaceCacheIndex(klass.get(), interface->GetVirtualMethod(j))) {
+        first = interface->GetVirtualMethod(i);
+        second = interface->GetVirtualMethod(j);
+        break;
+      }
+    }
+  }
+  ASSERT_TRUE(second != NULL);
+  mirror::ArtMethod* first_implementation = klass->FindVirtualMethodForInterface(first);
+  mirror::ArtMethod* second_implementation = klass->FindVirtualMethodForInterface(second);
+  ASSERT_NE(first_implementation, second_implementation);
+
+  // Each lookup evicts the other method, and still finds the right implementation.
+  EXPECT_EQ(first_implementation, self->FindVirtualMethodForInterface(klass.get(), first));
+  EXPECT_TRUE(IsCached(self, klass.get(), first));
+  EXPECT_EQ(second_implementation, self->FindVirtualMethodForInterface(klass.get(), second));
+  EXPECT_TRUE(IsCached(self, klass.get(), second));
+  EXPECT_FALSE(IsCached(self, klass.get(), first));
+  EXPECT_EQ(first_implementation, self->FindVirtualMethodForInterface(klass.get(), first));
+  EXPECT_TRUE(IsCached(self, klass.get(), first));
+  EXPECT_FALSE(IsCached(self, klass.get(), second));
+}
+
+}  // namespace art
@@ -53,7 +53,9 @@ void PcToRegisterLineTable::Init(RegisterTrackingMode mode, InstructionFlags* fl
                                  uint32_t insns_size, uint16_t registers_size,
                                  MethodVerifier* verifier) {
   DCHECK_GT(insns_size, 0U);
-  register_lines_.reset(new RegisterLine*[insns_size]());
+  register_lines_ = reinterpret_cast<RegisterLine**>(
+      verifier->GetArena()->Alloc(insns_size * sizeof(RegisterLine*),
+                                  ArenaAllocator::kAllocVerifier));
   size_ = insns_size;
   for (uint32_t i = 0; i < insns_size; i++) {
     bool interesting = false;
@@ -77,8 +79,10 @@ void PcToRegisterLineTable::Init(RegisterTrackingMode mode, InstructionFlags* fl
 }
 
 PcToRegisterLineTable::~PcToRegisterLineTable() {
+  // The memory belongs to the verifier's arena, only run the destructors.
+  RegisterLineArenaDelete deleter;
   for (size_t i = 0; i < size_; i++) {
-    delete register_lines_[i];
+    deleter(register_lines_[i]);
     if (kIsDebugBuild) {
       register_lines_[i] = nullptr;
     }
@@ -87,7 +91,8 @@ PcToRegisterLineTable::~PcToRegisterLineTable() {
 
 MethodVerifier::FailureKind MethodVerifier::VerifyClass(const mirror::Class* klass,
                                                         bool allow_soft_failures,
-                                                        std::string* error) {
+                                                        std::string* error,
+                                                        VerificationDependencies* dependencies) {
   if (klass->IsVerified()) {
     return kNoFailure;
   }
@@ -118,7 +123,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(const mirror::Class* kla
   Thread* self = Thread::Current();
   SirtRef<mirror::DexCache> dex_cache(self, kh.GetDexCache());
   SirtRef<mirror::ClassLoader> class_loader(self, klass->GetClassLoader());
-  return VerifyClass(&dex_file, dex_cache, class_loader, class_def, allow_soft_failures, error);
+  return VerifyClass(&dex_file, dex_cache, class_loader, class_def, allow_soft_failures, error,
+                     dependencies);
 }
 
 MethodVerifier::FailureKind MethodVerifier::VerifyClass(const DexFile* dex_file,
@@ -126,7 +132,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(const DexFile* dex_file,
                                                         SirtRef<mirror::ClassLoader>& class_loader,
                                                         const DexFile::ClassDef* class_def,
                                                         bool allow_soft_failures,
-                                                        std::string* error) {
+                                                        std::string* error,
+                                                        VerificationDependencies* dependencies) {
   DCHECK(class_def != nullptr);
   const byte* class_data = dex_file->GetClassData(*class_def);
   if (class_data == NULL) {
@@ -166,7 +173,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(const DexFile* dex_file,
                                                       it.GetMethodCodeItem(),
                                                       method,
                                                       it.GetMemberAccessFlags(),
-                                                      allow_soft_failures);
+                                                      allow_soft_failures,
+                                                      dependencies);
     if (result != kNoFailure) {
       if (result == kHardFailure) {
         hard_fail = true;
@@ -208,7 +216,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(const DexFile* dex_file,
                                                       it.GetMethodCodeItem(),
                                                       method,
                                                       it.GetMemberAccessFlags(),
-                                                      allow_soft_failures);
+                                                      allow_soft_failures,
+                                                      dependencies);
     if (result != kNoFailure) {
       if (result == kHardFailure) {
         hard_fail = true;
@@ -239,7 +248,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyMethod(uint32_t method_idx,
                                                          const DexFile::CodeItem* code_item,
                                                          mirror::ArtMethod* method,
                                                          uint32_t method_access_flags,
-                                                         bool allow_soft_failures) {
+                                                         bool allow_soft_failures,
+                                                         VerificationDependencies* dependencies) {
   MethodVerifier::FailureKind result = kNoFailure;
   uint64_t start_ns = NanoTime();
 
@@ -256,6 +266,9 @@ MethodVerifier::FailureKind MethodVerifier::VerifyMethod(uint32_t method_idx,
       }
       result = kSoftFailure;
     }
+    if (dependencies != nullptr) {
+      verifier_.reg_types_.CollectDependencies(dependencies);
+    }
   } else {
     // Bad method data.
     CHECK_NE(verifier_.failures_.size(), 0U);
@@ -298,7 +311,8 @@ MethodVerifier::MethodVerifier(const DexFile* dex_file, SirtRef<mirror::DexCache
                                const DexFile::CodeItem* code_item, uint32_t dex_method_idx,
                                mirror::ArtMethod* method, uint32_t method_access_flags,
                                bool can_load_classes, bool allow_soft_failures)
-    : reg_types_(can_load_classes),
+    : arena_(Runtime::Current()->GetArenaPool()),
+      reg_types_(can_load_classes, &arena_),
       work_insn_idx_(-1),
       dex_method_idx_(dex_method_idx),
       mirror_method_(method),
@@ -1055,6 +1069,10 @@ bool MethodVerifier::VerifyCodeFlow() {
 
   work_line_.reset(RegisterLine::Create(registers_size, this));
   saved_line_.reset(RegisterLine::Create(registers_size, this));
+  peephole_line_.reset(RegisterLine::Create(registers_size, this));
+  if (gDebugVerify) {
+    debug_merge_line_.reset(RegisterLine::Create(registers_size, this));
+  }
 
   /* Initialize register types of method arguments. */
   if (!SetTypesFromSignature()) {
@@ -1428,9 +1446,9 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
 
   // We need to ensure the work line is consistent while performing validation. When we spot a
   // peephole pattern we compute a new line for either the fallthrough instruction or the
-  // branch target.
-  UniquePtr<RegisterLine> branch_line;
-  UniquePtr<RegisterLine> fallthrough_line;
+  // branch target, in peephole_line_.
+  RegisterLine* branch_line = NULL;
+  RegisterLine* fallthrough_line = NULL;
 
   // We need precise constant types only for deoptimization which happens at runtime.
   const bool need_precise_constant = !Runtime::Current()->IsCompiler();
@@ -1930,11 +1948,11 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
 
         if (!cast_type.IsUnresolvedTypes() && !orig_type.IsUnresolvedTypes() &&
             !cast_type.GetClass()->IsInterface() && !cast_type.IsAssignableFrom(orig_type)) {
-          RegisterLine* update_line = RegisterLine::Create(code_item_->registers_size_, this);
+          RegisterLine* update_line = peephole_line_.get();
           if (inst->Opcode() == Instruction::IF_EQZ) {
-            fallthrough_line.reset(update_line);
+            fallthrough_line = update_line;
           } else {
-            branch_line.reset(update_line);
+            branch_line = update_line;
           }
           update_line->CopyFromLine(work_line_.get());
           update_line->SetRegisterType(instance_of_inst->VRegB_22c(), cast_type);
@@ -2660,8 +2678,8 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
       return false;
     }
     /* update branch target, set "changed" if appropriate */
-    if (NULL != branch_line.get()) {
-      if (!UpdateRegisters(work_insn_idx_ + branch_target, branch_line.get())) {
+    if (NULL != branch_line) {
+      if (!UpdateRegisters(work_insn_idx_ + branch_target, branch_line)) {
         return false;
       }
     } else {
@@ -2766,9 +2784,9 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
     if (!CheckNotMoveException(code_item_->insns_, next_insn_idx)) {
       return false;
     }
-    if (NULL != fallthrough_line.get()) {
+    if (NULL != fallthrough_line) {
       // Make workline consistent with fallthrough computed from peephole optimization.
-      work_line_->CopyFromLine(fallthrough_line.get());
+      work_line_->CopyFromLine(fallthrough_line);
     }
     if (insn_flags_[next_insn_idx].IsReturn()) {
       // For returns we only care about the operand to the return, all other registers are dead.
@@ -3835,9 +3853,7 @@ bool MethodVerifier::UpdateRegisters(uint32_t next_insn, const RegisterLine* mer
       }
     }
   } else {
-    UniquePtr<RegisterLine> copy(gDebugVerify ?
-                                 RegisterLine::Create(target_line->NumRegs(), this) :
-                                 NULL);
+    RegisterLine* copy = debug_merge_line_.get();
     if (gDebugVerify) {
       copy->CopyFromLine(target_line);
     }
@@ -3848,7 +3864,7 @@ bool MethodVerifier::UpdateRegisters(uint32_t next_insn, const RegisterLine* mer
     if (gDebugVerify && changed) {
       LogVerifyInfo() << "Merging at [" << reinterpret_cast<void*>(work_insn_idx_) << "]"
                       << " to [" << reinterpret_cast<void*>(next_insn) << "]: " << "\n"
-                      << *copy.get() << "  MERGE\n"
+                      << *copy << "  MERGE\n"
                       << *merge_line << "  ==\n"
                       << *target_line << "\n";
     }
@@ -20,6 +20,7 @@
 #include <set>
 #include <vector>
 
+#include "base/arena_allocator.h"
 #include "base/casts.h"
 #include "base/macros.h"
 #include "base/stl_util.h"
@@ -44,6 +45,7 @@ namespace verifier {
 
 class MethodVerifier;
 class DexPcToReferenceMap;
+struct VerificationDependencies;
 
 /*
  * "Direct" and "virtual" methods are stored independently. The type of call used to invoke the
@@ -111,12 +113,13 @@ enum RegisterTrackingMode {
 // execution of that instruction.
 class PcToRegisterLineTable {
  public:
-  PcToRegisterLineTable() : size_(0) {}
+  PcToRegisterLineTable() : register_lines_(nullptr), size_(0) {}
   ~PcToRegisterLineTable();
 
   // Initialize the RegisterTable. Every instruction address can have a different set of information
   // about what's in which register, but for verification purposes we only need to store it at
-  // branch target addresses (because we merge into that).
+  // branch target addresses (because we merge into that). The table and its lines are allocated
+  // in the verifier's arena.
   void Init(RegisterTrackingMode mode, InstructionFlags* flags, uint32_t insns_size,
             uint16_t registers_size, MethodVerifier* verifier);
 
@@ -126,7 +129,7 @@ class PcToRegisterLineTable {
   }
 
  private:
-  UniquePtr<RegisterLine*[]> register_lines_;
+  RegisterLine** register_lines_;
   size_t size_;
 };
 
@@ -139,14 +142,19 @@ class MethodVerifier {
     kHardFailure,
   };
 
-  /* Verify a class. Returns "kNoFailure" on success. */
+  /*
+   * Verify a class. Returns "kNoFailure" on success. If dependencies is non-null the classes the
+   * verifier resolved while verifying the methods are recorded into it.
+   */
   static FailureKind VerifyClass(const mirror::Class* klass, bool allow_soft_failures,
-                                 std::string* error)
+                                 std::string* error,
+                                 VerificationDependencies* dependencies = nullptr)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static FailureKind VerifyClass(const DexFile* dex_file, SirtRef<mirror::DexCache>& dex_cache,
                                  SirtRef<mirror::ClassLoader>& class_loader,
                                  const DexFile::ClassDef* class_def,
-                                 bool allow_soft_failures, std::string* error)
+                                 bool allow_soft_failures, std::string* error,
+                                 VerificationDependencies* dependencies = nullptr)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   static void VerifyMethodAndDump(std::ostream& os, uint32_t method_idx, const DexFile* dex_file,
@@ -167,6 +175,10 @@ class MethodVerifier {
     return &reg_types_;
   }
 
+  ArenaAllocator* GetArena() {
+    return &arena_;
+  }
+
   // Log a verification failure.
   std::ostream& Fail(VerifyError error);
 
@@ -261,7 +273,8 @@ class MethodVerifier {
                                   const DexFile::ClassDef* class_def_idx,
                                   const DexFile::CodeItem* code_item,
                                   mirror::ArtMethod* method, uint32_t method_access_flags,
-                                  bool allow_soft_failures)
+                                  bool allow_soft_failures,
+                                  VerificationDependencies* dependencies)
           SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   void FindLocksAtDexPc() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -613,19 +626,29 @@ class MethodVerifier {
   const RegType& DetermineCat1Constant(int32_t value, bool precise)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Backs the RegTypes and RegisterLines created while verifying this method. A verifier is
+  // created per method, so everything is released in one go when verification finishes.
+  ArenaAllocator arena_;
+
   RegTypeCache reg_types_;
 
   PcToRegisterLineTable reg_table_;
 
   // Storage for the register status we're currently working on.
-  UniquePtr<RegisterLine> work_line_;
+  RegisterLineArenaUniquePtr work_line_;
 
   // The address of the instruction we're currently working on, note that this is in 2 byte
   // quantities
   uint32_t work_insn_idx_;
 
   // Storage for the register status we're saving for later.
-  UniquePtr<RegisterLine> saved_line_;
+  RegisterLineArenaUniquePtr saved_line_;
+
+  // Storage for the register status a peephole computes for a branch target or fallthrough.
+  RegisterLineArenaUniquePtr peephole_line_;
+
+  // Storage for the register status before a merge, kept for gDebugVerify logging.
+  RegisterLineArenaUniquePtr debug_merge_line_;
 
   const uint32_t dex_method_idx_;  // The method we're working on.
   // Its object representation if known.
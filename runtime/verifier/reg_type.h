@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_VERIFIER_REG_TYPE_H_
 #define ART_RUNTIME_VERIFIER_REG_TYPE_H_
 
+#include "base/arena_allocator.h"
 #include "base/macros.h"
 #include "globals.h"
 #include "primitive.h"
@@ -272,6 +273,15 @@ class RegType {
 
   void VisitRoots(RootVisitor* visitor, void* arg) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // The well known primitive types are heap allocated, types created by a RegTypeCache live in the
+  // cache's arena and are destroyed with it.
+  static void* operator new(size_t size) {
+    return ::operator new(size);
+  }
+  static void* operator new(size_t size, ArenaAllocator* arena) {
+    return arena->Alloc(size, ArenaAllocator::kAllocVerifier);
+  }
+
  protected:
   RegType(mirror::Class* klass, const std::string& descriptor, uint16_t cache_id)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
@@ -21,6 +21,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "object_utils.h"
+#include "verification_cache.h"
 
 namespace art {
 namespace verifier {
@@ -29,6 +30,15 @@ bool RegTypeCache::primitive_initialized_ = false;
 uint16_t RegTypeCache::primitive_count_ = 0;
 PreciseConstType* RegTypeCache::small_precise_constants_[kMaxSmallConstant - kMinSmallConstant + 1];
 
+static size_t HashDescriptor(const std::string& descriptor) {
+  // This is the java.lang.String hashcode for convenience, not interoperability.
+  size_t hash = 0;
+  for (char c : descriptor) {
+    hash = hash * 31 + c;
+  }
+  return hash;
+}
+
 static bool MatchingPrecisionForClass(RegType* entry, bool precise)
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   if (entry->IsPreciseReference() == precise) {
@@ -163,12 +173,44 @@ void RegTypeCache::ClearException() {
   }
 }
 
+void RegTypeCache::AddEntry(RegType* entry) {
+  DCHECK_EQ(entry->GetId(), entries_.size());
+  uint16_t id = entry->GetId();
+  entries_.push_back(entry);
+  descriptor_index_.insert(std::make_pair(HashDescriptor(entry->descriptor_), id));
+  if (entry->klass_ != NULL) {
+    class_index_.insert(std::make_pair(entry->klass_, id));
+  }
+  if (entry->IsConstant()) {
+    constant_index_.insert(std::make_pair(static_cast<size_t>(entry->ConstantValue()), id));
+  } else if (entry->IsConstantLo()) {
+    constant_index_.insert(std::make_pair(static_cast<size_t>(entry->ConstantValueLo()), id));
+  } else if (entry->IsConstantHi()) {
+    constant_index_.insert(std::make_pair(static_cast<size_t>(entry->ConstantValueHi()), id));
+  } else if (entry->IsUnresolvedMergedReference()) {
+    std::set<uint16_t> types = down_cast<UnresolvedMergedType*>(entry)->GetMergedTypes();
+    merged_index_.insert(std::make_pair(HashMergedTypes(types), id));
+  } else if (entry->IsUnresolvedSuperClass()) {
+    uint16_t child_id = down_cast<UnresolvedSuperClass*>(entry)->GetUnresolvedSuperClassChildId();
+    super_class_index_.insert(std::make_pair(child_id, id));
+  }
+}
+
+size_t RegTypeCache::HashMergedTypes(const std::set<uint16_t>& types) {
+  size_t hash = 0;
+  for (uint16_t type : types) {
+    hash = hash * 31 + type;
+  }
+  return hash;
+}
+
 const RegType& RegTypeCache::From(mirror::ClassLoader* loader, const char* descriptor,
                                   bool precise) {
   // Try looking up the class in the cache first.
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    if (MatchDescriptor(i, descriptor, precise)) {
-      return *(entries_[i]);
+  auto range = descriptor_index_.equal_range(HashDescriptor(descriptor));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (MatchDescriptor(it->second, descriptor, precise)) {
+      return *(entries_[it->second]);
     }
   }
   // Class not found in the cache, will create a new type for that.
@@ -188,19 +230,19 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader, const char* descr
     if (klass->CannotBeAssignedFromOtherTypes() || precise) {
       DCHECK(!(klass->IsAbstract()) || klass->IsArrayClass());
       DCHECK(!klass->IsInterface());
-      entry = new PreciseReferenceType(klass, descriptor, entries_.size());
+      entry = new (arena_) PreciseReferenceType(klass, descriptor, entries_.size());
     } else {
-      entry = new ReferenceType(klass, descriptor, entries_.size());
+      entry = new (arena_) ReferenceType(klass, descriptor, entries_.size());
     }
-    entries_.push_back(entry);
+    AddEntry(entry);
     return *entry;
   } else {  // Class not resolved.
     // We tried loading the class and failed, this might get an exception raised
     // so we want to clear it before we go on.
     ClearException();
     if (IsValidDescriptor(descriptor)) {
-      RegType* entry = new UnresolvedReferenceType(descriptor, entries_.size());
-      entries_.push_back(entry);
+      RegType* entry = new (arena_) UnresolvedReferenceType(descriptor, entries_.size());
+      AddEntry(entry);
       return *entry;
     } else {
       // The descriptor is broken return the unknown type as there's nothing sensible that
@@ -218,20 +260,21 @@ const RegType& RegTypeCache::FromClass(const char* descriptor, mirror::Class* kl
     return RegTypeFromPrimitiveType(klass->GetPrimitiveType());
   } else {
     // Look for the reference in the list of entries to have.
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
-      if (cur_entry->klass_ == klass && MatchingPrecisionForClass(cur_entry, precise)) {
+    auto range = class_index_.equal_range(klass);
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
+      if (MatchingPrecisionForClass(cur_entry, precise)) {
         return *cur_entry;
       }
     }
     // No reference to the class was found, create new reference.
     RegType* entry;
     if (precise) {
-      entry = new PreciseReferenceType(klass, descriptor, entries_.size());
+      entry = new (arena_) PreciseReferenceType(klass, descriptor, entries_.size());
     } else {
-      entry = new ReferenceType(klass, descriptor, entries_.size());
+      entry = new (arena_) ReferenceType(klass, descriptor, entries_.size());
     }
-    entries_.push_back(entry);
+    AddEntry(entry);
     return *entry;
   }
 }
@@ -243,9 +286,10 @@ RegTypeCache::~RegTypeCache() {
     // All entries are from the global pool, nothing to delete.
     return;
   }
-  std::vector<RegType*>::iterator non_primitive_begin = entries_.begin();
-  std::advance(non_primitive_begin, kNumPrimitivesAndSmallConstants);
-  STLDeleteContainerPointers(non_primitive_begin, entries_.end());
+  // The storage of the non primitive types belongs to the arena, only run their destructors.
+  for (size_t i = kNumPrimitivesAndSmallConstants; i < entries_.size(); i++) {
+    entries_[i]->~RegType();
+  }
 }
 
 void RegTypeCache::ShutDown() {
@@ -320,19 +364,19 @@ const RegType& RegTypeCache::FromUnresolvedMerge(const RegType& left, const RegT
     types.insert(right.GetId());
   }
   // Check if entry already exists.
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    RegType* cur_entry = entries_[i];
-    if (cur_entry->IsUnresolvedMergedReference()) {
-      std::set<uint16_t> cur_entry_types =
-          (down_cast<UnresolvedMergedType*>(cur_entry))->GetMergedTypes();
-      if (cur_entry_types == types) {
-        return *cur_entry;
-      }
+  auto range = merged_index_.equal_range(HashMergedTypes(types));
+  for (auto it = range.first; it != range.second; ++it) {
+    RegType* cur_entry = entries_[it->second];
+    std::set<uint16_t> cur_entry_types =
+        (down_cast<UnresolvedMergedType*>(cur_entry))->GetMergedTypes();
+    if (cur_entry_types == types) {
+      return *cur_entry;
     }
   }
   // Create entry.
-  RegType* entry = new UnresolvedMergedType(left.GetId(), right.GetId(), this, entries_.size());
-  entries_.push_back(entry);
+  RegType* entry = new (arena_) UnresolvedMergedType(left.GetId(), right.GetId(), this,
+                                                     entries_.size());
+  AddEntry(entry);
   if (kIsDebugBuild) {
     UnresolvedMergedType* tmp_entry = down_cast<UnresolvedMergedType*>(entry);
     std::set<uint16_t> check_types = tmp_entry->GetMergedTypes();
@@ -343,20 +387,12 @@ const RegType& RegTypeCache::FromUnresolvedMerge(const RegType& left, const RegT
 
 const RegType& RegTypeCache::FromUnresolvedSuperClass(const RegType& child) {
   // Check if entry already exists.
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    RegType* cur_entry = entries_[i];
-    if (cur_entry->IsUnresolvedSuperClass()) {
-      UnresolvedSuperClass* tmp_entry =
-          down_cast<UnresolvedSuperClass*>(cur_entry);
-      uint16_t unresolved_super_child_id =
-          tmp_entry->GetUnresolvedSuperClassChildId();
-      if (unresolved_super_child_id == child.GetId()) {
-        return *cur_entry;
-      }
-    }
+  auto it = super_class_index_.find(child.GetId());
+  if (it != super_class_index_.end()) {
+    return *entries_[it->second];
   }
-  RegType* entry = new UnresolvedSuperClass(child.GetId(), this, entries_.size());
-  entries_.push_back(entry);
+  RegType* entry = new (arena_) UnresolvedSuperClass(child.GetId(), this, entries_.size());
+  AddEntry(entry);
   return *entry;
 }
 
@@ -364,29 +400,31 @@ const UninitializedType& RegTypeCache::Uninitialized(const RegType& type, uint32
   UninitializedType* entry = NULL;
   const std::string& descriptor(type.GetDescriptor());
   if (type.IsUnresolvedTypes()) {
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
+    auto range = descriptor_index_.equal_range(HashDescriptor(descriptor));
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
       if (cur_entry->IsUnresolvedAndUninitializedReference() &&
           down_cast<UnresolvedUninitializedRefType*>(cur_entry)->GetAllocationPc() == allocation_pc &&
           (cur_entry->GetDescriptor() == descriptor)) {
         return *down_cast<UnresolvedUninitializedRefType*>(cur_entry);
       }
     }
-    entry = new UnresolvedUninitializedRefType(descriptor, allocation_pc, entries_.size());
+    entry = new (arena_) UnresolvedUninitializedRefType(descriptor, allocation_pc, entries_.size());
   } else {
     mirror::Class* klass = type.GetClass();
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
+    auto range = class_index_.equal_range(klass);
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
       if (cur_entry->IsUninitializedReference() &&
           down_cast<UninitializedReferenceType*>(cur_entry)
-              ->GetAllocationPc() == allocation_pc &&
-          cur_entry->GetClass() == klass) {
+              ->GetAllocationPc() == allocation_pc) {
         return *down_cast<UninitializedReferenceType*>(cur_entry);
       }
     }
-    entry = new UninitializedReferenceType(klass, descriptor, allocation_pc, entries_.size());
+    entry = new (arena_) UninitializedReferenceType(klass, descriptor, allocation_pc,
+                                                    entries_.size());
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
@@ -395,40 +433,43 @@ const RegType& RegTypeCache::FromUninitialized(const RegType& uninit_type) {
 
   if (uninit_type.IsUnresolvedTypes()) {
     const std::string& descriptor(uninit_type.GetDescriptor());
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
+    auto range = descriptor_index_.equal_range(HashDescriptor(descriptor));
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
       if (cur_entry->IsUnresolvedReference() &&
           cur_entry->GetDescriptor() == descriptor) {
         return *cur_entry;
       }
     }
-    entry = new UnresolvedReferenceType(descriptor.c_str(), entries_.size());
+    entry = new (arena_) UnresolvedReferenceType(descriptor.c_str(), entries_.size());
   } else {
     mirror::Class* klass = uninit_type.GetClass();
+    auto range = class_index_.equal_range(klass);
     if (uninit_type.IsUninitializedThisReference() && !klass->IsFinal()) {
       // For uninitialized "this reference" look for reference types that are not precise.
-      for (size_t i = primitive_count_; i < entries_.size(); i++) {
-        RegType* cur_entry = entries_[i];
-        if (cur_entry->IsReference() && cur_entry->GetClass() == klass) {
+      for (auto it = range.first; it != range.second; ++it) {
+        RegType* cur_entry = entries_[it->second];
+        if (cur_entry->IsReference()) {
           return *cur_entry;
         }
       }
-      entry = new ReferenceType(klass, "", entries_.size());
+      entry = new (arena_) ReferenceType(klass, "", entries_.size());
     } else if (klass->IsInstantiable()) {
       // We're uninitialized because of allocation, look or create a precise type as allocations
       // may only create objects of that type.
-      for (size_t i = primitive_count_; i < entries_.size(); i++) {
-        RegType* cur_entry = entries_[i];
-        if (cur_entry->IsPreciseReference() && cur_entry->GetClass() == klass) {
+      for (auto it = range.first; it != range.second; ++it) {
+        RegType* cur_entry = entries_[it->second];
+        if (cur_entry->IsPreciseReference()) {
           return *cur_entry;
         }
       }
-      entry = new PreciseReferenceType(klass, uninit_type.GetDescriptor(), entries_.size());
+      entry = new (arena_) PreciseReferenceType(klass, uninit_type.GetDescriptor(),
+                                                entries_.size());
     } else {
       return Conflict();
     }
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
@@ -473,31 +514,34 @@ const UninitializedType& RegTypeCache::UninitializedThisArgument(const RegType&
   UninitializedType* entry;
   const std::string& descriptor(type.GetDescriptor());
   if (type.IsUnresolvedTypes()) {
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
+    auto range = descriptor_index_.equal_range(HashDescriptor(descriptor));
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
       if (cur_entry->IsUnresolvedAndUninitializedThisReference() &&
           cur_entry->GetDescriptor() == descriptor) {
         return *down_cast<UninitializedType*>(cur_entry);
       }
     }
-    entry = new UnresolvedUninitializedThisRefType(descriptor, entries_.size());
+    entry = new (arena_) UnresolvedUninitializedThisRefType(descriptor, entries_.size());
   } else {
     mirror::Class* klass = type.GetClass();
-    for (size_t i = primitive_count_; i < entries_.size(); i++) {
-      RegType* cur_entry = entries_[i];
-      if (cur_entry->IsUninitializedThisReference() && cur_entry->GetClass() == klass) {
+    auto range = class_index_.equal_range(klass);
+    for (auto it = range.first; it != range.second; ++it) {
+      RegType* cur_entry = entries_[it->second];
+      if (cur_entry->IsUninitializedThisReference()) {
         return *down_cast<UninitializedType*>(cur_entry);
       }
     }
-    entry = new UninitializedThisReferenceType(klass, descriptor, entries_.size());
+    entry = new (arena_) UninitializedThisReferenceType(klass, descriptor, entries_.size());
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
 const ConstantType& RegTypeCache::FromCat1NonSmallConstant(int32_t value, bool precise) {
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    RegType* cur_entry = entries_[i];
+  auto range = constant_index_.equal_range(static_cast<size_t>(value));
+  for (auto it = range.first; it != range.second; ++it) {
+    RegType* cur_entry = entries_[it->second];
     if (cur_entry->klass_ == NULL && cur_entry->IsConstant() &&
         cur_entry->IsPreciseConstant() == precise &&
         (down_cast<ConstantType*>(cur_entry))->ConstantValue() == value) {
@@ -506,17 +550,18 @@ const ConstantType& RegTypeCache::FromCat1NonSmallConstant(int32_t value, bool p
   }
   ConstantType* entry;
   if (precise) {
-    entry = new PreciseConstType(value, entries_.size());
+    entry = new (arena_) PreciseConstType(value, entries_.size());
   } else {
-    entry = new ImpreciseConstType(value, entries_.size());
+    entry = new (arena_) ImpreciseConstType(value, entries_.size());
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
 const ConstantType& RegTypeCache::FromCat2ConstLo(int32_t value, bool precise) {
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    RegType* cur_entry = entries_[i];
+  auto range = constant_index_.equal_range(static_cast<size_t>(value));
+  for (auto it = range.first; it != range.second; ++it) {
+    RegType* cur_entry = entries_[it->second];
     if (cur_entry->IsConstantLo() && (cur_entry->IsPrecise() == precise) &&
         (down_cast<ConstantType*>(cur_entry))->ConstantValueLo() == value) {
       return *down_cast<ConstantType*>(cur_entry);
@@ -524,17 +569,18 @@ const ConstantType& RegTypeCache::FromCat2ConstLo(int32_t value, bool precise) {
   }
   ConstantType* entry;
   if (precise) {
-    entry = new PreciseConstLoType(value, entries_.size());
+    entry = new (arena_) PreciseConstLoType(value, entries_.size());
   } else {
-    entry = new ImpreciseConstLoType(value, entries_.size());
+    entry = new (arena_) ImpreciseConstLoType(value, entries_.size());
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
 const ConstantType& RegTypeCache::FromCat2ConstHi(int32_t value, bool precise) {
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    RegType* cur_entry = entries_[i];
+  auto range = constant_index_.equal_range(static_cast<size_t>(value));
+  for (auto it = range.first; it != range.second; ++it) {
+    RegType* cur_entry = entries_[it->second];
     if (cur_entry->IsConstantHi() && (cur_entry->IsPrecise() == precise) &&
         (down_cast<ConstantType*>(cur_entry))->ConstantValueHi() == value) {
       return *down_cast<ConstantType*>(cur_entry);
@@ -542,11 +588,11 @@ const ConstantType& RegTypeCache::FromCat2ConstHi(int32_t value, bool precise) {
   }
   ConstantType* entry;
   if (precise) {
-    entry = new PreciseConstHiType(value, entries_.size());
+    entry = new (arena_) PreciseConstHiType(value, entries_.size());
   } else {
-    entry = new ImpreciseConstHiType(value, entries_.size());
+    entry = new (arena_) ImpreciseConstHiType(value, entries_.size());
   }
-  entries_.push_back(entry);
+  AddEntry(entry);
   return *entry;
 }
 
@@ -577,6 +623,24 @@ void RegTypeCache::VisitRoots(RootVisitor* visitor, void* arg) {
   for (RegType* entry : entries_) {
     entry->VisitRoots(visitor, arg);
   }
+  // Classes may have moved, re-key the class index.
+  class_index_.clear();
+  for (size_t i = primitive_count_; i < entries_.size(); i++) {
+    if (entries_[i]->klass_ != NULL) {
+      class_index_.insert(std::make_pair(entries_[i]->klass_, static_cast<uint16_t>(i)));
+    }
+  }
+}
+
+void RegTypeCache::CollectDependencies(VerificationDependencies* dependencies) {
+  for (size_t i = primitive_count_; i < entries_.size(); i++) {
+    RegType* cur_entry = entries_[i];
+    if (cur_entry->IsUnresolvedTypes()) {
+      dependencies->has_unresolved_types = true;
+    } else if (cur_entry->HasClass()) {
+      dependencies->Add(cur_entry->GetClass());
+    }
+  }
 }
 
 }  // namespace verifier
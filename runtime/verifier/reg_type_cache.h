@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_VERIFIER_REG_TYPE_CACHE_H_
 #define ART_RUNTIME_VERIFIER_REG_TYPE_CACHE_H_
 
+#include "base/arena_allocator.h"
 #include "base/casts.h"
 #include "base/macros.h"
 #include "base/stl_util.h"
@@ -25,6 +26,7 @@
 #include "runtime.h"
 
 #include <stdint.h>
+#include <map>
 #include <vector>
 
 namespace art {
@@ -35,10 +37,13 @@ class ClassLoader;
 namespace verifier {
 
 class RegType;
+struct VerificationDependencies;
 
 class RegTypeCache {
  public:
-  explicit RegTypeCache(bool can_load_classes) : can_load_classes_(can_load_classes) {
+  // Non-primitive RegTypes are allocated in arena, which must outlive the cache.
+  RegTypeCache(bool can_load_classes, ArenaAllocator* arena)
+      : arena_(arena), can_load_classes_(can_load_classes) {
     entries_.reserve(64);
     FillPrimitiveAndSmallConstantTypes();
   }
@@ -148,6 +153,10 @@ class RegTypeCache {
 
   void VisitRoots(RootVisitor* visitor, void* arg) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Add the classes referenced by the entries of this cache to dependencies.
+  void CollectDependencies(VerificationDependencies* dependencies)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
  private:
   void FillPrimitiveAndSmallConstantTypes() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   mirror::Class* ResolveClass(const char* descriptor, mirror::ClassLoader* loader)
@@ -158,6 +167,10 @@ class RegTypeCache {
   const ConstantType& FromCat1NonSmallConstant(int32_t value, bool precise)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Append a newly created entry and add it to the lookup indexes.
+  void AddEntry(RegType* entry) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static size_t HashMergedTypes(const std::set<uint16_t>& types);
+
   template <class Type>
   static Type* CreatePrimitiveTypeInstance(const std::string& descriptor)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -166,6 +179,24 @@ class RegTypeCache {
   // The actual storage for the RegTypes.
   std::vector<RegType*> entries_;
 
+  // Indexes of the non-primitive entries, so that lookups don't need to scan entries_. Ids with
+  // the same key are kept in creation order, so the first matching id is the one a scan of
+  // entries_ would have found.
+  typedef std::multimap<size_t, uint16_t> Index;
+  // Hash of the descriptor to entry id.
+  Index descriptor_index_;
+  // Class to entry id, rebuilt when classes move.
+  std::multimap<mirror::Class*, uint16_t> class_index_;
+  // Constant value (low or high half for category 2 constants) to entry id.
+  Index constant_index_;
+  // Hash of the set of merged types to unresolved merged type id.
+  Index merged_index_;
+  // Child id to unresolved super class id.
+  Index super_class_index_;
+
+  // Allocator for the non-primitive entries.
+  ArenaAllocator* const arena_;
+
   // A quick look up for popular small constants.
   static constexpr int32_t kMinSmallConstant = -1;
   static constexpr int32_t kMaxSmallConstant = 4;
@@ -23,6 +23,11 @@
 namespace art {
 namespace verifier {
 
+RegisterLine* RegisterLine::Create(size_t num_regs, MethodVerifier* verifier) {
+  void* memory = verifier->GetArena()->Alloc(ComputeSize(num_regs), ArenaAllocator::kAllocVerifier);
+  return new (memory) RegisterLine(num_regs, verifier);
+}
+
 bool RegisterLine::CheckConstructorReturn() const {
   for (size_t i = 0; i < num_regs_; i++) {
     if (GetRegisterType(i).IsUninitializedThisReference() ||
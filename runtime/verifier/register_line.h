@@ -50,10 +50,13 @@ enum TypeCategory {
 // stack of entered monitors (identified by code unit offset).
 class RegisterLine {
  public:
-  static RegisterLine* Create(size_t num_regs, MethodVerifier* verifier) {
-    uint8_t* memory = new uint8_t[sizeof(RegisterLine) + (num_regs * sizeof(uint16_t))];
-    RegisterLine* rl = new (memory) RegisterLine(num_regs, verifier);
-    return rl;
+  // Create a line in the verifier's arena. The memory is released with the arena, the line must
+  // be destroyed explicitly (see RegisterLineArenaDelete) to release its monitor state.
+  static RegisterLine* Create(size_t num_regs, MethodVerifier* verifier);
+
+  // Bytes of arena needed by a line of num_regs registers.
+  static size_t ComputeSize(size_t num_regs) {
+    return sizeof(RegisterLine) + (num_regs * sizeof(uint16_t));
   }
 
   // Implement category-1 "move" instructions. Copy a 32-bit value from "vsrc" to "vdst".
@@ -343,14 +346,15 @@ class RegisterLine {
     SetResultTypeToUnknown();
   }
 
-  // Storage for the result register's type, valid after an invocation
-  uint16_t result_[2];
-
   // Back link to the verifier
   MethodVerifier* verifier_;
 
   // Length of reg_types_
   const uint32_t num_regs_;
+
+  // Storage for the result register's type, valid after an invocation. Kept next to num_regs_ so
+  // that the two pack into one word on 64-bit targets.
+  uint16_t result_[2];
   // A stack of monitor enter locations
   std::vector<uint32_t> monitors_;
   // A map from register to a bit vector of indices into the monitors_ stack. As we pop the monitor
@@ -360,7 +364,20 @@ class RegisterLine {
 
   // An array of RegType Ids associated with each dex register.
   uint16_t line_[0];
+
+  DISALLOW_COPY_AND_ASSIGN(RegisterLine);
 };
+
+// Runs the destructor of an arena allocated RegisterLine without freeing its memory.
+struct RegisterLineArenaDelete {
+  void operator()(RegisterLine* ptr) const {
+    if (ptr != nullptr) {
+      ptr->~RegisterLine();
+    }
+  }
+};
+
+typedef UniquePtr<RegisterLine, RegisterLineArenaDelete> RegisterLineArenaUniquePtr;
 std::ostream& operator<<(std::ostream& os, const RegisterLine& rhs);
 
 }  // namespace verifier
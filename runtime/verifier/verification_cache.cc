@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verification_cache.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "base/logging.h"
+#include "base/mutex-inl.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "dex_file.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/dex_cache.h"
+#include "object_utils.h"
+#include "os.h"
+#include "runtime.h"
+#include "sirt_ref.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace verifier {
+
+// The first line of a cache file. Bump the version when the format or the meaning of a
+// verification result changes.
+static const char* kVerificationCacheHeader = "art-verification-cache 1";
+
+void VerificationDependencies::Add(mirror::Class* klass) {
+  while (klass->IsArrayClass()) {
+    klass = klass->GetComponentType();
+  }
+  if (klass->IsPrimitive()) {
+    return;
+  }
+  mirror::DexCache* dex_cache = klass->GetDexCache();
+  if (dex_cache == nullptr || dex_cache->GetDexFile() == nullptr) {
+    // Proxy classes aren't backed by a dex file, treat them as something we can't check.
+    has_unresolved_types = true;
+    return;
+  }
+  classes.Overwrite(ClassHelper(klass).GetDescriptor(),
+                    dex_cache->GetDexFile()->GetLocationChecksum());
+}
+
+VerificationCache::VerificationCache(const std::string& filename)
+    : filename_(filename),
+      lock_("verification cache lock"),
+      entries_(),
+      dirty_(false) {
+}
+
+// Each line after the header describes one class:
+//   <dex checksum> <class def index> <descriptor> <soft failure> <dependency count>
+//   followed by <dependency count> pairs of <descriptor> <dex checksum>.
+bool VerificationCache::Parse(std::istream& is) {
+  std::string header;
+  if (!std::getline(is, header) || header != kVerificationCacheHeader) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    uint32_t checksum;
+    uint32_t class_def_idx;
+    Entry entry;
+    size_t num_dependencies;
+    if (!(ls >> checksum >> class_def_idx >> entry.descriptor >> entry.soft_failure
+             >> num_dependencies)) {
+      return false;
+    }
+    for (size_t i = 0; i < num_dependencies; ++i) {
+      std::string descriptor;
+      uint32_t dependency_checksum;
+      if (!(ls >> descriptor >> dependency_checksum)) {
+        return false;
+      }
+      entry.dependencies.Overwrite(descriptor, dependency_checksum);
+    }
+    entries_.Overwrite(Key(checksum, class_def_idx), entry);
+  }
+  return true;
+}
+
+bool VerificationCache::Load() {
+  std::string contents;
+  if (!ReadFileToString(filename_, &contents)) {
+    VLOG(verifier) << "No verification cache at " << filename_;
+    return false;
+  }
+  std::istringstream is(contents);
+  MutexLock mu(Thread::Current(), lock_);
+  if (!Parse(is)) {
+    LOG(WARNING) << "Discarding malformed verification cache " << filename_;
+    entries_.clear();
+    return false;
+  }
+  dirty_ = false;
+  VLOG(verifier) << "Loaded " << entries_.size() << " verification results from " << filename_;
+  return true;
+}
+
+bool VerificationCache::Save() {
+  std::ostringstream os;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    if (!dirty_) {
+      return true;
+    }
+    os << kVerificationCacheHeader << "\n";
+    for (const auto& it : entries_) {
+      const Entry& entry = it.second;
+      os << it.first.first << " " << it.first.second << " " << entry.descriptor << " "
+         << entry.soft_failure << " " << entry.dependencies.size();
+      for (const auto& dependency : entry.dependencies) {
+        os << " " << dependency.first << " " << dependency.second;
+      }
+      os << "\n";
+    }
+    dirty_ = false;
+  }
+  // Write to a temporary file and rename it into place so that a concurrently starting runtime
+  // never sees a partially written cache.
+  std::string tmp_filename(filename_ + ".tmp");
+  UniquePtr<File> file(OS::CreateEmptyFile(tmp_filename.c_str()));
+  if (file.get() == nullptr) {
+    PLOG(WARNING) << "Failed to create verification cache " << tmp_filename;
+    return false;
+  }
+  std::string data(os.str());
+  if (!file->WriteFully(data.c_str(), data.length()) || file->Close() != 0) {
+    PLOG(WARNING) << "Failed to write verification cache " << tmp_filename;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename " << tmp_filename << " to " << filename_;
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool VerificationCache::Lookup(mirror::Class* klass, bool* soft_failure) {
+  const DexFile& dex_file = ClassHelper(klass).GetDexFile();
+  Key key(dex_file.GetLocationChecksum(), klass->GetDexClassDefIndex());
+  Entry entry;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    entry = it->second;
+  }
+  if (entry.descriptor != ClassHelper(klass).GetDescriptor()) {
+    return false;
+  }
+  // The verifier resolved these classes through the class loader of klass, check that they still
+  // come from the same dex files.
+  Thread* self = Thread::Current();
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  SirtRef<mirror::ClassLoader> class_loader(self, klass->GetClassLoader());
+  for (const auto& dependency : entry.dependencies) {
+    mirror::Class* dependency_class = class_linker->FindClass(dependency.first.c_str(),
+                                                              class_loader);
+    if (dependency_class == nullptr) {
+      self->ClearException();
+      return false;
+    }
+    mirror::DexCache* dex_cache = dependency_class->GetDexCache();
+    if (dex_cache == nullptr || dex_cache->GetDexFile() == nullptr ||
+        dex_cache->GetDexFile()->GetLocationChecksum() != dependency.second) {
+      return false;
+    }
+  }
+  *soft_failure = entry.soft_failure;
+  return true;
+}
+
+void VerificationCache::Record(mirror::Class* klass, bool soft_failure,
+                               const VerificationDependencies& deps) {
+  if (deps.has_unresolved_types) {
+    return;
+  }
+  ClassHelper kh(klass);
+  Key key(kh.GetDexFile().GetLocationChecksum(), klass->GetDexClassDefIndex());
+  Entry entry;
+  entry.descriptor = kh.GetDescriptor();
+  entry.soft_failure = soft_failure;
+  entry.dependencies = deps.classes;
+  // The class itself is implied by the key.
+  entry.dependencies.erase(entry.descriptor);
+  MutexLock mu(Thread::Current(), lock_);
+  entries_.Overwrite(key, entry);
+  dirty_ = true;
+}
+
+size_t VerificationCache::Size() {
+  MutexLock mu(Thread::Current(), lock_);
+  return entries_.size();
+}
+
+}  // namespace verifier
+}  // namespace art
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_VERIFIER_VERIFICATION_CACHE_H_
+#define ART_RUNTIME_VERIFIER_VERIFICATION_CACHE_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <string>
+#include <utility>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "safe_map.h"
+
+namespace art {
+namespace mirror {
+class Class;
+}  // namespace mirror
+namespace verifier {
+
+// The classes consulted while verifying a class, keyed by descriptor and mapped to the location
+// checksum of the dex file that defined them when the class was verified.
+struct VerificationDependencies {
+  VerificationDependencies() : has_unresolved_types(false) {}
+
+  // Record klass (or the element class of an array class) as a dependency.
+  void Add(mirror::Class* klass) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  SafeMap<std::string, uint32_t> classes;
+  // Set when verification saw a type that didn't resolve. Such results depend on the absence of
+  // a class, which a checksum can't capture, so they are not cached.
+  bool has_unresolved_types;
+};
+
+// A persistent record of runtime verification results. Classes that passed verification (with or
+// without soft failures) are recorded along with their dependencies, so that a later run of the
+// runtime on the same dex files can skip MethodVerifier entirely. An entry is only used if the
+// class's dex file and every dependency still resolve to dex files with the same checksums.
+class VerificationCache {
+ public:
+  explicit VerificationCache(const std::string& filename);
+
+  // Read the entries previously written to the cache file. Returns false if the file is missing
+  // or malformed, in which case the cache starts out empty.
+  bool Load() LOCKS_EXCLUDED(lock_);
+
+  // Write the entries to the cache file if anything changed since it was loaded.
+  bool Save() LOCKS_EXCLUDED(lock_);
+
+  // Returns true and sets soft_failure if there is a valid entry for klass.
+  bool Lookup(mirror::Class* klass, bool* soft_failure)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(lock_);
+
+  // Record the result of verifying klass.
+  void Record(mirror::Class* klass, bool soft_failure, const VerificationDependencies& deps)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(lock_);
+
+  size_t Size() LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Entry {
+    std::string descriptor;
+    bool soft_failure;
+    SafeMap<std::string, uint32_t> dependencies;
+  };
+  // Dex file location checksum and class def index of the verified class.
+  typedef std::pair<uint32_t, uint16_t> Key;
+
+  bool Parse(std::istream& is) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const std::string filename_;
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<Key, Entry> entries_ GUARDED_BY(lock_);
+  bool dirty_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(VerificationCache);
+};
+
+}  // namespace verifier
+}  // namespace art
+
+#endif  // ART_RUNTIME_VERIFIER_VERIFICATION_CACHE_H_
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verification_cache.h"
+
+#include "class_linker.h"
+#include "common_test.h"
+#include "method_verifier.h"
+
+namespace art {
+namespace verifier {
+
+class VerificationCacheTest : public CommonTest {};
+
+TEST_F(VerificationCacheTest, RecordSaveLoad) {
+  ScopedObjectAccess soa(Thread::Current());
+  ScratchFile tmp;
+  mirror::Class* klass = class_linker_->FindSystemClass("Ljava/lang/String;");
+  ASSERT_TRUE(klass != NULL);
+
+  VerificationDependencies dependencies;
+  std::string error_msg;
+  ASSERT_EQ(MethodVerifier::kNoFailure,
+            MethodVerifier::VerifyClass(klass, true, &error_msg, &dependencies)) << error_msg;
+  EXPECT_FALSE(dependencies.has_unresolved_types);
+  EXPECT_NE(0U, dependencies.classes.size());
+
+  {
+    VerificationCache cache(tmp.GetFilename());
+    bool soft_failure;
+    EXPECT_FALSE(cache.Lookup(klass, &soft_failure));
+    cache.Record(klass, false, dependencies);
+    ASSERT_TRUE(cache.Lookup(klass, &soft_failure));
+    EXPECT_FALSE(soft_failure);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  VerificationCache cache(tmp.GetFilename());
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(1U, cache.Size());
+  bool soft_failure = true;
+  ASSERT_TRUE(cache.Lookup(klass, &soft_failure));
+  EXPECT_FALSE(soft_failure);
+  mirror::Class* other = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  EXPECT_FALSE(cache.Lookup(other, &soft_failure));
+}
+
+TEST_F(VerificationCacheTest, UnresolvedNotRecorded) {
+  ScopedObjectAccess soa(Thread::Current());
+  ScratchFile tmp;
+  mirror::Class* klass = class_linker_->FindSystemClass("Ljava/lang/String;");
+  VerificationDependencies dependencies;
+  dependencies.has_unresolved_types = true;
+  VerificationCache cache(tmp.GetFilename());
+  cache.Record(klass, false, dependencies);
+  EXPECT_EQ(0U, cache.Size());
+}
+
+TEST_F(VerificationCacheTest, Malformed) {
+  ScratchFile tmp;
+  const char kGarbage[] = "not a verification cache\n";
+  ASSERT_TRUE(tmp.GetFile()->WriteFully(kGarbage, sizeof(kGarbage) - 1));
+  VerificationCache cache(tmp.GetFilename());
+  EXPECT_FALSE(cache.Load());
+  EXPECT_EQ(0U, cache.Size());
+}
+
+}  // namespace verifier
+}  // namespace art
@@ -14,27 +14,41 @@
  * limitations under the License.
  */
 
+import java.util.Arrays;
 import junit.framework.Assert;
 
 public class Main {
   public static void main(String args[]) {
+    test_Arrays_fill();
     test_Double_doubleToRawLongBits();
     test_Double_longBitsToDouble();
     test_Float_floatToRawIntBits();
     test_Float_intBitsToFloat();
+    test_Integer_bitCount();
+    test_Integer_numberOfLeadingZeros();
+    test_Integer_numberOfTrailingZeros();
+    test_Long_bitCount();
+    test_Long_numberOfLeadingZeros();
+    test_Long_numberOfTrailingZeros();
     test_Math_abs_I();
     test_Math_abs_J();
     test_Math_min();
     test_Math_max();
+    test_Math_min_J();
+    test_Math_max_J();
     test_StrictMath_abs_I();
     test_StrictMath_abs_J();
     test_StrictMath_min();
     test_StrictMath_max();
+    test_StrictMath_min_J();
+    test_StrictMath_max_J();
     test_String_charAt();
     test_String_compareTo();
+    test_String_equals();
     test_String_indexOf();
     test_String_isEmpty();
     test_String_length();
+    test_System_arraycopy();
   }
 
   public static void test_String_length() {
@@ -329,4 +343,262 @@ public class Main {
     Assert.assertEquals(Double.longBitsToDouble(0x7ff0000000000000L), Double.POSITIVE_INFINITY);
     Assert.assertEquals(Double.longBitsToDouble(0xfff0000000000000L), Double.NEGATIVE_INFINITY);
   }
+
+  public static void test_Integer_bitCount() {
+    Assert.assertEquals(Integer.bitCount(0), 0);
+    Assert.assertEquals(Integer.bitCount(1), 1);
+    Assert.assertEquals(Integer.bitCount(0x0f0f0f0f), 16);
+    Assert.assertEquals(Integer.bitCount(0x80000000), 1);
+    Assert.assertEquals(Integer.bitCount(Integer.MAX_VALUE), 31);
+    Assert.assertEquals(Integer.bitCount(-1), 32);
+    // The result in the register of the argument, a loop gets x promoted.
+    int x = -1;
+    for (int i = 0; i < 3; i++) {
+      x = Integer.bitCount(x);
+    }
+    Assert.assertEquals(x, 1);
+  }
+
+  public static void test_Long_bitCount() {
+    Assert.assertEquals(Long.bitCount(0L), 0);
+    Assert.assertEquals(Long.bitCount(1L), 1);
+    Assert.assertEquals(Long.bitCount(0x100000000L), 1);
+    Assert.assertEquals(Long.bitCount(0x0f0f0f0f0f0f0f0fL), 32);
+    Assert.assertEquals(Long.bitCount(Long.MIN_VALUE), 1);
+    Assert.assertEquals(Long.bitCount(Long.MAX_VALUE), 63);
+    Assert.assertEquals(Long.bitCount(-1L), 64);
+  }
+
+  public static void test_Integer_numberOfLeadingZeros() {
+    Assert.assertEquals(Integer.numberOfLeadingZeros(0), 32);
+    Assert.assertEquals(Integer.numberOfLeadingZeros(1), 31);
+    Assert.assertEquals(Integer.numberOfLeadingZeros(0x00010000), 15);
+    Assert.assertEquals(Integer.numberOfLeadingZeros(Integer.MAX_VALUE), 1);
+    Assert.assertEquals(Integer.numberOfLeadingZeros(-1), 0);
+  }
+
+  public static void test_Long_numberOfLeadingZeros() {
+    Assert.assertEquals(Long.numberOfLeadingZeros(0L), 64);
+    Assert.assertEquals(Long.numberOfLeadingZeros(1L), 63);
+    Assert.assertEquals(Long.numberOfLeadingZeros(0xffffffffL), 32);
+    Assert.assertEquals(Long.numberOfLeadingZeros(0x100000000L), 31);
+    Assert.assertEquals(Long.numberOfLeadingZeros(Long.MAX_VALUE), 1);
+    Assert.assertEquals(Long.numberOfLeadingZeros(-1L), 0);
+  }
+
+  public static void test_Integer_numberOfTrailingZeros() {
+    Assert.assertEquals(Integer.numberOfTrailingZeros(0), 32);
+    Assert.assertEquals(Integer.numberOfTrailingZeros(1), 0);
+    Assert.assertEquals(Integer.numberOfTrailingZeros(0x00010000), 16);
+    Assert.assertEquals(Integer.numberOfTrailingZeros(Integer.MIN_VALUE), 31);
+    Assert.assertEquals(Integer.numberOfTrailingZeros(-1), 0);
+  }
+
+  public static void test_Long_numberOfTrailingZeros() {
+    Assert.assertEquals(Long.numberOfTrailingZeros(0L), 64);
+    Assert.assertEquals(Long.numberOfTrailingZeros(1L), 0);
+    Assert.assertEquals(Long.numberOfTrailingZeros(0x80000000L), 31);
+    Assert.assertEquals(Long.numberOfTrailingZeros(0x100000000L), 32);
+    Assert.assertEquals(Long.numberOfTrailingZeros(Long.MIN_VALUE), 63);
+    Assert.assertEquals(Long.numberOfTrailingZeros(-1L), 0);
+  }
+
+  public static void test_Math_min_J() {
+    Assert.assertEquals(Math.min(0L, 0L), 0L);
+    Assert.assertEquals(Math.min(1L, 0L), 0L);
+    Assert.assertEquals(Math.min(0L, 1L), 0L);
+    Assert.assertEquals(Math.min(0L, Long.MAX_VALUE), 0L);
+    Assert.assertEquals(Math.min(Long.MIN_VALUE, 0L), Long.MIN_VALUE);
+    Assert.assertEquals(Math.min(Long.MIN_VALUE, Long.MAX_VALUE), Long.MIN_VALUE);
+    // Equal high words, so the low words decide.
+    Assert.assertEquals(Math.min(0x100000001L, 0x1ffffffffL), 0x100000001L);
+    Assert.assertEquals(Math.min(-1L, 0xffffffffL), -1L);
+  }
+
+  public static void test_Math_max_J() {
+    Assert.assertEquals(Math.max(0L, 0L), 0L);
+    Assert.assertEquals(Math.max(1L, 0L), 1L);
+    Assert.assertEquals(Math.max(0L, 1L), 1L);
+    Assert.assertEquals(Math.max(0L, Long.MAX_VALUE), Long.MAX_VALUE);
+    Assert.assertEquals(Math.max(Long.MIN_VALUE, 0L), 0L);
+    Assert.assertEquals(Math.max(Long.MIN_VALUE, Long.MAX_VALUE), Long.MAX_VALUE);
+    Assert.assertEquals(Math.max(0x100000001L, 0x1ffffffffL), 0x1ffffffffL);
+    Assert.assertEquals(Math.max(-1L, 0xffffffffL), 0xffffffffL);
+  }
+
+  public static void test_StrictMath_min_J() {
+    Assert.assertEquals(StrictMath.min(0L, 0L), 0L);
+    Assert.assertEquals(StrictMath.min(1L, 0L), 0L);
+    Assert.assertEquals(StrictMath.min(0L, 1L), 0L);
+    Assert.assertEquals(StrictMath.min(Long.MIN_VALUE, Long.MAX_VALUE), Long.MIN_VALUE);
+    Assert.assertEquals(StrictMath.min(0x100000001L, 0x1ffffffffL), 0x100000001L);
+  }
+
+  public static void test_StrictMath_max_J() {
+    Assert.assertEquals(StrictMath.max(0L, 0L), 0L);
+    Assert.assertEquals(StrictMath.max(1L, 0L), 1L);
+    Assert.assertEquals(StrictMath.max(0L, 1L), 1L);
+    Assert.assertEquals(StrictMath.max(Long.MIN_VALUE, Long.MAX_VALUE), Long.MAX_VALUE);
+    Assert.assertEquals(StrictMath.max(0x100000001L, 0x1ffffffffL), 0x1ffffffffL);
+  }
+
+  public static void test_String_equals() {
+    String str = "0123456789";
+    String copy = new String("0123456789");
+    String shorter = "012345678";
+    String longer = "0123456789a";
+    String sameLength = "0123456780";
+    String offset = new String("xxx0123456789yyy");
+    String sub = offset.substring(3, 13);
+    String empty = "";
+    Object notString = new Object();
+
+    // Same reference.
+    Assert.assertTrue(str.equals(str));
+    Assert.assertTrue(empty.equals(empty));
+    // Null and other classes.
+    Assert.assertFalse(str.equals(null));
+    Assert.assertFalse(empty.equals(null));
+    Assert.assertFalse(str.equals(notString));
+    // Different lengths.
+    Assert.assertFalse(str.equals(shorter));
+    Assert.assertFalse(shorter.equals(str));
+    Assert.assertFalse(str.equals(longer));
+    Assert.assertFalse(str.equals(empty));
+    Assert.assertFalse(empty.equals(str));
+    // Same length, compared character by character.
+    Assert.assertTrue(str.equals(copy));
+    Assert.assertTrue(copy.equals(str));
+    Assert.assertFalse(str.equals(sameLength));
+    Assert.assertTrue(empty.equals(new String("")));
+    // Strings sharing a char array at an offset.
+    Assert.assertTrue(str.equals(sub));
+    Assert.assertTrue(sub.equals(str));
+    Assert.assertFalse(offset.equals(sub));
+
+    String strNull = null;
+    try {
+      strNull.equals(str);
+      Assert.fail();
+    } catch (NullPointerException expected) {
+    }
+  }
+
+  public static void test_System_arraycopy() {
+    char[] src = "0123456789".toCharArray();
+    char[] dst = new char[12];
+    System.arraycopy(src, 0, dst, 1, 10);
+    Assert.assertEquals(dst[0], (char) 0);
+    for (int i = 0; i < 10; i++) {
+      Assert.assertEquals(dst[i + 1], src[i]);
+    }
+    Assert.assertEquals(dst[11], (char) 0);
+    System.arraycopy(src, 8, dst, 0, 2);
+    Assert.assertEquals(dst[0], '8');
+    Assert.assertEquals(dst[1], '9');
+    Assert.assertEquals(dst[2], '1');
+    // Nothing to copy, at the very end of both arrays.
+    System.arraycopy(src, 10, dst, 12, 0);
+
+    // Long enough to be left to the library.
+    char[] longSrc = new char[100];
+    for (int i = 0; i < longSrc.length; i++) {
+      longSrc[i] = (char) ('a' + i % 26);
+    }
+    char[] longDst = new char[101];
+    System.arraycopy(longSrc, 0, longDst, 1, 100);
+    Assert.assertEquals(longDst[0], (char) 0);
+    for (int i = 0; i < 100; i++) {
+      Assert.assertEquals(longDst[i + 1], longSrc[i]);
+    }
+
+    // Overlapping copies within one array.
+    char[] chars = "0123456789".toCharArray();
+    System.arraycopy(chars, 0, chars, 1, 9);
+    Assert.assertEquals(new String(chars), "0012345678");
+    System.arraycopy(chars, 2, chars, 0, 8);
+    Assert.assertEquals(new String(chars), "1234567878");
+
+    // Other arrays.
+    int[] ints = { 1, 2, 3 };
+    int[] intsCopy = new int[3];
+    System.arraycopy(ints, 0, intsCopy, 0, 3);
+    Assert.assertEquals(intsCopy[2], 3);
+    Object[] objects = { "a", "b" };
+    Object[] objectsCopy = new Object[2];
+    System.arraycopy(objects, 0, objectsCopy, 0, 2);
+    Assert.assertSame(objectsCopy[1], objects[1]);
+
+    try {
+      System.arraycopy(null, 0, dst, 0, 1);
+      Assert.fail();
+    } catch (NullPointerException expected) {
+    }
+    try {
+      System.arraycopy(src, 0, null, 0, 1);
+      Assert.fail();
+    } catch (NullPointerException expected) {
+    }
+    try {
+      System.arraycopy(src, -1, dst, 0, 1);
+      Assert.fail();
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(src, 0, dst, -1, 1);
+      Assert.fail();
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(src, 0, dst, 0, -1);
+      Assert.fail();
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(src, 5, dst, 0, 6);
+      Assert.fail();
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(src, 0, dst, 3, 10);
+      Assert.fail();
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(src, 0, ints, 0, 1);
+      Assert.fail();
+    } catch (ArrayStoreException expected) {
+    }
+    try {
+      System.arraycopy("0123", 0, dst, 0, 1);
+      Assert.fail();
+    } catch (ArrayStoreException expected) {
+    }
+  }
+
+  public static void test_Arrays_fill() {
+    byte[] bytes = new byte[5];
+    Arrays.fill(bytes, (byte) -2);
+    for (byte b : bytes) {
+      Assert.assertEquals(b, (byte) -2);
+    }
+    char[] chars = new char[3];
+    Arrays.fill(chars, '\uffff');
+    for (char c : chars) {
+      Assert.assertEquals(c, '\uffff');
+    }
+    int[] ints = new int[7];
+    Arrays.fill(ints, Integer.MIN_VALUE);
+    for (int i : ints) {
+      Assert.assertEquals(i, Integer.MIN_VALUE);
+    }
+    Arrays.fill(new int[0], 1);
+
+    int[] intsNull = null;
+    try {
+      Arrays.fill(intsNull, 1);
+      Assert.fail();
+    } catch (NullPointerException expected) {
+    }
+  }
 }
@@ -25,7 +25,9 @@ TEST_DEX_DIRECTORIES := \
 	AllFields \
 	ExceptionHandle \
 	GetMethodSignature \
+	Inlining \
 	Interfaces \
+	LiveTemps \
 	Main \
 	MyClass \
 	MyClassNatives \
@@ -33,9 +35,14 @@ TEST_DEX_DIRECTORIES := \
 	NonStaticLeafMethods \
 	ProtoCompare \
 	ProtoCompare2 \
+	RangeChecks \
+	RedundantLoads \
+	ScalarReplacement \
+	SingleImplementation \
 	StaticLeafMethods \
 	Statics \
 	StaticsFromCode \
+	Vectorization \
 	XandY
 
 # subdirectories of which are used with test-art-target-oat
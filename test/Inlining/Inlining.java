@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Inlining {
+    int x;
+
+    static void empty() {
+    }
+
+    static int returnArg(int a) {
+        return a;
+    }
+
+    static int constant() {
+        return 42;
+    }
+
+    private int getX() {
+        return x;
+    }
+
+    private void setX(int value) {
+        x = value;
+    }
+
+    private void emptyInstance() {
+    }
+
+    private int getXOf(Inlining other) {
+        return other.x;
+    }
+
+    static void callEmpty() {
+        empty();
+    }
+
+    static int callReturnArg(int a) {
+        return returnArg(a);
+    }
+
+    static int callConstant() {
+        return constant();
+    }
+
+    int callGetter() {
+        return getX();
+    }
+
+    void callSetter(int value) {
+        setX(value);
+    }
+
+    void callEmptyInstance() {
+        emptyInstance();
+    }
+
+    int callGetterOfArgument(Inlining other) {
+        return getXOf(other);
+    }
+
+    static int callConstantOfOtherClass() {
+        return InliningOther.constant();
+    }
+
+    int callGetterInTry() {
+        try {
+            return getX();
+        } catch (RuntimeException e) {
+            return 0;
+        }
+    }
+}
+
+class InliningOther {
+    static int constant() {
+        return 1;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class RangeChecks {
+    static int countUp(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int countDown(int[] a) {
+        int sum = 0;
+        for (int i = a.length - 1; i >= 0; i--) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int boundedByArgument(int[] a, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int countUpByTwo(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i += 2) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int boundedByOtherArray(int[] a, int[] b) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += b[i];
+        }
+        return sum;
+    }
+}
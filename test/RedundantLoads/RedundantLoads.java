@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class RedundantLoads {
+    static class Inner {
+        int value;
+    }
+
+    Inner inner;
+    int x;
+    int y;
+
+    int loadInDominatedBlock(boolean flag) {
+        int sum = inner.value;
+        if (flag) {
+            sum += inner.value;
+        }
+        return sum;
+    }
+
+    int loadAfterStore(boolean flag, Inner other) {
+        int sum = inner.value;
+        inner = other;
+        if (flag) {
+            sum += inner.value;
+        }
+        return sum;
+    }
+
+    int loadAfterCall(boolean flag) {
+        int sum = inner.value;
+        clobber();
+        if (flag) {
+            sum += inner.value;
+        }
+        return sum;
+    }
+
+    int loadInHandler(Inner other) {
+        try {
+            return other.value;
+        } catch (NullPointerException e) {
+            return other.value + 1;
+        }
+    }
+
+    int loadElementInHandler(int[] a, int i) {
+        try {
+            return a[i];
+        } catch (ArrayIndexOutOfBoundsException e) {
+            return a[i] + 1;
+        }
+    }
+
+    int invariantLoad(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += x;
+        }
+        return sum;
+    }
+
+    int loadInLoopWithStore(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += x;
+            y = sum;
+        }
+        return sum;
+    }
+
+    int loadInLoopWithCall(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += x;
+            clobber();
+        }
+        return sum;
+    }
+
+    void clobber() {
+        y++;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class ScalarReplacement {
+    static class Point {
+        int x;
+        int y;
+
+        Point(int x, int y) {
+            this.x = x;
+            this.y = y;
+        }
+    }
+
+    static class Doubled {
+        int x;
+
+        Doubled(int x) {
+            this.x = x * 2;
+        }
+    }
+
+    static Point escaped;
+
+    static int nonEscaping(int x, int y) {
+        Point p = new Point(x, y);
+        return p.x + p.y;
+    }
+
+    static int escaping(int x, int y) {
+        Point p = new Point(x, y);
+        escaped = p;
+        return p.x + p.y;
+    }
+
+    static int notCopyingConstructor(int x) {
+        Doubled d = new Doubled(x);
+        return d.x;
+    }
+
+    static int writtenAfterConstruction(int x, int y) {
+        Point p = new Point(x, y);
+        p.x = y;
+        return p.x + p.y;
+    }
+}
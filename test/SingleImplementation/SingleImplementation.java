@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.InvocationHandler;
+import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+
+class SingleImplementation {
+    // m00 and m64 share an IMT slot, so calls to them go through the IMT conflict trampoline.
+    interface Many {
+        int m00();
+        int m01();
+        int m02();
+        int m03();
+        int m04();
+        int m05();
+        int m06();
+        int m07();
+        int m08();
+        int m09();
+        int m10();
+        int m11();
+        int m12();
+        int m13();
+        int m14();
+        int m15();
+        int m16();
+        int m17();
+        int m18();
+        int m19();
+        int m20();
+        int m21();
+        int m22();
+        int m23();
+        int m24();
+        int m25();
+        int m26();
+        int m27();
+        int m28();
+        int m29();
+        int m30();
+        int m31();
+        int m32();
+        int m33();
+        int m34();
+        int m35();
+        int m36();
+        int m37();
+        int m38();
+        int m39();
+        int m40();
+        int m41();
+        int m42();
+        int m43();
+        int m44();
+        int m45();
+        int m46();
+        int m47();
+        int m48();
+        int m49();
+        int m50();
+        int m51();
+        int m52();
+        int m53();
+        int m54();
+        int m55();
+        int m56();
+        int m57();
+        int m58();
+        int m59();
+        int m60();
+        int m61();
+        int m62();
+        int m63();
+        int m64();
+    }
+
+    static class OnlyImplementation implements Many {
+        public int m00() { return 1; }
+        public int m01() { return 0; }
+        public int m02() { return 0; }
+        public int m03() { return 0; }
+        public int m04() { return 0; }
+        public int m05() { return 0; }
+        public int m06() { return 0; }
+        public int m07() { return 0; }
+        public int m08() { return 0; }
+        public int m09() { return 0; }
+        public int m10() { return 0; }
+        public int m11() { return 0; }
+        public int m12() { return 0; }
+        public int m13() { return 0; }
+        public int m14() { return 0; }
+        public int m15() { return 0; }
+        public int m16() { return 0; }
+        public int m17() { return 0; }
+        public int m18() { return 0; }
+        public int m19() { return 0; }
+        public int m20() { return 0; }
+        public int m21() { return 0; }
+        public int m22() { return 0; }
+        public int m23() { return 0; }
+        public int m24() { return 0; }
+        public int m25() { return 0; }
+        public int m26() { return 0; }
+        public int m27() { return 0; }
+        public int m28() { return 0; }
+        public int m29() { return 0; }
+        public int m30() { return 0; }
+        public int m31() { return 0; }
+        public int m32() { return 0; }
+        public int m33() { return 0; }
+        public int m34() { return 0; }
+        public int m35() { return 0; }
+        public int m36() { return 0; }
+        public int m37() { return 0; }
+        public int m38() { return 0; }
+        public int m39() { return 0; }
+        public int m40() { return 0; }
+        public int m41() { return 0; }
+        public int m42() { return 0; }
+        public int m43() { return 0; }
+        public int m44() { return 0; }
+        public int m45() { return 0; }
+        public int m46() { return 0; }
+        public int m47() { return 0; }
+        public int m48() { return 0; }
+        public int m49() { return 0; }
+        public int m50() { return 0; }
+        public int m51() { return 0; }
+        public int m52() { return 0; }
+        public int m53() { return 0; }
+        public int m54() { return 0; }
+        public int m55() { return 0; }
+        public int m56() { return 0; }
+        public int m57() { return 0; }
+        public int m58() { return 0; }
+        public int m59() { return 0; }
+        public int m60() { return 0; }
+        public int m61() { return 0; }
+        public int m62() { return 0; }
+        public int m63() { return 0; }
+        public int m64() { return 0; }
+    }
+
+    static int callM00(Many many) {
+        return many.m00();
+    }
+
+    static int callM01(Many many) {
+        return many.m01();
+    }
+
+    static int callWithImplementation() {
+        return callM00(new OnlyImplementation());
+    }
+
+    // The proxy class is only defined at runtime, after the compiler's class hierarchy analysis.
+    static int callWithProxy() {
+        InvocationHandler handler = new InvocationHandler() {
+            public Object invoke(Object proxy, Method method, Object[] args) {
+                return 2;
+            }
+        };
+        Many many = (Many) Proxy.newProxyInstance(Many.class.getClassLoader(),
+                                                  new Class[] { Many.class }, handler);
+        return callM00(many);
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Vectorization {
+    static void add(int[] a, int[] b, int[] c) {
+        for (int i = 0; i < a.length; i++) {
+            a[i] = b[i] + c[i];
+        }
+    }
+
+    static int sum(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static void addByTwo(int[] a, int[] b, int[] c) {
+        for (int i = 0; i < a.length; i += 2) {
+            a[i] = b[i] + c[i];
+        }
+    }
+
+    // Each element depends on the one stored by the previous iteration.
+    static void addToPrevious(int[] a) {
+        for (int i = 1; i < a.length; i++) {
+            a[i] = a[i - 1] + 1;
+        }
+    }
+
+    static void addChars(char[] a, char[] b, char[] c) {
+        for (int i = 0; i < a.length; i++) {
+            a[i] = (char) (b[i] + c[i]);
+        }
+    }
+
+    static void addLongs(long[] a, long[] b, long[] c) {
+        for (int i = 0; i < a.length; i++) {
+            a[i] = b[i] + c[i];
+        }
+    }
+}